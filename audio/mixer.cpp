@@ -44,24 +44,23 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent, RateConverterQuality quality);
 	~Channel();
 
 	/**
-	 * Mixes the channel's samples into the given buffer.
+	 * Mixes the channel's samples into the given mix bus.
 	 *
-	 * @param data buffer where to mix the data
-	 * @param len  number of sample *pairs*. So a value of
-	 *             10 means that the buffer contains twice 10 sample, each
-	 *             16 bits, for a total of 40 bytes.
+	 * @param data   mix bus where to mix the data, in 1/256th of a sample
+	 * @param len    number of sample *pairs*. So a value of
+	 *               10 means that the buffer contains twice 10 samples.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int32 *data, uint len);
 
 	/**
 	 * Queries whether the channel is still playing or not.
 	 */
-	bool isFinished() const { return _stream->endOfStream(); }
+	bool isFinished() const { return _stream->endOfStream() && !_converter->hasPendingOutput(); }
 
 	/**
 	 * Queries whether the channel is a permanent channel.
@@ -86,7 +85,7 @@ public:
 	/**
 	 * Queries whether the channel is currently paused.
 	 */
-	bool isPaused() const { return (_pauseLevel != 0); }
+	bool isPaused() const { return (_pauseLevel.load() != 0); }
 
 	/**
 	 * Sets the channel's own volume.
@@ -148,21 +147,27 @@ private:
 	const Mixer::SoundType _type;
 	SoundHandle _handle;
 	bool _permanent;
-	int _pauseLevel;
+	Common::Atomic<int> _pauseLevel;
 	int _id;
 
 	byte _volume;
 	int8 _balance;
 
 	void updateChannelVolumes();
-	st_volume_t _volL, _volR;
+	/** The left volume in the upper and the right one in the lower 16 bits. */
+	Common::Atomic<uint32> _mixVolume;
 
 	Mixer *_mixer;
 
-	uint32 _samplesConsumed;
+	// Written by mix() and read by getElapsedTime(). _timeSeq is odd while
+	// mix() updates them.
+	Common::Atomic<uint32> _timeSeq;
+	Common::Atomic<uint32> _samplesConsumed;
+	Common::Atomic<uint32> _mixerTimeStamp;
 	uint32 _samplesDecoded;
-	uint32 _mixerTimeStamp;
+
 	uint32 _pauseStartTime;
+	uint32 _pauseEndTime;
 	uint32 _pauseTime;
 
 	RateConverter *_converter;
@@ -174,18 +179,24 @@ private:
 #pragma mark -
 
 // TODO: parameter "system" is unused
-MixerImpl::MixerImpl(OSystem *system, uint sampleRate)
-	: _mutex(), _sampleRate(sampleRate), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+MixerImpl::MixerImpl(OSystem *system, uint sampleRate, RateConverterQuality rateConverterQuality)
+	: _mutex(), _sampleRate(sampleRate), _rateConverterQuality(rateConverterQuality),
+	  _mixerReady(false), _handleSeed(0), _soundTypeSettings(), _mixingChannel(0),
+	  _mixBuffer(0), _mixBufferSize(0), _ditherSeed(1) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = 0;
+		_stopping[i] = false;
+	}
 }
 
 MixerImpl::~MixerImpl() {
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	free(_mixBuffer);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -196,7 +207,72 @@ uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
 
+bool MixerImpl::isChannelActive(int index) const {
+	return _channels[index] && _mixChannels[index].load() == _channels[index];
+}
+
+bool MixerImpl::isChannelPlaying(int index) const {
+	// Channels which are being stopped still count until they are deleted, so
+	// that callers can rely on the stream not being used anymore afterwards
+	return _channels[index] && (_stopping[index] || _mixChannels[index].load() == _channels[index]);
+}
+
+Channel *MixerImpl::findChannel(SoundHandle handle) const {
+	const int index = handle._val % NUM_CHANNELS;
+	if (!isChannelActive(index) || _channels[index]->getHandle()._val != handle._val)
+		return 0;
+
+	return _channels[index];
+}
+
+void MixerImpl::reapChannels() {
+	// The mixer callback does not touch a channel anymore after clearing its
+	// slot, so these can be deleted right away
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (_channels[i] && !isChannelPlaying(i)) {
+			// Deleting the stream might call back into the mixer
+			Channel *chan = _channels[i];
+			_channels[i] = 0;
+			delete chan;
+		}
+	}
+}
+
+void MixerImpl::removeChannel(int index, RemovedChannels &removed) {
+	removed.channels[index] = _channels[index];
+	// Another thread might be stopping it already. Then we only have to wait
+	// until the mixer callback is done with it, too.
+	removed.owned[index] = !_stopping[index];
+	if (removed.owned[index]) {
+		_stopping[index] = true;
+		_mixChannels[index].store(0);
+	}
+}
+
+void MixerImpl::deleteRemovedChannels(const RemovedChannels &removed) {
+	// The mixer callback announces the channel it works on before it checks
+	// that it is still in its slot. Either it has seen the cleared slot, or
+	// it is still busy with the channel and we have to wait for it. This is
+	// done without holding the mutex, since the stream of another channel
+	// might call us from the mixer callback.
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		while (removed.channels[i] && _mixingChannel.load() == removed.channels[i])
+			g_system->delayMillis(1);
+	}
+
+	Common::StackLock lock(_mutex);
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		if (removed.channels[i] && removed.owned[i]) {
+			delete _channels[i];
+			_channels[i] = 0;
+			_stopping[i] = false;
+		}
+	}
+}
+
 void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
+	reapChannels();
+
 	int index = -1;
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] == 0) {
@@ -219,6 +295,9 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 	_handleSeed++;
 	if (handle)
 		*handle = chanHandle;
+
+	// Hand the fully set up channel over to the mixer callback
+	_mixChannels[index].store(chan);
 }
 
 void MixerImpl::playStream(
@@ -242,7 +321,7 @@ void MixerImpl::playStream(
 	// Prevent duplicate sounds
 	if (id != -1) {
 		for (int i = 0; i != NUM_CHANNELS; i++)
-			if (_channels[i] != 0 && _channels[i]->getId() == id) {
+			if (isChannelPlaying(i) && _channels[i]->getId() == id) {
 				// Delete the stream if were asked to auto-dispose it.
 				// Note: This could cause trouble if the client code does not
 				// yet expect the stream to be gone. The primary example to
@@ -260,80 +339,175 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterQuality);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
 }
 
-int MixerImpl::mixCallback(byte *samples, uint len) {
-	assert(samples);
-
+int MixerImpl::mixChannels(uint len) {
+#ifndef COMMON_HAS_LOCKFREE_ATOMICS
+	// The slots cannot be handed over safely without atomic operations
 	Common::StackLock lock(_mutex);
+#endif
 
-	int16 *buf = (int16 *)samples;
-	// we store stereo, 16-bit samples
-	assert(len % 4 == 0);
-	len >>= 2;
+	// Reallocate the mix bus, if necessary
+	if (len > _mixBufferSize) {
+		free(_mixBuffer);
+		_mixBuffer = (int32 *)malloc(2 * len * sizeof(int32));
+		_mixBufferSize = len;
+
+		if (!_mixBuffer)
+			error("[MixerImpl::mixChannels] Cannot allocate memory for the mix bus");
+	}
 
 	// Since the mixer callback has been called, the mixer must be ready...
-	_mixerReady = true;
+	// Only set the flag once, the engine side reads it all the time.
+	if (!_mixerReady)
+		_mixerReady = true;
 
 	//  zero the buf
-	memset(buf, 0, 2 * len * sizeof(int16));
+	memset(_mixBuffer, 0, 2 * len * sizeof(int32));
 
 	// mix all channels
 	int res = 0, tmp;
-	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i]) {
-			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = 0;
-			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
-
-				if (tmp > res)
-					res = tmp;
-			}
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		Channel *chan = _mixChannels[i].load();
+		if (!chan)
+			continue;
+
+		// See deleteRemovedChannels() for why the order matters here
+		_mixingChannel.store(chan);
+		if (_mixChannels[i].load() != chan)
+			continue;
+
+		if (chan->isFinished()) {
+			// Leave the deletion to the engine side. The slot might have
+			// been cleared or reused in the meantime.
+			_mixChannels[i].compareExchange(chan, 0);
+		} else if (!chan->isPaused()) {
+			tmp = chan->mix(_mixBuffer, len);
+
+			if (tmp > res)
+				res = tmp;
 		}
+	}
+	_mixingChannel.store(0);
+
+	return res;
+}
+
+int MixerImpl::mixCallback(byte *samples, uint len) {
+	assert(samples);
+
+	int16 *buf = (int16 *)samples;
+	// we store stereo, 16-bit samples
+	assert(len % 4 == 0);
+	len >>= 2;
+
+	const int res = mixChannels(len);
+
+	// Silence stays silence, without any dither noise
+	if (res == 0) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		for (uint i = 0; i != 2 * len; i++)
+			buf[i] = (int16)0x8000;
+#else
+		memset(buf, 0, 2 * len * sizeof(int16));
+#endif
+		return res;
+	}
+
+	// Round to 16 bits with triangular dither of +/- one sample step, which
+	// is the only place where the output is clipped
+	uint32 seed = _ditherSeed;
+	for (uint i = 0; i != 2 * len; i++) {
+		seed = seed * 1103515245 + 12345;
+		const int32 dither = (int32)((seed >> 16) & 0xFF) - (int32)(seed >> 24);
+		const int32 val = CLIP<int32>((_mixBuffer[i] + dither + 128) >> 8, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		buf[i] = (int16)(val ^ 0x8000);
+#else
+		buf[i] = (int16)val;
+#endif
+	}
+	_ditherSeed = seed;
+
+	return res;
+}
+
+int MixerImpl::mixCallbackFloat(float *samples, uint len) {
+	assert(samples);
+
+	// we store stereo, 32-bit float samples
+	assert(len % 8 == 0);
+	len >>= 3;
+
+	const int res = mixChannels(len);
+
+	const float scale = 1.0f / (32768 * 256);
+	for (uint i = 0; i != 2 * len; i++)
+		samples[i] = CLIP<float>(_mixBuffer[i] * scale, -1.0f, 1.0f);
 
 	return res;
 }
 
 void MixerImpl::stopAll() {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = 0;
+	RemovedChannels removed;
+	{
+		Common::StackLock lock(_mutex);
+		reapChannels();
+
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			removed.channels[i] = 0;
+			if (_channels[i] != 0 && !_channels[i]->isPermanent())
+				removeChannel(i, removed);
 		}
 	}
+
+	deleteRemovedChannels(removed);
 }
 
 void MixerImpl::stopID(int id) {
-	Common::StackLock lock(_mutex);
-	for (int i = 0; i != NUM_CHANNELS; i++) {
-		if (_channels[i] != 0 && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = 0;
+	RemovedChannels removed;
+	{
+		Common::StackLock lock(_mutex);
+		reapChannels();
+
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			removed.channels[i] = 0;
+			if (_channels[i] != 0 && _channels[i]->getId() == id)
+				removeChannel(i, removed);
 		}
 	}
+
+	deleteRemovedChannels(removed);
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
-	Common::StackLock lock(_mutex);
+	RemovedChannels removed;
+	{
+		Common::StackLock lock(_mutex);
+		reapChannels();
 
-	// Simply ignore stop requests for handles of sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
-		return;
+		for (int i = 0; i != NUM_CHANNELS; i++)
+			removed.channels[i] = 0;
+
+		// Simply ignore stop requests for handles of sounds that already terminated
+		const int index = handle._val % NUM_CHANNELS;
+		if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+			return;
 
-	delete _channels[index];
-	_channels[index] = 0;
+		removeChannel(index, removed);
+	}
+
+	deleteRemovedChannels(removed);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
@@ -350,37 +524,41 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return;
 
-	_channels[index]->setVolume(volume);
+	chan->setVolume(volume);
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_mutex);
+
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return 0;
 
-	return _channels[index]->getVolume();
+	return chan->getVolume();
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return;
 
-	_channels[index]->setBalance(balance);
+	chan->setBalance(balance);
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Common::StackLock lock(_mutex);
+
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return 0;
 
-	return _channels[index]->getBalance();
+	return chan->getBalance();
 }
 
 uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
@@ -390,11 +568,11 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
 
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return Timestamp(0, _sampleRate);
 
-	return _channels[index]->getElapsedTime();
+	return chan->getElapsedTime();
 }
 
 void MixerImpl::pauseAll(bool paused) {
@@ -420,49 +598,55 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
-	const int index = handle._val % NUM_CHANNELS;
-	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
+	Channel *chan = findChannel(handle);
+	if (!chan)
 		return;
 
-	_channels[index]->pause(paused);
+	chan->pause(paused);
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
 	Common::StackLock lock(_mutex);
+	reapChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getId() == id)
+		if (isChannelPlaying(i) && _channels[i]->getId() == id)
 			return true;
 	return false;
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reapChannels();
+
 	const int index = handle._val % NUM_CHANNELS;
-	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
+	if (isChannelPlaying(index) && _channels[index]->getHandle()._val == handle._val)
 		return _channels[index]->getId();
 	return 0;
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	reapChannels();
 
 #ifdef ENABLE_EVENTRECORDER
 	g_eventRec.updateSubsystems();
 #endif
 
 	const int index = handle._val % NUM_CHANNELS;
-	return _channels[index] && _channels[index]->getHandle()._val == handle._val;
+	return isChannelPlaying(index) && _channels[index]->getHandle()._val == handle._val;
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
 	Common::StackLock lock(_mutex);
+	reapChannels();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
-		if (_channels[i] && _channels[i]->getType() == type)
+		if (isChannelPlaying(i) && _channels[i]->getType() == type)
 			return true;
 	return false;
 }
@@ -500,16 +684,18 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
-    : _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-      _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
-      _pauseStartTime(0), _pauseTime(0), _converter(0), _volL(0), _volR(0),
+                 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+                 RateConverterQuality quality)
+    : _type(type), _mixer(mixer), _id(id), _permanent(permanent),
+      _volume(Mixer::kMaxChannelVolume),
+      _balance(0), _pauseLevel(0), _samplesDecoded(0),
+      _pauseStartTime(0), _pauseEndTime(0), _pauseTime(0), _converter(0), _mixVolume(0),
       _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), reverseStereo, quality);
 }
 
 Channel::~Channel() {
@@ -543,39 +729,46 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
+	st_volume_t volL, volR;
 	if (!_mixer->isSoundTypeMuted(_type)) {
 		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
 
 		if (_balance == 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = vol / Mixer::kMaxChannelVolume;
 		} else if (_balance < 0) {
-			_volL = vol / Mixer::kMaxChannelVolume;
-			_volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volL = vol / Mixer::kMaxChannelVolume;
+			volR = ((127 + _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
 		} else {
-			_volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
-			_volR = vol / Mixer::kMaxChannelVolume;
+			volL = ((127 - _balance) * vol) / (Mixer::kMaxChannelVolume * 127);
+			volR = vol / Mixer::kMaxChannelVolume;
 		}
 	} else {
-		_volL = _volR = 0;
+		volL = volR = 0;
 	}
+
+	_mixVolume.store((volL << 16) | volR);
 }
 
 void Channel::pause(bool paused) {
 	//assert((paused && _pauseLevel >= 0) || (!paused && _pauseLevel));
 
+	// Only the engine side changes the pause level, so there is no need for
+	// an atomic increment
+	const int pauseLevel = _pauseLevel.load();
 	if (paused) {
-		_pauseLevel++;
-
-		if (_pauseLevel == 1)
+		if (pauseLevel == 0)
 			_pauseStartTime = g_system->getMillis(true);
-	} else if (_pauseLevel > 0) {
-		_pauseLevel--;
 
-		if (!_pauseLevel) {
-			_pauseTime = (g_system->getMillis(true) - _pauseStartTime);
+		_pauseLevel.store(pauseLevel + 1);
+	} else if (pauseLevel > 0) {
+		if (pauseLevel == 1) {
+			_pauseEndTime = g_system->getMillis(true);
+			_pauseTime = _pauseEndTime - _pauseStartTime;
 			_pauseStartTime = 0;
 		}
+
+		_pauseLevel.store(pauseLevel - 1);
 	}
 }
 
@@ -585,17 +778,29 @@ Timestamp Channel::getElapsedTime() {
 
 	Audio::Timestamp ts(0, rate);
 
-	if (_mixerTimeStamp == 0)
+	uint32 seq, samplesConsumed, mixerTimeStamp;
+	do {
+		seq = _timeSeq.load();
+		samplesConsumed = _samplesConsumed.load();
+		mixerTimeStamp = _mixerTimeStamp.load();
+	} while ((seq & 1) || _timeSeq.load() != seq);
+
+	if (mixerTimeStamp == 0)
 		return ts;
 
-	if (isPaused())
-		delta = _pauseStartTime - _mixerTimeStamp;
-	else
-		delta = g_system->getMillis(true) - _mixerTimeStamp - _pauseTime;
+	if (isPaused()) {
+		delta = _pauseStartTime - mixerTimeStamp;
+	} else {
+		delta = g_system->getMillis(true) - mixerTimeStamp;
+		// Paused channels are not mixed, so the last pause only matters
+		// if nothing was mixed since then
+		if (mixerTimeStamp < _pauseEndTime)
+			delta -= _pauseTime;
+	}
 
 	// Convert the number of samples into a time duration.
 
-	ts = ts.addFrames(_samplesConsumed);
+	ts = ts.addFrames(samplesConsumed);
 	ts = ts.addMsecs(delta);
 
 	// In theory it would seem like a good idea to limit the approximation
@@ -607,18 +812,25 @@ Timestamp Channel::getElapsedTime() {
 	return ts;
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int32 *data, uint len) {
 	assert(_stream);
 
 	int res = 0;
-	if (_stream->endOfData()) {
+	if (_stream->endOfData() && !_converter->hasPendingOutput()) {
 		// TODO: call drain method
 	} else {
 		assert(_converter);
-		_samplesConsumed = _samplesDecoded;
-		_mixerTimeStamp = g_system->getMillis(true);
-		_pauseTime = 0;
-		res = _converter->flow(*_stream, data, len, _volL, _volR);
+		const uint32 now = g_system->getMillis(true);
+		const uint32 seq = _timeSeq.load();
+		_timeSeq.store(seq + 1);
+		_samplesConsumed.store(_samplesDecoded);
+		_mixerTimeStamp.store(now);
+		_timeSeq.store(seq + 2);
+
+		// The volume is only multiplied in, so the mix bus keeps all of the
+		// precision
+		const uint32 volume = _mixVolume.load();
+		res = _converter->flowMix32(*_stream, data, len, volume >> 16, volume & 0xFFFF);
 		_samplesDecoded += res;
 	}
 
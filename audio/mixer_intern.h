@@ -24,8 +24,10 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -38,10 +40,23 @@ namespace Audio {
  * Initialisation of instances of this class usually happens as follows:
  * 1) Creat a new Audio::MixerImpl instance.
  * 2) Set the hardware output sample rate via the setSampleRate() method.
- * 3) Hook up the mixCallback() in a suitable audio processing thread/callback.
+ * 3) Hook up the mixCallback() (or mixCallbackFloat(), if the audio device
+ *    takes float samples) in a suitable audio processing thread/callback.
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * The mixer callback never waits for the other threads: calls made by engines
+ * only lock a mutex among themselves and hand channels over to the mixer
+ * callback through atomic slots. Once a sound has been stopped or is reported
+ * as not active anymore, its stream is not used anymore, and it is deleted
+ * by the next call which stops or queries sounds. Streams must not stop their
+ * own channel, though. Without lock-free atomics (see Common::Atomic), the
+ * mixer callback locks the mutex as well.
+ *
+ * The channels are added up in a 32 bit mix bus, which keeps the fractions
+ * of their volume scaling. Only the final output is clipped and, for 16 bit
+ * output, dithered.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -54,9 +69,15 @@ private:
 		NUM_CHANNELS = 16
 	};
 
+	/**
+	 * Serializes the engine side. The mixer callback only locks it without
+	 * COMMON_HAS_LOCKFREE_ATOMICS.
+	 */
 	Common::Mutex _mutex;
 
 	const uint _sampleRate;
+	/** The quality of the rate converters of new channels. */
+	const RateConverterQuality _rateConverterQuality;
 	bool _mixerReady;
 	uint32 _handleSeed;
 
@@ -68,12 +89,36 @@ private:
 	};
 
 	SoundTypeSettings _soundTypeSettings[4];
+
+	/** The channels owned by the engine side, including finished ones. */
 	Channel *_channels[NUM_CHANNELS];
+	/** Whether a stop call is waiting for the mixer callback to let go. */
+	bool _stopping[NUM_CHANNELS];
+
+	/**
+	 * The channels seen by the mixer callback. The callback clears a slot
+	 * when its channel has finished, which is then deleted by the engine
+	 * side.
+	 */
+	Common::Atomic<Channel *> _mixChannels[NUM_CHANNELS];
 
+	/** The channel the mixer callback is working on, 0 when it is idle. */
+	Common::Atomic<Channel *> _mixingChannel;
+
+	/**
+	 * The mix bus, in 1/256th of a 16 bit sample, which the rate converters
+	 * mix into. Like the dither state below it is only used by the mixer
+	 * callback.
+	 */
+	int32 *_mixBuffer;
+	/** The number of sample pairs the mix bus can hold. */
+	uint _mixBufferSize;
+	/** State of the random generator for the dither. */
+	uint32 _ditherSeed;
 
 public:
 
-	MixerImpl(OSystem *system, uint sampleRate);
+	MixerImpl(OSystem *system, uint sampleRate, RateConverterQuality rateConverterQuality = kRateConverterLinear);
 	~MixerImpl();
 
 	virtual bool isReady() const { return _mixerReady; }
@@ -121,6 +166,42 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	/** Whether the channel in the slot is still handed to the mixer callback. */
+	bool isChannelActive(int index) const;
+
+	/** Whether the channel in the slot is active or being stopped. */
+	bool isChannelPlaying(int index) const;
+
+	/** Return the active channel of the handle, or 0. */
+	Channel *findChannel(SoundHandle handle) const;
+
+	/** Delete the channels which the mixer callback has finished. Requires the mutex. */
+	void reapChannels();
+
+	/** Channels taken from the mixer callback by a stop call. */
+	struct RemovedChannels {
+		Channel *channels[NUM_CHANNELS];
+		/** Whether this call has to delete the channel. */
+		bool owned[NUM_CHANNELS];
+	};
+
+	/** Take the channel from the mixer callback. Requires the mutex. */
+	void removeChannel(int index, RemovedChannels &removed);
+
+	/**
+	 * Wait until the mixer callback is done with the removed channels and
+	 * delete them. Must not be called with the mutex locked.
+	 */
+	void deleteRemovedChannels(const RemovedChannels &removed);
+
+	/**
+	 * Mix all channels into the mix bus.
+	 *
+	 * @param len number of sample pairs to mix
+	 * @return number of sample pairs processed, like mixCallback()
+	 */
+	int mixChannels(uint len);
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -133,6 +214,16 @@ public:
 	 */
 	int mixCallback(byte *samples, uint len);
 
+	/**
+	 * The mixer callback function for audio devices which take float
+	 * samples. This saves the conversion to 16 bit and the dithering.
+	 *
+	 * @param samples Sample buffer, in which stereo samples in the range of -1 to 1 will be stored.
+	 * @param len Length of the provided buffer to fill (in bytes, should be divisible by 8).
+	 * @return number of sample pairs processed (which can still be silence!)
+	 */
+	int mixCallbackFloat(float *samples, uint len);
+
 	/**
 	 * Set the internal 'is ready' flag of the mixer.
 	 * Backends should invoke Mixer::setReady(true) once initialisation of
@@ -16,6 +16,7 @@ MODULE_OBJS := \
 	mpu401.o \
 	musicplugin.o \
 	null.o \
+	samplecache.o \
 	timestamp.o \
 	decoders/3do.o \
 	decoders/aac.o \
@@ -63,9 +64,43 @@ MODULE_OBJS += \
 	alsa_opl.o
 endif
 
+ifdef USE_SSE2
+MODULE_OBJS += \
+	softsynth/opl/dbopl_sse2.o
+$(MODULE)/softsynth/opl/dbopl_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef USE_AVX2
+MODULE_OBJS += \
+	softsynth/opl/dbopl_avx2.o
+$(MODULE)/softsynth/opl/dbopl_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	softsynth/opl/dbopl_neon.o
+endif
+
 ifndef USE_ARM_SOUND_ASM
 MODULE_OBJS += \
 	rate.o
+
+ifdef USE_SSE2
+MODULE_OBJS += \
+	rate_sse2.o
+$(MODULE)/rate_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef USE_AVX2
+MODULE_OBJS += \
+	rate_avx2.o
+$(MODULE)/rate_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	rate_neon.o
+endif
 else
 MODULE_OBJS += \
 	rate_arm.o \
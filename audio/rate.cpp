@@ -30,7 +30,9 @@
 
 #include "audio/audiostream.h"
 #include "audio/rate.h"
+#include "audio/rate_simd.h"
 #include "audio/mixer.h"
+#include "common/cpudetect.h"
 #include "common/frac.h"
 #include "common/textconsole.h"
 #include "common/util.h"
@@ -57,6 +59,187 @@ enum {
 	FRAC_HALF_LOW = (1L << (FRAC_BITS_LOW-1))
 };
 
+/**
+ * The mixing loops for one instruction set.
+ */
+struct MixFramesFuncs {
+	MixFramesFunc mono;
+	MixFramesFunc stereo;
+	MixFramesFunc reverseStereo;
+
+	MixFrames32Func mono32;
+	MixFrames32Func stereo32;
+	MixFrames32Func reverseStereo32;
+};
+
+#ifdef USE_SSE2
+static const MixFramesFuncs kSSE2MixFramesFuncs = {
+	mixMonoFramesSSE2, mixStereoFramesSSE2, mixReverseStereoFramesSSE2,
+	mixMonoFrames32SSE2, mixStereoFrames32SSE2, mixReverseStereoFrames32SSE2
+};
+#endif
+#ifdef USE_AVX2
+static const MixFramesFuncs kAVX2MixFramesFuncs = {
+	mixMonoFramesAVX2, mixStereoFramesAVX2, mixReverseStereoFramesAVX2,
+	mixMonoFrames32AVX2, mixStereoFrames32AVX2, mixReverseStereoFrames32AVX2
+};
+#endif
+#ifdef USE_NEON
+static const MixFramesFuncs kNEONMixFramesFuncs = {
+	mixMonoFramesNEON, mixStereoFramesNEON, mixReverseStereoFramesNEON,
+	mixMonoFrames32NEON, mixStereoFrames32NEON, mixReverseStereoFrames32NEON
+};
+#endif
+
+/**
+ * Pick the fastest mixing loops the CPU supports, or return 0 if there are
+ * none and everything is left to the scalar code.
+ */
+static const MixFramesFuncs *getMixFramesFuncs() {
+#ifdef SCUMM_LITTLE_ENDIAN
+#ifdef USE_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return &kAVX2MixFramesFuncs;
+#endif
+#ifdef USE_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return &kSSE2MixFramesFuncs;
+#endif
+#ifdef USE_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return &kNEONMixFramesFuncs;
+#endif
+#endif
+	return 0;
+}
+
+/**
+ * Mix converted frames into the output buffer, applying the volume and
+ * clipping the result.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFrames(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	uint done = 0;
+
+	// The vectorized loops only multiply with 16 bit volumes
+	const MixFramesFuncs *funcs = getMixFramesFuncs();
+	if (funcs && vol_l <= Audio::Mixer::kMaxMixerVolume && vol_r <= Audio::Mixer::kMaxMixerVolume) {
+		if (!stereo)
+			done = funcs->mono(obuf, in, frames, vol_l, vol_r);
+		else if (reverseStereo)
+			done = funcs->reverseStereo(obuf, in, frames, vol_l, vol_r);
+		else
+			done = funcs->stereo(obuf, in, frames, vol_l, vol_r);
+
+		obuf += done * 2;
+		in += done * (stereo ? 2 : 1);
+	}
+
+	for (; done < frames; done++) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		// output left channel
+		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+
+		// output right channel
+		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+
+		obuf += 2;
+	}
+}
+
+/**
+ * Mix converted frames into a 32 bit buffer, in 1/256th of a sample, where
+ * the volume is only multiplied in.
+ */
+template<bool stereo, bool reverseStereo>
+static void mixFrames(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	uint done = 0;
+
+	// The vectorized loops only multiply with 16 bit volumes
+	const MixFramesFuncs *funcs = getMixFramesFuncs();
+	if (funcs && vol_l <= Audio::Mixer::kMaxMixerVolume && vol_r <= Audio::Mixer::kMaxMixerVolume) {
+		if (!stereo)
+			done = funcs->mono32(obuf, in, frames, vol_l, vol_r);
+		else if (reverseStereo)
+			done = funcs->reverseStereo32(obuf, in, frames, vol_l, vol_r);
+		else
+			done = funcs->stereo32(obuf, in, frames, vol_l, vol_r);
+
+		obuf += done * 2;
+		in += done * (stereo ? 2 : 1);
+	}
+
+	for (; done < frames; done++) {
+		st_sample_t out0, out1;
+		out0 = *in++;
+		out1 = (stereo ? *in++ : out0);
+
+		obuf[reverseStereo    ] += out0 * (int32)vol_l;
+		obuf[reverseStereo ^ 1] += out1 * (int32)vol_r;
+
+		obuf += 2;
+	}
+}
+
+/**
+ * Base class for the rate converters which resample into an intermediate
+ * buffer first. Its contents are then mixed into the output buffer in one
+ * go, which leaves the gathering of samples to the converters and allows
+ * the mixing to be vectorized.
+ */
+template<bool stereo, bool reverseStereo>
+class ResamplingRateConverter : public RateConverter {
+public:
+	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return mix(input, obuf, osamp, vol_l, vol_r);
+	}
+	int flowMix32(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return mix(input, obuf, osamp, vol_l, vol_r);
+	}
+	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+
+protected:
+	template<class T>
+	int mix(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
+
+	/**
+	 * Resample up to the given number of frames.
+	 *
+	 * @return the number of frames written, which is less than requested
+	 *         only if the input stream ran out of data
+	 */
+	virtual uint resample(AudioStream &input, st_sample_t *out, uint frames) = 0;
+};
+
+/*
+ * Processed signed long samples from ibuf to obuf.
+ * Return number of sample pairs processed.
+ */
+template<bool stereo, bool reverseStereo>
+template<class T>
+int ResamplingRateConverter<stereo, reverseStereo>::mix(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+	st_sample_t outBuf[INTERMEDIATE_BUFFER_SIZE];
+	const uint maxFrames = ARRAYSIZE(outBuf) / (stereo ? 2 : 1);
+	st_size_t done = 0;
+
+	while (done < osamp) {
+		const uint frames = MIN<st_size_t>(maxFrames, osamp - done);
+		const uint resampled = resample(input, outBuf, frames);
+
+		mixFrames<stereo, reverseStereo>(obuf + done * 2, outBuf, resampled, vol_l, vol_r);
+		done += resampled;
+
+		if (resampled < frames)
+			break;
+	}
+	return done;
+}
+
 /**
  * Audio rate converter based on simple resampling. Used when no
  * interpolation is required.
@@ -64,7 +247,7 @@ enum {
  * Limited to sampling frequency <= 65535 Hz.
  */
 template<bool stereo, bool reverseStereo>
-class SimpleRateConverter : public RateConverter {
+class SimpleRateConverter : public ResamplingRateConverter<stereo, reverseStereo> {
 protected:
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
@@ -77,12 +260,10 @@ protected:
 	/** fractional position increment in the output stream */
 	long opos_inc;
 
+	uint resample(AudioStream &input, st_sample_t *out, uint frames);
+
 public:
 	SimpleRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
-	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
-		return ST_SUCCESS;
-	}
 };
 
 
@@ -107,18 +288,9 @@ SimpleRateConverter<stereo, reverseStereo>::SimpleRateConverter(st_rate_t inrate
 	inLen = 0;
 }
 
-/*
- * Processed signed long samples from ibuf to obuf.
- * Return number of sample pairs processed.
- */
 template<bool stereo, bool reverseStereo>
-int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
+uint SimpleRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *out, uint frames) {
+	for (uint i = 0; i < frames; i++) {
 
 		// read enough input samples so that opos >= 0
 		do {
@@ -127,7 +299,7 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 				inPtr = inBuf;
 				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
 				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+					return i;
 			}
 			inLen -= (stereo ? 2 : 1);
 			opos--;
@@ -136,22 +308,14 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 			}
 		} while (opos >= 0);
 
-		st_sample_t out0, out1;
-		out0 = *inPtr++;
-		out1 = (stereo ? *inPtr++ : out0);
+		*out++ = *inPtr++;
+		if (stereo)
+			*out++ = *inPtr++;
 
 		// Increment output position
 		opos += opos_inc;
-
-		// output left channel
-		clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-		// output right channel
-		clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-		obuf += 2;
 	}
-	return (obuf - ostart) / 2;
+	return frames;
 }
 
 /**
@@ -166,7 +330,7 @@ int SimpleRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
  */
 
 template<bool stereo, bool reverseStereo>
-class LinearRateConverter : public RateConverter {
+class LinearRateConverter : public ResamplingRateConverter<stereo, reverseStereo> {
 protected:
 	st_sample_t inBuf[INTERMEDIATE_BUFFER_SIZE];
 	const st_sample_t *inPtr;
@@ -183,12 +347,10 @@ protected:
 	/** current sample(s) in the input stream (left/right channel) */
 	st_sample_t icur0, icur1;
 
+	uint resample(AudioStream &input, st_sample_t *out, uint frames);
+
 public:
 	LinearRateConverter(st_rate_t inrate, st_rate_t outrate);
-	int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r);
-	int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
-		return ST_SUCCESS;
-	}
 };
 
 
@@ -216,18 +378,9 @@ LinearRateConverter<stereo, reverseStereo>::LinearRateConverter(st_rate_t inrate
 	inLen = 0;
 }
 
-/*
- * Processed signed long samples from ibuf to obuf.
- * Return number of sample pairs processed.
- */
 template<bool stereo, bool reverseStereo>
-int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-	st_sample_t *ostart, *oend;
-
-	ostart = obuf;
-	oend = obuf + osamp * 2;
-
-	while (obuf < oend) {
+uint LinearRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *out, uint frames) {
+	for (uint i = 0; i < frames; i++) {
 
 		// read enough input samples so that opos < 0
 		while ((frac_t)FRAC_ONE_LOW <= opos) {
@@ -236,7 +389,7 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 				inPtr = inBuf;
 				inLen = input.readBuffer(inBuf, ARRAYSIZE(inBuf));
 				if (inLen <= 0)
-					return (obuf - ostart) / 2;
+					return i;
 			}
 			inLen -= (stereo ? 2 : 1);
 			ilast0 = icur0;
@@ -248,29 +401,192 @@ int LinearRateConverter<stereo, reverseStereo>::flow(AudioStream &input, st_samp
 			opos -= FRAC_ONE_LOW;
 		}
 
-		// Loop as long as the outpos trails behind, and as long as there is
-		// still space in the output buffer.
-		while (opos < (frac_t)FRAC_ONE_LOW && obuf < oend) {
-			// interpolate
-			st_sample_t out0, out1;
-			out0 = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
-			out1 = (stereo ?
-						  (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW)) :
-						  out0);
+		// interpolate
+		*out++ = (st_sample_t)(ilast0 + (((icur0 - ilast0) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+		if (stereo)
+			*out++ = (st_sample_t)(ilast1 + (((icur1 - ilast1) * opos + FRAC_HALF_LOW) >> FRAC_BITS_LOW));
+
+		// Increment output position
+		opos += opos_inc;
+	}
+	return frames;
+}
+
+/**
+ * Audio rate converter based on windowed sinc interpolation.
+ *
+ * Each output frame is computed from the input frames around it, weighted
+ * by a Blackman windowed sinc function. Its cutoff is a bit below the
+ * Nyquist frequency of the lower one of the two rates, so unlike the linear
+ * converter this also filters out most of what would alias or image.
+ *
+ * The filter coefficients are computed once for 256 positions between two
+ * input frames, so converting itself only takes integer arithmetic.
+ *
+ * Limited to sampling frequency <= 131071 Hz.
+ */
+template<bool stereo, bool reverseStereo>
+class SincRateConverter : public ResamplingRateConverter<stereo, reverseStereo> {
+protected:
+	enum {
+		kChannels = stereo ? 2 : 1,
+		/** The number of taps when upsampling; more are used for downsampling. */
+		kMinTaps = 16,
+		kMaxTaps = 64,
+		kPhaseBits = 8,
+		kPhases = 1 << kPhaseBits,
+		kCoeffBits = 14
+	};
+
+	/** The number of input frames each output frame is computed from */
+	int _taps;
+	/** _taps coefficients for each of the kPhases positions */
+	int16 *_coeffs;
+
+	/** The input frames, starting with the ones still needed for the filter */
+	st_sample_t *_inBuf;
+	int _inBufFrames;
+	int _inFrames;
+
+	/** fractional position of the filter window in _inBuf */
+	frac_t _pos;
+
+	/** fractional position increment in the output stream */
+	frac_t _posInc;
+
+	/** The silent frames still to be added after the end of the input */
+	int _tailFrames;
+
+	bool refill(AudioStream &input);
+	uint resample(AudioStream &input, st_sample_t *out, uint frames);
+
+public:
+	SincRateConverter(st_rate_t inrate, st_rate_t outrate);
+	~SincRateConverter();
+
+	virtual bool hasPendingOutput() const {
+		return _tailFrames > 0 || (_pos >> FRAC_BITS_LOW) + _taps <= _inFrames;
+	}
+};
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::SincRateConverter(st_rate_t inrate, st_rate_t outrate) {
+	if (inrate >= 131072 || outrate >= 131072) {
+		error("rate effect can only handle rates < 131072");
+	}
+
+	_posInc = (inrate << FRAC_BITS_LOW) / outrate;
+
+	// When downsampling, the cutoff is lower and the filter has to get wider
+	// to keep the same steepness
+	const double ratio = MIN<double>(1.0, (double)outrate / inrate);
+	const double cutoff = ratio * 0.9;
+	_taps = MIN<int>(kMaxTaps, ((int)ceil(kMinTaps / ratio) + 1) & ~1);
+
+	_coeffs = new int16[kPhases * _taps];
+	for (int phase = 0; phase < kPhases; phase++) {
+		const double frac = (double)phase / kPhases;
+		double coeffs[kMaxTaps];
+		double sum = 0.0;
+
+		for (int i = 0; i < _taps; i++) {
+			// The distance of the tap from the output frame, in input frames
+			const double x = i - (_taps / 2 - 1) - frac;
+			const double t = M_PI * cutoff * x;
+			const double sinc = (t == 0.0) ? 1.0 : sin(t) / t;
+			const double window = 0.42 + 0.5 * cos(2.0 * M_PI * x / _taps) + 0.08 * cos(4.0 * M_PI * x / _taps);
+
+			coeffs[i] = sinc * window;
+			sum += coeffs[i];
+		}
+
+		// Normalize each phase, so that it passes silence and DC unchanged.
+		// The rounding error goes to the nearest tap.
+		int16 *dst = _coeffs + phase * _taps;
+		int total = 0;
+		for (int i = 0; i < _taps; i++) {
+			dst[i] = (int16)floor(coeffs[i] / sum * (1 << kCoeffBits) + 0.5);
+			total += dst[i];
+		}
+		dst[_taps / 2 - 1 + (phase >= kPhases / 2)] += (1 << kCoeffBits) - total;
+	}
 
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
+	// Start with silence before the first input frame, which is where the
+	// first output frame is centered on
+	_inBufFrames = _taps + INTERMEDIATE_BUFFER_SIZE / kChannels;
+	_inBuf = new st_sample_t[_inBufFrames * kChannels];
+	_inFrames = _taps / 2 - 1;
+	memset(_inBuf, 0, _inFrames * kChannels * sizeof(st_sample_t));
+	_pos = 0;
 
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
+	// The same goes for the last input frame
+	_tailFrames = _taps / 2;
+}
+
+template<bool stereo, bool reverseStereo>
+SincRateConverter<stereo, reverseStereo>::~SincRateConverter() {
+	delete[] _coeffs;
+	delete[] _inBuf;
+}
+
+/*
+ * Drop the input frames which are not needed anymore and read new ones.
+ * Once the input has ended, add silence until the filter has passed its
+ * last frame. Return false if there are no more.
+ */
+template<bool stereo, bool reverseStereo>
+bool SincRateConverter<stereo, reverseStereo>::refill(AudioStream &input) {
+	const int consumed = MIN<int>(_pos >> FRAC_BITS_LOW, _inFrames);
+	if (consumed > 0) {
+		memmove(_inBuf, _inBuf + consumed * kChannels, (_inFrames - consumed) * kChannels * sizeof(st_sample_t));
+		_inFrames -= consumed;
+		_pos -= consumed << FRAC_BITS_LOW;
+	}
+
+	const int len = input.readBuffer(_inBuf + _inFrames * kChannels, (_inBufFrames - _inFrames) * kChannels);
+	if (len <= 0) {
+		if (_tailFrames == 0 || !input.endOfStream())
+			return false;
+
+		const int frames = MIN(_tailFrames, _inBufFrames - _inFrames);
+		memset(_inBuf + _inFrames * kChannels, 0, frames * kChannels * sizeof(st_sample_t));
+		_inFrames += frames;
+		_tailFrames -= frames;
+		return true;
+	}
+
+	_inFrames += len / kChannels;
+	return true;
+}
+
+template<bool stereo, bool reverseStereo>
+uint SincRateConverter<stereo, reverseStereo>::resample(AudioStream &input, st_sample_t *out, uint frames) {
+	for (uint i = 0; i < frames; i++) {
+		// The whole filter window has to be in the buffer
+		while ((_pos >> FRAC_BITS_LOW) + _taps > _inFrames) {
+			if (!refill(input))
+				return i;
+		}
 
-			obuf += 2;
+		const st_sample_t *in = _inBuf + (_pos >> FRAC_BITS_LOW) * kChannels;
+		const int16 *coeffs = _coeffs + ((_pos & (FRAC_ONE_LOW - 1)) >> (FRAC_BITS_LOW - kPhaseBits)) * _taps;
 
-			// Increment output position
-			opos += opos_inc;
+		int32 out0 = 1 << (kCoeffBits - 1);
+		int32 out1 = out0;
+		for (int tap = 0; tap < _taps; tap++) {
+			out0 += in[tap * kChannels] * coeffs[tap];
+			if (stereo)
+				out1 += in[tap * kChannels + 1] * coeffs[tap];
 		}
+
+		*out++ = (st_sample_t)CLIP<int32>(out0 >> kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+		if (stereo)
+			*out++ = (st_sample_t)CLIP<int32>(out1 >> kCoeffBits, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+
+		// Increment output position
+		_pos += _posInc;
 	}
-	return (obuf - ostart) / 2;
+	return frames;
 }
 
 
@@ -291,12 +607,21 @@ public:
 	}
 
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
-		assert(input.isStereo() == stereo);
+		return mix(input, obuf, osamp, vol_l, vol_r);
+	}
 
-		st_sample_t *ptr;
-		st_size_t len;
+	virtual int flowMix32(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		return mix(input, obuf, osamp, vol_l, vol_r);
+	}
 
-		st_sample_t *ostart = obuf;
+	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
+		return ST_SUCCESS;
+	}
+
+private:
+	template<class T>
+	int mix(AudioStream &input, T *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		assert(input.isStereo() == stereo);
 
 		if (stereo)
 			osamp *= 2;
@@ -312,28 +637,14 @@ public:
 			error("[CopyRateConverter::flow] Cannot allocate memory for temp buffer");
 
 		// Read up to 'osamp' samples into our temporary buffer
-		len = input.readBuffer(_buffer, osamp);
+		const int len = input.readBuffer(_buffer, osamp);
+		if (len <= 0)
+			return 0;
 
 		// Mix the data into the output buffer
-		ptr = _buffer;
-		for (; len > 0; len -= (stereo ? 2 : 1)) {
-			st_sample_t out0, out1;
-			out0 = *ptr++;
-			out1 = (stereo ? *ptr++ : out0);
-
-			// output left channel
-			clampedAdd(obuf[reverseStereo    ], (out0 * (int)vol_l) / Audio::Mixer::kMaxMixerVolume);
-
-			// output right channel
-			clampedAdd(obuf[reverseStereo ^ 1], (out1 * (int)vol_r) / Audio::Mixer::kMaxMixerVolume);
-
-			obuf += 2;
-		}
-		return (obuf - ostart) / 2;
-	}
-
-	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) {
-		return ST_SUCCESS;
+		const uint frames = len / (stereo ? 2 : 1);
+		mixFrames<stereo, reverseStereo>(obuf, _buffer, frames, vol_l, vol_r);
+		return frames;
 	}
 };
 
@@ -341,9 +652,11 @@ public:
 #pragma mark -
 
 template<bool stereo, bool reverseStereo>
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, RateConverterQuality quality) {
 	if (inrate != outrate) {
-		if ((inrate % outrate) == 0 && (inrate < 65536)) {
+		if (quality == kRateConverterSinc) {
+			return new SincRateConverter<stereo, reverseStereo>(inrate, outrate);
+		} else if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			return new SimpleRateConverter<stereo, reverseStereo>(inrate, outrate);
 		} else {
 			return new LinearRateConverter<stereo, reverseStereo>(inrate, outrate);
@@ -356,14 +669,14 @@ RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate) {
 /**
  * Create and return a RateConverter object for the specified input and output rates.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
 	if (stereo) {
 		if (reverseStereo)
-			return makeRateConverter<true, true>(inrate, outrate);
+			return makeRateConverter<true, true>(inrate, outrate, quality);
 		else
-			return makeRateConverter<true, false>(inrate, outrate);
+			return makeRateConverter<true, false>(inrate, outrate, quality);
 	} else
-		return makeRateConverter<false, false>(inrate, outrate);
+		return makeRateConverter<false, false>(inrate, outrate, quality);
 }
 
 } // End of namespace Audio
@@ -47,24 +47,26 @@ enum {
 
 static inline void clampedAdd(int16& a, int b) {
 	register int val;
-#ifdef OUTPUT_UNSIGNED_AUDIO
-	val = (a ^ 0x8000) + b;
-#else
 	val = a + b;
-#endif
 
 	if (val > ST_SAMPLE_MAX)
 		val = ST_SAMPLE_MAX;
 	else if (val < ST_SAMPLE_MIN)
 		val = ST_SAMPLE_MIN;
 
-#ifdef OUTPUT_UNSIGNED_AUDIO
-	a = ((int16)val) ^ 0x8000;
-#else
 	a = val;
-#endif
 }
 
+/**
+ * How to convert between different sample rates.
+ */
+enum RateConverterQuality {
+	/** Linear interpolation, or dropping samples for whole number ratios. */
+	kRateConverterLinear,
+	/** Windowed sinc interpolation, which sounds better but is slower. */
+	kRateConverterSinc
+};
+
 class RateConverter {
 public:
 	RateConverter() {}
@@ -75,10 +77,25 @@ public:
 	 */
 	virtual int flow(AudioStream &input, st_sample_t *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
 
+	/**
+	 * Like flow(), but mix into a buffer of 32 bit samples, in 1/256th of
+	 * a 16 bit sample. Nothing is rounded or clipped, so the volume is
+	 * only multiplied in.
+	 *
+	 * @return Number of sample pairs written into the buffer.
+	 */
+	virtual int flowMix32(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) = 0;
+
 	virtual int drain(st_sample_t *obuf, st_size_t osamp, st_volume_t vol) = 0;
+
+	/**
+	 * Whether flow() still returns samples for input which was read
+	 * already, after the input has ended.
+	 */
+	virtual bool hasPendingOutput() const { return false; }
 };
 
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false);
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo = false, RateConverterQuality quality = kRateConverterLinear);
 
 } // End of namespace Audio
 
@@ -444,36 +444,81 @@ public:
 #pragma mark -
 
 
+/**
+ * There are no assembler loops which mix into 32 bit buffers, so the ARM
+ * converters mix at full volume into a silent 16 bit buffer first. The
+ * volume is applied while adding that to the 32 bit buffer.
+ */
+template<class Converter, bool reverseStereo>
+class Mix32RateConverter : public Converter {
+	st_sample_t *_mixBuffer;
+	st_size_t _mixBufferSize;
+
+public:
+	Mix32RateConverter() : _mixBuffer(0), _mixBufferSize(0) {}
+	Mix32RateConverter(st_rate_t inrate, st_rate_t outrate)
+		: Converter(inrate, outrate), _mixBuffer(0), _mixBufferSize(0) {}
+	~Mix32RateConverter() {
+		free(_mixBuffer);
+	}
+
+	virtual int flowMix32(AudioStream &input, int32 *obuf, st_size_t osamp, st_volume_t vol_l, st_volume_t vol_r) {
+		// Reallocate temp buffer, if necessary
+		if (osamp > _mixBufferSize) {
+			free(_mixBuffer);
+			_mixBuffer = (st_sample_t *)malloc(osamp * 2 * sizeof(st_sample_t));
+			_mixBufferSize = osamp;
+		}
+
+		if (!_mixBuffer)
+			error("[Mix32RateConverter::flowMix32] Cannot allocate memory for temp buffer");
+
+		memset(_mixBuffer, 0, osamp * 2 * sizeof(st_sample_t));
+		const int frames = this->flow(input, _mixBuffer, osamp, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+
+		// With reversed stereo, the left input already is in the right output
+		const int32 volL = reverseStereo ? vol_r : vol_l;
+		const int32 volR = reverseStereo ? vol_l : vol_r;
+		for (int i = 0; i < frames; i++) {
+			obuf[2 * i    ] += _mixBuffer[2 * i    ] * volL;
+			obuf[2 * i + 1] += _mixBuffer[2 * i + 1] * volR;
+		}
+		return frames;
+	}
+};
+
 /**
  * Create and return a RateConverter object for the specified input and output rates.
+ *
+ * There is no ARM version of the sinc converter, so the quality is ignored.
  */
-RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo) {
+RateConverter *makeRateConverter(st_rate_t inrate, st_rate_t outrate, bool stereo, bool reverseStereo, RateConverterQuality quality) {
 	if (inrate != outrate) {
 		if ((inrate % outrate) == 0 && (inrate < 65536)) {
 			if (stereo) {
 				if (reverseStereo)
-					return new SimpleRateConverter<true, true>(inrate, outrate);
+					return new Mix32RateConverter<SimpleRateConverter<true, true>, true>(inrate, outrate);
 				else
-					return new SimpleRateConverter<true, false>(inrate, outrate);
+					return new Mix32RateConverter<SimpleRateConverter<true, false>, false>(inrate, outrate);
 			} else
-				return new SimpleRateConverter<false, false>(inrate, outrate);
+				return new Mix32RateConverter<SimpleRateConverter<false, false>, false>(inrate, outrate);
 		} else {
 			if (stereo) {
 				if (reverseStereo)
-					return new LinearRateConverter<true, true>(inrate, outrate);
+					return new Mix32RateConverter<LinearRateConverter<true, true>, true>(inrate, outrate);
 				else
-					return new LinearRateConverter<true, false>(inrate, outrate);
+					return new Mix32RateConverter<LinearRateConverter<true, false>, false>(inrate, outrate);
 			} else
-				return new LinearRateConverter<false, false>(inrate, outrate);
+				return new Mix32RateConverter<LinearRateConverter<false, false>, false>(inrate, outrate);
 		 }
 	} else {
 		if (stereo) {
 			if (reverseStereo)
-				return new CopyRateConverter<true, true>();
+				return new Mix32RateConverter<CopyRateConverter<true, true>, true>();
 			else
-				return new CopyRateConverter<true, false>();
+				return new Mix32RateConverter<CopyRateConverter<true, false>, false>();
 		} else
-			return new CopyRateConverter<false, false>();
+			return new Mix32RateConverter<CopyRateConverter<false, false>, false>();
 	}
 }
 
@@ -0,0 +1,99 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -mavx2, see audio/module.mk
+
+#include "audio/rate_simd.h"
+
+#include <immintrin.h>
+
+namespace Audio {
+
+namespace {
+
+struct AVX2Ops {
+	typedef __m256i Wide;
+
+	enum { kSamples = 16 };
+
+	static Wide load(const st_sample_t *ptr) { return _mm256_loadu_si256((const __m256i *)ptr); }
+	static Wide loadDup(const st_sample_t *ptr) {
+		// Zero extend each sample to 32 bits and copy it to the upper half
+		const __m256i samples = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)ptr));
+		return _mm256_or_si256(samples, _mm256_slli_epi32(samples, 16));
+	}
+	static void store(st_sample_t *ptr, Wide x) { _mm256_storeu_si256((__m256i *)ptr, x); }
+
+	static Wide swapPairs(Wide x) {
+		return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+	}
+	static Wide setPairs(st_volume_t x, st_volume_t y) { return _mm256_set1_epi32((y << 16) | x); }
+
+	static Wide scale(Wide x, Wide volume) {
+		// See SSE2Ops::scale
+		const __m256i lo = _mm256_mullo_epi16(x, volume);
+		const __m256i hi = _mm256_mulhi_epi16(x, volume);
+		const __m256i floored = _mm256_or_si256(_mm256_slli_epi16(hi, 8), _mm256_srli_epi16(lo, 8));
+		const __m256i exact = _mm256_cmpeq_epi16(_mm256_and_si256(lo, _mm256_set1_epi16(0xFF)), _mm256_setzero_si256());
+		return _mm256_sub_epi16(floored, _mm256_andnot_si256(exact, _mm256_srai_epi16(hi, 15)));
+	}
+	static Wide addSaturate(Wide x, Wide y) { return _mm256_adds_epi16(x, y); }
+	static void mulAdd32(int32 *ptr, Wide x, Wide volume) {
+		// See SSE2Ops::mulAdd32. The unpacking works within the 128 bit
+		// halves, so these have to be put back in order.
+		const __m256i lo = _mm256_mullo_epi16(x, volume);
+		const __m256i hi = _mm256_mulhi_epi16(x, volume);
+		const __m256i first = _mm256_unpacklo_epi16(lo, hi);
+		const __m256i second = _mm256_unpackhi_epi16(lo, hi);
+		__m256i *dst = (__m256i *)ptr;
+		_mm256_storeu_si256(dst, _mm256_add_epi32(_mm256_loadu_si256(dst), _mm256_permute2x128_si256(first, second, 0x20)));
+		_mm256_storeu_si256(dst + 1, _mm256_add_epi32(_mm256_loadu_si256(dst + 1), _mm256_permute2x128_si256(first, second, 0x31)));
+	}
+};
+
+} // End of anonymous namespace
+
+uint mixMonoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames<AVX2Ops>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<AVX2Ops, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<AVX2Ops, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixMonoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames32<AVX2Ops>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<AVX2Ops, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<AVX2Ops, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,88 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/rate_simd.h"
+
+#include <arm_neon.h>
+
+namespace Audio {
+
+namespace {
+
+struct NEONOps {
+	typedef int16x8_t Wide;
+
+	enum { kSamples = 8 };
+
+	static Wide load(const st_sample_t *ptr) { return vld1q_s16(ptr); }
+	static Wide loadDup(const st_sample_t *ptr) {
+		const int16x4_t samples = vld1_s16(ptr);
+		const int16x4x2_t pairs = vzip_s16(samples, samples);
+		return vcombine_s16(pairs.val[0], pairs.val[1]);
+	}
+	static void store(st_sample_t *ptr, Wide x) { vst1q_s16(ptr, x); }
+
+	static Wide swapPairs(Wide x) { return vrev32q_s16(x); }
+	static Wide setPairs(st_volume_t x, st_volume_t y) { return vreinterpretq_s16_u32(vdupq_n_u32((y << 16) | x)); }
+
+	static Wide scale(Wide x, Wide volume) {
+		int32x4_t lo = vmull_s16(vget_low_s16(x), vget_low_s16(volume));
+		int32x4_t hi = vmull_s16(vget_high_s16(x), vget_high_s16(volume));
+		// Round negative products towards zero, then divide by 256
+		lo = vaddq_s32(lo, vandq_s32(vshrq_n_s32(lo, 31), vdupq_n_s32(0xFF)));
+		hi = vaddq_s32(hi, vandq_s32(vshrq_n_s32(hi, 31), vdupq_n_s32(0xFF)));
+		return vcombine_s16(vshrn_n_s32(lo, 8), vshrn_n_s32(hi, 8));
+	}
+	static Wide addSaturate(Wide x, Wide y) { return vqaddq_s16(x, y); }
+	static void mulAdd32(int32 *ptr, Wide x, Wide volume) {
+		vst1q_s32(ptr, vmlal_s16(vld1q_s32(ptr), vget_low_s16(x), vget_low_s16(volume)));
+		vst1q_s32(ptr + 4, vmlal_s16(vld1q_s32(ptr + 4), vget_high_s16(x), vget_high_s16(volume)));
+	}
+};
+
+} // End of anonymous namespace
+
+uint mixMonoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames<NEONOps>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<NEONOps, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<NEONOps, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixMonoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames32<NEONOps>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<NEONOps, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<NEONOps, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+} // End of namespace Audio
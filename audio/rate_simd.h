@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_RATE_SIMD_H
+#define AUDIO_RATE_SIMD_H
+
+#include "audio/rate.h"
+
+/*
+ * Internal to the rate converters: the vectorized loops which mix converted
+ * samples into the output buffer, of 16 or 32 bit samples.
+ *
+ * Like the blending kernels of TransparentSurface, the loops are written
+ * once against a small set of vector operations, which each instruction set
+ * specific file provides as an "Ops" struct:
+ *
+ *  - Wide: a register of Ops::kSamples signed 16 bit lanes
+ *  - load, store: kSamples samples, without any alignment requirements
+ *  - loadDup: kSamples / 2 samples, each one repeated, for mono input
+ *  - swapPairs: swap the lanes of each pair, for reversed stereo
+ *  - setPairs: a register with x in the even lanes and y in the odd ones
+ *  - scale: x * volume / Mixer::kMaxMixerVolume, rounded towards zero like
+ *    the integer division of the scalar code
+ *  - addSaturate: add with signed saturation, which is what clampedAdd does
+ *  - mulAdd32: add the full 32 bit products x * volume to kSamples 32 bit
+ *    samples, without any alignment requirements
+ *
+ * So the results are the same as the ones of the scalar code, which the
+ * test suite checks.
+ *
+ * The loops only handle as many frames as fill whole registers and return
+ * that number. The remaining frames are left to the scalar code.
+ */
+
+namespace Audio {
+
+typedef uint (*MixFramesFunc)(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+typedef uint (*MixFrames32Func)(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+
+#ifdef USE_SSE2
+uint mixMonoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixMonoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+#endif
+
+#ifdef USE_AVX2
+uint mixMonoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFramesAVX2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixMonoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFrames32AVX2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+#endif
+
+#ifdef USE_NEON
+uint mixMonoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFramesNEON(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixMonoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixStereoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+uint mixReverseStereoFrames32NEON(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r);
+#endif
+
+namespace RateSIMD {
+
+template<class Ops>
+uint mixMonoFrames(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	typedef typename Ops::Wide Wide;
+
+	const Wide volume = Ops::setPairs(vol_l, vol_r);
+	const uint step = Ops::kSamples / 2;
+	const uint count = frames - frames % step;
+
+	for (uint i = 0; i < count; i += step) {
+		const Wide samples = Ops::scale(Ops::loadDup(in + i), volume);
+		Ops::store(obuf + 2 * i, Ops::addSaturate(Ops::load(obuf + 2 * i), samples));
+	}
+
+	return count;
+}
+
+template<class Ops, bool reverseStereo>
+uint mixStereoFrames(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	typedef typename Ops::Wide Wide;
+
+	// With reversed stereo, the left input ends up in the right output, but
+	// still with the left volume
+	const Wide volume = reverseStereo ? Ops::setPairs(vol_r, vol_l) : Ops::setPairs(vol_l, vol_r);
+	const uint step = Ops::kSamples / 2;
+	const uint count = frames - frames % step;
+
+	for (uint i = 0; i < count; i += step) {
+		Wide samples = Ops::load(in + 2 * i);
+		if (reverseStereo)
+			samples = Ops::swapPairs(samples);
+		samples = Ops::scale(samples, volume);
+		Ops::store(obuf + 2 * i, Ops::addSaturate(Ops::load(obuf + 2 * i), samples));
+	}
+
+	return count;
+}
+
+template<class Ops>
+uint mixMonoFrames32(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	typedef typename Ops::Wide Wide;
+
+	const Wide volume = Ops::setPairs(vol_l, vol_r);
+	const uint step = Ops::kSamples / 2;
+	const uint count = frames - frames % step;
+
+	for (uint i = 0; i < count; i += step)
+		Ops::mulAdd32(obuf + 2 * i, Ops::loadDup(in + i), volume);
+
+	return count;
+}
+
+template<class Ops, bool reverseStereo>
+uint mixStereoFrames32(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	typedef typename Ops::Wide Wide;
+
+	// See mixStereoFrames()
+	const Wide volume = reverseStereo ? Ops::setPairs(vol_r, vol_l) : Ops::setPairs(vol_l, vol_r);
+	const uint step = Ops::kSamples / 2;
+	const uint count = frames - frames % step;
+
+	for (uint i = 0; i < count; i += step) {
+		Wide samples = Ops::load(in + 2 * i);
+		if (reverseStereo)
+			samples = Ops::swapPairs(samples);
+		Ops::mulAdd32(obuf + 2 * i, samples, volume);
+	}
+
+	return count;
+}
+
+} // End of namespace RateSIMD
+
+} // End of namespace Audio
+
+#endif
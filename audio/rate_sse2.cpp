@@ -0,0 +1,97 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -msse2, see audio/module.mk
+
+#include "audio/rate_simd.h"
+
+#include <emmintrin.h>
+
+namespace Audio {
+
+namespace {
+
+struct SSE2Ops {
+	typedef __m128i Wide;
+
+	enum { kSamples = 8 };
+
+	static Wide load(const st_sample_t *ptr) { return _mm_loadu_si128((const __m128i *)ptr); }
+	static Wide loadDup(const st_sample_t *ptr) {
+		const __m128i samples = _mm_loadl_epi64((const __m128i *)ptr);
+		return _mm_unpacklo_epi16(samples, samples);
+	}
+	static void store(st_sample_t *ptr, Wide x) { _mm_storeu_si128((__m128i *)ptr, x); }
+
+	static Wide swapPairs(Wide x) {
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+	}
+	static Wide setPairs(st_volume_t x, st_volume_t y) { return _mm_set1_epi32((y << 16) | x); }
+
+	static Wide scale(Wide x, Wide volume) {
+		const __m128i lo = _mm_mullo_epi16(x, volume);
+		const __m128i hi = _mm_mulhi_epi16(x, volume);
+		// Bits 8 to 23 of the 32 bit products, which is the product divided
+		// by 256 and rounded down
+		const __m128i floored = _mm_or_si128(_mm_slli_epi16(hi, 8), _mm_srli_epi16(lo, 8));
+		// Negative products which are not a multiple of 256 need one more
+		const __m128i exact = _mm_cmpeq_epi16(_mm_and_si128(lo, _mm_set1_epi16(0xFF)), _mm_setzero_si128());
+		return _mm_sub_epi16(floored, _mm_andnot_si128(exact, _mm_srai_epi16(hi, 15)));
+	}
+	static Wide addSaturate(Wide x, Wide y) { return _mm_adds_epi16(x, y); }
+	static void mulAdd32(int32 *ptr, Wide x, Wide volume) {
+		// Interleave the lower and upper halves of the products
+		const __m128i lo = _mm_mullo_epi16(x, volume);
+		const __m128i hi = _mm_mulhi_epi16(x, volume);
+		__m128i *dst = (__m128i *)ptr;
+		_mm_storeu_si128(dst, _mm_add_epi32(_mm_loadu_si128(dst), _mm_unpacklo_epi16(lo, hi)));
+		_mm_storeu_si128(dst + 1, _mm_add_epi32(_mm_loadu_si128(dst + 1), _mm_unpackhi_epi16(lo, hi)));
+	}
+};
+
+} // End of anonymous namespace
+
+uint mixMonoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames<SSE2Ops>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<SSE2Ops, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFramesSSE2(st_sample_t *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames<SSE2Ops, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixMonoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixMonoFrames32<SSE2Ops>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixStereoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<SSE2Ops, false>(obuf, in, frames, vol_l, vol_r);
+}
+
+uint mixReverseStereoFrames32SSE2(int32 *obuf, const st_sample_t *in, uint frames, st_volume_t vol_l, st_volume_t vol_r) {
+	return RateSIMD::mixStereoFrames32<SSE2Ops, true>(obuf, in, frames, vol_l, vol_r);
+}
+
+} // End of namespace Audio
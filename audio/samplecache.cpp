@@ -0,0 +1,372 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/samplecache.h"
+#include "audio/audiostream.h"
+#include "audio/timestamp.h"
+
+#include "common/atomic.h"
+#include "common/mutex.h"
+#include "common/textconsole.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+namespace Audio {
+
+/**
+ * The decoded samples of a sound. They are shared by the cache and the
+ * streams playing them, which can be destroyed on different threads, so
+ * the reference count is atomic, or guarded by a mutex without lock-free
+ * atomics.
+ */
+class DecodedSamples : Common::NonCopyable {
+public:
+	DecodedSamples(int16 *data, uint32 numSamples, int rate, bool stereo)
+		: _data(data), _numSamples(numSamples), _rate(rate), _stereo(stereo), _refCount(1) {}
+
+	void incRef() {
+		addRef(1);
+	}
+
+	void decRef() {
+		if (addRef(-1) == 0)
+			delete this;
+	}
+
+	const int16 *getData() const { return _data; }
+	uint32 getNumSamples() const { return _numSamples; }
+	int getRate() const { return _rate; }
+	bool isStereo() const { return _stereo; }
+
+private:
+	~DecodedSamples() {
+		free(_data);
+	}
+
+	/** Change the reference count and return the new one. */
+	int addRef(int delta) {
+#ifndef COMMON_HAS_LOCKFREE_ATOMICS
+		Common::StackLock lock(_refMutex);
+#endif
+		int count;
+		do {
+			count = _refCount.load();
+		} while (!_refCount.compareExchange(count, count + delta));
+		return count + delta;
+	}
+
+	int16 *_data;
+	const uint32 _numSamples;
+	const int _rate;
+	const bool _stereo;
+	Common::Atomic<int> _refCount;
+#ifndef COMMON_HAS_LOCKFREE_ATOMICS
+	Common::Mutex _refMutex;
+#endif
+};
+
+/**
+ * Plays back decoded samples from the cache.
+ */
+class DecodedSampleStream : public SeekableAudioStream {
+public:
+	DecodedSampleStream(DecodedSamples *samples) : _samples(samples), _pos(0) {
+		_samples->incRef();
+	}
+
+	~DecodedSampleStream() {
+		_samples->decRef();
+	}
+
+	int readBuffer(int16 *buffer, const int numSamples) {
+		const int len = MIN<int>(numSamples, _samples->getNumSamples() - _pos);
+		memcpy(buffer, _samples->getData() + _pos, len * sizeof(int16));
+		_pos += len;
+		return len;
+	}
+
+	bool isStereo() const  { return _samples->isStereo(); }
+	bool endOfData() const { return _pos >= _samples->getNumSamples(); }
+
+	int getRate() const { return _samples->getRate(); }
+	Timestamp getLength() const {
+		return Timestamp(0, _samples->getNumSamples() / (isStereo() ? 2 : 1), getRate());
+	}
+
+	bool seek(const Timestamp &where) {
+		const uint32 pos = convertTimeToStreamPos(where, getRate(), isStereo()).totalNumberOfFrames();
+		if (pos > _samples->getNumSamples())
+			return false;
+
+		_pos = pos;
+		return true;
+	}
+
+private:
+	DecodedSamples *_samples;
+	uint32 _pos;
+};
+
+DecodedSampleCache::Lock::Lock(Common::Mutex *mutex) : _mutex(mutex) {
+	if (_mutex)
+		_mutex->lock();
+}
+
+DecodedSampleCache::Lock::~Lock() {
+	if (_mutex)
+		_mutex->unlock();
+}
+
+DecodedSampleCache::DecodedSampleCache(uint32 maxBytes, Common::TimerManager *timerManager)
+	: _nextId(0), _usedBytes(0), _maxBytes(maxBytes), _timerManager(timerManager), _mutex(0) {
+
+	if (_timerManager) {
+		_mutex = new Common::Mutex();
+		if (!_timerManager->installTimerProc(timerProc, kUpdateInterval, this, "DecodedSampleCache"))
+			warning("DecodedSampleCache: Could not install the timer, sounds will not be decoded in the background");
+	}
+}
+
+DecodedSampleCache::~DecodedSampleCache() {
+	if (_timerManager)
+		_timerManager->removeTimerProc(timerProc);
+
+	clear();
+	delete _mutex;
+}
+
+void DecodedSampleCache::timerProc(void *refCon) {
+	((DecodedSampleCache *)refCon)->update();
+}
+
+void DecodedSampleCache::prefetch(const Common::String &key, AudioStream *stream) {
+	assert(stream);
+	Lock lock(_mutex);
+
+	EntryMap::iterator found = _lookup.find(key);
+	if (found != _lookup.end()) {
+		// Another one is about to be played, so keep it around for longer
+		if (found->_value->samples) {
+			_entries.push_front(*found->_value);
+			_entries.erase(found->_value);
+			found->_value = _entries.begin();
+		}
+
+		delete stream;
+		return;
+	}
+
+	Entry entry;
+	entry.key = key;
+	entry.id = _nextId++;
+	entry.samples = 0;
+	entry.stream = stream;
+	entry.buffer = 0;
+	entry.bufferSamples = 0;
+	entry.bufferCapacity = 0;
+
+	_entries.push_front(entry);
+	_lookup[key] = _entries.begin();
+}
+
+bool DecodedSampleCache::isCached(const Common::String &key) const {
+	Lock lock(_mutex);
+
+	EntryMap::const_iterator found = _lookup.find(key);
+	return found != _lookup.end() && found->_value->samples;
+}
+
+SeekableAudioStream *DecodedSampleCache::getStream(const Common::String &key) {
+	Lock lock(_mutex);
+
+	EntryMap::iterator found = _lookup.find(key);
+	if (found == _lookup.end() || !found->_value->samples)
+		return 0;
+
+	// Move it to the front of the list
+	_entries.push_front(*found->_value);
+	_entries.erase(found->_value);
+	found->_value = _entries.begin();
+
+	return new DecodedSampleStream(_entries.front().samples);
+}
+
+void DecodedSampleCache::remove(const Common::String &key) {
+	Lock lock(_mutex);
+
+	EntryMap::iterator found = _lookup.find(key);
+	if (found != _lookup.end())
+		evict(found->_value);
+}
+
+void DecodedSampleCache::clear() {
+	Lock lock(_mutex);
+
+	while (!_entries.empty())
+		evict(_entries.begin());
+}
+
+uint32 DecodedSampleCache::getUsedBytes() const {
+	Lock lock(_mutex);
+	return _usedBytes;
+}
+
+bool DecodedSampleCache::update(uint maxSamples) {
+	while (true) {
+		Common::String key;
+		uint32 id;
+		AudioStream *stream;
+		int16 *buffer;
+		uint32 offset;
+		uint request;
+
+		{
+			Lock lock(_mutex);
+
+			// The sound queued first is the last one still being decoded
+			EntryList::iterator entry = _entries.end();
+			for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+				if (i->stream)
+					entry = i;
+			}
+
+			if (entry == _entries.end())
+				return false;
+
+			// Stereo streams can only return whole sample pairs
+			request = entry->stream->isStereo() ? (maxSamples & ~1) : maxSamples;
+			if (request == 0)
+				return true;
+
+			// Grow the buffer by half of its size, but at least by the request
+			if (entry->bufferSamples + request > entry->bufferCapacity) {
+				const uint32 capacity = entry->bufferSamples + MAX<uint32>(request, entry->bufferSamples / 2);
+				const uint32 bytes = (capacity - entry->bufferCapacity) * sizeof(int16);
+
+				int16 *newBuffer = 0;
+				if (makeRoom(bytes, entry))
+					newBuffer = (int16 *)realloc(entry->buffer, capacity * sizeof(int16));
+
+				if (!newBuffer) {
+					// The sound does not fit in, it will be played as usual
+					evict(entry);
+					continue;
+				}
+
+				entry->buffer = newBuffer;
+				entry->bufferCapacity = capacity;
+				_usedBytes += bytes;
+			}
+
+			// Take the stream and the buffer out, the entry may be dropped
+			// in the meantime
+			key = entry->key;
+			id = entry->id;
+			stream = entry->stream;
+			buffer = entry->buffer;
+			offset = entry->bufferSamples;
+			entry->stream = 0;
+			entry->buffer = 0;
+		}
+
+		const int len = stream->readBuffer(buffer + offset, request);
+		const bool finished = len <= 0 || stream->endOfData();
+		if (len > 0)
+			maxSamples -= len;
+
+		{
+			Lock lock(_mutex);
+
+			EntryMap::iterator found = _lookup.find(key);
+			if (found != _lookup.end() && found->_value->id == id) {
+				EntryList::iterator entry = found->_value;
+				entry->stream = stream;
+				entry->buffer = buffer;
+				if (len > 0)
+					entry->bufferSamples += len;
+
+				if (finished)
+					finishDecoding(entry);
+				continue;
+			}
+		}
+
+		// The sound was dropped while it was decoded
+		delete stream;
+		free(buffer);
+	}
+}
+
+bool DecodedSampleCache::makeRoom(uint32 bytes, EntryList::iterator keep) {
+	if (bytes > _maxBytes)
+		return false;
+
+	while (_usedBytes + bytes > _maxBytes) {
+		// Drop the least recently used sound which has been decoded
+		EntryList::iterator victim = _entries.end();
+		for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+			if (i->samples && i != keep)
+				victim = i;
+		}
+
+		if (victim == _entries.end())
+			return false;
+
+		evict(victim);
+	}
+
+	return true;
+}
+
+void DecodedSampleCache::finishDecoding(EntryList::iterator entry) {
+	const int rate = entry->stream->getRate();
+	const bool stereo = entry->stream->isStereo();
+	delete entry->stream;
+	entry->stream = 0;
+
+	// Give the memory which was not needed back
+	if (entry->bufferSamples < entry->bufferCapacity) {
+		int16 *buffer = (int16 *)realloc(entry->buffer, MAX<uint32>(entry->bufferSamples, 1) * sizeof(int16));
+		if (buffer) {
+			_usedBytes -= (entry->bufferCapacity - entry->bufferSamples) * sizeof(int16);
+			entry->buffer = buffer;
+			entry->bufferCapacity = entry->bufferSamples;
+		}
+	}
+
+	entry->samples = new DecodedSamples(entry->buffer, entry->bufferSamples, rate, stereo);
+	entry->buffer = 0;
+}
+
+void DecodedSampleCache::evict(EntryList::iterator entry) {
+	_usedBytes -= entry->bufferCapacity * sizeof(int16);
+
+	if (entry->samples)
+		entry->samples->decRef();
+	delete entry->stream;
+	free(entry->buffer);
+
+	_lookup.erase(entry->key);
+	_entries.erase(entry);
+}
+
+} // End of namespace Audio
@@ -0,0 +1,179 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SAMPLECACHE_H
+#define AUDIO_SAMPLECACHE_H
+
+#include "common/scummsys.h"
+#include "common/hash-str.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+namespace Common {
+class Mutex;
+class TimerManager;
+}
+
+namespace Audio {
+
+class AudioStream;
+class SeekableAudioStream;
+class DecodedSamples;
+
+/**
+ * Keeps decoded samples of compressed sounds, like speech, in memory.
+ *
+ * Decoding a Vorbis, MP3 or FLAC sound happens while it is being played,
+ * in the mixer callback, which is most expensive right when it starts.
+ * Engines which know which sounds are going to be played next can hand
+ * their streams to the cache beforehand, to have them decoded in the
+ * background. Playing a cached sound then only takes copying samples.
+ *
+ * The least recently used sounds are dropped when the decoded samples
+ * take more memory than the budget. Streams returned by the cache keep
+ * their samples, even if the cache drops them or is destroyed.
+ */
+class DecodedSampleCache : Common::NonCopyable {
+public:
+	enum {
+		/**
+		 * The number of samples decoded in one update. The timer thread
+		 * is shared with the other timers, e.g. music players, so each
+		 * update only takes a small part of an interval. This still
+		 * decodes faster than 44.1 kHz stereo plays back.
+		 */
+		kUpdateSamples = 1024,
+		/** The interval of the background updates, in microseconds. */
+		kUpdateInterval = 10000
+	};
+
+	/**
+	 * Create a cache.
+	 *
+	 * Without a timer manager, the sounds are only decoded when update()
+	 * is called. With one, this happens in timer callbacks, so there can
+	 * only be one such cache at a time.
+	 *
+	 * @param maxBytes     the memory budget for the decoded samples
+	 * @param timerManager the timer manager to decode in the background with
+	 */
+	DecodedSampleCache(uint32 maxBytes, Common::TimerManager *timerManager = 0);
+	~DecodedSampleCache();
+
+	/**
+	 * Queue a sound for decoding, unless it is cached or queued already.
+	 *
+	 * With a timer manager, the stream is decoded on the timer thread. So
+	 * it must not share its data source with anything else, e.g. it should
+	 * read from its own Common::File or from memory.
+	 *
+	 * @param key    an identifier of the sound, e.g. the file name and offset
+	 * @param stream the stream to decode, which the cache takes ownership of
+	 */
+	void prefetch(const Common::String &key, AudioStream *stream);
+
+	/**
+	 * Return whether the sound is decoded completely.
+	 */
+	bool isCached(const Common::String &key) const;
+
+	/**
+	 * Return a stream over the decoded samples of a sound, or 0 if the
+	 * sound is not decoded completely. In that case, the caller should
+	 * play the sound from its compressed data as usual.
+	 */
+	SeekableAudioStream *getStream(const Common::String &key);
+
+	/**
+	 * Drop a sound, or stop decoding it.
+	 */
+	void remove(const Common::String &key);
+
+	/**
+	 * Drop all sounds, and stop decoding any.
+	 */
+	void clear();
+
+	/**
+	 * Decode some of the queued sounds, in the order they were queued.
+	 * The cache is not locked while a stream is read, so the other calls
+	 * do not have to wait for the decoder.
+	 *
+	 * @param maxSamples the number of samples to decode at most
+	 * @return whether there are sounds left to decode
+	 */
+	bool update(uint maxSamples = kUpdateSamples);
+
+	/**
+	 * Return the memory taken by decoded samples, in bytes.
+	 */
+	uint32 getUsedBytes() const;
+
+private:
+	struct Entry {
+		Common::String key;
+		/** Tells apart the entries for a key, which can be dropped and queued again while it is decoded */
+		uint32 id;
+		/** The decoded samples, 0 until decoding has finished */
+		DecodedSamples *samples;
+
+		/** The stream which is being decoded, 0 while update() reads from it */
+		AudioStream *stream;
+		int16 *buffer;
+		uint32 bufferSamples;
+		uint32 bufferCapacity;
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<Common::String, EntryList::iterator> EntryMap;
+
+	/** Locks the mutex, if the cache decodes in the background. */
+	class Lock {
+	public:
+		Lock(Common::Mutex *mutex);
+		~Lock();
+	private:
+		Common::Mutex *_mutex;
+	};
+
+	static void timerProc(void *refCon);
+
+	void evict(EntryList::iterator entry);
+	/** Drop sounds which have been decoded until bytes more fit in. */
+	bool makeRoom(uint32 bytes, EntryList::iterator keep);
+	void finishDecoding(EntryList::iterator entry);
+
+	EntryList _entries;     ///< Most recently used first
+	EntryMap _lookup;
+	uint32 _nextId;
+	uint32 _usedBytes;
+	const uint32 _maxBytes;
+
+	Common::TimerManager *_timerManager;
+	Common::Mutex *_mutex;
+};
+
+} // End of namespace Audio
+
+#endif
@@ -35,9 +35,12 @@
 // Last synch with DOSBox SVN trunk r3752
 
 #include "dbopl.h"
+#include "dbopl_simd.h"
 
 #ifndef DISABLE_DOSBOX_OPL
 
+#include "common/cpudetect.h"
+
 namespace OPL {
 namespace DOSBox {
 
@@ -90,6 +93,9 @@ namespace DBOPL {
 //Has to fit within 16bit lookuptable
 #define MUL_SH		16
 
+//Operators are generated in blocks of at most this many samples
+#define BLOCK_SAMPLES	128
+
 //Check some ranges
 #if ENV_EXTRA > 3
 #error Too many envelope bits
@@ -146,7 +152,8 @@ static Bit16u SinTable[ 512 ];
 
 //6 is just 0 shifted and masked
 
-static Bit16s WaveTable[ 8 * 512 ];
+//One more entry for the vectorized lookups reading 32 bits at a time
+static Bit16s WaveTable[ 8 * 512 + 1 ];
 //Distance into WaveTable the wave starts
 static const Bit16u WaveBaseTable[8] = {
 	0x000, 0x200, 0x200, 0x800,
@@ -167,9 +174,15 @@ static const Bit16u WaveStartTable[8] = {
 #endif
 
 #if ( DBOPL_WAVE == WAVE_TABLEMUL )
-static Bit16u MulTable[ 384 ];
+//The entry behind the table is 0 for silent volumes, one more for the vectorized lookups
+static Bit16u MulTable[ 384 + 2 ];
 #endif
 
+//The noise generator runs hundreds of steps each sample, so jump ahead with tables holding
+//the result of running 2^n steps on each byte of its state
+#define NOISE_JUMPS 11
+static Bit32u NoiseJumpTable[ NOISE_JUMPS ][ 3 ][ 256 ];
+
 static Bit8u KslTable[ 8 * 16 ];
 static Bit8u TremoloTable[ TREMOLO_TABLE ];
 //Start of a channel behind the chip struct start
@@ -375,73 +388,123 @@ INLINE Bit32s Operator::RateForward( Bit32u add ) {
 	return ret;
 }
 
-template< Operator::State yes>
-Bits Operator::TemplateVolume(  ) {
-	Bit32s vol = volume;
-	Bit32s change;
-	switch ( yes ) {
-	case OFF:
-		return ENV_MAX;
-	case ATTACK:
-		change = RateForward( attackAdd );
-		if ( !change )
-			return vol;
-		vol += ( (~vol) * change ) >> 3;
-		if ( vol < ENV_MIN ) {
-			volume = ENV_MIN;
-			rateIndex = 0;
-			SetState( DECAY );
-			return ENV_MIN;
-		}
-		break;
-	case DECAY:
-		vol += RateForward( decayAdd );
-		if ( GCC_UNLIKELY(vol >= sustainLevel) ) {
-			//Check if we didn't overshoot max attenuation, then just go off
-			if ( GCC_UNLIKELY(vol >= ENV_MAX) ) {
-				volume = ENV_MAX;
-				SetState( OFF );
-				return ENV_MAX;
-			}
-			//Continue as sustain
-			rateIndex = 0;
-			SetState( SUSTAIN );
-		}
-		break;
-	case SUSTAIN:
-		if ( reg20 & MASK_SUSTAIN ) {
-			return vol;
-		}
-		//In sustain phase, but not sustaining, do regular release
-	case RELEASE:
-		vol += RateForward( releaseAdd );
-		if ( GCC_UNLIKELY(vol >= ENV_MAX) ) {
-			volume = ENV_MAX;
-			SetState( OFF );
-			return ENV_MAX;
-		}
-		break;
-	}
-	volume = vol;
-	return vol;
+INLINE Bitu Operator::ForwardWave() {
+	waveIndex += waveCurrent;
+	return waveIndex >> WAVE_SH;
 }
 
-static const VolumeHandler VolumeHandlerTable[5] = {
-	&Operator::TemplateVolume< Operator::OFF >,
-	&Operator::TemplateVolume< Operator::RELEASE >,
-	&Operator::TemplateVolume< Operator::SUSTAIN >,
-	&Operator::TemplateVolume< Operator::DECAY >,
-	&Operator::TemplateVolume< Operator::ATTACK >
-};
-
-INLINE Bitu Operator::ForwardVolume() {
-	return currentLevel + (this->*volHandler)();
+//Volumes at or above the silent level are all the same to the wave generation
+static INLINE Bit32u LimitVolume( Bitu vol ) {
+	return vol < ENV_LIMIT ? vol : ENV_LIMIT;
 }
 
+//Slow envelopes keep the same volume for many samples, until the rate counter overflows
+//Fill the volumes for those up front and return where the next change happens
+static INLINE Bitu FillConstant( Bitu i, Bitu samples, Bit32u& index, Bit32u add, Bit32u vol, Bit32u* volumes ) {
+	//Not worth it when the volume changes every few samples
+	if ( add > ( RATE_MASK >> 3 ) )
+		return i;
+	//Samples before the counter overflows, at most the whole block
+	Bitu count = samples - i;
+	if ( add && ( RATE_MASK - index ) / add < count ) {
+		count = ( RATE_MASK - index ) / add;
+	}
+	index += count * add;
+	for ( Bitu end = i + count; i < end; i++ ) {
+		volumes[ i ] = vol;
+	}
+	return i;
+}
 
-INLINE Bitu Operator::ForwardWave() {
-	waveIndex += waveCurrent;
-	return waveIndex >> WAVE_SH;
+void Operator::ForwardVolumes( Bitu samples, Bit32u* volumes ) {
+	//Work on local copies, the members would have to be reloaded after every write to volumes
+	const Bit32u level = currentLevel;
+	Bit32u index = rateIndex;
+	Bit32s vol = volume;
+	Bitu i = 0;
+	//Run each state of the envelope in its own loop until it changes to the next one
+	while ( i < samples ) {
+		switch ( state ) {
+		case OFF:
+			for ( ; i < samples; i++ ) {
+				volumes[ i ] = LimitVolume( level + ENV_MAX );
+			}
+			break;
+		case ATTACK:
+			for ( ; i < samples; i++ ) {
+				index += attackAdd;
+				Bit32s change = index >> RATE_SH;
+				index &= RATE_MASK;
+				if ( change ) {
+					vol += ( (~vol) * change ) >> 3;
+					if ( vol < ENV_MIN ) {
+						vol = ENV_MIN;
+						index = 0;
+						SetState( DECAY );
+						volumes[ i++ ] = LimitVolume( level + vol );
+						break;
+					}
+				}
+				volumes[ i ] = LimitVolume( level + vol );
+			}
+			break;
+		case DECAY:
+			for ( ; i < samples; i++ ) {
+				if ( vol < sustainLevel ) {
+					i = FillConstant( i, samples, index, decayAdd, LimitVolume( level + vol ), volumes );
+				}
+				if ( i == samples )
+					break;
+				index += decayAdd;
+				vol += index >> RATE_SH;
+				index &= RATE_MASK;
+				if ( GCC_UNLIKELY(vol >= sustainLevel) ) {
+					//Check if we didn't overshoot max attenuation, then just go off
+					if ( GCC_UNLIKELY(vol >= ENV_MAX) ) {
+						vol = ENV_MAX;
+						SetState( OFF );
+					} else {
+						//Continue as sustain
+						index = 0;
+						SetState( SUSTAIN );
+					}
+					volumes[ i++ ] = LimitVolume( level + vol );
+					break;
+				}
+				volumes[ i ] = LimitVolume( level + vol );
+			}
+			break;
+		case SUSTAIN:
+			if ( reg20 & MASK_SUSTAIN ) {
+				for ( ; i < samples; i++ ) {
+					volumes[ i ] = LimitVolume( level + vol );
+				}
+				break;
+			}
+			//In sustain phase, but not sustaining, do regular release
+		case RELEASE:
+			for ( ; i < samples; i++ ) {
+				if ( vol < ENV_MAX ) {
+					i = FillConstant( i, samples, index, releaseAdd, LimitVolume( level + vol ), volumes );
+				}
+				if ( i == samples )
+					break;
+				index += releaseAdd;
+				vol += index >> RATE_SH;
+				index &= RATE_MASK;
+				if ( GCC_UNLIKELY(vol >= ENV_MAX) ) {
+					vol = ENV_MAX;
+					SetState( OFF );
+					volumes[ i++ ] = LimitVolume( level + vol );
+					break;
+				}
+				volumes[ i ] = LimitVolume( level + vol );
+			}
+			break;
+		}
+	}
+	rateIndex = index;
+	volume = vol;
 }
 
 void Operator::Write20( const Chip* chip, Bit8u val ) {
@@ -518,7 +581,6 @@ void Operator::WriteE0( const Chip* chip, Bit8u val ) {
 
 INLINE void Operator::SetState( Bit8u s ) {
 	state = s;
-	volHandler = VolumeHandlerTable[ s ];
 }
 
 INLINE bool Operator::Silent() const {
@@ -582,17 +644,71 @@ INLINE Bits Operator::GetWave( Bitu index, Bitu vol ) {
 #endif
 }
 
-INLINE Bits Operator::GetSample( Bits modulation ) {
-	Bitu vol = ForwardVolume();
-	if ( ENV_SILENT( vol ) ) {
-		//Simply forward the wave
-		waveIndex += waveCurrent;
-		return 0;
-	} else {
-		Bitu index = ForwardWave();
-		index += modulation;
-		return GetWave( index, vol );
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+//Return the vectorized wave generation for this cpu, or 0 if there is none
+static WaveBlockFunc GetWaveBlockFunc() {
+#ifdef SCUMM_LITTLE_ENDIAN
+#ifdef USE_AVX2
+	if ( Common::hasCPUFeature( Common::kCPUFeatureAVX2 ) )
+		return generateWavesAVX2;
+#endif
+#ifdef USE_SSE2
+	if ( Common::hasCPUFeature( Common::kCPUFeatureSSE2 ) )
+		return generateWavesSSE2;
+#endif
+#ifdef USE_NEON
+	if ( Common::hasCPUFeature( Common::kCPUFeatureNEON ) )
+		return generateWavesNEON;
+#endif
+#endif
+	return 0;
+}
+#endif
+
+//Modulation for the operators which don't get any
+static const Bit32s NoModulation[ BLOCK_SAMPLES ] = { 0 };
+
+void Operator::GenerateBlock( Bitu samples, Bit32u* volumes, const Bit32s* modulation, Bit32s* output ) {
+	if ( !modulation ) {
+		modulation = NoModulation;
+	}
+	//Off stays off for the whole block, so just forward the wave
+	if ( state == OFF ) {
+		waveIndex += samples * waveCurrent;
+		memset( output, 0, sizeof( Bit32s ) * samples );
+		return;
 	}
+	ForwardVolumes( samples, volumes );
+	Bitu i = 0;
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+	WaveBlockFunc func = GetWaveBlockFunc();
+	if ( func ) {
+		WaveBlock block;
+		block.waveBase = waveBase;
+		block.waveMask = waveMask;
+		block.waveIndex = waveIndex;
+		block.waveCurrent = waveCurrent;
+		block.waveShift = WAVE_SH;
+		block.mulTable = MulTable;
+		i = func( block, samples, volumes, modulation, output );
+		waveIndex += i * waveCurrent;
+	}
+#endif
+	Bit32u index = waveIndex;
+	for ( ; i < samples; i++ ) {
+		index += waveCurrent;
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+		//Silent volumes end up behind the multiplication table, which gives 0
+		output[ i ] = GetWave( ( index >> WAVE_SH ) + modulation[ i ], volumes[ i ] );
+#else
+		if ( ENV_SILENT( volumes[ i ] ) ) {
+			output[ i ] = 0;
+		} else {
+			output[ i ] = GetWave( ( index >> WAVE_SH ) + modulation[ i ], volumes[ i ] );
+		}
+#endif
+	}
+	waveIndex = index;
 }
 
 Operator::Operator() {
@@ -784,57 +900,96 @@ void Channel::ResetC0( const Chip* chip ) {
 	WriteC0( chip, val );
 }
 
+void Channel::GenerateFeedback( Bitu samples, Bit32u* volumes, Bit32s* output ) {
+	Operator* modulator = Op( 0 );
+	modulator->ForwardVolumes( samples, volumes );
+	//Local copies again, which stay in registers while writing the output
+	Bit32s old0 = old[0];
+	Bit32s old1 = old[1];
+	Bit32u waveIndex = modulator->waveIndex;
+	const Bit32u waveCurrent = modulator->waveCurrent;
+	for ( Bitu i = 0; i < samples; i++ ) {
+		//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
+		Bit32s mod = (Bit32u)((old0 + old1)) >> feedback;
+		old0 = old1;
+		waveIndex += waveCurrent;
+		Bitu index = ( waveIndex >> WAVE_SH ) + mod;
+#if ( DBOPL_WAVE == WAVE_TABLEMUL )
+		old1 = modulator->GetWave( index, volumes[ i ] );
+#else
+		if ( ENV_SILENT( volumes[ i ] ) ) {
+			old1 = 0;
+		} else {
+			old1 = modulator->GetWave( index, volumes[ i ] );
+		}
+#endif
+		output[ i ] = old0;
+	}
+	old[0] = old0;
+	old[1] = old1;
+	modulator->waveIndex = waveIndex;
+}
+
 template< bool opl3Mode>
-INLINE void Channel::GeneratePercussion( Chip* chip, Bit32s* output ) {
-	Channel* chan = this;
+INLINE void Channel::GeneratePercussion( Chip* chip, Bitu samples, Bit32s* output ) {
+	Bit32u volumes[ BLOCK_SAMPLES ];
+	Bit32u sdVolumes[ BLOCK_SAMPLES ];
+	Bit32u tcVolumes[ BLOCK_SAMPLES ];
+	Bit32s first[ BLOCK_SAMPLES ];
+	Bit32s sample[ BLOCK_SAMPLES ];
+	Bit32s next[ BLOCK_SAMPLES ];
 
 	//BassDrum
-	Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
-	old[0] = old[1];
-	old[1] = Op(0)->GetSample( mod );
-
+	GenerateFeedback( samples, volumes, first );
 	//When bassdrum is in AM mode first operator is ignoed
-	if ( chan->regC0 & 1 ) {
-		mod = 0;
-	} else {
-		mod = old[0];
-	}
-	Bit32s sample = Op(1)->GetSample( mod );
+	Op(1)->GenerateBlock( samples, volumes, ( regC0 & 1 ) ? 0 : first, sample );
 
+	//Tom-tom
+	Op(4)->GenerateBlock( samples, volumes, 0, next );
+	for ( Bitu i = 0; i < samples; i++ ) {
+		sample[ i ] += next[ i ];
+	}
 
-	//Precalculate stuff used by other outputs
-	Bit32u noiseBit = chip->ForwardNoise() & 0x1;
-	Bit32u c2 = Op(2)->ForwardWave();
-	Bit32u c5 = Op(5)->ForwardWave();
-	Bit32u phaseBit = (((c2 & 0x88) ^ ((c2<<5) & 0x80)) | ((c5 ^ (c5<<2)) & 0x20)) ? 0x02 : 0x00;
+	//The other outputs depend on the noise and each others phase, so do them sample by sample
+	Bit32u* hhVolumes = volumes;
+	Op(2)->ForwardVolumes( samples, hhVolumes );
+	Op(3)->ForwardVolumes( samples, sdVolumes );
+	Op(5)->ForwardVolumes( samples, tcVolumes );
+	for ( Bitu i = 0; i < samples; i++ ) {
+		//Precalculate stuff used by other outputs
+		Bit32u noiseBit = chip->ForwardNoise() & 0x1;
+		Bit32u c2 = Op(2)->ForwardWave();
+		Bit32u c5 = Op(5)->ForwardWave();
+		Bit32u phaseBit = (((c2 & 0x88) ^ ((c2<<5) & 0x80)) | ((c5 ^ (c5<<2)) & 0x20)) ? 0x02 : 0x00;
 
-	//Hi-Hat
-	Bit32u hhVol = Op(2)->ForwardVolume();
-	if ( !ENV_SILENT( hhVol ) ) {
-		Bit32u hhIndex = (phaseBit<<8) | (0x34 << ( phaseBit ^ (noiseBit << 1 )));
-		sample += Op(2)->GetWave( hhIndex, hhVol );
-	}
-	//Snare Drum
-	Bit32u sdVol = Op(3)->ForwardVolume();
-	if ( !ENV_SILENT( sdVol ) ) {
-		Bit32u sdIndex = ( 0x100 + (c2 & 0x100) ) ^ ( noiseBit << 8 );
-		sample += Op(3)->GetWave( sdIndex, sdVol );
+		//Hi-Hat
+		Bit32u hhVol = hhVolumes[ i ];
+		if ( !ENV_SILENT( hhVol ) ) {
+			Bit32u hhIndex = (phaseBit<<8) | (0x34 << ( phaseBit ^ (noiseBit << 1 )));
+			sample[ i ] += Op(2)->GetWave( hhIndex, hhVol );
+		}
+		//Snare Drum
+		Bit32u sdVol = sdVolumes[ i ];
+		if ( !ENV_SILENT( sdVol ) ) {
+			Bit32u sdIndex = ( 0x100 + (c2 & 0x100) ) ^ ( noiseBit << 8 );
+			sample[ i ] += Op(3)->GetWave( sdIndex, sdVol );
+		}
+		//Top-Cymbal
+		Bit32u tcVol = tcVolumes[ i ];
+		if ( !ENV_SILENT( tcVol ) ) {
+			Bit32u tcIndex = (1 + phaseBit) << 8;
+			sample[ i ] += Op(5)->GetWave( tcIndex, tcVol );
+		}
 	}
-	//Tom-tom
-	sample += Op(4)->GetSample( 0 );
-
-	//Top-Cymbal
-	Bit32u tcVol = Op(5)->ForwardVolume();
-	if ( !ENV_SILENT( tcVol ) ) {
-		Bit32u tcIndex = (1 + phaseBit) << 8;
-		sample += Op(5)->GetWave( tcIndex, tcVol );
-	}
-	sample <<= 1;
-	if ( opl3Mode ) {
-		output[0] += sample;
-		output[1] += sample;
-	} else {
-		output[0] += sample;
+
+	for ( Bitu i = 0; i < samples; i++ ) {
+		Bit32s value = sample[ i ] << 1;
+		if ( opl3Mode ) {
+			output[ i * 2 + 0 ] += value;
+			output[ i * 2 + 1 ] += value;
+		} else {
+			output[ i ] += value;
+		}
 	}
 }
 
@@ -911,49 +1066,67 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		Op( 4 )->Prepare( chip );
 		Op( 5 )->Prepare( chip );
 	}
-	for ( Bitu i = 0; i < samples; i++ ) {
+	//Generate one operator after the other for a block of samples, feeding the output of one into the next
+	Bit32u volumes[ BLOCK_SAMPLES ];
+	Bit32s first[ BLOCK_SAMPLES ];
+	Bit32s sample[ BLOCK_SAMPLES ];
+	Bit32s next[ BLOCK_SAMPLES ];
+	for ( Bitu done = 0; done < samples; ) {
+		Bitu todo = samples - done;
+		if ( todo > BLOCK_SAMPLES )
+			todo = BLOCK_SAMPLES;
+
 		//Early out for percussion handlers
 		if ( mode == sm2Percussion ) {
-			GeneratePercussion<false>( chip, output + i );
-			continue;	//Prevent some unitialized value bitching
+			GeneratePercussion<false>( chip, todo, output + done );
+			done += todo;
+			continue;
 		} else if ( mode == sm3Percussion ) {
-			GeneratePercussion<true>( chip, output + i * 2 );
-			continue;	//Prevent some unitialized value bitching
+			GeneratePercussion<true>( chip, todo, output + done * 2 );
+			done += todo;
+			continue;
 		}
 
-		//Do unsigned shift so we can shift out all bits but still stay in 10 bit range otherwise
-		Bit32s mod = (Bit32u)((old[0] + old[1])) >> feedback;
-		old[0] = old[1];
-		old[1] = Op(0)->GetSample( mod );
-		Bit32s sample;
-		Bit32s out0 = old[0];
+		GenerateFeedback( todo, volumes, first );
 		if ( mode == sm2AM || mode == sm3AM ) {
-			sample = out0 + Op(1)->GetSample( 0 );
+			Op(1)->GenerateBlock( todo, volumes, 0, sample );
+			for ( Bitu i = 0; i < todo; i++ ) {
+				sample[ i ] += first[ i ];
+			}
 		} else if ( mode == sm2FM || mode == sm3FM ) {
-			sample = Op(1)->GetSample( out0 );
+			Op(1)->GenerateBlock( todo, volumes, first, sample );
 		} else if ( mode == sm3FMFM ) {
-			Bits next = Op(1)->GetSample( out0 );
-			next = Op(2)->GetSample( next );
-			sample = Op(3)->GetSample( next );
+			Op(1)->GenerateBlock( todo, volumes, first, next );
+			Op(2)->GenerateBlock( todo, volumes, next, next );
+			Op(3)->GenerateBlock( todo, volumes, next, sample );
 		} else if ( mode == sm3AMFM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 );
-			next = Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( next );
+			Op(1)->GenerateBlock( todo, volumes, 0, next );
+			Op(2)->GenerateBlock( todo, volumes, next, next );
+			Op(3)->GenerateBlock( todo, volumes, next, sample );
+			for ( Bitu i = 0; i < todo; i++ ) {
+				sample[ i ] += first[ i ];
+			}
 		} else if ( mode == sm3FMAM ) {
-			sample = Op(1)->GetSample( out0 );
-			Bits next = Op(2)->GetSample( 0 );
-			sample += Op(3)->GetSample( next );
+			Op(1)->GenerateBlock( todo, volumes, first, sample );
+			Op(2)->GenerateBlock( todo, volumes, 0, next );
+			Op(3)->GenerateBlock( todo, volumes, next, next );
+			for ( Bitu i = 0; i < todo; i++ ) {
+				sample[ i ] += next[ i ];
+			}
 		} else if ( mode == sm3AMAM ) {
-			sample = out0;
-			Bits next = Op(1)->GetSample( 0 );
-			sample += Op(2)->GetSample( next );
-			sample += Op(3)->GetSample( 0 );
+			Op(1)->GenerateBlock( todo, volumes, 0, next );
+			Op(2)->GenerateBlock( todo, volumes, next, sample );
+			Op(3)->GenerateBlock( todo, volumes, 0, next );
+			for ( Bitu i = 0; i < todo; i++ ) {
+				sample[ i ] += first[ i ] + next[ i ];
+			}
 		}
 		switch( mode ) {
 		case sm2AM:
 		case sm2FM:
-			output[ i ] += sample;
+			for ( Bitu i = 0; i < todo; i++ ) {
+				output[ done + i ] += sample[ i ];
+			}
 			break;
 		case sm3AM:
 		case sm3FM:
@@ -961,8 +1134,10 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 		case sm3AMFM:
 		case sm3FMAM:
 		case sm3AMAM:
-			output[ i * 2 + 0 ] += sample & maskLeft;
-			output[ i * 2 + 1 ] += sample & maskRight;
+			for ( Bitu i = 0; i < todo; i++ ) {
+				output[ ( done + i ) * 2 + 0 ] += sample[ i ] & maskLeft;
+				output[ ( done + i ) * 2 + 1 ] += sample[ i ] & maskRight;
+			}
 			break;
 		case sm2Percussion:
 			// This case was not handled in the DOSBox code either
@@ -985,6 +1160,7 @@ Channel* Channel::BlockTemplate( Chip* chip, Bit32u samples, Bit32s* output ) {
 			// TODO: Consider checking this.
 			break;
 		}
+		done += todo;
 	}
 	switch( mode ) {
 	case sm2AM:
@@ -1026,14 +1202,31 @@ Chip::Chip() {
 	opl3Active = 0;
 }
 
+//Noise calculation from mame
+static INLINE Bit32u StepNoise( Bit32u value ) {
+	value ^= ( 0x800302 ) & ( 0 - (value & 1 ) );
+	return value >> 1;
+}
+
+//The steps are linear, so combining the jumps of each byte gives the jump of the whole state
+static INLINE Bit32u JumpNoise( Bit32u value, Bitu jump ) {
+	return NoiseJumpTable[ jump ][ 0 ][ value & 0xff ] ^
+		NoiseJumpTable[ jump ][ 1 ][ ( value >> 8 ) & 0xff ] ^
+		NoiseJumpTable[ jump ][ 2 ][ ( value >> 16 ) & 0xff ];
+}
+
 INLINE Bit32u Chip::ForwardNoise() {
 	noiseCounter += noiseAdd;
 	Bitu count = noiseCounter >> LFO_SH;
 	noiseCounter &= WAVE_MASK;
-	for ( ; count > 0; --count ) {
-		//Noise calculation from mame
-		noiseValue ^= ( 0x800302 ) & ( 0 - (noiseValue & 1 ) );
-		noiseValue >>= 1;
+	//Do count steps as the jumps for each bit set in it
+	for ( ; count >= ( 1 << NOISE_JUMPS ); count -= 1 << ( NOISE_JUMPS - 1 ) ) {
+		noiseValue = JumpNoise( noiseValue, NOISE_JUMPS - 1 );
+	}
+	for ( Bitu jump = 0; count > 0; jump++, count >>= 1 ) {
+		if ( count & 1 ) {
+			noiseValue = JumpNoise( noiseValue, jump );
+		}
 	}
 	return noiseValue;
 }
@@ -1446,6 +1639,21 @@ void InitTables( void ) {
 	}
 #endif
 
+	//Create the noise jump tables, by doing a step for the first and doubling the jumps after that
+	for ( int part = 0; part < 3; part++ ) {
+		for ( int i = 0; i < 256; i++ ) {
+			NoiseJumpTable[ 0 ][ part ][ i ] = StepNoise( i << ( part * 8 ) );
+		}
+	}
+	for ( int jump = 1; jump < NOISE_JUMPS; jump++ ) {
+		for ( int part = 0; part < 3; part++ ) {
+			for ( int i = 0; i < 256; i++ ) {
+				Bit32u value = i << ( part * 8 );
+				NoiseJumpTable[ jump ][ part ][ i ] = JumpNoise( JumpNoise( value, jump - 1 ), jump - 1 );
+			}
+		}
+	}
+
 	//Create the ksl table
 	for ( int oct = 0; oct < 8; oct++ ) {
 		int base = oct * 8;
@@ -66,7 +66,6 @@ struct Channel;
 typedef Bits ( DB_FASTCALL *WaveHandler) ( Bitu i, Bitu volume );
 #endif
 
-typedef Bits ( DBOPL::Operator::*VolumeHandler) ( );
 typedef Channel* ( DBOPL::Channel::*SynthHandler) ( Chip* chip, Bit32u samples, Bit32s* output );
 
 //Different synth modes that can generate blocks of data
@@ -109,8 +108,6 @@ public:
 		ATTACK
 	} State;
 
-	VolumeHandler volHandler;
-
 #if (DBOPL_WAVE == WAVE_HANDLER)
 	WaveHandler waveHandler;	//Routine that generate a wave
 #else
@@ -169,15 +166,14 @@ public:
 	void KeyOn( Bit8u mask);
 	void KeyOff( Bit8u mask);
 
-	template< State state>
-	Bits TemplateVolume( );
-
 	Bit32s RateForward( Bit32u add );
 	Bitu ForwardWave();
-	Bitu ForwardVolume();
+	//Run the envelope for a block, the volumes are limited to the silent level
+	void ForwardVolumes( Bitu samples, Bit32u* volumes );
 
-	Bits GetSample( Bits modulation );
 	Bits GetWave( Bitu index, Bitu vol );
+	//Generate a block of samples, volumes is scratch space for as many samples
+	void GenerateBlock( Bitu samples, Bit32u* volumes, const Bit32s* modulation, Bit32s* output );
 public:
 	Operator();
 };
@@ -208,9 +204,12 @@ struct Channel {
 	void WriteC0( const Chip* chip, Bit8u val );
 	void ResetC0( const Chip* chip );
 
+	//Generate the first operator with its feedback, output is delayed one sample like the original
+	void GenerateFeedback( Bitu samples, Bit32u* volumes, Bit32s* output );
+
 	//call this for the first channel
 	template< bool opl3Mode >
-	void GeneratePercussion( Chip* chip, Bit32s* output );
+	void GeneratePercussion( Chip* chip, Bitu samples, Bit32s* output );
 
 	//Generate blocks of data in specific modes
 	template<SynthMode mode>
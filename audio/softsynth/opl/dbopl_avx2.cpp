@@ -0,0 +1,73 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -mavx2, see audio/module.mk
+
+#include "audio/softsynth/opl/dbopl_simd.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+#include <immintrin.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+namespace {
+
+struct AVX2Ops {
+	typedef __m256i Wide;
+
+	enum { kSamples = 8 };
+
+	static Wide load(const Bit32u *ptr) { return _mm256_loadu_si256((const __m256i *)ptr); }
+	static void store(Bit32u *ptr, Wide x) { _mm256_storeu_si256((__m256i *)ptr, x); }
+
+	static Wide set(Bit32u x) { return _mm256_set1_epi32(x); }
+	static Wide steps(Bit32u x) { return _mm256_setr_epi32(x, 2 * x, 3 * x, 4 * x, 5 * x, 6 * x, 7 * x, 8 * x); }
+
+	static Wide add(Wide x, Wide y) { return _mm256_add_epi32(x, y); }
+	static Wide bitAnd(Wide x, Wide y) { return _mm256_and_si256(x, y); }
+	static Wide shiftRight(Wide x, Bit32u shift) { return _mm256_srl_epi32(x, _mm_cvtsi32_si128(shift)); }
+
+	static Wide lookup(const WaveBlock &block, Wide index, Wide volume) {
+		// Gather 32 bits at each table entry, which is why the tables need
+		// an entry more, and keep the lower 16 bits of them
+		Wide wave = _mm256_i32gather_epi32((const int *)block.waveBase, index, 2);
+		wave = _mm256_srai_epi32(_mm256_slli_epi32(wave, 16), 16);
+		Wide mul = _mm256_i32gather_epi32((const int *)block.mulTable, volume, 2);
+		mul = _mm256_and_si256(mul, _mm256_set1_epi32(0xFFFF));
+		return _mm256_srai_epi32(_mm256_mullo_epi32(wave, mul), 16);
+	}
+};
+
+} // End of anonymous namespace
+
+Bitu generateWavesAVX2(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output) {
+	return WaveSIMD::generateWaves<AVX2Ops>(block, samples, volumes, modulation, output);
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif // !DISABLE_DOSBOX_OPL
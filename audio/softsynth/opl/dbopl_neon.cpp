@@ -0,0 +1,76 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "audio/softsynth/opl/dbopl_simd.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+#include <arm_neon.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+namespace {
+
+struct NEONOps {
+	typedef uint32x4_t Wide;
+
+	enum { kSamples = 4 };
+
+	static Wide load(const Bit32u *ptr) { return vld1q_u32(ptr); }
+	static void store(Bit32u *ptr, Wide x) { vst1q_u32(ptr, x); }
+
+	static Wide set(Bit32u x) { return vdupq_n_u32(x); }
+	static Wide steps(Bit32u x) {
+		const Bit32u values[4] = { x, 2 * x, 3 * x, 4 * x };
+		return vld1q_u32(values);
+	}
+
+	static Wide add(Wide x, Wide y) { return vaddq_u32(x, y); }
+	static Wide bitAnd(Wide x, Wide y) { return vandq_u32(x, y); }
+	static Wide shiftRight(Wide x, Bit32u shift) { return vshlq_u32(x, vdupq_n_s32(-(int32)shift)); }
+
+	static Wide lookup(const WaveBlock &block, Wide index, Wide volume) {
+		// There are no gathers, but the table lookups still leave the
+		// multiplication to the vector unit
+		Bit32u i[4], v[4];
+		store(i, index);
+		store(v, volume);
+		const int32 waves[4] = { block.waveBase[i[0]], block.waveBase[i[1]], block.waveBase[i[2]], block.waveBase[i[3]] };
+		const int32 muls[4] = { block.mulTable[v[0]], block.mulTable[v[1]], block.mulTable[v[2]], block.mulTable[v[3]] };
+		const int32x4_t product = vmulq_s32(vld1q_s32(waves), vld1q_s32(muls));
+		return vreinterpretq_u32_s32(vshrq_n_s32(product, 16));
+	}
+};
+
+} // End of anonymous namespace
+
+Bitu generateWavesNEON(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output) {
+	return WaveSIMD::generateWaves<NEONOps>(block, samples, volumes, modulation, output);
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif // !DISABLE_DOSBOX_OPL
@@ -0,0 +1,119 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef AUDIO_SOFTSYNTH_OPL_DBOPL_SIMD_H
+#define AUDIO_SOFTSYNTH_OPL_DBOPL_SIMD_H
+
+#include "audio/softsynth/opl/dbopl.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+/*
+ * Internal to the DOSBox OPL emulator: the vectorized loops which look up
+ * the waves of an operator for a block of samples, once its envelope has
+ * been run for the block.
+ *
+ * Like the mixing loops of the rate converters, the loop is written once
+ * against a small set of vector operations, which each instruction set
+ * specific file provides as an "Ops" struct:
+ *
+ *  - Wide: a register of Ops::kSamples 32 bit lanes
+ *  - load, store: kSamples values, without any alignment requirements
+ *  - set: a register with x in all lanes
+ *  - steps: a register with x, 2 * x, ..., kSamples * x
+ *  - add, bitAnd, shiftRight: lane wise, with wrap around like uint32
+ *  - lookup: (waveBase[index] * mulTable[volume]) >> MUL_SH, which is what
+ *    Operator::GetWave does
+ *
+ * So the results are the same as the ones of the scalar code, which the
+ * test suite checks.
+ *
+ * The loop only handles as many samples as fill whole registers and
+ * returns that number. The remaining samples are left to the scalar code.
+ */
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+/**
+ * The state of an operator which the wave loops need.
+ *
+ * The volumes passed along with it have to be limited to the silent level,
+ * with mulTable holding 0 there. Both tables have to be followed by one
+ * more entry, for the gathers which read 32 bits at a time.
+ */
+struct WaveBlock {
+	const Bit16s *waveBase;
+	Bit32u waveMask;
+	/** The phase before the first sample, advanced by waveCurrent for each one */
+	Bit32u waveIndex;
+	Bit32u waveCurrent;
+	/** The shift from the phase to the wave table index */
+	Bit32u waveShift;
+	const Bit16u *mulTable;
+};
+
+typedef Bitu (*WaveBlockFunc)(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output);
+
+#ifdef USE_SSE2
+Bitu generateWavesSSE2(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output);
+#endif
+
+#ifdef USE_AVX2
+Bitu generateWavesAVX2(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output);
+#endif
+
+#ifdef USE_NEON
+Bitu generateWavesNEON(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output);
+#endif
+
+namespace WaveSIMD {
+
+template<class Ops>
+Bitu generateWaves(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output) {
+	typedef typename Ops::Wide Wide;
+
+	const Bitu count = samples - samples % Ops::kSamples;
+	const Wide mask = Ops::set(block.waveMask);
+	const Wide step = Ops::set(block.waveCurrent * Ops::kSamples);
+	Wide phase = Ops::add(Ops::set(block.waveIndex), Ops::steps(block.waveCurrent));
+
+	for (Bitu i = 0; i < count; i += Ops::kSamples) {
+		Wide index = Ops::add(Ops::shiftRight(phase, block.waveShift), Ops::load((const Bit32u *)modulation + i));
+		index = Ops::bitAnd(index, mask);
+		Ops::store((Bit32u *)output + i, Ops::lookup(block, index, Ops::load(volumes + i)));
+		phase = Ops::add(phase, step);
+	}
+
+	return count;
+}
+
+} // End of namespace WaveSIMD
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif // !DISABLE_DOSBOX_OPL
+
+#endif
@@ -0,0 +1,108 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -msse2, see audio/module.mk
+
+#include "audio/softsynth/opl/dbopl_simd.h"
+
+#ifndef DISABLE_DOSBOX_OPL
+
+#include <emmintrin.h>
+
+namespace OPL {
+namespace DOSBox {
+namespace DBOPL {
+
+namespace {
+
+struct SSE2Ops {
+	// Two registers, so that one multiplication handles the 16 bit values
+	// of eight samples
+	struct Wide {
+		__m128i lo, hi;
+	};
+
+	enum { kSamples = 8 };
+
+	static Wide make(__m128i lo, __m128i hi) {
+		Wide x;
+		x.lo = lo;
+		x.hi = hi;
+		return x;
+	}
+
+	static Wide load(const Bit32u *ptr) {
+		return make(_mm_loadu_si128((const __m128i *)ptr), _mm_loadu_si128((const __m128i *)(ptr + 4)));
+	}
+	static void store(Bit32u *ptr, Wide x) {
+		_mm_storeu_si128((__m128i *)ptr, x.lo);
+		_mm_storeu_si128((__m128i *)(ptr + 4), x.hi);
+	}
+
+	static Wide set(Bit32u x) { return make(_mm_set1_epi32(x), _mm_set1_epi32(x)); }
+	static Wide steps(Bit32u x) { return make(_mm_setr_epi32(x, 2 * x, 3 * x, 4 * x), _mm_setr_epi32(5 * x, 6 * x, 7 * x, 8 * x)); }
+
+	static Wide add(Wide x, Wide y) { return make(_mm_add_epi32(x.lo, y.lo), _mm_add_epi32(x.hi, y.hi)); }
+	static Wide bitAnd(Wide x, Wide y) { return make(_mm_and_si128(x.lo, y.lo), _mm_and_si128(x.hi, y.hi)); }
+	static Wide shiftRight(Wide x, Bit32u shift) {
+		const __m128i count = _mm_cvtsi32_si128(shift);
+		return make(_mm_srl_epi32(x.lo, count), _mm_srl_epi32(x.hi, count));
+	}
+
+	static __m128i gather(const Bit16s *table, Wide index) {
+		// There are no gathers before AVX2, so insert the entries one by one
+		__m128i result = _mm_cvtsi32_si128((uint16)table[_mm_cvtsi128_si32(index.lo)]);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.lo, 4))], 1);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.lo, 8))], 2);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.lo, 12))], 3);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(index.hi)], 4);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.hi, 4))], 5);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.hi, 8))], 6);
+		result = _mm_insert_epi16(result, table[_mm_cvtsi128_si32(_mm_srli_si128(index.hi, 12))], 7);
+		return result;
+	}
+
+	static Wide lookup(const WaveBlock &block, Wide index, Wide volume) {
+		const __m128i wave = gather(block.waveBase, index);
+		const __m128i mul = gather((const Bit16s *)block.mulTable, volume);
+
+		// The upper halves of the signed by unsigned 16 bit products: an
+		// unsigned multiplication counts negative waves 65536 too high, which
+		// adds the multiplier once more to the upper half
+		const __m128i negative = _mm_srai_epi16(wave, 15);
+		const __m128i product = _mm_sub_epi16(_mm_mulhi_epu16(wave, mul), _mm_and_si128(negative, mul));
+		const __m128i sign = _mm_srai_epi16(product, 15);
+		return make(_mm_unpacklo_epi16(product, sign), _mm_unpackhi_epi16(product, sign));
+	}
+};
+
+} // End of anonymous namespace
+
+Bitu generateWavesSSE2(const WaveBlock &block, Bitu samples, const Bit32u *volumes, const Bit32s *modulation, Bit32s *output) {
+	return WaveSIMD::generateWaves<SSE2Ops>(block, samples, volumes, modulation, output);
+}
+
+} // End of namespace DBOPL
+} // End of namespace DOSBox
+} // End of namespace OPL
+
+#endif // !DISABLE_DOSBOX_OPL
@@ -183,6 +183,20 @@ public:
 	 */
 	virtual Common::SeekableReadStream *createReadStream() = 0;
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, which may map the file into memory instead
+	 * of reading it. Only use this for files which are not modified while
+	 * the stream is open, like game data: reading from a mapped file which
+	 * was truncated in the meantime crashes.
+	 *
+	 * The default implementation does not map files and just calls
+	 * createReadStream().
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	virtual Common::SeekableReadStream *createMappedReadStream() { return createReadStream(); }
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -31,6 +31,7 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_exit		//Needed for IRIX's unistd.h
 
 #include "backends/fs/posix/posix-fs.h"
+#include "backends/fs/posix/posix-mappedstream.h"
 #include "backends/fs/stdiostream.h"
 #include "common/algorithm.h"
 
@@ -248,6 +249,16 @@ Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
 	return StdioStream::makeFromPath(getPath(), false);
 }
 
+Common::SeekableReadStream *POSIXFilesystemNode::createMappedReadStream() {
+#ifdef POSIX_USE_MAPPED_FILES
+	Common::SeekableReadStream *stream = MappedFileReadStream::makeFromPath(getPath());
+	if (stream)
+		return stream;
+#endif
+
+	return createReadStream();
+}
+
 Common::WriteStream *POSIXFilesystemNode::createWriteStream() {
 	return StdioStream::makeFromPath(getPath(), true);
 }
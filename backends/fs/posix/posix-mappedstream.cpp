@@ -0,0 +1,71 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// Disable symbol overrides so that we can use open, close etc.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/posix-mappedstream.h"
+
+#ifdef POSIX_USE_MAPPED_FILES
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+enum {
+	// Files smaller than this are cheaper to read through stdio than to map.
+	kMinMappedFileSize = 4096
+};
+
+MappedFileReadStream *MappedFileReadStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		return 0;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+	    st.st_size < kMinMappedFileSize || st.st_size > 0x7FFFFFFF) {
+		close(fd);
+		return 0;
+	}
+
+	void *mapping = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping stays valid after the descriptor is closed.
+	close(fd);
+
+	if (mapping == MAP_FAILED)
+		return 0;
+
+	return new MappedFileReadStream((const byte *)mapping, (uint32)st.st_size);
+}
+
+MappedFileReadStream::MappedFileReadStream(const byte *mapping, uint32 size)
+	: Common::MemoryReadStream(mapping, size), _mapping(mapping), _mappingSize(size) {
+}
+
+MappedFileReadStream::~MappedFileReadStream() {
+	munmap(const_cast<byte *>(_mapping), _mappingSize);
+}
+
+#endif
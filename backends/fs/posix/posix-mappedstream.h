@@ -0,0 +1,66 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_MAPPEDSTREAM_H
+#define BACKENDS_FS_POSIX_MAPPEDSTREAM_H
+
+#include "common/scummsys.h"
+
+#if defined(POSIX) && !defined(PLAYSTATION3)
+
+#define POSIX_USE_MAPPED_FILES
+
+#include "common/memstream.h"
+#include "common/noncopyable.h"
+#include "common/str.h"
+
+/**
+ * A read stream over a file which is mapped into memory with mmap().
+ *
+ * Reading and seeking work on the mapping like for any MemoryReadStream,
+ * so the kernel pages the file in on demand, and getDataPointer() gives
+ * direct access to the whole file content without copying it.
+ */
+class MappedFileReadStream : public Common::MemoryReadStream, public Common::NonCopyable {
+public:
+	/**
+	 * Map the file at the given path. Returns 0 if the file cannot be
+	 * mapped, e.g. because it is empty or smaller than a page; callers
+	 * should fall back to a regular stream in that case.
+	 */
+	static MappedFileReadStream *makeFromPath(const Common::String &path);
+
+	virtual ~MappedFileReadStream();
+
+	/** Return a pointer to the start of the mapped file content. */
+	const byte *getDataPointer() const { return _mapping; }
+
+private:
+	MappedFileReadStream(const byte *mapping, uint32 size);
+
+	const byte *_mapping;
+	uint32 _mappingSize;
+};
+
+#endif
+
+#endif
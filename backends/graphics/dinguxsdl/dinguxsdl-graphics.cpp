@@ -298,6 +298,8 @@ void DINGUXSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	collectDirtyRects();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -38,6 +38,10 @@ void Context::reset() {
 	shadersSupported = false;
 	multitextureSupported = false;
 	framebufferObjectSupported = false;
+	unpackSubImageSupported = false;
+	pixelBufferObjectSupported = false;
+
+	textureUploadBytes = 0;
 
 #define GL_FUNC_DEF(ret, name, param) name = nullptr;
 #include "backends/graphics/opengl/opengl-func.h"
@@ -138,6 +142,10 @@ void OpenGLGraphicsManager::initializeGLContext() {
 			g_context.multitextureSupported = true;
 		} else if (token == "GL_EXT_framebuffer_object") {
 			g_context.framebufferObjectSupported = true;
+		} else if (token == "GL_EXT_unpack_subimage") {
+			g_context.unpackSubImageSupported = true;
+		} else if (token == "GL_ARB_pixel_buffer_object") {
+			g_context.pixelBufferObjectSupported = true;
 		}
 	}
 
@@ -157,6 +165,24 @@ void OpenGLGraphicsManager::initializeGLContext() {
 		g_context.shadersSupported = ARBShaderObjects & ARBShadingLanguage100 & ARBVertexShader & ARBFragmentShader;
 	}
 
+	// Desktop GL always has GL_UNPACK_ROW_LENGTH. GLES only has it with
+	// GL_EXT_unpack_subimage.
+	if (g_context.type == kContextGL) {
+		g_context.unpackSubImageSupported = true;
+	}
+
+	// Pixel buffer objects are only used in desktop GL contexts. GLES 2.0
+	// has no GL_PIXEL_UNPACK_BUFFER, and mapping buffers needs another
+	// extension there.
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2 && !defined(USE_BUILTIN_OPENGL)
+	if (g_context.type != kContextGL || !g_context.glGenBuffers || !g_context.glDeleteBuffers ||
+	    !g_context.glBindBuffer || !g_context.glBufferData || !g_context.glMapBuffer || !g_context.glUnmapBuffer) {
+		g_context.pixelBufferObjectSupported = false;
+	}
+#else
+	g_context.pixelBufferObjectSupported = false;
+#endif
+
 	// Log context type.
 	switch (g_context.type) {
 	case kContextGL:
@@ -177,6 +203,8 @@ void OpenGLGraphicsManager::initializeGLContext() {
 	debug(5, "OpenGL: Shader support: %d", g_context.shadersSupported);
 	debug(5, "OpenGL: Multitexture support: %d", g_context.multitextureSupported);
 	debug(5, "OpenGL: FBO support: %d", g_context.framebufferObjectSupported);
+	debug(5, "OpenGL: Unpack subimage support: %d", g_context.unpackSubImageSupported);
+	debug(5, "OpenGL: Pixel buffer object support: %d", g_context.pixelBufferObjectSupported);
 }
 
 } // End of namespace OpenGL
@@ -142,6 +142,15 @@ GL_FUNC_2_DEF(GLenum, glCheckFramebufferStatus, glCheckFramebufferStatusEXT, (GL
 GL_FUNC_2_DEF(void, glActiveTexture, glActiveTextureARB, (GLenum texture));
 #endif
 
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2 && !defined(USE_BUILTIN_OPENGL)
+GL_FUNC_2_DEF(void, glGenBuffers, glGenBuffersARB, (GLsizei n, GLuint *buffers));
+GL_FUNC_2_DEF(void, glDeleteBuffers, glDeleteBuffersARB, (GLsizei n, const GLuint *buffers));
+GL_FUNC_2_DEF(void, glBindBuffer, glBindBufferARB, (GLenum target, GLuint buffer));
+GL_FUNC_2_DEF(void, glBufferData, glBufferDataARB, (GLenum target, GLsizeiptr size, const GLvoid *data, GLenum usage));
+GL_FUNC_2_DEF(GLvoid *, glMapBuffer, glMapBufferARB, (GLenum target, GLenum access));
+GL_FUNC_2_DEF(GLboolean, glUnmapBuffer, glUnmapBufferARB, (GLenum target));
+#endif
+
 #ifdef DEFINED_GL_EXT_FUNC_DEF
 #undef DEFINED_GL_EXT_FUNC_DEF
 #undef GL_EXT_FUNC_DEF
@@ -28,6 +28,8 @@
 #include "backends/graphics/opengl/pipelines/shader.h"
 #include "backends/graphics/opengl/shader.h"
 
+#include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
 #include "common/algorithm.h"
@@ -55,7 +57,8 @@ OpenGLGraphicsManager::OpenGLGraphicsManager()
       _cursorX(0), _cursorY(0), _cursorDisplayX(0),_cursorDisplayY(0), _cursorHotspotX(0), _cursorHotspotY(0),
       _cursorHotspotXScaled(0), _cursorHotspotYScaled(0), _cursorWidthScaled(0), _cursorHeightScaled(0),
       _cursorKeyColor(0), _cursorVisible(false), _cursorDontScale(false), _cursorPaletteEnabled(false),
-      _forceRedraw(false), _scissorOverride(3)
+      _forceRedraw(false), _scissorOverride(3),
+      _showUploadStats(ConfMan.hasKey("opengl_upload_stats") && ConfMan.getBool("opengl_upload_stats")), _uploadStatsStartTime(0), _uploadStatsFrames(0)
 #ifdef USE_OSD
       , _osdAlpha(0), _osdFadeStartTime(0), _osd(nullptr)
 #endif
@@ -378,7 +381,15 @@ void OpenGLGraphicsManager::updateScreen() {
 		_cursor->updateGLTexture();
 	}
 	_overlay->updateGLTexture();
+	if (_showUploadStats && gDebugLevel >= 5) {
+		updateUploadStats();
+	}
+
+	// Leave the OSD out of the upload statistics, it is not drawn by the
+	// game.
+	const uint32 uploadBytes = g_context.textureUploadBytes;
 	_osd->updateGLTexture();
+	g_context.textureUploadBytes = uploadBytes;
 
 	// Clear the screen buffer.
 	if (_scissorOverride && !_overlayVisible) {
@@ -751,6 +762,32 @@ void OpenGLGraphicsManager::displayMessageOnOSD(const char *msg) {
 #endif
 }
 
+void OpenGLGraphicsManager::updateUploadStats() {
+	const uint32 now = g_system->getMillis();
+
+	// Start measuring after the first frame, which uploads everything.
+	if (!_uploadStatsStartTime) {
+		g_context.textureUploadBytes = 0;
+		_uploadStatsStartTime = now;
+		return;
+	}
+
+	++_uploadStatsFrames;
+
+	const uint32 elapsed = now - _uploadStatsStartTime;
+	if (elapsed < kUploadStatsInterval) {
+		return;
+	}
+
+	const uint32 bytes = g_context.textureUploadBytes;
+	debug(5, "OpenGL texture uploads: %u KB/s, %u KB/frame over %u frames",
+	      (uint)((uint64)bytes * 1000 / elapsed / 1024), bytes / _uploadStatsFrames / 1024, _uploadStatsFrames);
+
+	g_context.textureUploadBytes = 0;
+	_uploadStatsStartTime = now;
+	_uploadStatsFrames = 0;
+}
+
 void OpenGLGraphicsManager::setPalette(const byte *colors, uint start, uint num) {
 	assert(_gameScreen->hasPalette());
 
@@ -533,6 +533,21 @@ private:
 	 */
 	uint _scissorOverride;
 
+	/**
+	 * Log how many bytes were uploaded to textures, once a second. This is
+	 * enabled with the "opengl_upload_stats" config key, and logged at
+	 * debug level 5 like the rest of the OpenGL details.
+	 */
+	void updateUploadStats();
+
+	bool _showUploadStats;
+	uint32 _uploadStatsStartTime;
+	uint _uploadStatsFrames;
+
+	enum {
+		kUploadStatsInterval = 1000
+	};
+
 #ifdef USE_OSD
 	//
 	// OSD
@@ -120,6 +120,18 @@ struct Context {
 	/** Whether FBO support is available or not. */
 	bool framebufferObjectSupported;
 
+	/** Whether GL_UNPACK_ROW_LENGTH is available or not. */
+	bool unpackSubImageSupported;
+
+	/** Whether GL_ARB_pixel_buffer_object is available or not. */
+	bool pixelBufferObjectSupported;
+
+	/**
+	 * The number of bytes uploaded to textures. Clients may reset it to
+	 * measure the uploads over some time.
+	 */
+	uint32 textureUploadBytes;
+
 #define GL_FUNC_DEF(ret, name, param) ret (GL_CALL_CONV *name)param
 #include "backends/graphics/opengl/opengl-func.h"
 #undef GL_FUNC_DEF
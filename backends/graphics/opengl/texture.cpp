@@ -48,12 +48,17 @@ GLTexture::GLTexture(GLenum glIntFormat, GLenum glFormat, GLenum glType)
     : _glIntFormat(glIntFormat), _glFormat(glFormat), _glType(glType),
       _width(0), _height(0), _logicalWidth(0), _logicalHeight(0),
       _texCoords(), _glFilter(GL_NEAREST),
-      _glTexture(0) {
+      _glTexture(0), _glPixelBuffer(0) {
 	create();
 }
 
 GLTexture::~GLTexture() {
 	GL_CALL_SAFE(glDeleteTextures, (1, &_glTexture));
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2 && !defined(USE_BUILTIN_OPENGL)
+	if (_glPixelBuffer) {
+		GL_CALL_SAFE(glDeleteBuffers, (1, &_glPixelBuffer));
+	}
+#endif
 }
 
 void GLTexture::enableLinearFiltering(bool enable) {
@@ -72,6 +77,13 @@ void GLTexture::enableLinearFiltering(bool enable) {
 void GLTexture::destroy() {
 	GL_CALL(glDeleteTextures(1, &_glTexture));
 	_glTexture = 0;
+
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2 && !defined(USE_BUILTIN_OPENGL)
+	if (_glPixelBuffer) {
+		GL_CALL(glDeleteBuffers(1, &_glPixelBuffer));
+		_glPixelBuffer = 0;
+	}
+#endif
 }
 
 void GLTexture::create() {
@@ -146,26 +158,117 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 	// Set the texture on the active texture unit.
 	bind();
 
+	const uint bytesPerPixel = src.format.bytesPerPixel;
+
 	// Update the actual texture.
-	// Although we have the area of the texture buffer we want to update we
-	// cannot take advantage of the left/right boundries here because it is
-	// not possible to specify a pitch to glTexSubImage2D. To be precise, with
-	// plain OpenGL we could set GL_UNPACK_ROW_LENGTH to achieve this. However,
-	// OpenGL ES 1.0 does not support GL_UNPACK_ROW_LENGTH. Thus, we are left
-	// with the following options:
-	//
-	// 1) (As we do right now) Simply always update the whole texture lines of
-	//    rect changed. This is simplest to implement. In case performance is
-	//    really an issue we can think of switching to another method.
-	//
-	// 2) Copy the dirty rect to a temporary buffer and upload that by using
-	//    glTexSubImage2D. This is what the Android backend does. It is more
-	//    complicated though.
-	//
-	// 3) Use glTexSubImage2D per line changed. This is what the old OpenGL
-	//    graphics manager did but it is much slower! Thus, we do not use it.
-	GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
-	                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+	// With GL_UNPACK_ROW_LENGTH we can tell OpenGL the pitch of the source
+	// data and only upload the area itself. OpenGL ES 1.0 (and 2.0 without
+	// GL_EXT_unpack_subimage) does not support it though. There we simply
+	// update the whole texture lines of the rect changed. Copying the rect
+	// to a temporary buffer first would cost another copy of the data, and
+	// one glTexSubImage2D call per line is much slower.
+	if (g_context.unpackSubImageSupported && area.width() != src.w) {
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, src.pitch / bytesPerPixel));
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, area.left, area.top, area.width(), area.height(),
+		                       _glFormat, _glType, src.getBasePtr(area.left, area.top)));
+		GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+
+		g_context.textureUploadBytes += area.width() * area.height() * bytesPerPixel;
+	} else {
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, area.top, src.w, area.height(),
+		                       _glFormat, _glType, src.getBasePtr(0, area.top)));
+
+		g_context.textureUploadBytes += src.w * area.height() * bytesPerPixel;
+	}
+}
+
+void GLTexture::updateAreas(const Graphics::DirtyRectList &areas, const Graphics::Surface &src) {
+	if (g_context.pixelBufferObjectSupported && updateAreasBuffered(areas, src)) {
+		return;
+	}
+
+	if (g_context.unpackSubImageSupported) {
+		for (Graphics::DirtyRectList::const_iterator i = areas.begin(); i != areas.end(); ++i) {
+			updateArea(*i, src);
+		}
+		return;
+	}
+
+	// Whole lines are uploaded anyway. Merge the areas sharing lines, so
+	// that no line is uploaded twice.
+	Graphics::DirtyRectList lines;
+	for (Graphics::DirtyRectList::const_iterator i = areas.begin(); i != areas.end(); ++i) {
+		lines.add(Common::Rect(0, i->top, src.w, i->bottom));
+	}
+
+	for (Graphics::DirtyRectList::const_iterator i = lines.begin(); i != lines.end(); ++i) {
+		updateArea(*i, src);
+	}
+}
+
+bool GLTexture::updateAreasBuffered(const Graphics::DirtyRectList &areas, const Graphics::Surface &src) {
+#if !USE_FORCED_GLES && !USE_FORCED_GLES2 && !defined(USE_BUILTIN_OPENGL)
+	const uint bytesPerPixel = src.format.bytesPerPixel;
+
+	// The areas are packed one after another into the buffer, without any
+	// padding between rows.
+	uint32 size = 0;
+	for (Graphics::DirtyRectList::const_iterator i = areas.begin(); i != areas.end(); ++i) {
+		size += i->width() * i->height() * bytesPerPixel;
+	}
+	if (!size) {
+		return true;
+	}
+
+	if (!_glPixelBuffer) {
+		GL_CALL(glGenBuffers(1, &_glPixelBuffer));
+	}
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _glPixelBuffer));
+
+	// Give the buffer new storage each time. This way the driver does not
+	// need to wait until the previous upload from it finished.
+	GL_CALL(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+	GLvoid *buffer;
+	GL_ASSIGN(buffer, glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+	if (!buffer) {
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		return false;
+	}
+
+	byte *dst = (byte *)buffer;
+	for (Graphics::DirtyRectList::const_iterator i = areas.begin(); i != areas.end(); ++i) {
+		const uint rowSize = i->width() * bytesPerPixel;
+		for (int y = i->top; y < i->bottom; y++) {
+			memcpy(dst, src.getBasePtr(i->left, y), rowSize);
+			dst += rowSize;
+		}
+	}
+
+	GLboolean intact;
+	GL_ASSIGN(intact, glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+	if (!intact) {
+		// The buffer contents were lost, e.g. on a mode switch
+		GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+		return false;
+	}
+
+	bind();
+
+	// With a bound buffer the data pointer is an offset into it.
+	uint32 offset = 0;
+	for (Graphics::DirtyRectList::const_iterator i = areas.begin(); i != areas.end(); ++i) {
+		GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, i->left, i->top, i->width(), i->height(),
+		                       _glFormat, _glType, (const GLvoid *)(size_t)offset));
+		offset += i->width() * i->height() * bytesPerPixel;
+	}
+
+	GL_CALL(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+	g_context.textureUploadBytes += size;
+	return true;
+#else
+	return false;
+#endif
 }
 
 //
@@ -173,7 +276,7 @@ void GLTexture::updateArea(const Common::Rect &area, const Graphics::Surface &sr
 //
 
 Surface::Surface()
-    : _allDirty(false), _dirtyArea() {
+    : _allDirty(false), _dirtyRects(kDirtyRectOverdraw, kMaxDirtyRects) {
 }
 
 void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcPtr, uint srcPitch) {
@@ -181,14 +284,8 @@ void Surface::copyRectToTexture(uint x, uint y, uint w, uint h, const void *srcP
 	assert(x + w <= dstSurf->w);
 	assert(y + h <= dstSurf->h);
 
-	// *sigh* Common::Rect::extend behaves unexpected whenever one of the two
-	// parameters is an empty rect. Thus, we check whether the current dirty
-	// area is valid. In case it is not we simply use the parameters as new
-	// dirty area. Otherwise, we simply call extend.
-	if (_dirtyArea.isEmpty()) {
-		_dirtyArea = Common::Rect(x, y, x + w, y + h);
-	} else {
-		_dirtyArea.extend(Common::Rect(x, y, x + w, y + h));
+	if (!_allDirty) {
+		_dirtyRects.add(Common::Rect(x, y, x + w, y + h));
 	}
 
 	const byte *src = (const byte *)srcPtr;
@@ -214,12 +311,13 @@ void Surface::fill(uint32 color) {
 	flagDirty();
 }
 
-Common::Rect Surface::getDirtyArea() const {
+const Graphics::DirtyRectList &Surface::getDirtyRects() {
 	if (_allDirty) {
-		return Common::Rect(getWidth(), getHeight());
-	} else {
-		return _dirtyArea;
+		_dirtyRects.clear();
+		_dirtyRects.add(Common::Rect(getWidth(), getHeight()));
 	}
+
+	return _dirtyRects;
 }
 
 //
@@ -279,38 +377,45 @@ void Texture::updateGLTexture() {
 		return;
 	}
 
-	Common::Rect dirtyArea = getDirtyArea();
+	const Graphics::DirtyRectList &dirtyRects = getDirtyRects();
+	Graphics::DirtyRectList uploadRects;
 
-	// In case we use linear filtering we might need to duplicate the last
-	// pixel row/column to avoid glitches with filtering.
-	if (_glTexture.isLinearFilteringEnabled()) {
-		if (dirtyArea.right == _userPixelData.w && _userPixelData.w != _textureData.w) {
-			uint height = dirtyArea.height();
+	for (Graphics::DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		Common::Rect dirtyArea = *i;
 
-			const byte *src = (const byte *)_textureData.getBasePtr(_userPixelData.w - 1, dirtyArea.top);
-			byte *dst = (byte *)_textureData.getBasePtr(_userPixelData.w, dirtyArea.top);
+		// In case we use linear filtering we might need to duplicate the last
+		// pixel row/column to avoid glitches with filtering.
+		if (_glTexture.isLinearFilteringEnabled()) {
+			if (dirtyArea.right == _userPixelData.w && _userPixelData.w != _textureData.w) {
+				uint height = dirtyArea.height();
 
-			while (height-- > 0) {
-				memcpy(dst, src, _textureData.format.bytesPerPixel);
-				dst += _textureData.pitch;
-				src += _textureData.pitch;
-			}
+				const byte *src = (const byte *)_textureData.getBasePtr(_userPixelData.w - 1, dirtyArea.top);
+				byte *dst = (byte *)_textureData.getBasePtr(_userPixelData.w, dirtyArea.top);
 
-			// Extend the dirty area.
-			++dirtyArea.right;
-		}
+				while (height-- > 0) {
+					memcpy(dst, src, _textureData.format.bytesPerPixel);
+					dst += _textureData.pitch;
+					src += _textureData.pitch;
+				}
 
-		if (dirtyArea.bottom == _userPixelData.h && _userPixelData.h != _textureData.h) {
-			const byte *src = (const byte *)_textureData.getBasePtr(dirtyArea.left, _userPixelData.h - 1);
-			byte *dst = (byte *)_textureData.getBasePtr(dirtyArea.left, _userPixelData.h);
-			memcpy(dst, src, dirtyArea.width() * _textureData.format.bytesPerPixel);
+				// Extend the dirty area.
+				++dirtyArea.right;
+			}
+
+			if (dirtyArea.bottom == _userPixelData.h && _userPixelData.h != _textureData.h) {
+				const byte *src = (const byte *)_textureData.getBasePtr(dirtyArea.left, _userPixelData.h - 1);
+				byte *dst = (byte *)_textureData.getBasePtr(dirtyArea.left, _userPixelData.h);
+				memcpy(dst, src, dirtyArea.width() * _textureData.format.bytesPerPixel);
 
-			// Extend the dirty area.
-			++dirtyArea.bottom;
+				// Extend the dirty area.
+				++dirtyArea.bottom;
+			}
 		}
+
+		uploadRects.add(dirtyArea);
 	}
 
-	_glTexture.updateArea(dirtyArea, _textureData);
+	_glTexture.updateAreas(uploadRects, _textureData);
 
 	// We should have handled everything, thus not dirty anymore.
 	clearDirty();
@@ -410,20 +515,25 @@ void TextureCLUT8::updateGLTexture() {
 	// Do the palette look up
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	Common::Rect dirtyArea = getDirtyArea();
-
-	if (outSurf->format.bytesPerPixel == 2) {
-		doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
-	} else if (outSurf->format.bytesPerPixel == 4) {
-		doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
-		                        dirtyArea.width(), dirtyArea.height(),
-		                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
-	} else {
-		warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+	const Graphics::DirtyRectList &dirtyRects = getDirtyRects();
+
+	for (Graphics::DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		const Common::Rect &dirtyArea = *i;
+
+		if (outSurf->format.bytesPerPixel == 2) {
+			doPaletteLookUp<uint16>((uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint16 *)_palette);
+		} else if (outSurf->format.bytesPerPixel == 4) {
+			doPaletteLookUp<uint32>((uint32 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        (const byte *)_clut8Data.getBasePtr(dirtyArea.left, dirtyArea.top),
+			                        dirtyArea.width(), dirtyArea.height(),
+			                        outSurf->pitch, _clut8Data.pitch, (const uint32 *)_palette);
+		} else {
+			warning("TextureCLUT8::updateTexture: Unsupported pixel depth: %d", outSurf->format.bytesPerPixel);
+			break;
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -464,25 +574,29 @@ void TextureRGB555::updateTexture() {
 	// Convert color space.
 	Graphics::Surface *outSurf = Texture::getSurface();
 
-	const Common::Rect dirtyArea = getDirtyArea();
+	const Graphics::DirtyRectList &dirtyRects = getDirtyRects();
 
-	uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
+	for (Graphics::DirtyRectList::const_iterator i = dirtyRects.begin(); i != dirtyRects.end(); ++i) {
+		const Common::Rect &dirtyArea = *i;
 
-	const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
-	const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
+		uint16 *dst = (uint16 *)outSurf->getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint dstAdd = outSurf->pitch - 2 * dirtyArea.width();
 
-	for (int height = dirtyArea.height(); height > 0; --height) {
-		for (int width = dirtyArea.width(); width > 0; --width) {
-			const uint16 color = *src++;
+		const uint16 *src = (const uint16 *)_rgb555Data.getBasePtr(dirtyArea.left, dirtyArea.top);
+		const uint srcAdd = _rgb555Data.pitch - 2 * dirtyArea.width();
 
-			*dst++ =   ((color & 0x7C00) << 1)                             // R
-			         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
-			         | (color & 0x001F);                                   // B
-		}
+		for (int height = dirtyArea.height(); height > 0; --height) {
+			for (int width = dirtyArea.width(); width > 0; --width) {
+				const uint16 color = *src++;
 
-		src = (const uint16 *)((const byte *)src + srcAdd);
-		dst = (uint16 *)((byte *)dst + dstAdd);
+				*dst++ =   ((color & 0x7C00) << 1)                             // R
+				         | (((color & 0x03E0) << 1) | ((color & 0x0200) >> 4)) // G
+				         | (color & 0x001F);                                   // B
+			}
+
+			src = (const uint16 *)((const byte *)src + srcAdd);
+			dst = (uint16 *)((byte *)dst + dstAdd);
+		}
 	}
 
 	// Do generic handling of updating the texture.
@@ -609,7 +723,7 @@ void TextureCLUT8GPU::updateGLTexture() {
 
 	// Update CLUT8 texture if necessary.
 	if (Surface::isDirty()) {
-		_clut8Texture.updateArea(getDirtyArea(), _clut8Data);
+		_clut8Texture.updateAreas(getDirtyRects(), _clut8Data);
 		clearDirty();
 	}
 
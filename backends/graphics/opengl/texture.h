@@ -25,6 +25,7 @@
 
 #include "backends/graphics/opengl/opengl-sys.h"
 
+#include "graphics/dirty_rects.h"
 #include "graphics/pixelformat.h"
 #include "graphics/surface.h"
 
@@ -99,6 +100,20 @@ public:
 	 */
 	void updateArea(const Common::Rect &area, const Graphics::Surface &src);
 
+	/**
+	 * Copy the image data of several areas to the texture.
+	 *
+	 * When the context cannot upload parts of rows, whole rows are uploaded
+	 * and areas sharing rows are uploaded together. With pixel buffer
+	 * objects, the areas are copied into a buffer which OpenGL transfers to
+	 * the texture on its own, so the upload does not stall the caller.
+	 *
+	 * @param areas    The areas to update.
+	 * @param src      Surface for the whole texture containing the pixel data
+	 *                 to upload.
+	 */
+	void updateAreas(const Graphics::DirtyRectList &areas, const Graphics::Surface &src);
+
 	/**
 	 * Query the GL texture's width.
 	 */
@@ -132,6 +147,14 @@ public:
 	 */
 	GLuint getGLTexture() const { return _glTexture; }
 private:
+	/**
+	 * Upload the areas through the pixel buffer object.
+	 *
+	 * @return false if the buffer could not be mapped, and nothing was
+	 *         uploaded.
+	 */
+	bool updateAreasBuffered(const Graphics::DirtyRectList &areas, const Graphics::Surface &src);
+
 	const GLenum _glIntFormat;
 	const GLenum _glFormat;
 	const GLenum _glType;
@@ -143,6 +166,9 @@ private:
 	GLint _glFilter;
 
 	GLuint _glTexture;
+
+	/** The pixel buffer object for uploads, created on first use. */
+	GLuint _glPixelBuffer;
 };
 
 /**
@@ -201,7 +227,7 @@ public:
 	void fill(uint32 color);
 
 	void flagDirty() { _allDirty = true; }
-	virtual bool isDirty() const { return _allDirty || !_dirtyArea.isEmpty(); }
+	virtual bool isDirty() const { return _allDirty || !_dirtyRects.empty(); }
 
 	virtual uint getWidth() const = 0;
 	virtual uint getHeight() const = 0;
@@ -239,12 +265,25 @@ public:
 	 */
 	virtual const GLTexture &getGLTexture() const = 0;
 protected:
-	void clearDirty() { _allDirty = false; _dirtyArea = Common::Rect(); }
+	void clearDirty() { _allDirty = false; _dirtyRects.clear(); }
 
-	Common::Rect getDirtyArea() const;
+	/**
+	 * The areas changed since the last update. When the whole surface is
+	 * flagged dirty this is a single rect covering all of it.
+	 */
+	const Graphics::DirtyRectList &getDirtyRects();
 private:
+	enum {
+		/**
+		 * Each upload has a cost of its own, so nearby rects are merged when
+		 * that uploads no more than this many pixels needlessly.
+		 */
+		kDirtyRectOverdraw = 32 * 32,
+		kMaxDirtyRects = 16
+	};
+
 	bool _allDirty;
-	Common::Rect _dirtyArea;
+	Graphics::DirtyRectList _dirtyRects;
 };
 
 /**
@@ -25,6 +25,7 @@
 #if defined(SDL_BACKEND)
 
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "backends/platform/sdl/sdl.h"
 #include "common/config-manager.h"
@@ -85,6 +86,9 @@ static const int s_gfxModeSwitchTable[][4] = {
 		{ GFX_NORMAL, GFX_DOTMATRIX, -1, -1 }
 	};
 
+// Scaled areas smaller than this are not worth handing to the scaler threads
+static const int kMinBandedScaleArea = 320 * 64;
+
 #ifdef USE_SCALERS
 static int cursorStretch200To240(uint8 *buf, uint32 pitch, int width, int height, int srcX, int srcY, int origSrcY);
 #endif
@@ -138,7 +142,8 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_overlayVisible(false),
 	_overlayscreen(0), _tmpscreen2(0),
-	_scalerProc(0), _screenChangeCount(0),
+	_scalerProc(0), _scalerPool(0), _scalerOverlap(false), _scalePending(false),
+	_screenChangeCount(0), _dirtyRects(0, NUM_DIRTY_RECT - 1), _numDirtyRects(0),
 	_mouseVisible(false), _mouseNeedsRedraw(false), _mouseData(0), _mouseSurface(0),
 	_mouseOrigSurface(0), _cursorDontScale(false), _cursorPaletteDisabled(true),
 	_currentShakePos(0), _newShakePos(0),
@@ -189,10 +194,34 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #else
 	_videoMode.fullscreen = true;
 #endif
+
+	// A negative number of scaler threads means to use a few of the other
+	// cores, if SDL can tell us how many there are
+	int scalerThreads = ConfMan.getInt("scaler_threads");
+	if (scalerThreads < 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		scalerThreads = MIN(SDL_GetCPUCount() - 1, 3);
+#else
+		scalerThreads = 0;
+#endif
+	}
+	if (scalerThreads > 0) {
+		_scalerPool = new SdlScalerPool(scalerThreads);
+		_scalerOverlap = ConfMan.getBool("scaler_overlap");
+	}
 }
 
 SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	unloadGFXMode();
+	delete _scalerPool;
+
+	const Graphics::DirtyRectList::Stats &stats = _dirtyRects.getStats();
+	if (stats.frames && stats.addedPixels) {
+		debug(2, "Dirty rects: %u frames, %.1f rects and %.0f pixels redrawn per frame, %.2f times the area added",
+		      stats.frames, (double)stats.rects / stats.frames, (double)stats.redrawnPixels / stats.frames,
+		      (double)stats.redrawnPixels / stats.addedPixels);
+	}
+
 	if (_mouseSurface)
 		SDL_FreeSurface(_mouseSurface);
 	_mouseSurface = 0;
@@ -288,6 +317,8 @@ void SurfaceSdlGraphicsManager::resetGraphicsScale() {
 void SurfaceSdlGraphicsManager::beginGFXTransaction() {
 	assert(_transactionMode == kTransactionNone);
 
+	finishPendingScale();
+
 	_transactionMode = kTransactionActive;
 
 	_transactionDetails.sizeChanged = false;
@@ -912,6 +943,8 @@ bool SurfaceSdlGraphicsManager::loadGFXMode() {
 }
 
 void SurfaceSdlGraphicsManager::unloadGFXMode() {
+	finishPendingScale();
+
 	if (_screen) {
 		SDL_FreeSurface(_screen);
 		_screen = NULL;
@@ -962,6 +995,8 @@ bool SurfaceSdlGraphicsManager::hotswapGFXMode() {
 	if (!_screen)
 		return false;
 
+	finishPendingScale();
+
 	// Keep around the old _screen & _overlayscreen so we can restore the screen data
 	// after the mode switch.
 	SDL_Surface *old_screen = _screen;
@@ -1024,6 +1059,9 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	ScalerProc *scalerProc;
 	int scale1;
 
+	// Show the previous frame first, if it is still being scaled
+	finishPendingScale();
+
 	// definitions not available for non-DEBUG here. (needed this to compile in SYMBIAN32 & linux?)
 #if defined(DEBUG) && !defined(WIN32) && !defined(_WIN32_WCE)
 	assert(_hwscreen != NULL);
@@ -1099,6 +1137,8 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	if (_mouseNeedsRedraw)
 		undrawMouse();
 
+	collectDirtyRects();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
@@ -1130,6 +1170,16 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwscreen->pitch;
 
+		// Large rects are scaled in bands by the worker threads. The stretch
+		// for aspect ratio correction needs the whole rect, so each rect is
+		// finished before going on. Only a frame which consists of a single
+		// rect may be finished later, while the engine is already working on
+		// the next frame.
+		SdlScalerPool *pool = _scalerPool;
+		const bool overlap = pool && _scalerOverlap && _numDirtyRects == 1 &&
+		                     !_overlayVisible && !_videoMode.aspectRatioCorrection;
+		bool deferred = false;
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			register int dst_y = r->y + _currentShakePos;
 			register int dst_h = 0;
@@ -1152,8 +1202,20 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 					dst_y = real2Aspect(dst_y);
 
 				assert(scalerProc != NULL);
-				scalerProc((byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch, srcPitch,
-					(byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch, dstPitch, r->w, dst_h);
+				const byte *srcPtr = (byte *)srcSurf->pixels + (r->x * 2 + 2) + (r->y + 1) * srcPitch;
+				byte *dstPtr = (byte *)_hwscreen->pixels + rx1 * 2 + dst_y * dstPitch;
+
+				if (pool && r->w * dst_h >= kMinBandedScaleArea) {
+					pool->addBands(scalerProc, srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h, scale1);
+					if (overlap) {
+						pool->start();
+						deferred = true;
+					} else {
+						pool->finish();
+					}
+				} else {
+					scalerProc(srcPtr, srcPitch, dstPtr, dstPitch, r->w, dst_h);
+				}
 			}
 
 			r->x = rx1;
@@ -1166,111 +1228,163 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				r->h = stretch200To240((uint8 *) _hwscreen->pixels, dstPitch, r->w, r->h, r->x, r->y, orig_dst_y * scale1);
 #endif
 		}
-		SDL_UnlockSurface(srcSurf);
-		SDL_UnlockSurface(_hwscreen);
-
-		// Readjust the dirty rect list in case we are doing a full update.
-		// This is necessary if shaking is active.
-		if (_forceFull) {
-			_dirtyRectList[0].y = 0;
-			_dirtyRectList[0].h = effectiveScreenHeight();
+
+		if (deferred) {
+			// Keep the surfaces locked, and remember what is needed to
+			// present the frame once the workers are done with it
+			_scalePending = true;
+			_pendingForceFull = _forceFull;
+			_pendingRect = _dirtyRectList[0];
+			_pendingSrcSurf = srcSurf;
+			_pendingMouseX = _mouseCurState.x;
+			_pendingMouseY = _mouseCurState.y;
+		} else {
+			SDL_UnlockSurface(srcSurf);
+			SDL_UnlockSurface(_hwscreen);
+
+			presentScreen();
 		}
+	}
 
-		drawMouse();
+	_numDirtyRects = 0;
+	_forceFull = false;
+	_mouseNeedsRedraw = false;
+}
+
+void SurfaceSdlGraphicsManager::presentScreen() {
+	// Readjust the dirty rect list in case we are doing a full update.
+	// This is necessary if shaking is active.
+	if (_forceFull) {
+		_dirtyRectList[0].y = 0;
+		_dirtyRectList[0].h = effectiveScreenHeight();
+	}
+
+	drawMouse();
 
 #ifdef USE_OSD
-		if (_osdAlpha != SDL_ALPHA_TRANSPARENT) {
-			SDL_BlitSurface(_osdSurface, 0, _hwscreen, 0);
-		}
+	if (_osdAlpha != SDL_ALPHA_TRANSPARENT) {
+		SDL_BlitSurface(_osdSurface, 0, _hwscreen, 0);
+	}
 #endif
 
 #ifdef USE_SDL_DEBUG_FOCUSRECT
-		// We draw the focus rectangle on top of everything, to assure it's easily visible.
-		// Of course when the overlay is visible we do not show it, since it is only for game
-		// specific focus.
-		if (_enableFocusRect && !_overlayVisible) {
-			int y = _focusRect.top + _currentShakePos;
-			int h = 0;
-			int x = _focusRect.left * scale1;
-			int w = _focusRect.width() * scale1;
-
-			if (y < height) {
-				h = _focusRect.height();
-				if (h > height - y)
-					h = height - y;
-
-				y *= scale1;
+	// We draw the focus rectangle on top of everything, to assure it's easily visible.
+	// Of course when the overlay is visible we do not show it, since it is only for game
+	// specific focus.
+	if (_enableFocusRect && !_overlayVisible) {
+		const int height = _videoMode.screenHeight;
+		const int scale1 = _videoMode.scaleFactor;
+		int y = _focusRect.top + _currentShakePos;
+		int h = 0;
+		int x = _focusRect.left * scale1;
+		int w = _focusRect.width() * scale1;
+
+		if (y < height) {
+			h = _focusRect.height();
+			if (h > height - y)
+				h = height - y;
+
+			y *= scale1;
+
+			if (_videoMode.aspectRatioCorrection && !_overlayVisible)
+				y = real2Aspect(y);
+
+			if (h > 0 && w > 0) {
+				SDL_LockSurface(_hwscreen);
+
+				// Use white as color for now.
+				Uint32 rectColor = SDL_MapRGB(_hwscreen->format, 0xFF, 0xFF, 0xFF);
+
+				// First draw the top and bottom lines
+				// then draw the left and right lines
+				if (_hwscreen->format->BytesPerPixel == 2) {
+					uint16 *top = (uint16 *)((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 2);
+					uint16 *bottom = (uint16 *)((byte *)_hwscreen->pixels + (y + h) * _hwscreen->pitch + x * 2);
+					byte *left = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 2);
+					byte *right = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + (x + w - 1) * 2);
+
+					while (w--) {
+						*top++ = rectColor;
+						*bottom++ = rectColor;
+					}
 
-				if (_videoMode.aspectRatioCorrection && !_overlayVisible)
-					y = real2Aspect(y);
-
-				if (h > 0 && w > 0) {
-					SDL_LockSurface(_hwscreen);
-
-					// Use white as color for now.
-					Uint32 rectColor = SDL_MapRGB(_hwscreen->format, 0xFF, 0xFF, 0xFF);
-
-					// First draw the top and bottom lines
-					// then draw the left and right lines
-					if (_hwscreen->format->BytesPerPixel == 2) {
-						uint16 *top = (uint16 *)((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 2);
-						uint16 *bottom = (uint16 *)((byte *)_hwscreen->pixels + (y + h) * _hwscreen->pitch + x * 2);
-						byte *left = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 2);
-						byte *right = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + (x + w - 1) * 2);
-
-						while (w--) {
-							*top++ = rectColor;
-							*bottom++ = rectColor;
-						}
-
-						while (h--) {
-							*(uint16 *)left = rectColor;
-							*(uint16 *)right = rectColor;
-
-							left += _hwscreen->pitch;
-							right += _hwscreen->pitch;
-						}
-					} else if (_hwscreen->format->BytesPerPixel == 4) {
-						uint32 *top = (uint32 *)((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 4);
-						uint32 *bottom = (uint32 *)((byte *)_hwscreen->pixels + (y + h) * _hwscreen->pitch + x * 4);
-						byte *left = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 4);
-						byte *right = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + (x + w - 1) * 4);
-
-						while (w--) {
-							*top++ = rectColor;
-							*bottom++ = rectColor;
-						}
-
-						while (h--) {
-							*(uint32 *)left = rectColor;
-							*(uint32 *)right = rectColor;
-
-							left += _hwscreen->pitch;
-							right += _hwscreen->pitch;
-						}
+					while (h--) {
+						*(uint16 *)left = rectColor;
+						*(uint16 *)right = rectColor;
+
+						left += _hwscreen->pitch;
+						right += _hwscreen->pitch;
+					}
+				} else if (_hwscreen->format->BytesPerPixel == 4) {
+					uint32 *top = (uint32 *)((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 4);
+					uint32 *bottom = (uint32 *)((byte *)_hwscreen->pixels + (y + h) * _hwscreen->pitch + x * 4);
+					byte *left = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + x * 4);
+					byte *right = ((byte *)_hwscreen->pixels + y * _hwscreen->pitch + (x + w - 1) * 4);
+
+					while (w--) {
+						*top++ = rectColor;
+						*bottom++ = rectColor;
 					}
 
-					SDL_UnlockSurface(_hwscreen);
+					while (h--) {
+						*(uint32 *)left = rectColor;
+						*(uint32 *)right = rectColor;
+
+						left += _hwscreen->pitch;
+						right += _hwscreen->pitch;
+					}
 				}
+
+				SDL_UnlockSurface(_hwscreen);
 			}
 		}
+	}
 #endif
 
-		// Finally, blit all our changes to the screen
-		if (!_displayDisabled) {
-			SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
-		}
+	// Finally, blit all our changes to the screen
+	if (!_displayDisabled) {
+		SDL_UpdateRects(_hwscreen, _numDirtyRects, _dirtyRectList);
 	}
+}
+
+void SurfaceSdlGraphicsManager::finishPendingScale() {
+	if (!_scalePending)
+		return;
+
+	_scalePending = false;
+	_scalerPool->finish();
+
+	SDL_UnlockSurface(_pendingSrcSurf);
+	SDL_UnlockSurface(_hwscreen);
+
+	// The engine may already have requested a full redraw and moved the
+	// mouse for the next frame. Present the pending frame with its own state
+	// instead. Any dirty rects of the next frame are still in _dirtyRects.
+	const bool nextForceFull = _forceFull;
+	const int16 nextMouseX = _mouseCurState.x;
+	const int16 nextMouseY = _mouseCurState.y;
+
+	_dirtyRectList[0] = _pendingRect;
+	_numDirtyRects = 1;
+	_forceFull = _pendingForceFull;
+	_mouseCurState.x = _pendingMouseX;
+	_mouseCurState.y = _pendingMouseY;
+
+	presentScreen();
 
 	_numDirtyRects = 0;
-	_forceFull = false;
-	_mouseNeedsRedraw = false;
+	_forceFull = nextForceFull;
+	_mouseCurState.x = nextMouseX;
+	_mouseCurState.y = nextMouseY;
+	if (nextMouseX != _pendingMouseX || nextMouseY != _pendingMouseY)
+		_mouseNeedsRedraw = true;
 }
 
 bool SurfaceSdlGraphicsManager::saveScreenshot(const char *filename) {
 	assert(_hwscreen != NULL);
 
 	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
+	finishPendingScale();
 	return SDL_SaveBMP(_hwscreen, filename) == 0;
 }
 
@@ -1403,11 +1517,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 	if (_forceFull)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceFull = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!_overlayVisible && !realCoordinates) {
@@ -1457,14 +1566,46 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool re
 		return;
 	}
 
-	if (w > 0 && h > 0) {
+	if (w <= 0 || h <= 0)
+		return;
+
+	if (!realCoordinates) {
+		_dirtyRects.add(Common::Rect(x, y, x + w, y + h));
+		return;
+	}
+
+	// Rects in real coordinates are added while the screen is presented,
+	// after the other rects have been scaled, so they go to the list directly
+	if (_numDirtyRects == NUM_DIRTY_RECT) {
+		_forceFull = true;
+		return;
+	}
+
+	SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+
+	r->x = x;
+	r->y = y;
+	r->w = w;
+	r->h = h;
+}
+
+void SurfaceSdlGraphicsManager::collectDirtyRects() {
+	if (_forceFull) {
+		_dirtyRects.clear();
+		return;
+	}
+
+	Graphics::DirtyRectList::const_iterator i;
+	for (i = _dirtyRects.begin(); i != _dirtyRects.end() && _numDirtyRects < NUM_DIRTY_RECT; ++i) {
 		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
 
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+		r->x = i->left;
+		r->y = i->top;
+		r->w = i->width();
+		r->h = i->height();
 	}
+
+	_dirtyRects.nextFrame();
 }
 
 int16 SurfaceSdlGraphicsManager::getHeight() {
@@ -1600,6 +1741,8 @@ void SurfaceSdlGraphicsManager::showOverlay() {
 	if (_overlayVisible)
 		return;
 
+	finishPendingScale();
+
 	_overlayVisible = true;
 
 	// Since resolution could change, put mouse to adjusted position
@@ -1621,6 +1764,8 @@ void SurfaceSdlGraphicsManager::hideOverlay() {
 	if (!_overlayVisible)
 		return;
 
+	finishPendingScale();
+
 	int x, y;
 
 	_overlayVisible = false;
@@ -1647,6 +1792,8 @@ void SurfaceSdlGraphicsManager::clearOverlay() {
 	if (!_overlayVisible)
 		return;
 
+	finishPendingScale();
+
 	// Clear the overlay by making the game screen "look through" everywhere.
 	SDL_Rect src, dst;
 	src.x = src.y = 0;
@@ -1750,6 +1897,8 @@ bool SurfaceSdlGraphicsManager::showMouse(bool visible) {
 	if (_mouseVisible == visible)
 		return visible;
 
+	finishPendingScale();
+
 	bool last = _mouseVisible;
 	_mouseVisible = visible;
 	_mouseNeedsRedraw = true;
@@ -1869,6 +2018,8 @@ void SurfaceSdlGraphicsManager::blitCursor() {
 #endif
 	int w, h, i, j;
 
+	finishPendingScale();
+
 	if (!_mouseOrigSurface || !_mouseData)
 		return;
 
@@ -2123,6 +2274,8 @@ void SurfaceSdlGraphicsManager::displayMessageOnOSD(const char *msg) {
 
 	Common::StackLock lock(_graphicsMutex);	// Lock the mutex until this function ends
 
+	finishPendingScale();
+
 	uint i;
 
 	// Lock the OSD surface for drawing
@@ -2404,6 +2557,8 @@ void SurfaceSdlGraphicsManager::notifyMousePos(Common::Point mouse) {
 
 #if SDL_VERSION_ATLEAST(2, 0, 0)
 void SurfaceSdlGraphicsManager::deinitializeRenderer() {
+	finishPendingScale();
+
 	SDL_DestroyTexture(_screenTexture);
 	_screenTexture = nullptr;
 
@@ -2414,6 +2569,8 @@ void SurfaceSdlGraphicsManager::deinitializeRenderer() {
 }
 
 void SurfaceSdlGraphicsManager::setWindowResolution(int width, int height) {
+	finishPendingScale();
+
 	_windowWidth  = width;
 	_windowHeight = height;
 
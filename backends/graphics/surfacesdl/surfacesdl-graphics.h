@@ -25,6 +25,7 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "graphics/dirty_rects.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "common/events.h"
@@ -69,6 +70,8 @@ enum {
 };
 
 
+class SdlScalerPool;
+
 class AspectRatio {
 	int _kw, _kh;
 public:
@@ -275,6 +278,29 @@ protected:
 	int _scalerType;
 	int _transactionMode;
 
+	/**
+	 * Worker threads which scale large dirty rects in bands, or 0. Set up
+	 * through the "scaler_threads" config option.
+	 */
+	SdlScalerPool *_scalerPool;
+
+	/**
+	 * Whether a frame which is one large rect may still be scaled while the
+	 * engine prepares the next one. Set through the "scaler_overlap" config
+	 * option.
+	 */
+	bool _scalerOverlap;
+
+	/**
+	 * State of a frame which is still being scaled, and is presented by
+	 * finishPendingScale().
+	 */
+	bool _scalePending;
+	bool _pendingForceFull;
+	SDL_Rect _pendingRect;
+	SDL_Surface *_pendingSrcSurf;
+	int16 _pendingMouseX, _pendingMouseY;
+
 	// Indicates whether it is needed to free _hwsurface in destructor
 	bool _displayDisabled;
 
@@ -288,7 +314,10 @@ protected:
 		MAX_SCALING = 3
 	};
 
-	// Dirty rect management
+	// Dirty rect management. Rects in game or overlay coordinates are
+	// merged in _dirtyRects, and moved to _dirtyRectList by
+	// collectDirtyRects() at the start of each screen update.
+	Graphics::DirtyRectList _dirtyRects;
 	SDL_Rect _dirtyRectList[NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
@@ -359,6 +388,7 @@ protected:
 #endif
 
 	virtual void addDirtyRect(int x, int y, int w, int h, bool realCoordinates = false);
+	void collectDirtyRects();
 
 	virtual void drawMouse();
 	virtual void undrawMouse();
@@ -366,6 +396,19 @@ protected:
 
 	virtual void internUpdateScreen();
 
+	/**
+	 * Draw the mouse, OSD and focus rect on top of the scaled dirty rects,
+	 * and show them.
+	 */
+	void presentScreen();
+
+	/**
+	 * Wait for the frame still being scaled, if any, and present it. This
+	 * has to be called before anything else accesses the scaled surfaces,
+	 * or changes what presentScreen() draws.
+	 */
+	void finishPendingScale();
+
 	virtual bool loadGFXMode();
 	virtual void unloadGFXMode();
 	virtual bool hotswapGFXMode();
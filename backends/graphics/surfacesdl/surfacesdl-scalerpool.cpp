@@ -0,0 +1,147 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "backends/graphics/surfacesdl/surfacesdl-scalerpool.h"
+
+#include "common/textconsole.h"
+#include "common/util.h"
+
+SdlScalerPool::SdlScalerPool(int numThreads)
+	: _startedJobs(0), _nextJob(0), _unfinishedJobs(0), _running(false), _quit(false) {
+
+	_mutex = SDL_CreateMutex();
+	_workCond = SDL_CreateCond();
+	_doneCond = SDL_CreateCond();
+
+	for (int i = 0; i < numThreads; i++) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, "ScummVM Scaler", this);
+#else
+		SDL_Thread *thread = SDL_CreateThread(workerThreadEntry, this);
+#endif
+		if (!thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			break;
+		}
+		_threads.push_back(thread);
+	}
+}
+
+SdlScalerPool::~SdlScalerPool() {
+	if (_running)
+		finish();
+
+	// Signal the workers to end, and wait for them to actually finish
+	SDL_LockMutex(_mutex);
+	_quit = true;
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+
+	for (uint i = 0; i < _threads.size(); i++)
+		SDL_WaitThread(_threads[i], NULL);
+
+	SDL_DestroyCond(_doneCond);
+	SDL_DestroyCond(_workCond);
+	SDL_DestroyMutex(_mutex);
+}
+
+void SdlScalerPool::addBands(ScalerProc *proc, const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, int height, int scale) {
+	assert(!_running);
+
+	// One band for each worker and one for the thread calling finish().
+	// Keep the bands an even number of rows high, since DotMatrix picks its
+	// pattern by the parity of the row within the call.
+	int bandHeight = (height + _threads.size()) / (_threads.size() + 1);
+	bandHeight = MAX<int>((bandHeight + 1) & ~1, kMinBandHeight);
+
+	SDL_LockMutex(_mutex);
+	for (int y = 0; y < height; y += bandHeight) {
+		Job job;
+		job.proc = proc;
+		job.src = src + y * srcPitch;
+		job.srcPitch = srcPitch;
+		job.dst = dst + y * scale * dstPitch;
+		job.dstPitch = dstPitch;
+		job.width = width;
+		job.height = MIN(bandHeight, height - y);
+		_jobs.push_back(job);
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlScalerPool::start() {
+	assert(!_running);
+	_running = true;
+
+	SDL_LockMutex(_mutex);
+	_startedJobs = _jobs.size();
+	_unfinishedJobs = _jobs.size();
+	SDL_CondBroadcast(_workCond);
+	SDL_UnlockMutex(_mutex);
+}
+
+void SdlScalerPool::finish() {
+	if (!_running)
+		start();
+
+	SDL_LockMutex(_mutex);
+	while (_nextJob < _startedJobs)
+		runJob();
+	while (_unfinishedJobs > 0)
+		SDL_CondWait(_doneCond, _mutex);
+
+	_jobs.clear();
+	_startedJobs = 0;
+	_nextJob = 0;
+	SDL_UnlockMutex(_mutex);
+
+	_running = false;
+}
+
+void SdlScalerPool::runJob() {
+	const Job job = _jobs[_nextJob++];
+
+	SDL_UnlockMutex(_mutex);
+	job.proc(job.src, job.srcPitch, job.dst, job.dstPitch, job.width, job.height);
+	SDL_LockMutex(_mutex);
+
+	if (--_unfinishedJobs == 0)
+		SDL_CondBroadcast(_doneCond);
+}
+
+void SdlScalerPool::workerThread() {
+	SDL_LockMutex(_mutex);
+	while (!_quit) {
+		if (_nextJob < _startedJobs)
+			runJob();
+		else
+			SDL_CondWait(_workCond, _mutex);
+	}
+	SDL_UnlockMutex(_mutex);
+}
+
+int SDLCALL SdlScalerPool::workerThreadEntry(void *arg) {
+	SdlScalerPool *pool = (SdlScalerPool *)arg;
+	assert(pool);
+	pool->workerThread();
+	return 0;
+}
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALERPOOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+
+#include "common/array.h"
+#include "graphics/scaler.h"
+
+/**
+ * A small pool of worker threads which run scalers on horizontal bands of
+ * a dirty rect in parallel.
+ *
+ * The scalers read up to two pixels around each source pixel, but only
+ * from the source surface, which nobody writes to while scaling. Every
+ * band writes to its own rows of the destination. So splitting a call at
+ * any source row gives the same result as scaling it at once.
+ *
+ * Jobs are queued with addBands() while the pool is idle. start() hands
+ * them to the workers, finish() runs the ones not yet taken on the calling
+ * thread and waits for the rest. The calling thread may do other work in
+ * between.
+ */
+class SdlScalerPool {
+public:
+	/**
+	 * Create a pool with the given number of worker threads. With no
+	 * workers, all jobs run on the thread calling finish().
+	 */
+	explicit SdlScalerPool(int numThreads);
+	~SdlScalerPool();
+
+	int getThreadCount() const { return _threads.size(); }
+
+	/**
+	 * Queue a scaler call, split into bands of whole source rows.
+	 *
+	 * @param scale	the factor between source and destination rows
+	 */
+	void addBands(ScalerProc *proc, const uint8 *src, uint32 srcPitch, uint8 *dst, uint32 dstPitch, int width, int height, int scale);
+
+	/** Let the workers start on the queued jobs. */
+	void start();
+
+	/** Help with the queued jobs and wait until all of them are done. */
+	void finish();
+
+	/** Whether start() was called without a matching finish(). */
+	bool isRunning() const { return _running; }
+
+private:
+	struct Job {
+		ScalerProc *proc;
+		const uint8 *src;
+		uint32 srcPitch;
+		uint8 *dst;
+		uint32 dstPitch;
+		int width, height;
+	};
+
+	enum {
+		/** Bands are never smaller than this many source rows. */
+		kMinBandHeight = 16
+	};
+
+	/** Run the next started job, the mutex has to be locked. */
+	void runJob();
+
+	void workerThread();
+	static int SDLCALL workerThreadEntry(void *arg);
+
+	Common::Array<Job> _jobs;
+	uint _startedJobs;
+	uint _nextJob;
+	uint _unfinishedJobs;
+	bool _running;
+	bool _quit;
+
+	SDL_mutex *_mutex;
+	SDL_cond *_workCond;
+	SDL_cond *_doneCond;
+	Common::Array<SDL_Thread *> _threads;
+};
+
+#endif
@@ -531,6 +531,8 @@ void WINCESdlGraphicsManager::internUpdateScreen() {
 		update_scalers();
 	}
 
+	collectDirtyRects();
+
 	// Force a full redraw if requested
 	if (_forceFull) {
 		_numDirtyRects = 1;
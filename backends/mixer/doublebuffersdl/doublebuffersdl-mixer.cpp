@@ -45,7 +45,7 @@ void DoubleBufferSDLMixerManager::startAudio() {
 
 	// Create two sound buffers
 	_activeSoundBuf = 0;
-	uint bufSize = _obtained.samples * 4;
+	uint bufSize = _obtained.samples * (isFloatOutput() ? 8 : 4);
 	_soundBufSize = bufSize;
 	_soundBuffers[0] = (byte *)calloc(1, bufSize);
 	_soundBuffers[1] = (byte *)calloc(1, bufSize);
@@ -75,7 +75,10 @@ void DoubleBufferSDLMixerManager::mixerProducerThread() {
 
 		// Generate samples and put them into the next buffer
 		nextSoundBuffer = _activeSoundBuf ^ 1;
-		_mixer->mixCallback(_soundBuffers[nextSoundBuffer], _soundBufSize);
+		if (isFloatOutput())
+			_mixer->mixCallbackFloat((float *)_soundBuffers[nextSoundBuffer], _soundBufSize);
+		else
+			_mixer->mixCallback(_soundBuffers[nextSoundBuffer], _soundBufSize);
 
 		// Swap buffers
 		_activeSoundBuf = nextSoundBuffer;
@@ -81,14 +81,15 @@ void SdlMixerManager::init() {
 		warning("Could not open audio device: %s", SDL_GetError());
 
 		// The mixer is not marked as ready
-		_mixer = new Audio::MixerImpl(g_system, desired.freq);
+		_mixer = new Audio::MixerImpl(g_system, desired.freq, getRateConverterQuality());
 		return;
 	}
 
 	// The obtained sample format is not supported by the mixer, call
 	// SDL_OpenAudio again with NULL as the second argument to force
-	// SDL to do resampling to the desired audio spec.
-	if (_obtained.format != desired.format) {
+	// SDL to do resampling to the desired audio spec. Devices which take
+	// float samples get them straight from the mixer.
+	if (_obtained.format != desired.format && !isFloatOutput()) {
 		debug(1, "SDL mixer sound format: %d differs from desired: %d", _obtained.format, desired.format);
 		SDL_CloseAudio();
 
@@ -96,7 +97,7 @@ void SdlMixerManager::init() {
 			warning("Could not open audio device: %s", SDL_GetError());
 
 			// The mixer is not marked as ready
-			_mixer = new Audio::MixerImpl(g_system, desired.freq);
+			_mixer = new Audio::MixerImpl(g_system, desired.freq, getRateConverterQuality());
 			return;
 		}
 
@@ -118,13 +119,17 @@ void SdlMixerManager::init() {
 		error("SDL mixer output requires stereo output device");
 #endif
 
-	_mixer = new Audio::MixerImpl(g_system, _obtained.freq);
+	_mixer = new Audio::MixerImpl(g_system, _obtained.freq, getRateConverterQuality());
 	assert(_mixer);
 	_mixer->setReady(true);
 
 	startAudio();
 }
 
+Audio::RateConverterQuality SdlMixerManager::getRateConverterQuality() const {
+	return ConfMan.get("audio_resampler") == "sinc" ? Audio::kRateConverterSinc : Audio::kRateConverterLinear;
+}
+
 SDL_AudioSpec SdlMixerManager::getAudioSpec(uint32 outputRate) {
 	SDL_AudioSpec desired;
 
@@ -159,9 +164,20 @@ void SdlMixerManager::startAudio() {
 	SDL_PauseAudio(0);
 }
 
+bool SdlMixerManager::isFloatOutput() const {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	return _obtained.format == AUDIO_F32SYS;
+#else
+	return false;
+#endif
+}
+
 void SdlMixerManager::callbackHandler(byte *samples, int len) {
 	assert(_mixer);
-	_mixer->mixCallback(samples, len);
+	if (isFloatOutput())
+		_mixer->mixCallbackFloat((float *)samples, len);
+	else
+		_mixer->mixCallback(samples, len);
 }
 
 void SdlMixerManager::sdlCallback(void *this_, byte *samples, int len) {
@@ -77,11 +77,22 @@ protected:
 	 */
 	virtual SDL_AudioSpec getAudioSpec(uint32 rate);
 
+	/**
+	 * Returns the rate converter quality picked with the
+	 * "audio_resampler" setting
+	 */
+	Audio::RateConverterQuality getRateConverterQuality() const;
+
 	/**
 	 * Starts SDL audio
 	 */
 	virtual void startAudio();
 
+	/**
+	 * Whether the obtained audio specification uses float samples
+	 */
+	bool isFloatOutput() const;
+
 	/**
 	 * Handles the audio callback
 	 */
@@ -76,7 +76,7 @@ void WINCESdlMixerManager::init() {
 
 	// Create the mixer instance
 	if (_mixer == 0)
-		_mixer = new Audio::MixerImpl(g_system, sampleRate);
+		_mixer = new Audio::MixerImpl(g_system, sampleRate, getRateConverterQuality());
 
 	// Add sound thread priority
 	if (!ConfMan.hasKey("sound_thread_priority"))
@@ -100,7 +100,7 @@ void WINCESdlMixerManager::init() {
 		int vol3 = _mixer->getVolumeForSoundType(Audio::Mixer::kSFXSoundType);
 		int vol4 = _mixer->getVolumeForSoundType(Audio::Mixer::kSpeechSoundType);
 		delete _mixer;
-		_mixer = new Audio::MixerImpl(g_system, sampleRate);
+		_mixer = new Audio::MixerImpl(g_system, sampleRate, getRateConverterQuality());
 		_mixer->setVolumeForSoundType(Audio::Mixer::kPlainSoundType, vol1);
 		_mixer->setVolumeForSoundType(Audio::Mixer::kMusicSoundType, vol2);
 		_mixer->setVolumeForSoundType(Audio::Mixer::kSFXSoundType, vol3);
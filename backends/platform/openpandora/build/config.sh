@@ -17,7 +17,7 @@ export DEFINES=-DNDEBUG
 
 # Edit the configure line to suit.
 cd ../../../..
-./configure --backend=openpandora --host=openpandora --disable-nasm \
+./configure --backend=openpandora --host=openpandora \
   --with-sdl-prefix=/usr/local/angstrom/arm/arm-angstrom-linux-gnueabi/usr/bin \
   --disable-vorbis --enable-tremor --with-tremor-prefix=/usr/local/angstrom/arm/arm-angstrom-linux-gnueabi/usr \
   --enable-zlib --with-zlib-prefix=/usr/local/angstrom/arm/arm-angstrom-linux-gnueabi/usr \
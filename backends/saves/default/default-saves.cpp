@@ -87,7 +87,9 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 	} else {
 		// Open the file for loading.
 		Common::SeekableReadStream *sf = file->_value.createReadStream();
-		return Common::wrapCompressedReadStream(sf);
+		// Save files are often read in several passes (header, thumbnail,
+		// then the actual data), so keep seek checkpoints for big ones.
+		return Common::wrapCompressedReadStream(sf, 0, 256 * 1024);
 	}
 }
 
@@ -181,6 +181,9 @@ void registerDefaults() {
 	ConfMan.registerDefault("gfx_mode", "normal");
 	ConfMan.registerDefault("render_mode", "default");
 	ConfMan.registerDefault("desired_screen_aspect_ratio", "auto");
+	ConfMan.registerDefault("scaler_threads", -1);
+	ConfMan.registerDefault("scaler_overlap", false);
+	ConfMan.registerDefault("opengl_upload_stats", false);
 
 	// Sound & Music
 	ConfMan.registerDefault("music_volume", 192);
@@ -191,6 +194,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("sfx_mute", false);
 	ConfMan.registerDefault("speech_mute", false);
 	ConfMan.registerDefault("mute", false);
+	ConfMan.registerDefault("audio_resampler", "linear");
 
 	ConfMan.registerDefault("multi_midi", false);
 	ConfMan.registerDefault("native_mt32", false);
@@ -240,6 +244,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("joystick_num", -1);
 	ConfMan.registerDefault("confirm_exit", false);
 	ConfMan.registerDefault("disable_sdl_parachute", false);
+	ConfMan.registerDefault("mmap_files", false);
 
 	ConfMan.registerDefault("disable_display", false);
 	ConfMan.registerDefault("record_mode", "none");
@@ -250,6 +255,8 @@ void registerDefaults() {
 
 	ConfMan.registerDefault("gui_browser_show_hidden", false);
 
+	ConfMan.registerDefault("detection_cache", false);
+
 #ifdef USE_FLUIDSYNTH
 	// The settings are deliberately stored the same way as in Qsynth. The
 	// FluidSynth music driver is responsible for transforming them into
@@ -445,6 +445,7 @@ void PluginManager::addToPluginsInMemList(Plugin *plugin) {
 // Engine plugins
 
 #include "engines/metaengine.h"
+#include "engines/detectioncache.h"
 
 namespace Common {
 DECLARE_SINGLETON(EngineManager);
@@ -518,6 +519,10 @@ GameList EngineManager::detectGames(const Common::FSList &fslist) const {
 	GameList candidates;
 	EnginePlugin::List plugins;
 	EnginePlugin::List::const_iterator iter;
+
+	// Let all engines share the file properties computed for this directory
+	DetectionCacheMan.beginPass();
+
 	PluginManager::instance().loadFirstPlugin();
 	do {
 		plugins = getPlugins();
@@ -0,0 +1,225 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+#include "common/noncopyable.h"
+
+#if defined(_MSC_VER) && !defined(__GNUC__)
+#include <intrin.h>
+#endif
+
+namespace Common {
+
+/**
+ * A value which can be shared between threads without a mutex.
+ *
+ * T has to be an integer or a pointer type of 32 bits or of the size of a
+ * pointer. All operations are sequentially consistent, i.e. they also act
+ * as full memory barriers.
+ *
+ * Without compiler support (GCC, Clang or MSVC), or on targets where the
+ * compiler would implement these operations with locks in libatomic, this
+ * falls back to a plain volatile value, which is only good enough on single
+ * core systems. Code which relies on these operations to hand data over
+ * between threads has to keep using a mutex when COMMON_HAS_LOCKFREE_ATOMICS
+ * is not defined.
+ */
+template<class T>
+class Atomic : NonCopyable {
+public:
+	Atomic() : _value(T()) {}
+	explicit Atomic(T value) : _value(value) {}
+
+	/** Return the current value. */
+	T load() const;
+
+	/** Set a new value. */
+	void store(T value);
+
+	/** Set a new value and return the old one. */
+	T exchange(T value);
+
+	/**
+	 * Set a new value if the current one equals the expected one.
+	 *
+	 * @return true if the value was replaced
+	 */
+	bool compareExchange(T expected, T value);
+
+private:
+	volatile T _value;
+};
+
+#if defined(__GCC_ATOMIC_INT_LOCK_FREE) && __GCC_ATOMIC_INT_LOCK_FREE == 2 && __GCC_ATOMIC_POINTER_LOCK_FREE == 2
+
+#define COMMON_HAS_LOCKFREE_ATOMICS
+
+template<class T>
+inline T Atomic<T>::load() const {
+	return __atomic_load_n(&_value, __ATOMIC_SEQ_CST);
+}
+
+template<class T>
+inline void Atomic<T>::store(T value) {
+	__atomic_store_n(&_value, value, __ATOMIC_SEQ_CST);
+}
+
+template<class T>
+inline T Atomic<T>::exchange(T value) {
+	return __atomic_exchange_n(&_value, value, __ATOMIC_SEQ_CST);
+}
+
+template<class T>
+inline bool Atomic<T>::compareExchange(T expected, T value) {
+	return __atomic_compare_exchange_n(&_value, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(__GNUC__) && !defined(__GCC_ATOMIC_INT_LOCK_FREE) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) && \
+	(__SIZEOF_POINTER__ == 4 || defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8))
+
+#define COMMON_HAS_LOCKFREE_ATOMICS
+
+// Compilers older than GCC 4.7 only tell whether compare and swap is
+// implemented inline. The __sync builtins are full barriers, except for
+// plain loads and stores.
+
+template<class T>
+inline T Atomic<T>::load() const {
+	__sync_synchronize();
+	const T value = _value;
+	__sync_synchronize();
+	return value;
+}
+
+template<class T>
+inline void Atomic<T>::store(T value) {
+	exchange(value);
+}
+
+template<class T>
+inline T Atomic<T>::exchange(T value) {
+	T old = _value;
+	T seen;
+	while ((seen = __sync_val_compare_and_swap(&_value, old, value)) != old)
+		old = seen;
+	return old;
+}
+
+template<class T>
+inline bool Atomic<T>::compareExchange(T expected, T value) {
+	return __sync_bool_compare_and_swap(&_value, expected, value);
+}
+
+#elif defined(_MSC_VER) && !defined(__GNUC__)
+
+#define COMMON_HAS_LOCKFREE_ATOMICS
+
+namespace AtomicIntern {
+
+template<int size> struct Interlocked;
+
+template<>
+struct Interlocked<4> {
+	template<class T>
+	static T exchange(volatile T *p, T value) {
+		return (T)_InterlockedExchange((volatile long *)p, (long)value);
+	}
+	template<class T>
+	static T compareExchange(volatile T *p, T expected, T value) {
+		return (T)_InterlockedCompareExchange((volatile long *)p, (long)value, (long)expected);
+	}
+};
+
+#if defined(_M_X64) || defined(_M_ARM64)
+template<>
+struct Interlocked<8> {
+	template<class T>
+	static T exchange(volatile T *p, T value) {
+		return (T)_InterlockedExchange64((volatile __int64 *)p, (__int64)value);
+	}
+	template<class T>
+	static T compareExchange(volatile T *p, T expected, T value) {
+		return (T)_InterlockedCompareExchange64((volatile __int64 *)p, (__int64)value, (__int64)expected);
+	}
+};
+#endif
+
+} // End of namespace AtomicIntern
+
+template<class T>
+inline T Atomic<T>::load() const {
+	// A compare exchange which never changes anything, for the barrier
+	return AtomicIntern::Interlocked<sizeof(T)>::compareExchange(const_cast<volatile T *>(&_value), T(), T());
+}
+
+template<class T>
+inline void Atomic<T>::store(T value) {
+	exchange(value);
+}
+
+template<class T>
+inline T Atomic<T>::exchange(T value) {
+	return AtomicIntern::Interlocked<sizeof(T)>::exchange(&_value, value);
+}
+
+template<class T>
+inline bool Atomic<T>::compareExchange(T expected, T value) {
+	return AtomicIntern::Interlocked<sizeof(T)>::compareExchange(&_value, expected, value) == expected;
+}
+
+#else
+
+// Not atomic at all, see above
+
+template<class T>
+inline T Atomic<T>::load() const {
+	return _value;
+}
+
+template<class T>
+inline void Atomic<T>::store(T value) {
+	_value = value;
+}
+
+template<class T>
+inline T Atomic<T>::exchange(T value) {
+	const T old = _value;
+	_value = value;
+	return old;
+}
+
+template<class T>
+inline bool Atomic<T>::compareExchange(T expected, T value) {
+	if (_value != expected)
+		return false;
+	_value = value;
+	return true;
+}
+
+#endif
+
+} // End of namespace Common
+
+#endif
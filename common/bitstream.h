@@ -26,8 +26,10 @@
 #define COMMON_BITSTREAM_H
 
 #include "common/scummsys.h"
+#include "common/types.h"
 #include "common/textconsole.h"
 #include "common/stream.h"
+#include "common/util.h"
 
 namespace Common {
 
@@ -70,11 +72,160 @@ public:
 	/** Add a bit to the value x, making it an n+1-bit value. */
 	virtual void addBit(uint32 &x, uint32 n) = 0;
 
+	/** Are the bits handed out from MSB to LSB of the data values? */
+	virtual bool isMSBFirst() const = 0;
+
 protected:
 	BitStream() {
 	}
 };
 
+/**
+ * A minimal, non-virtual stream over a memory buffer, to be used as the
+ * data source of a BitStreamImpl.
+ *
+ * It implements the subset of the SeekableReadStream interface needed by
+ * the bit stream, but as none of its methods is virtual, they can be
+ * inlined into the bit stream's hot paths.
+ */
+class BitStreamMemoryStream {
+private:
+	const byte * const _ptrOrig;
+	const byte *_ptr;
+	const uint32 _size;
+	uint32 _pos;
+	DisposeAfterUse::Flag _disposeMemory;
+	bool _eos;
+
+public:
+	BitStreamMemoryStream(const byte *dataPtr, uint32 dataSize, DisposeAfterUse::Flag disposeMemory = DisposeAfterUse::NO) :
+		_ptrOrig(dataPtr),
+		_ptr(dataPtr),
+		_size(dataSize),
+		_pos(0),
+		_disposeMemory(disposeMemory),
+		_eos(false) {}
+
+	~BitStreamMemoryStream() {
+		if (_disposeMemory)
+			free(const_cast<byte *>(_ptrOrig));
+	}
+
+	bool eos() const {
+		return _eos;
+	}
+
+	bool err() const {
+		return false;
+	}
+
+	int32 pos() const {
+		return _pos;
+	}
+
+	int32 size() const {
+		return _size;
+	}
+
+	bool seek(int32 offset, int whence = SEEK_SET) {
+		assert(whence == SEEK_SET || whence == SEEK_CUR);
+
+		if (whence == SEEK_CUR)
+			offset += _pos;
+
+		assert((uint32)offset <= _size);
+
+		_eos = false;
+		_pos = offset;
+		_ptr = _ptrOrig + _pos;
+		return true;
+	}
+
+	byte readByte() {
+		if (_pos >= _size) {
+			_eos = true;
+			return 0;
+		}
+
+		_pos++;
+		return *_ptr++;
+	}
+
+	uint16 readUint16LE() {
+		if ((_pos + 2) > _size) {
+			_eos = true;
+			if (_pos < _size) {
+				_pos++;
+				return *_ptr++;
+			} else {
+				return 0;
+			}
+		}
+
+		uint16 val = READ_LE_UINT16(_ptr);
+
+		_pos += 2;
+		_ptr += 2;
+
+		return val;
+	}
+
+	uint16 readUint16BE() {
+		if ((_pos + 2) > _size) {
+			_eos = true;
+			if (_pos < _size) {
+				_pos++;
+				return (*_ptr++) << 8;
+			} else {
+				return 0;
+			}
+		}
+
+		uint16 val = READ_BE_UINT16(_ptr);
+
+		_pos += 2;
+		_ptr += 2;
+
+		return val;
+	}
+
+	uint32 readUint32LE() {
+		if ((_pos + 4) > _size) {
+			uint32 val = readByte();
+			val |= (uint32)readByte() << 8;
+			val |= (uint32)readByte() << 16;
+			val |= (uint32)readByte() << 24;
+
+			return val;
+		}
+
+		uint32 val = READ_LE_UINT32(_ptr);
+
+		_pos += 4;
+		_ptr += 4;
+
+		return val;
+	}
+
+	uint32 readUint32BE() {
+		if ((_pos + 4) > _size) {
+			uint32 val = (uint32)readByte() << 24;
+			val |= (uint32)readByte() << 16;
+			val |= (uint32)readByte() << 8;
+			val |= (uint32)readByte();
+
+			return val;
+		}
+
+		uint32 val = READ_BE_UINT32(_ptr);
+
+		_pos += 4;
+		_ptr += 4;
+
+		return val;
+	}
+};
+
 /**
  * A template implementing a bit stream for different data memory layouts.
  *
@@ -84,15 +235,25 @@ protected:
  * For example, a bit stream with the layout parameters 32, true, false
  * for valueBits, isLE and isMSB2LSB, reads 32bit little-endian values
  * from the data stream and hands out the bits in the order of LSB to MSB.
+ *
+ * The bits are buffered in a 64-bit cache, so reading and peeking up to 32
+ * bits at once only needs a few shifts and masks, even across value
+ * borders. The cache is only refilled with as many values as a read needs,
+ * so like before, the data stream is never more than one value ahead of
+ * the bit stream position after a read.
+ *
+ * The data stream is given by STREAM: Either a SeekableReadStream, or a
+ * BitStreamMemoryStream for data already in memory, which avoids virtual
+ * calls when refilling the cache.
  */
-template<int valueBits, bool isLE, bool isMSB2LSB>
+template<class STREAM, int valueBits, bool isLE, bool isMSB2LSB>
 class BitStreamImpl : public BitStream {
 private:
-	SeekableReadStream *_stream; ///< The input stream.
-	bool _disposeAfterUse;       ///< Should we delete the stream on destruction?
+	STREAM *_stream;       ///< The input stream.
+	bool _disposeAfterUse; ///< Should we delete the stream on destruction?
 
-	uint32 _value;   ///< Current value.
-	uint8  _inValue; ///< Position within the current value.
+	uint64 _cache;     ///< Buffered bits, the next one at the MSB or LSB depending on bit order.
+	uint8  _cacheBits; ///< Number of bits in the cache.
 
 	/** Read a data value. */
 	inline uint32 readData() {
@@ -116,32 +277,69 @@ private:
 		return 0;
 	}
 
-	/** Read the next data value. */
-	inline void readValue() {
-		if ((size() - pos()) < valueBits)
-			error("BitStreamImpl::readValue(): End of bit stream reached");
+	/** Return the number of bits in the stream not read into the cache yet. */
+	inline uint32 bitsLeftInStream() const {
+		// Not calling size() directly avoids a virtual call
+		return BitStreamImpl::size() - (uint32)_stream->pos() * 8;
+	}
 
-		_value = readData();
-		if (_stream->err() || _stream->eos())
-			error("BitStreamImpl::readValue(): Read error");
+	/** Read data values into the cache until it holds at least n bits, or the data ends. */
+	inline void refill(uint8 n) {
+		while (_cacheBits < n && bitsLeftInStream() >= (uint32)valueBits) {
+			uint64 value = readData();
+			if (_stream->err() || _stream->eos())
+				error("BitStreamImpl::refill(): Read error");
 
-		// If we're reading the bits MSB first, we need to shift the value to that position
-		if (isMSB2LSB)
-			_value <<= 32 - valueBits;
+			if (isMSB2LSB)
+				_cache |= value << (64 - valueBits - _cacheBits);
+			else
+				_cache |= value << _cacheBits;
+
+			_cacheBits += valueBits;
 		}
+	}
+
+	/** Make sure the cache holds at least n bits. */
+	inline void fillCache(uint8 n) {
+		if (_cacheBits >= n)
+			return;
+
+		refill(n);
+
+		if (_cacheBits < n)
+			error("BitStreamImpl::fillCache(): End of bit stream reached");
+	}
+
+	/** Return the next n bits in the cache, which has to hold at least that many. */
+	inline uint32 peekCache(uint8 n) const {
+		if (isMSB2LSB)
+			return (uint32)(_cache >> (64 - n));
+		else
+			return (uint32)(_cache & ((((uint64)1) << n) - 1));
+	}
+
+	/** Drop the next n bits from the cache, which has to hold at least that many. */
+	inline void consumeCache(uint8 n) {
+		if (isMSB2LSB)
+			_cache <<= n;
+		else
+			_cache >>= n;
+
+		_cacheBits -= n;
+	}
 
 public:
 	/** Create a bit stream using this input data stream and optionally delete it on destruction. */
-	BitStreamImpl(SeekableReadStream *stream, bool disposeAfterUse = false) :
-		_stream(stream), _disposeAfterUse(disposeAfterUse), _value(0), _inValue(0) {
+	BitStreamImpl(STREAM *stream, bool disposeAfterUse = false) :
+		_stream(stream), _disposeAfterUse(disposeAfterUse), _cache(0), _cacheBits(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
 			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
 	}
 
 	/** Create a bit stream using this input data stream. */
-	BitStreamImpl(SeekableReadStream &stream) :
-		_stream(&stream), _disposeAfterUse(false), _value(0), _inValue(0) {
+	BitStreamImpl(STREAM &stream) :
+		_stream(&stream), _disposeAfterUse(false), _cache(0), _cacheBits(0) {
 
 		if ((valueBits != 8) && (valueBits != 16) && (valueBits != 32))
 			error("BitStreamImpl: Invalid memory layout %d, %d, %d", valueBits, isLE, isMSB2LSB);
@@ -154,25 +352,10 @@ public:
 
 	/** Read a bit from the bit stream. */
 	uint32 getBit() {
-		// Check if we need the next value
-		if (_inValue == 0)
-			readValue();
+		fillCache(1);
 
-		// Get the current bit
-		int b = 0;
-		if (isMSB2LSB)
-			b = ((_value & 0x80000000) == 0) ? 0 : 1;
-		else
-			b = ((_value & 1) == 0) ? 0 : 1;
-
-		// Shift to the next bit
-		if (isMSB2LSB)
-			_value <<= 1;
-		else
-			_value >>= 1;
-
-		// Increase the position within the current value
-		_inValue = (_inValue + 1) % valueBits;
+		uint32 b = peekCache(1);
+		consumeCache(1);
 
 		return b;
 	}
@@ -194,35 +377,19 @@ public:
 		if (n > 32)
 			error("BitStreamImpl::getBits(): Too many bits requested to be read");
 
-		// Read the number of bits
-		uint32 v = 0;
-
-		if (isMSB2LSB) {
-			while (n-- > 0)
-				v = (v << 1) | getBit();
-		} else {
-			for (uint32 i = 0; i < n; i++)
-				v = (v >> 1) | (((uint32) getBit()) << 31);
+		fillCache(n);
 
-			v >>= (32 - n);
-		}
+		uint32 v = peekCache(n);
+		consumeCache(n);
 
 		return v;
 	}
 
 	/** Read a bit from the bit stream, without changing the stream's position. */
 	uint32 peekBit() {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
-
-		uint32 v = getBit();
-
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
+		fillCache(1);
 
-		return v;
+		return peekCache(1);
 	}
 
 	/**
@@ -231,17 +398,15 @@ public:
 	 * The bit order is the same as in getBits().
 	 */
 	uint32 peekBits(uint8 n) {
-		uint32 value   = _value;
-		uint8  inValue = _inValue;
-		uint32 curPos  = _stream->pos();
+		if (n == 0)
+			return 0;
 
-		uint32 v = getBits(n);
+		if (n > 32)
+			error("BitStreamImpl::peekBits(): Too many bits requested to be read");
 
-		_stream->seek(curPos);
-		_inValue = inValue;
-		_value   = value;
+		fillCache(n);
 
-		return v;
+		return peekCache(n);
 	}
 
 	/**
@@ -265,33 +430,63 @@ public:
 			x = (x & ~(1 << n)) | (getBit() << n);
 	}
 
+	/** Are the bits handed out from MSB to LSB of the data values? */
+	bool isMSBFirst() const {
+		return isMSB2LSB;
+	}
+
 	/** Rewind the bit stream back to the start. */
 	void rewind() {
 		_stream->seek(0);
 
-		_value   = 0;
-		_inValue = 0;
+		_cache     = 0;
+		_cacheBits = 0;
 	}
 
 	/** Skip the specified amount of bits. */
 	void skip(uint32 n) {
-		while (n-- > 0)
-			getBit();
+		if (n < _cacheBits) {
+			consumeCache(n);
+			return;
+		}
+
+		n -= _cacheBits;
+		_cache     = 0;
+		_cacheBits = 0;
+
+		// Skip whole values in the stream directly
+		const uint32 values = n / valueBits;
+		if (values > 0) {
+			if (values * valueBits > bitsLeftInStream())
+				error("BitStreamImpl::skip(): End of bit stream reached");
+
+			_stream->seek(values * (valueBits >> 3), SEEK_CUR);
+			n -= values * valueBits;
+		}
+
+		if (n > 0) {
+			fillCache(n);
+			consumeCache(n);
+		}
 	}
 
 	/** Skip the bits to closest data value border. */
 	void align() {
-		while (_inValue)
-			getBit();
+		// The cache always ends on a value border
+		consumeCache(_cacheBits % valueBits);
+
+		// Hand whole values left over from peeking back to the data
+		// stream, so it is positioned right at the bit stream position.
+		if (_cacheBits) {
+			_stream->seek(-(int32)(_cacheBits >> 3), SEEK_CUR);
+			_cache     = 0;
+			_cacheBits = 0;
+		}
 	}
 
 	/** Return the stream position in bits. */
 	uint32 pos() const {
-		if (_stream->pos() == 0)
-			return 0;
-
-		uint32 p = (_inValue == 0) ? _stream->pos() : ((_stream->pos() - 1) & ~((uint32) ((valueBits >> 3) - 1)));
-		return p * 8 + _inValue;
+		return (uint32)_stream->pos() * 8 - _cacheBits;
 	}
 
 	/** Return the stream size in bits. */
@@ -307,27 +502,52 @@ public:
 // typedefs for various memory layouts.
 
 /** 8-bit data, MSB to LSB. */
-typedef BitStreamImpl<8, false, true > BitStream8MSB;
+typedef BitStreamImpl<SeekableReadStream, 8, false, true > BitStream8MSB;
+/** 8-bit data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 8, false, false> BitStream8LSB;
+
+/** 16-bit little-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, true , true > BitStream16LEMSB;
+/** 16-bit little-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, true , false> BitStream16LELSB;
+/** 16-bit big-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, false, true > BitStream16BEMSB;
+/** 16-bit big-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 16, false, false> BitStream16BELSB;
+
+/** 32-bit little-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, true , true > BitStream32LEMSB;
+/** 32-bit little-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, true , false> BitStream32LELSB;
+/** 32-bit big-endian data, MSB to LSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, false, true > BitStream32BEMSB;
+/** 32-bit big-endian data, LSB to MSB. */
+typedef BitStreamImpl<SeekableReadStream, 32, false, false> BitStream32BELSB;
+
+
+
+/** 8-bit data, MSB to LSB. */
+typedef BitStreamImpl<BitStreamMemoryStream, 8, false, true > BitStreamMemory8MSB;
 /** 8-bit data, LSB to MSB. */
-typedef BitStreamImpl<8, false, false> BitStream8LSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 8, false, false> BitStreamMemory8LSB;
 
 /** 16-bit little-endian data, MSB to LSB. */
-typedef BitStreamImpl<16, true , true > BitStream16LEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, true , true > BitStreamMemory16LEMSB;
 /** 16-bit little-endian data, LSB to MSB. */
-typedef BitStreamImpl<16, true , false> BitStream16LELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, true , false> BitStreamMemory16LELSB;
 /** 16-bit big-endian data, MSB to LSB. */
-typedef BitStreamImpl<16, false, true > BitStream16BEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, false, true > BitStreamMemory16BEMSB;
 /** 16-bit big-endian data, LSB to MSB. */
-typedef BitStreamImpl<16, false, false> BitStream16BELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 16, false, false> BitStreamMemory16BELSB;
 
 /** 32-bit little-endian data, MSB to LSB. */
-typedef BitStreamImpl<32, true , true > BitStream32LEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, true , true > BitStreamMemory32LEMSB;
 /** 32-bit little-endian data, LSB to MSB. */
-typedef BitStreamImpl<32, true , false> BitStream32LELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, true , false> BitStreamMemory32LELSB;
 /** 32-bit big-endian data, MSB to LSB. */
-typedef BitStreamImpl<32, false, true > BitStream32BEMSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, false, true > BitStreamMemory32BEMSB;
 /** 32-bit big-endian data, LSB to MSB. */
-typedef BitStreamImpl<32, false, false> BitStream32BELSB;
+typedef BitStreamImpl<BitStreamMemoryStream, 32, false, false> BitStreamMemory32BELSB;
 
 } // End of namespace Common
 
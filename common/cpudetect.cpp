@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "common/cpudetect.h"
+
+namespace Common {
+
+static uint32 s_detectedFeatures = 0;
+static bool s_featuresDetected = false;
+static uint32 s_featureMask = 0xFFFFFFFF;
+
+static uint32 detectCPUFeatures() {
+	uint32 features = 0;
+
+#if (defined(__i386__) || defined(__x86_64__)) && (defined(__clang__) || __GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 8))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		features |= kCPUFeatureSSE2;
+	if (__builtin_cpu_supports("avx2"))
+		features |= kCPUFeatureAVX2;
+#elif defined(_M_X64) || defined(__x86_64__)
+	// SSE2 is part of the x86-64 baseline
+	features |= kCPUFeatureSSE2;
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	features |= kCPUFeatureNEON;
+#endif
+
+	return features;
+}
+
+bool hasCPUFeature(CPUFeature feature) {
+	if (!s_featuresDetected) {
+		s_detectedFeatures = detectCPUFeatures();
+		s_featuresDetected = true;
+	}
+
+	return (s_detectedFeatures & s_featureMask & feature) != 0;
+}
+
+void setCPUFeatureMask(uint32 mask) {
+	s_featureMask = mask;
+}
+
+} // End of namespace Common
@@ -0,0 +1,56 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef COMMON_CPUDETECT_H
+#define COMMON_CPUDETECT_H
+
+#include "common/scummsys.h"
+
+namespace Common {
+
+/**
+ * Instruction set extensions which code may pick optimized paths for.
+ */
+enum CPUFeature {
+	kCPUFeatureSSE2 = 1 << 0,
+	kCPUFeatureAVX2 = 1 << 1,
+	kCPUFeatureNEON = 1 << 2
+};
+
+/**
+ * Check whether the CPU we are running on supports the given feature.
+ *
+ * x86 features are detected at runtime. NEON is only reported when the
+ * compiler targets it anyway, since there is no portable way to query it.
+ */
+bool hasCPUFeature(CPUFeature feature);
+
+/**
+ * Restrict the features reported by hasCPUFeature() to the given mask of
+ * CPUFeature values. This allows testing and benchmarking the fallback
+ * code paths. Pass 0xFFFFFFFF to report everything supported again.
+ */
+void setCPUFeatureMask(uint32 mask);
+
+} // End of namespace Common
+
+#endif
@@ -0,0 +1,618 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// The control byte layout used by this hash map follows the "Swiss table"
+// design: one metadata byte per slot, scanned eight slots at a time.
+
+#ifndef COMMON_FLATHASHMAP_H
+#define COMMON_FLATHASHMAP_H
+
+#include "common/scummsys.h"
+#include "common/endian.h"
+#include "common/func.h"
+#include "common/memory.h"
+#include "common/textconsole.h"
+
+namespace Common {
+
+class String;
+
+/**
+ * Whether FlatHashMap keeps the full hash of each key next to it. This pays
+ * off for keys which are expensive to compare or to hash, like strings,
+ * since most mismatching entries are then ruled out without calling the
+ * equality functor, and growing the map does not need to hash any keys
+ * again. For cheap keys, like integers, it only makes the entries larger.
+ */
+template<class Key>
+struct FlatHashMapKeyTraits {
+	enum { kStoreHash = false };
+};
+
+template<>
+struct FlatHashMapKeyTraits<String> {
+	enum { kStoreHash = true };
+};
+
+/** The part of a FlatHashMap entry which holds the hash of its key, if any. */
+template<bool kStoreHash>
+struct FlatHashMapNodeHash {
+	uint _hash;
+
+	explicit FlatHashMapNodeHash(uint hash) : _hash(hash) {}
+	bool matchesHash(uint hash) const { return _hash == hash; }
+	template<class HashFunc, class Key>
+	uint getHash(const HashFunc &, const Key &) const { return _hash; }
+};
+
+template<>
+struct FlatHashMapNodeHash<false> {
+	explicit FlatHashMapNodeHash(uint) {}
+	bool matchesHash(uint) const { return true; }
+	template<class HashFunc, class Key>
+	uint getHash(const HashFunc &hash, const Key &key) const { return hash(key); }
+};
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in alternative to HashMap<Key,Val> for
+ * lookup-heavy code.
+ *
+ * Keys and values are stored inline in a single array, so there is no
+ * allocation per entry and no pointer to follow on a probe. Next to the
+ * entries, an array of control bytes holds 7 bits of each key's hash (or
+ * a marker for empty and erased slots). Lookups compare these bytes for a
+ * group of eight slots at once and only call the equality functor on
+ * entries whose hash bits match. For string keys, the full hash is kept as
+ * well and compared first, see FlatHashMapKeyTraits.
+ *
+ * Only string keys gain from this, and only when they are looked up in no
+ * particular order: in an optimized build, random lookups are about a third
+ * faster than with HashMap. When the keys are looked up in the order they
+ * were inserted in, HashMap is just as fast, since its nodes are then next
+ * to each other in memory. For integer keys, FlatHashMap is no faster than
+ * HashMap (slightly slower, in fact), so there is no point in switching
+ * integer-keyed maps over.
+ *
+ * The API mirrors HashMap, including iterators exposing _key and _value.
+ * Unlike HashMap, inserting new keys may move existing entries in memory,
+ * so neither references to values nor iterators survive an insertion.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+private:
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	typedef FlatHashMapNodeHash<FlatHashMapKeyTraits<Key>::kStoreHash> NodeHash;
+
+	struct Node : public NodeHash {
+		const Key _key;
+		Val _value;
+		Node(const Key &key, size_type hash) : NodeHash(hash), _key(key), _value() {}
+		Node(const Key &key, const Val &value, size_type hash) : NodeHash(hash), _key(key), _value(value) {}
+	};
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+		FLATHASHMAP_GROUP_WIDTH = 8,
+
+		// Maximum fill ratio (including erased slots) before the storage
+		// is enlarged. This guarantees that every probe sequence ends on an
+		// empty slot.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 3,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 4
+	};
+
+	enum {
+		kCtrlEmpty = 0x80,
+		kCtrlDeleted = 0xFE
+	};
+
+	/**
+	 * Control bytes, one per slot, followed by a copy of the first
+	 * FLATHASHMAP_GROUP_WIDTH bytes so a group may be read starting at any
+	 * slot without wrapping around.
+	 */
+	byte *_ctrl;
+	Node *_slots;
+	size_type _mask;	///< Capacity minus one; the capacity is a power of two
+	size_type _size;
+	size_type _deleted;
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	/** Default value, returned by the const getVal. */
+	const Val _defaultVal;
+
+	static bool isFull(byte ctrl) { return (ctrl & 0x80) == 0; }
+
+	/** The 7 bits of the hash which are stored in the control byte. */
+	static byte hashBits(size_type hash) { return (byte)((hash * 2654435761U) >> 25); }
+
+	static uint64 loadGroup(const byte *ctrl) { return READ_LE_UINT64(ctrl); }
+
+	/** Mark the high bit of every byte in the group equal to the given value. */
+	static uint64 matchByte(uint64 group, byte value) {
+		const uint64 lsbs = 0x0101010101010101ULL;
+		const uint64 x = group ^ (lsbs * value);
+		return (x - lsbs) & ~x & (lsbs << 7);
+	}
+
+	/** Mark the high bit of every empty slot in the group. */
+	static uint64 matchEmpty(uint64 group) {
+		return group & ~(group << 6) & 0x8080808080808080ULL;
+	}
+
+	/** Mark the high bit of every empty or erased slot in the group. */
+	static uint64 matchFree(uint64 group) {
+		return group & 0x8080808080808080ULL;
+	}
+
+	/** Return the index of the lowest slot marked in a match mask. */
+	static uint lowestMatch(uint64 mask) {
+#if defined(__GNUC__) && (__GNUC__ >= 4)
+		return __builtin_ctzll(mask) >> 3;
+#else
+		uint idx = 0;
+		while (!(mask & 0x80)) {
+			mask >>= 8;
+			idx++;
+		}
+		return idx;
+#endif
+	}
+
+	void setCtrl(size_type idx, byte value) {
+		_ctrl[idx] = value;
+		if (idx < FLATHASHMAP_GROUP_WIDTH)
+			_ctrl[_mask + 1 + idx] = value;
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const { return lookup(key, _hash(key)); }
+	size_type lookup(const Key &key, size_type hash) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	size_type findFreeSlot(size_type hash) const;
+	void rehash(size_type newCapacity);
+
+	/**
+	 * Simple FlatHashMap iterator implementation.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, hashmap_t *hashmap) : _idx(idx), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != 0);
+			assert(_idx <= _hashmap->_mask);
+			assert(isFull(_hashmap->_ctrl[_idx]));
+			return &_hashmap->_slots[_idx];
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _hashmap(0) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			do {
+				_idx++;
+			} while (_idx <= _hashmap->_mask && !isFull(_hashmap->_ctrl[_idx]));
+			if (_idx > _hashmap->_mask)
+				_idx = (size_type)-1;
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getVal(const Key &key, const Val &defaultVal) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+
+	void erase(iterator entry);
+	void erase(const Key &key);
+
+	/**
+	 * Make room for at least the given number of entries, so that inserting
+	 * them does not need to rehash.
+	 */
+	void reserve(size_type count);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (isFull(_ctrl[ctr]))
+				return iterator(ctr, this);
+		}
+		return end();
+	}
+	iterator	end() {
+		return iterator((size_type)-1, this);
+	}
+
+	const_iterator	begin() const {
+		// Find and return the first non-empty entry
+		for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+			if (isFull(_ctrl[ctr]))
+				return const_iterator(ctr, this);
+		}
+		return end();
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, this);
+	}
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (ctr <= _mask)
+			return iterator(ctr, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (ctr <= _mask)
+			return const_iterator(ctr, this);
+		return end();
+	}
+
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+/**
+ * Allocate empty storage for the given number of slots.
+ *
+ * @note The previous storage is *not* freed here.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && !(capacity & (capacity - 1)));
+
+	_mask = capacity - 1;
+	_size = 0;
+	_deleted = 0;
+
+	_ctrl = (byte *)malloc(capacity + FLATHASHMAP_GROUP_WIDTH);
+	_slots = (Node *)malloc(capacity * sizeof(Node));
+	if (!_ctrl || !_slots)
+		::error("FlatHashMap: Failed to allocate %u slots", capacity);
+
+	memset(_ctrl, kCtrlEmpty, capacity + FLATHASHMAP_GROUP_WIDTH);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+
+	free(_ctrl);
+	free(_slots);
+	_ctrl = 0;
+	_slots = 0;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note We do *not* deallocate the previous storage here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The capacities match, so the layout can be cloned slot by slot.
+	memcpy(_ctrl, map._ctrl, _mask + 1 + FLATHASHMAP_GROUP_WIDTH);
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			new ((void *)&_slots[ctr]) Node(map._slots[ctr]._key, map._slots[ctr]._value, map._slots[ctr].getHash(_hash, map._slots[ctr]._key));
+	}
+
+	_size = map._size;
+	_deleted = map._deleted;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (isFull(_ctrl[ctr]))
+			_slots[ctr].~Node();
+	}
+
+	memset(_ctrl, kCtrlEmpty, _mask + 1 + FLATHASHMAP_GROUP_WIDTH);
+	_size = 0;
+	_deleted = 0;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while (count * FLATHASHMAP_LOADFACTOR_DENOMINATOR >= capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+
+	if (capacity > _mask + 1)
+		rehash(capacity);
+}
+
+/**
+ * Return the first empty or erased slot on the probe sequence of the hash.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::findFreeSlot(size_type hash) const {
+	size_type pos = hash & _mask;
+	for (;;) {
+		const uint64 match = matchFree(loadGroup(_ctrl + pos));
+		if (match)
+			return (pos + lowestMatch(match)) & _mask;
+
+		pos = (pos + FLATHASHMAP_GROUP_WIDTH) & _mask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::rehash(size_type newCapacity) {
+	assert(newCapacity >= _mask + 1);
+
+	const size_type oldSize = _size;
+	const size_type oldMask = _mask;
+	byte *oldCtrl = _ctrl;
+	Node *oldSlots = _slots;
+
+	allocStorage(newCapacity);
+
+	// Rehash all the old elements. Since we know that no key exists twice
+	// in the old table, we only need to look for a free slot.
+	for (size_type ctr = 0; ctr <= oldMask; ++ctr) {
+		if (!isFull(oldCtrl[ctr]))
+			continue;
+
+		Node &node = oldSlots[ctr];
+		const size_type hash = node.getHash(_hash, node._key);
+		const size_type idx = findFreeSlot(hash);
+
+		new ((void *)&_slots[idx]) Node(node._key, node._value, hash);
+		setCtrl(idx, hashBits(hash));
+		_size++;
+
+		node.~Node();
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	// This check will fail if some previous operation corrupted this hashmap.
+	assert(_size == oldSize);
+
+	free(oldCtrl);
+	free(oldSlots);
+}
+
+/**
+ * Return the slot holding the given key with the given hash, or _mask + 1
+ * if there is none.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key, size_type hash) const {
+	const byte bits = hashBits(hash);
+	size_type pos = hash & _mask;
+
+	for (;;) {
+		const uint64 group = loadGroup(_ctrl + pos);
+
+		for (uint64 match = matchByte(group, bits); match; match &= match - 1) {
+			const size_type idx = (pos + lowestMatch(match)) & _mask;
+			if (_slots[idx].matchesHash(hash) && _equal(_slots[idx]._key, key))
+				return idx;
+		}
+
+		if (matchEmpty(group))
+			return _mask + 1;
+
+		pos = (pos + FLATHASHMAP_GROUP_WIDTH) & _mask;
+	}
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	const size_type hash = _hash(key);
+	size_type ctr = lookup(key, hash);
+	if (ctr <= _mask)
+		return ctr;
+
+	// Keep the load factor below a certain threshold. Erased slots are also
+	// counted, since they lengthen probe sequences just like used ones. If
+	// most of them are erased, rehashing at the same size is enough.
+	const size_type capacity = _mask + 1;
+	if ((_size + _deleted + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR) {
+		if (_deleted > _size)
+			rehash(capacity);
+		else
+			rehash(capacity < 500 ? (capacity * 4) : (capacity * 2));
+	}
+
+	ctr = findFreeSlot(hash);
+	if (_ctrl[ctr] == kCtrlDeleted)
+		_deleted--;
+
+	new ((void *)&_slots[ctr]) Node(key, hash);
+	setCtrl(ctr, hashBits(hash));
+	_size++;
+
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) <= _mask;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	// Inserting may move the storage, so only access it afterwards.
+	size_type ctr = lookupAndCreateIfMissing(key);
+	return _slots[ctr]._value;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	return getVal(key, _defaultVal);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (ctr <= _mask)
+		return _slots[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	_slots[ctr]._value = val;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	const size_type ctr = entry._idx;
+	assert(ctr <= _mask);
+	assert(isFull(_ctrl[ctr]));
+
+	// If we remove a key, we mark its slot as erased.
+	_slots[ctr].~Node();
+	setCtrl(ctr, kCtrlDeleted);
+	_size--;
+	_deleted++;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr > _mask)
+		return;
+
+	// If we remove a key, we mark its slot as erased.
+	_slots[ctr].~Node();
+	setCtrl(ctr, kCtrlDeleted);
+	_size--;
+	_deleted++;
+}
+
+} // End of namespace Common
+
+#endif
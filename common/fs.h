@@ -222,6 +222,16 @@ public:
 	 */
 	virtual SeekableReadStream *createReadStream() const;
 
+	/**
+	 * Creates a SeekableReadStream instance corresponding to the file
+	 * referred by this node, which may map the file into memory, if the
+	 * backend supports that. This is meant for game data, which does not
+	 * change while it is read; use createReadStream() for anything else.
+	 *
+	 * @return pointer to the stream object, 0 in case of a failure
+	 */
+	SeekableReadStream *createMappedReadStream() const;
+
 	/**
 	 * Creates a WriteStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -279,6 +289,7 @@ class FSDirectory : public Archive {
 	mutable bool _cached;
 	mutable int	_depth;
 	mutable bool _flat;
+	bool _mapFiles;
 
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const String &name) const;
@@ -314,6 +325,14 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Set whether members are opened with FSNode::createMappedReadStream().
+	 * Only enable this for directories holding game data, whose files are
+	 * not modified while they are open. Sub directories created afterwards
+	 * inherit the setting.
+	 */
+	void setMapFiles(bool mapFiles) { _mapFiles = mapFiles; }
+
 	/**
 	 * Create a new FSDirectory pointing to a sub directory of the instance. See class comment
 	 * for an explanation of the prefix parameter.
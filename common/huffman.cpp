@@ -33,7 +33,8 @@ Huffman::Symbol::Symbol(uint32 c, uint32 s) : code(c), symbol(s) {
 }
 
 
-Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) {
+Huffman::Huffman(uint8 maxLength, uint32 codeCount, const uint32 *codes, const uint8 *lengths, const uint32 *symbols) :
+	_tableOrder(kTableNone), _tableBits(0) {
 	assert(codeCount > 0);
 
 	assert(codes);
@@ -66,9 +67,108 @@ Huffman::~Huffman() {
 void Huffman::setSymbols(const uint32 *symbols) {
 	for (uint32 i = 0; i < _symbols.size(); i++)
 		_symbols[i]->symbol = symbols ? *symbols++ : i;
+
+	// The lookup tables hold the symbols, so they need to be rebuilt
+	_tableOrder = kTableNone;
+}
+
+void Huffman::fillTable(uint32 offset, uint8 tableBits, uint32 code, uint8 length, uint32 symbol, bool msbFirst) const {
+	// The code occupies the first length bits of the index, the remaining
+	// bits can have any value.
+	const uint32 count = 1 << (tableBits - length);
+
+	for (uint32 i = 0; i < count; i++) {
+		const uint32 index = msbFirst ? ((code << (tableBits - length)) | i) : (code | (i << length));
+
+		TableEntry &entry = _table[offset + index];
+		entry.symbol = symbol;
+		entry.length = length;
+	}
+}
+
+void Huffman::buildTable(bool msbFirst) const {
+	_tableBits = MIN<uint8>(_codes.size(), kPrimaryTableBits);
+
+	_table.clear();
+	_table.resize(1 << _tableBits);
+
+	// Fill in the short codes, and find out how many more bits are needed
+	// for the long codes starting with each primary index.
+	for (uint8 length = 1; length <= _codes.size(); length++) {
+		for (CodeList::const_iterator cCode = _codes[length - 1].begin(); cCode != _codes[length - 1].end(); ++cCode) {
+			if (length <= _tableBits) {
+				fillTable(0, _tableBits, cCode->code, length, cCode->symbol, msbFirst);
+				continue;
+			}
+
+			const uint32 prefix = msbFirst ? (cCode->code >> (length - _tableBits)) : (cCode->code & ((1 << _tableBits) - 1));
+			_table[prefix].subBits = MAX<uint8>(_table[prefix].subBits, length - _tableBits);
+		}
+	}
+
+	// Allocate the secondary tables. Codes which would need too big a table
+	// are left to the bit by bit decoding.
+	for (uint32 i = 0; i < ((uint32)1 << _tableBits); i++) {
+		if (!_table[i].subBits)
+			continue;
+
+		if (_table[i].subBits > kSecondaryTableBits) {
+			_table[i].subBits = 0;
+			continue;
+		}
+
+		const uint32 offset = _table.size();
+		_table.resize(offset + (1 << _table[i].subBits));
+		_table[i].symbol = offset;
+	}
+
+	// Fill in the long codes
+	for (uint8 length = _tableBits + 1; length <= _codes.size(); length++) {
+		for (CodeList::const_iterator cCode = _codes[length - 1].begin(); cCode != _codes[length - 1].end(); ++cCode) {
+			const uint32 prefix = msbFirst ? (cCode->code >> (length - _tableBits)) : (cCode->code & ((1 << _tableBits) - 1));
+			const TableEntry primary = _table[prefix];
+			if (!primary.subBits)
+				continue;
+
+			const uint8 restLength = length - _tableBits;
+			const uint32 rest = msbFirst ? (cCode->code & ((1 << restLength) - 1)) : (cCode->code >> _tableBits);
+			fillTable(primary.symbol, primary.subBits, rest, restLength, cCode->symbol, msbFirst);
+		}
+	}
+
+	_tableOrder = msbFirst ? kTableMSB2LSB : kTableLSB2MSB;
 }
 
 uint32 Huffman::getSymbol(BitStream &bits) const {
+	const bool msbFirst = bits.isMSBFirst();
+	if (_tableOrder != (msbFirst ? kTableMSB2LSB : kTableLSB2MSB))
+		buildTable(msbFirst);
+
+	// Near the end of the stream, we can't peek a full index
+	const uint32 bitsLeft = bits.size() - bits.pos();
+	if (bitsLeft < _tableBits)
+		return getSymbolSlow(bits);
+
+	const TableEntry &entry = _table[bits.peekBits(_tableBits)];
+	if (entry.length) {
+		bits.skip(entry.length);
+		return entry.symbol;
+	}
+
+	if (!entry.subBits || bitsLeft < (uint32)(_tableBits + entry.subBits))
+		return getSymbolSlow(bits);
+
+	bits.skip(_tableBits);
+
+	const TableEntry &subEntry = _table[entry.symbol + bits.peekBits(entry.subBits)];
+	if (!subEntry.length)
+		error("Unknown Huffman code");
+
+	bits.skip(subEntry.length);
+	return subEntry.symbol;
+}
+
+uint32 Huffman::getSymbolSlow(BitStream &bits) const {
 	uint32 code = 0;
 
 	for (uint32 i = 0; i < _codes.size(); i++) {
@@ -36,6 +36,12 @@ class BitStream;
 /**
  * Huffman bitstream decoding
  *
+ * Codes are decoded with the help of lookup tables: The next few bits of
+ * the stream are peeked and used as an index into a primary table, which
+ * directly yields the symbol for short codes. Longer codes are resolved
+ * through a secondary table. The tables are built on first use, for the
+ * bit order of the stream the decoder is used with.
+ *
  * Used in engines:
  *  - scumm
  */
@@ -59,6 +65,11 @@ public:
 	uint32 getSymbol(BitStream &bits) const;
 
 private:
+	enum {
+		kPrimaryTableBits   =  9, ///< Bits looked up at once in the primary table.
+		kSecondaryTableBits = 12  ///< Maximum bits looked up in a secondary table.
+	};
+
 	struct Symbol {
 		uint32 code;
 		uint32 symbol;
@@ -66,6 +77,29 @@ private:
 		Symbol(uint32 c, uint32 s);
 	};
 
+	/**
+	 * An entry of the lookup tables.
+	 *
+	 * If length is not 0, the entry holds a symbol and the number of bits
+	 * of its code still to be consumed. If subBits is not 0, the entry of
+	 * the primary table refers to a secondary table starting at index
+	 * symbol, indexed by the next subBits bits. If both are 0, the code
+	 * has to be decoded bit by bit.
+	 */
+	struct TableEntry {
+		uint32 symbol;
+		uint8  length;
+		uint8  subBits;
+
+		TableEntry() : symbol(0), length(0), subBits(0) {}
+	};
+
+	enum TableOrder {
+		kTableNone,
+		kTableMSB2LSB,
+		kTableLSB2MSB
+	};
+
 	typedef List<Symbol> CodeList;
 	typedef Array<CodeList> CodeLists;
 	typedef Array<Symbol *> SymbolList;
@@ -75,6 +109,22 @@ private:
 
 	/** Sorted list of pointers to the symbols. */
 	SymbolList _symbols;
+
+	/** Primary lookup table, followed by the secondary ones. */
+	mutable Array<TableEntry> _table;
+	/** The bit order the lookup tables were built for. */
+	mutable TableOrder _tableOrder;
+	/** Number of bits used to index the primary table. */
+	mutable uint8 _tableBits;
+
+	/** Build the lookup tables for the given bit order. */
+	void buildTable(bool msbFirst) const;
+
+	/** Fill the entries matching a code into the given table. */
+	void fillTable(uint32 offset, uint8 tableBits, uint32 code, uint8 length, uint32 symbol, bool msbFirst) const;
+
+	/** Decode the next symbol bit by bit. */
+	uint32 getSymbolSlow(BitStream &bits) const;
 };
 
 } // End of namespace Common
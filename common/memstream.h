@@ -71,6 +71,9 @@ public:
 	int32 size() const { return _size; }
 
 	bool seek(int32 offs, int whence = SEEK_SET);
+
+	const byte *peekBuffer(uint32 size);
+	void releaseBuffer(const byte *buffer);
 };
 
 
@@ -3,6 +3,7 @@ MODULE := common
 MODULE_OBJS := \
 	archive.o \
 	config-manager.o \
+	cpudetect.o \
 	coroutines.o \
 	dcl.o \
 	debug.o \
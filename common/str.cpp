@@ -30,6 +30,8 @@ namespace Common {
 
 MemoryPool *g_refCountPool = 0; // FIXME: This is never freed right now
 
+uint32 String::_heapAllocations = 0;
+
 static uint32 computeCapacity(uint32 len) {
 	// By default, for the capacity we use the next multiple of 32
 	return ((len + 32 - 1) & ~0x1F);
@@ -67,6 +69,7 @@ void String::initWithCStr(const char *str, uint32 len) {
 		_extern._refCount = 0;
 		_str = new char[_extern._capacity];
 		assert(_str != 0);
+		_heapAllocations++;
 	}
 
 	// Copy the string into the storage area
@@ -90,6 +93,39 @@ String::String(const String &str)
 	assert(_str != 0);
 }
 
+#if __cplusplus >= 201103L
+String::String(String &&str)
+    : _size(0), _str(_storage) {
+	moveFrom(str);
+}
+
+/**
+ * Take over the content of the given string, leaving it empty. Strings in
+ * external storage are handed over without touching the ref count.
+ *
+ * @note The previous storage of this string is *not* released here.
+ */
+void String::moveFrom(String &str) {
+	static_assert(COMMON_STRING_SIZE >= sizeof(_extern), "String storage is too small for the external storage data");
+
+	_size = str._size;
+
+	if (str.isStorageIntern()) {
+		memcpy(_storage, str._storage, _builtinCapacity);
+		_str = _storage;
+	} else {
+		_extern._refCount = str._extern._refCount;
+		_extern._capacity = str._extern._capacity;
+		_str = str._str;
+
+		str._str = str._storage;
+	}
+
+	str._storage[0] = 0;
+	str._size = 0;
+}
+#endif
+
 String::String(char c)
     : _size(0), _str(_storage) {
 
@@ -149,6 +185,7 @@ void String::ensureCapacity(uint32 new_size, bool keep_old) {
 		// Allocate new storage
 		newStorage = new char[newCapacity];
 		assert(newStorage);
+		_heapAllocations++;
 	}
 
 	// Copy old data if needed, elsewise reset the new storage.
@@ -242,6 +279,17 @@ String &String::operator=(const String &str) {
 	return *this;
 }
 
+#if __cplusplus >= 201103L
+String &String::operator=(String &&str) {
+	if (&str == this)
+		return *this;
+
+	decRefCount(_extern._refCount);
+	moveFrom(str);
+	return *this;
+}
+#endif
+
 String &String::operator=(char c) {
 	decRefCount(_extern._refCount);
 	_str = _storage;
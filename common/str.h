@@ -27,6 +27,16 @@
 
 #include <stdarg.h>
 
+/**
+ * @def COMMON_STRING_SIZE
+ * The size in bytes of a String object, which determines how long a string
+ * may be before it is moved to the heap (see String::_builtinCapacity).
+ * Ports can override this from their build flags.
+ */
+#ifndef COMMON_STRING_SIZE
+#define COMMON_STRING_SIZE 32
+#endif
+
 namespace Common {
 
 /**
@@ -57,8 +67,14 @@ protected:
 	 * while 16 seems to be the lowest you want to go... Anything lower
 	 * than 8 makes no sense, since that's the size of member _extern
 	 * (on 32 bit machines; 12 bytes on systems with 64bit pointers).
+	 * The value is derived from COMMON_STRING_SIZE.
+	 */
+	static const uint32 _builtinCapacity = COMMON_STRING_SIZE - sizeof(uint32) - sizeof(char *);
+
+	/**
+	 * Number of heap buffers allocated for strings so far.
 	 */
-	static const uint32 _builtinCapacity = 32 - sizeof(uint32) - sizeof(char *);
+	static uint32 _heapAllocations;
 
 	/**
 	 * Length of the string. Stored to avoid having to call strlen
@@ -109,6 +125,11 @@ public:
 	/** Construct a copy of the given string. */
 	String(const String &str);
 
+#if __cplusplus >= 201103L
+	/** Construct a string by taking over the storage of the given string. */
+	String(String &&str);
+#endif
+
 	/** Construct a string consisting of the given character. */
 	explicit String(char c);
 
@@ -116,6 +137,9 @@ public:
 
 	String &operator=(const char *str);
 	String &operator=(const String &str);
+#if __cplusplus >= 201103L
+	String &operator=(String &&str);
+#endif
 	String &operator=(char c);
 	String &operator+=(const char *str);
 	String &operator+=(const String &str);
@@ -237,6 +261,13 @@ public:
 	 */
 	static String vformat(const char *fmt, va_list args);
 
+	/**
+	 * Return the number of heap buffers allocated by all String objects so
+	 * far. Comparing two values allows measuring the string churn of a
+	 * piece of code, e.g. a frame of an engine.
+	 */
+	static uint32 getHeapAllocationCount() { return _heapAllocations; }
+
 public:
 	typedef char          value_type;
 	/**
@@ -276,6 +307,9 @@ protected:
 	void incRefCount() const;
 	void decRefCount(int *oldRefCount);
 	void initWithCStr(const char *str, uint32 len);
+#if __cplusplus >= 201103L
+	void moveFrom(String &str);
+#endif
 };
 
 // Append two strings to form a new (temp) string
@@ -54,6 +54,17 @@ uint32 MemoryReadStream::read(void *dataPtr, uint32 dataSize) {
 	return dataSize;
 }
 
+const byte *MemoryReadStream::peekBuffer(uint32 size) {
+	if (size > _size - _pos)
+		return 0;
+
+	return _ptr;
+}
+
+void MemoryReadStream::releaseBuffer(const byte *buffer) {
+	// Nothing to do, the buffer points into our memory
+}
+
 bool MemoryReadStream::seek(int32 offs, int whence) {
 	// Pre-Condition
 	assert(_pos <= _size);
@@ -113,6 +124,30 @@ enum {
 	CR = 0x0D
 };
 
+const byte *SeekableReadStream::peekBuffer(uint32 size) {
+	int32 curPos = pos();
+	if (curPos < 0 || size > (uint32)(this->size() - curPos))
+		return 0;
+
+	byte *buffer = (byte *)malloc(size ? size : 1);
+	if (!buffer)
+		return 0;
+
+	uint32 got = read(buffer, size);
+	seek(curPos);
+
+	if (got != size) {
+		free(buffer);
+		return 0;
+	}
+
+	return buffer;
+}
+
+void SeekableReadStream::releaseBuffer(const byte *buffer) {
+	free(const_cast<byte *>(buffer));
+}
+
 char *SeekableReadStream::readLine(char *buf, size_t bufSize) {
 	assert(buf != 0 && bufSize > 1);
 	char *p = buf;
@@ -240,6 +275,17 @@ bool SeekableSubReadStream::seek(int32 offset, int whence) {
 	return ret;
 }
 
+const byte *SeekableSubReadStream::peekBuffer(uint32 size) {
+	if (size > _end - _pos)
+		return 0;
+
+	return _parentStream->peekBuffer(size);
+}
+
+void SeekableSubReadStream::releaseBuffer(const byte *buffer) {
+	_parentStream->releaseBuffer(buffer);
+}
+
 uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	// Make sure the parent stream is at the right position
 	seek(0, SEEK_CUR);
@@ -247,6 +293,13 @@ uint32 SafeSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return SeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+const byte *SafeSeekableSubReadStream::peekBuffer(uint32 size) {
+	// Make sure the parent stream is at the right position
+	seek(0, SEEK_CUR);
+
+	return SeekableSubReadStream::peekBuffer(size);
+}
+
 
 #pragma mark -
 
@@ -453,6 +453,28 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Gives read access to the next size bytes of the stream without
+	 * advancing the stream position. Streams which keep their data in
+	 * memory return a pointer into that memory, so the caller can parse
+	 * the data in place. All other streams fall back to reading the data
+	 * into a temporary buffer.
+	 *
+	 * The returned buffer must be handed back to releaseBuffer() before
+	 * the stream is modified in any other way or destroyed.
+	 *
+	 * @param size	the number of bytes to access
+	 * @return a pointer to the data, or 0 if fewer than size bytes remain
+	 */
+	virtual const byte *peekBuffer(uint32 size);
+
+	/**
+	 * Releases a buffer obtained from peekBuffer().
+	 *
+	 * @param buffer	the buffer returned by peekBuffer(), may be 0
+	 */
+	virtual void releaseBuffer(const byte *buffer);
+
 	/**
 	 * Reads at most one less than the number of characters specified
 	 * by bufSize from the and stores them in the string buf. Reading
@@ -77,6 +77,9 @@ public:
 	virtual int32 size() const { return _end - _begin; }
 
 	virtual bool seek(int32 offset, int whence = SEEK_SET);
+
+	virtual const byte *peekBuffer(uint32 size);
+	virtual void releaseBuffer(const byte *buffer);
 };
 
 /**
@@ -114,6 +117,7 @@ public:
 	}
 
 	virtual uint32 read(void *dataPtr, uint32 dataSize);
+	virtual const byte *peekBuffer(uint32 size);
 };
 
 
@@ -106,8 +106,11 @@ typedef struct {
 #include "common/fs.h"
 #include "common/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/zlib.h"
 
-#include "common/hashmap.h"
+#include "common/flathashmap.h"
 #include "common/hash-str.h"
 
 #if defined(STRICTUNZIP) || defined(STRICTZIPUNZIP)
@@ -375,13 +378,14 @@ typedef struct {
 	unz_file_info_internal cur_file_info_internal;	/* private info about it*/
 } cached_file_in_zip;
 
-typedef Common::HashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
+typedef Common::FlatHashMap<Common::String, cached_file_in_zip, Common::IgnoreCase_Hash,
 	Common::IgnoreCase_EqualTo> ZipHash;
 
 /* unz_s contain internal information about the zipfile
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* owner of _stream, shared with member streams */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -544,6 +548,7 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 	int err=UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::SeekableReadStream>(stream);
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos==0)
@@ -595,7 +600,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream) {
 		err=UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return NULL;
 	}
@@ -644,7 +648,6 @@ int unzClose(unzFile file) {
 	if (s->pfile_in_zip_read != NULL)
 		unzCloseCurrentFile(file);
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -1420,6 +1423,26 @@ int unzGetGlobalComment(unzFile file, char *szComment, uLong uSizeBuf) {
 namespace Common {
 
 
+enum {
+	// Deflated members smaller than this are decompressed into memory right
+	// away; for those the setup cost of a decompressing stream outweighs
+	// the benefit.
+	kMinStreamedMemberSize = 64 * 1024
+};
+
+/**
+ * Stream for reading a part of the ZIP archive directly. It keeps the
+ * archive's stream alive, so it stays valid after the archive is deleted.
+ */
+class ZipMemberReadStream : public SafeSeekableSubReadStream {
+	SharedPtr<SeekableReadStream> _archiveStream;
+
+public:
+	ZipMemberReadStream(const SharedPtr<SeekableReadStream> &archiveStream, uint32 begin, uint32 end)
+		: SafeSeekableSubReadStream(archiveStream.get(), begin, end), _archiveStream(archiveStream) {
+	}
+};
+
 class ZipArchive : public Archive {
 	unzFile _zipFile;
 
@@ -1496,6 +1519,25 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	if (unzGetCurrentFileInfo(_zipFile, &fileInfo, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
 		return 0;
 
+	// Stored members and big deflated members are read straight from the
+	// archive instead, so opening them costs nothing until they are read.
+	// Note that in this case the CRC of the member is not checked.
+	bool encrypted = (fileInfo.flag & 1) != 0;
+	if (!encrypted && (fileInfo.compression_method == 0 ||
+	    (fileInfo.compression_method == Z_DEFLATED && fileInfo.uncompressed_size >= kMinStreamedMemberSize))) {
+		const unz_s *const archive = (const unz_s *)_zipFile;
+		const file_in_zip_read_info_s *const member = archive->pfile_in_zip_read;
+		const uint32 begin = member->pos_in_zipfile + member->byte_before_the_zipfile;
+		const uint32 end = begin + fileInfo.compressed_size;
+		unzCloseCurrentFile(_zipFile);
+
+		SeekableReadStream *stream = new ZipMemberReadStream(archive->_streamRef, begin, end);
+		if (fileInfo.compression_method == 0)
+			return stream;
+
+		return wrapDeflateReadStream(stream, fileInfo.uncompressed_size);
+	}
+
 	byte *buffer = (byte *)malloc(fileInfo.uncompressed_size);
 	assert(buffer);
 
@@ -1510,11 +1552,6 @@ SeekableReadStream *ZipArchive::createReadStreamForMember(const String &name) co
 	}
 
 	return new MemoryReadStream(buffer, fileInfo.uncompressed_size, DisposeAfterUse::YES);
-
-	// FIXME: instead of reading all into a memory stream, we could
-	// instead create a new ZipStream class. But then we have to be
-	// careful to handle the case where the client code opens multiple
-	// files in the archive and tries to use them independently.
 }
 
 Archive *makeZipArchive(const String &name) {
@@ -24,6 +24,7 @@
 #define FORBIDDEN_SYMBOL_ALLOW_ALL
 
 #include "common/zlib.h"
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -146,14 +147,35 @@ static bool _shownBackwardSeekingWarning = false;
 #endif
 
 /**
- * A simple wrapper class which can be used to wrap around an arbitrary
- * other SeekableReadStream and will then provide on-the-fly decompression support.
- * Assumes the compressed data to be in gzip format.
+ * A wrapper class which provides on-the-fly decompression of deflate data
+ * read from an arbitrary other SeekableReadStream.
+ *
+ * Seeking backward normally has to restart decompression from the start of
+ * the data. When a checkpoint interval is given, the stream instead records
+ * a checkpoint at the first deflate block boundary after every interval of
+ * output while decompressing. Each checkpoint holds the position in the
+ * compressed data together with the dictionary at that point (up to 32 KB),
+ * so seeking only has to decompress the data following the closest
+ * checkpoint before the target.
+ *
+ * If the size of the decompressed data is known up front, reads stop there
+ * and seeks past it fail, even if the compressed data is corrupt. Without a
+ * known size (zlib data without a size passed along), the stream ends where
+ * the compressed data does.
  */
-class GZipReadStream : public SeekableReadStream {
+class DeflateReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// compressed input read at a time
+		WINSIZE = 32768
+	};
+
+	struct Checkpoint {
+		uint32 outPos;		///< position in the decompressed data
+		uint32 inPos;		///< position of the next byte in the wrapped stream
+		int bits;			///< unused bits of the byte before inPos
+		uInt windowSize;
+		byte *window;
 	};
 
 	byte	_buf[BUFSIZE];
@@ -161,40 +183,96 @@ protected:
 	ScopedPtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
 	int _zlibErr;
+	int _windowBits;
 	uint32 _pos;
-	uint32 _origSize;
+	uint32 _origSize;	///< 0 if unknown
 	bool _eos;
 
-public:
+	Array<Checkpoint> _checkpoints;
+	uint32 _checkpointInterval;
+	uint32 _nextCheckpoint;
 
-	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0) : _wrapped(w), _stream() {
-		assert(w != 0);
+	void addCheckpoint(uint32 outPos) {
+#if ZLIB_VERNUM >= 0x1271
+		// Only block boundaries which are not the end of the data can be
+		// used to resume decompression.
+		if (!_checkpointInterval || outPos < _nextCheckpoint ||
+		    !(_stream.data_type & 128) || (_stream.data_type & 64))
+			return;
 
-		// Verify file header is correct
-		w->seek(0, SEEK_SET);
-		uint16 header = w->readUint16BE();
-		assert(header == 0x1F8B ||
-		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+		Checkpoint checkpoint;
+		checkpoint.outPos = outPos;
+		checkpoint.inPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.windowSize = WINSIZE;
+		checkpoint.window = (byte *)malloc(WINSIZE);
+		if (!checkpoint.window)
+			return;
 
-		if (header == 0x1F8B) {
-			// Retrieve the original file size
-			w->seek(-4, SEEK_END);
-			_origSize = w->readUint32LE();
-		} else {
-			// Original size not available in zlib format
-			// use an otherwise known size if supplied.
-			_origSize = knownSize;
+		if (inflateGetDictionary(&_stream, checkpoint.window, &checkpoint.windowSize) != Z_OK) {
+			free(checkpoint.window);
+			return;
+		}
+
+		_checkpoints.push_back(checkpoint);
+		_nextCheckpoint = outPos + _checkpointInterval;
+#endif
+	}
+
+	const Checkpoint *findCheckpoint(uint32 pos) const {
+		const Checkpoint *best = 0;
+		for (uint i = 0; i < _checkpoints.size() && _checkpoints[i].outPos <= pos; ++i)
+			best = &_checkpoints[i];
+		return best;
+	}
+
+	bool restart(const Checkpoint *checkpoint) {
+#if ZLIB_VERNUM >= 0x1271
+		// Decompression resumes at a checkpoint without any header, so we
+		// have to switch between raw and the original mode here.
+		_zlibErr = inflateReset2(&_stream, checkpoint ? -MAX_WBITS : _windowBits);
+#else
+		_zlibErr = inflateReset(&_stream);
+#endif
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+
+		if (!checkpoint) {
+			_pos = 0;
+			return _wrapped->seek(0, SEEK_SET);
+		}
+
+		if (!_wrapped->seek(checkpoint->inPos - (checkpoint->bits ? 1 : 0), SEEK_SET))
+			return false;
+
+		if (checkpoint->bits) {
+			byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint->bits, partial >> (8 - checkpoint->bits));
+			if (_zlibErr != Z_OK)
+				return false;
 		}
-		_pos = 0;
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint->window, checkpoint->windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_pos = checkpoint->outPos;
+		return true;
+	}
+
+public:
+
+	DeflateReadStream(SeekableReadStream *w, uint32 size, int windowBits, uint32 checkpointInterval)
+		: _wrapped(w), _stream(), _windowBits(windowBits), _pos(0), _origSize(size), _eos(false),
+		  _checkpointInterval(checkpointInterval), _nextCheckpoint(checkpointInterval) {
+		assert(w != 0);
+
 		w->seek(0, SEEK_SET);
-		_eos = false;
 
-		// Adding 32 to windowBits indicates to zlib that it is supposed to
-		// automatically detect whether gzip or zlib headers are used for
-		// the compressed file. This feature was added in zlib 1.2.0.4,
-		// released 10 August 2003.
-		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_zlibErr = inflateInit2(&_stream, windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -203,8 +281,11 @@ public:
 		_stream.avail_in = 0;
 	}
 
-	~GZipReadStream() {
+	~DeflateReadStream() {
 		inflateEnd(&_stream);
+
+		for (uint i = 0; i < _checkpoints.size(); ++i)
+			free(_checkpoints[i].window);
 	}
 
 	bool err() const { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -214,23 +295,34 @@ public:
 	}
 
 	uint32 read(void *dataPtr, uint32 dataSize) {
+		if (_origSize && dataSize > _origSize - _pos) {
+			dataSize = _origSize - _pos;
+			_eos = true;
+		}
+
 		_stream.next_out = (byte *)dataPtr;
 		_stream.avail_out = dataSize;
 
-		// Keep going while we get no error
+		// Keep going while we get no error. With checkpoints enabled, we
+		// decompress block by block, so they can be placed on the block
+		// boundaries.
+		const int flush = _checkpointInterval ? Z_BLOCK : Z_NO_FLUSH;
 		while (_zlibErr == Z_OK && _stream.avail_out) {
 			if (_stream.avail_in == 0 && !_wrapped->eos()) {
 				// If we are out of input data: Read more data, if available.
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+			_zlibErr = inflate(&_stream, flush);
+			if (_zlibErr == Z_OK)
+				addCheckpoint(_pos + dataSize - _stream.avail_out);
 		}
 
 		// Update the position counter
 		_pos += dataSize - _stream.avail_out;
 
-		if (_zlibErr == Z_STREAM_END && _stream.avail_out > 0)
+		// Data which ends before its known size is truncated or corrupt
+		if (_stream.avail_out > 0 && (_origSize || _zlibErr == Z_STREAM_END))
 			_eos = true;
 
 		return dataSize - _stream.avail_out;
@@ -260,30 +352,27 @@ public:
 			break;
 		}
 
-		assert(newPos >= 0);
-
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
-			// from the start of the file. A rather wasteful operation, best
-			// to avoid it. :/
+		assert(newPos >= 0 && (!_origSize || (uint32)newPos <= _origSize));
 
+		// Restart from the closest checkpoint when seeking backward, or
+		// when a checkpoint lies between the current and the new position.
+		const Checkpoint *checkpoint = findCheckpoint(newPos);
+		if ((uint32)newPos < _pos || (checkpoint && checkpoint->outPos > _pos)) {
 #ifndef RELEASE_BUILD
-			if (!_shownBackwardSeekingWarning) {
-				// We only throw this warning once per stream, to avoid
-				// getting the console swarmed with warnings when consecutive
-				// seeks are made.
-				debug(1, "Backward seeking in GZipReadStream detected");
+			if (!checkpoint && !_shownBackwardSeekingWarning) {
+				// To search backward without a checkpoint, we have to
+				// restart the whole decompression from the start of the
+				// file. A rather wasteful operation, best to avoid it. :/
+				// We only throw this warning once, to avoid getting the
+				// console swarmed with warnings when consecutive seeks
+				// are made.
+				debug(1, "Backward seeking in DeflateReadStream detected");
 				_shownBackwardSeekingWarning = true;
 			}
 #endif
 
-			_pos = 0;
-			_wrapped->seek(0, SEEK_SET);
-			_zlibErr = inflateReset(&_stream);
-			if (_zlibErr != Z_OK)
-				return false;	// FIXME: STREAM REWRITE
-			_stream.next_in = _buf;
-			_stream.avail_in = 0;
+			if (!restart(checkpoint))
+				return false;
 		}
 
 		offset = newPos - _pos;
@@ -293,11 +382,54 @@ public:
 		// bytes, so this should be fine.
 		byte tmpBuf[1024];
 		while (!err() && offset > 0) {
-			offset -= read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
+			uint32 got = read(tmpBuf, MIN((int32)sizeof(tmpBuf), offset));
+			if (!got)
+				break;
+			offset -= got;
 		}
 
 		_eos = false;
-		return true;	// FIXME: STREAM REWRITE
+
+		// Without a known size, there is no telling whether the data was
+		// meant to end before the new position.
+		return offset == 0 || !_origSize;
+	}
+};
+
+/**
+ * A simple wrapper class which can be used to wrap around an arbitrary
+ * other SeekableReadStream and will then provide on-the-fly decompression support.
+ * Assumes the compressed data to be in gzip format.
+ */
+class GZipReadStream : public DeflateReadStream {
+	static uint32 getOrigSize(SeekableReadStream *w, uint32 knownSize) {
+		assert(w != 0);
+
+		// Verify file header is correct
+		w->seek(0, SEEK_SET);
+		uint16 header = w->readUint16BE();
+		assert(header == 0x1F8B ||
+		       ((header & 0x0F00) == 0x0800 && header % 31 == 0));
+
+		if (header == 0x1F8B) {
+			// Retrieve the original file size
+			w->seek(-4, SEEK_END);
+			return w->readUint32LE();
+		} else {
+			// Original size not available in zlib format
+			// use an otherwise known size if supplied.
+			return knownSize;
+		}
+	}
+
+public:
+	// Adding 32 to windowBits indicates to zlib that it is supposed to
+	// automatically detect whether gzip or zlib headers are used for
+	// the compressed file. This feature was added in zlib 1.2.0.4,
+	// released 10 August 2003.
+	// Note: This is *crucial* for savegame compatibility, do *not* remove!
+	GZipReadStream(SeekableReadStream *w, uint32 knownSize = 0, uint32 checkpointInterval = 0)
+		: DeflateReadStream(w, getOrigSize(w, knownSize), MAX_WBITS + 32, checkpointInterval) {
 	}
 };
 
@@ -409,7 +541,7 @@ public:
 
 #endif	// USE_ZLIB
 
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize) {
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize, uint32 checkpointInterval) {
 	if (toBeWrapped) {
 		uint16 header = toBeWrapped->readUint16BE();
 		bool isCompressed = (header == 0x1F8B ||
@@ -418,7 +550,7 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 		toBeWrapped->seek(-2, SEEK_CUR);
 		if (isCompressed) {
 #if defined(USE_ZLIB)
-			return new GZipReadStream(toBeWrapped, knownSize);
+			return new GZipReadStream(toBeWrapped, knownSize, checkpointInterval);
 #else
 			delete toBeWrapped;
 			return NULL;
@@ -428,6 +560,18 @@ SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, ui
 	return toBeWrapped;
 }
 
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize) {
+	if (toBeWrapped) {
+#if defined(USE_ZLIB)
+		// Negative MAX_WBITS tells zlib there's no zlib header
+		return new DeflateReadStream(toBeWrapped, uncompressedSize, -MAX_WBITS, 1024 * 1024);
+#else
+		delete toBeWrapped;
+#endif
+	}
+	return NULL;
+}
+
 WriteStream *wrapCompressedWriteStream(WriteStream *toBeWrapped) {
 #if defined(USE_ZLIB)
 	if (toBeWrapped)
@@ -112,13 +112,37 @@ bool inflateZlibInstallShield(byte *dst, uint dstLen, const byte *src, uint srcL
  * the decompressed length at wrap-time, then it can be supplied as knownSize
  * here. knownSize will be ignored if the GZip-stream DOES include a length.
  *
+ * Seeking backward in the wrapped stream normally restarts the decompression
+ * from the start. If checkpointInterval is not 0, the stream instead records
+ * a checkpoint roughly every checkpointInterval bytes of decompressed data
+ * while reading, so that a seek only has to decompress the data after the
+ * closest checkpoint. Each checkpoint takes up to 32 KB of memory.
+ *
+ * It is safe to call this with a NULL parameter (in this case, NULL is
+ * returned).
+ *
+ * @param toBeWrapped			the stream to be wrapped (if it is in gzip-format)
+ * @param knownSize				a supplied length of the compressed data (if not available directly)
+ * @param checkpointInterval	distance between seek checkpoints in bytes, 0 to disable them
+ */
+SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0, uint32 checkpointInterval = 0);
+
+/**
+ * Take an arbitrary SeekableReadStream holding raw deflate data, i.e. data
+ * compressed with deflate but *without* zlib or gzip header as found in ZIP
+ * archives, and wrap it in a custom stream which provides transparent
+ * on-the-fly decompression. Seeking is supported; the stream records a
+ * checkpoint every 1 MB of decompressed data, so seeking does not have to
+ * restart decompression from the beginning of the data.
+ *
+ * If there is no ZLIB support, NULL is returned and the stream is destroyed.
  * It is safe to call this with a NULL parameter (in this case, NULL is
  * returned).
  *
- * @param toBeWrapped	the stream to be wrapped (if it is in gzip-format)
- * @param knownSize		a supplied length of the compressed data (if not available directly)
+ * @param toBeWrapped		the stream holding the compressed data
+ * @param uncompressedSize	the size of the decompressed data
  */
-SeekableReadStream *wrapCompressedReadStream(SeekableReadStream *toBeWrapped, uint32 knownSize = 0);
+SeekableReadStream *wrapDeflateReadStream(SeekableReadStream *toBeWrapped, uint32 uncompressedSize);
 
 /**
  * Take an arbitrary WriteStream and wrap it in a custom stream which provides
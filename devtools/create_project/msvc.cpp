@@ -147,11 +147,7 @@ void MSVCProvider::createGlobalProp(const BuildSetup &setup) {
 	if (!properties)
 		error("Could not open \"" + setup.outputDir + '/' + setup.projectDescription + "_Global64" + getPropertiesExtension() + "\" for writing");
 
-	// HACK: We must disable the "nasm" feature for x64. To achieve that we must duplicate the feature list and
-	// recreate a define list.
-	FeatureList x64Features = setup.features;
-	setFeatureBuildState("nasm", x64Features, false);
-	StringList x64Defines = getFeatureDefines(x64Features);
+	StringList x64Defines = getFeatureDefines(setup.features);
 	StringList x64EngineDefines = getEngineDefines(setup.engines);
 	x64Defines.splice(x64Defines.end(), x64EngineDefines);
 
@@ -92,9 +92,6 @@ void VisualStudioProvider::createProjectFile(const std::string &name, const std:
 		outputConfiguration(project, setup, libraries, "Release", "Win32", "", true);
 
 		// x64
-		// For 'x64' we must disable NASM support. Usually we would need to disable the "nasm" feature for that and
-		// re-create the library list, BUT since NASM doesn't link any additional libraries, we can just use the
-		// libraries list created for IA-32. If that changes in the future, we need to adjust this part!
 		outputConfiguration(project, setup, libraries, "Debug", "x64", "64", false);
 		outputConfiguration(project, setup, libraries, "Analysis", "x64", "64", false);
 		outputConfiguration(project, setup, libraries, "LLVM", "Win32", "64", false);
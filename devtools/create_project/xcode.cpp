@@ -1030,12 +1030,8 @@ void XcodeProvider::setupAdditionalSources(std::string targetName, Property &fil
 // Setup global defines
 void XcodeProvider::setupDefines(const BuildSetup &setup) {
 
-	for (StringList::const_iterator i = setup.defines.begin(); i != setup.defines.end(); ++i) {
-		if (*i == "HAVE_NASM")  // Not supported on Mac (TODO: change how it's handled in main class or add it only in MSVC/CodeBlocks providers?)
-			continue;
-
+	for (StringList::const_iterator i = setup.defines.begin(); i != setup.defines.end(); ++i)
 		ADD_DEFINE(_defines, *i);
-	}
 	// Add special defines for Mac support
 	REMOVE_DEFINE(_defines, "MACOSX");
 	REMOVE_DEFINE(_defines, "IPHONE");
@@ -27,7 +27,6 @@ BuildRequires: libogg-devel
 BuildRequires: libvorbis-devel
 BuildRequires: flac-devel
 BuildRequires: zlib-devel
-BuildRequires: nasm
 BuildRequires: SDL-devel >= 1.2.2
 BuildRequires: freetype-devel
 
@@ -31,6 +31,7 @@
 #include "common/translation.h"
 #include "gui/EventRecorder.h"
 #include "engines/advancedDetector.h"
+#include "engines/detectioncache.h"
 #include "engines/obsolete.h"
 
 static GameDescriptor toGameDescriptor(const ADGameDescription &g, const PlainGameDescriptor *sg) {
@@ -390,26 +391,41 @@ bool AdvancedMetaEngine::getFileProperties(const Common::FSNode &parent, const F
 	// file and as one with resource fork.
 
 	if (game.flags & ADGF_MACRESFORK) {
+		Common::String path = parent.getChild(fname).getPath();
+
+		if (DetectionCacheMan.lookupVerified(path, _md5Bytes, true, fileProps.size, fileProps.md5))
+			return true;
+
 		Common::MacResManager macResMan;
 
 		if (!macResMan.open(parent, fname))
 			return false;
 
-		fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
 		fileProps.size = macResMan.getResForkDataSize();
+		if (!DetectionCacheMan.lookup(path, _md5Bytes, true, fileProps.size, fileProps.md5)) {
+			fileProps.md5 = macResMan.computeResForkMD5AsString(_md5Bytes);
+			DetectionCacheMan.store(path, _md5Bytes, true, fileProps.size, fileProps.md5);
+		}
 		return true;
 	}
 
 	if (!allFiles.contains(fname))
 		return false;
 
+	const Common::FSNode &node = allFiles[fname];
+	if (DetectionCacheMan.lookupVerified(node.getPath(), _md5Bytes, false, fileProps.size, fileProps.md5))
+		return true;
+
 	Common::File testFile;
 
-	if (!testFile.open(allFiles[fname]))
+	if (!testFile.open(node))
 		return false;
 
 	fileProps.size = (int32)testFile.size();
-	fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+	if (!DetectionCacheMan.lookup(node.getPath(), _md5Bytes, false, fileProps.size, fileProps.md5)) {
+		fileProps.md5 = Common::computeStreamMD5AsString(testFile, _md5Bytes);
+		DetectionCacheMan.store(node.getPath(), _md5Bytes, false, fileProps.size, fileProps.md5);
+	}
 	return true;
 }
 
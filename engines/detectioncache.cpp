@@ -0,0 +1,218 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "engines/detectioncache.h"
+
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/debug.h"
+#include "common/savefile.h"
+#include "common/system.h"
+
+namespace Common {
+DECLARE_SINGLETON(DetectionCache);
+}
+
+static const char *const kCacheFileName = "detection.cache";
+static const char *const kCacheHeader = "ScummVM detection cache v1";
+
+DetectionCache::DetectionCache() : _pass(0), _loaded(false), _dirty(false) {
+	resetStats();
+}
+
+DetectionCache::~DetectionCache() {
+}
+
+Common::String DetectionCache::makeKey(const Common::String &path, uint32 md5Bytes, bool resFork) {
+	return Common::String::format("%c:%u:", resFork ? 'r' : 'f', md5Bytes) + path;
+}
+
+bool DetectionCache::isPersistent() const {
+	return ConfMan.getBool("detection_cache") && g_system && g_system->getSavefileManager();
+}
+
+void DetectionCache::beginPass() {
+	if (!_loaded)
+		load();
+
+	_pass++;
+}
+
+bool DetectionCache::lookupVerified(const Common::String &path, uint32 md5Bytes, bool resFork, int32 &size, Common::String &md5) {
+	EntryMap::const_iterator i = _entries.find(makeKey(path, md5Bytes, resFork));
+	if (i == _entries.end() || i->_value.pass != _pass)
+		return false;
+
+	_stats.hits++;
+	size = i->_value.size;
+	md5 = i->_value.md5;
+	return true;
+}
+
+bool DetectionCache::lookup(const Common::String &path, uint32 md5Bytes, bool resFork, int32 size, Common::String &md5) {
+	EntryMap::iterator i = _entries.find(makeKey(path, md5Bytes, resFork));
+	if (i == _entries.end()) {
+		_stats.misses++;
+		return false;
+	}
+
+	// Without the disk cache, there is no need to trust entries of earlier
+	// passes: the file may have been changed in place since then.
+	if (i->_value.pass != _pass && !isPersistent()) {
+		_entries.erase(i);
+		_stats.misses++;
+		return false;
+	}
+
+	if (i->_value.size != size) {
+		debug(3, "DetectionCache: '%s' changed size, dropping entry", path.c_str());
+		_entries.erase(i);
+		_dirty = true;
+		_stats.invalidated++;
+		_stats.misses++;
+		return false;
+	}
+
+	_stats.hits++;
+	i->_value.pass = _pass;
+	md5 = i->_value.md5;
+	return true;
+}
+
+void DetectionCache::store(const Common::String &path, uint32 md5Bytes, bool resFork, int32 size, const Common::String &md5) {
+	Entry &entry = _entries[makeKey(path, md5Bytes, resFork)];
+	entry.path = path;
+	entry.md5Bytes = md5Bytes;
+	entry.resFork = resFork;
+	entry.size = size;
+	entry.md5 = md5;
+	entry.pass = _pass;
+	_dirty = true;
+}
+
+void DetectionCache::invalidate(const Common::String &path) {
+	Common::Array<Common::String> stale;
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		if (i->_value.path == path)
+			stale.push_back(i->_key);
+	}
+
+	for (uint i = 0; i < stale.size(); i++)
+		_entries.erase(stale[i]);
+
+	if (!stale.empty()) {
+		_stats.invalidated += stale.size();
+		_dirty = true;
+	}
+}
+
+void DetectionCache::clear() {
+	_entries.clear();
+	_dirty = false;
+
+	if (g_system && g_system->getSavefileManager())
+		g_system->getSavefileManager()->removeSavefile(kCacheFileName);
+}
+
+void DetectionCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.invalidated = 0;
+}
+
+void DetectionCache::load() {
+	_loaded = true;
+
+	if (!isPersistent())
+		return;
+
+	Common::InSaveFile *in = g_system->getSavefileManager()->openForLoading(kCacheFileName);
+	if (!in)
+		return;
+
+	if (in->readLine() != kCacheHeader) {
+		warning("DetectionCache: Ignoring '%s' with unknown format", kCacheFileName);
+		delete in;
+		return;
+	}
+
+	// Each line holds: <f|r> <md5 bytes> <size> <md5> <path>
+	while (!in->eos() && !in->err()) {
+		Common::String line = in->readLine();
+		if (line.empty())
+			continue;
+
+		char kind;
+		uint md5Bytes;
+		int size;
+		char md5[33];
+		int pathStart = 0;
+
+		if (sscanf(line.c_str(), "%c %u %d %32s %n", &kind, &md5Bytes, &size, md5, &pathStart) != 4 || !pathStart)
+			continue;
+
+		Entry entry;
+		entry.path = line.c_str() + pathStart;
+		entry.md5Bytes = md5Bytes;
+		entry.resFork = (kind == 'r');
+		entry.size = size;
+		entry.md5 = md5;
+		entry.pass = 0;
+		_entries[makeKey(entry.path, entry.md5Bytes, entry.resFork)] = entry;
+	}
+
+	delete in;
+
+	debug(2, "DetectionCache: Loaded %u entries", (uint)_entries.size());
+}
+
+void DetectionCache::flush() {
+	if (!_dirty || !isPersistent())
+		return;
+
+	Common::OutSaveFile *out = g_system->getSavefileManager()->openForSaving(kCacheFileName, false);
+	if (!out) {
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+		return;
+	}
+
+	out->writeString(kCacheHeader);
+	out->writeByte('\n');
+
+	for (EntryMap::const_iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		const Entry &entry = i->_value;
+		out->writeString(Common::String::format("%c %u %d %s ", entry.resFork ? 'r' : 'f', entry.md5Bytes, entry.size, entry.md5.c_str()));
+		out->writeString(entry.path);
+		out->writeByte('\n');
+	}
+
+	out->finalize();
+	if (out->err())
+		warning("DetectionCache: Could not write '%s'", kCacheFileName);
+	else
+		_dirty = false;
+
+	delete out;
+
+	debug(2, "DetectionCache: %u hits, %u misses, %u invalidated", _stats.hits, _stats.misses, _stats.invalidated);
+}
@@ -0,0 +1,118 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef ENGINES_DETECTIONCACHE_H
+#define ENGINES_DETECTIONCACHE_H
+
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+#include "common/singleton.h"
+#include "common/str.h"
+
+/**
+ * Cache for the file properties (size and MD5) computed by the
+ * AdvancedDetector.
+ *
+ * All engines share one instance, so a file probed by several engines
+ * during one detection pass is only read once. When the "detection_cache"
+ * config key is set, the cache is additionally kept on disk between runs.
+ *
+ * Entries are keyed by the path of the file, the number of bytes hashed and
+ * whether the MD5 was taken from the resource fork. When the cache is kept
+ * on disk, entries carried over from a previous pass are reused when the
+ * size of the file is still the same; anything else invalidates them.
+ * Otherwise only entries of the current pass are reused.
+ */
+class DetectionCache : public Common::Singleton<DetectionCache> {
+public:
+	struct Stats {
+		uint32 hits;          ///< Lookups answered from the cache
+		uint32 misses;        ///< Lookups which required computing the MD5
+		uint32 invalidated;   ///< Entries dropped because the file changed
+	};
+
+	/**
+	 * Start a new detection pass. Entries stored or verified during the
+	 * current pass are trusted without checking the file again.
+	 */
+	void beginPass();
+
+	/**
+	 * Look up an entry which was already verified during the current pass.
+	 * This does not require the file to be opened.
+	 */
+	bool lookupVerified(const Common::String &path, uint32 md5Bytes, bool resFork, int32 &size, Common::String &md5);
+
+	/**
+	 * Look up an entry, verifying it against the current size of the file.
+	 * A stale entry is dropped and counted as invalidated. Without the disk
+	 * cache, entries of earlier passes are dropped as well.
+	 */
+	bool lookup(const Common::String &path, uint32 md5Bytes, bool resFork, int32 size, Common::String &md5);
+
+	/** Record the properties of a file computed by the detector. */
+	void store(const Common::String &path, uint32 md5Bytes, bool resFork, int32 size, const Common::String &md5);
+
+	/** Drop all entries for the given path. */
+	void invalidate(const Common::String &path);
+
+	/** Drop all entries, both in memory and on disk. */
+	void clear();
+
+	/** Write the cache to disk, if persistence is enabled and it changed. */
+	void flush();
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	friend class Common::Singleton<SingletonBaseType>;
+	DetectionCache();
+	~DetectionCache();
+
+	struct Entry {
+		Common::String path;
+		uint32 md5Bytes;
+		bool resFork;
+		int32 size;
+		Common::String md5;
+		uint32 pass;
+	};
+
+	typedef Common::HashMap<Common::String, Entry> EntryMap;
+
+	static Common::String makeKey(const Common::String &path, uint32 md5Bytes, bool resFork);
+
+	bool isPersistent() const;
+	void load();
+
+	EntryMap _entries;
+	Stats _stats;
+	uint32 _pass;
+	bool _loaded;
+	bool _dirty;
+};
+
+/** Shortcut for accessing the detection cache. */
+#define DetectionCacheMan DetectionCache::instance()
+
+#endif
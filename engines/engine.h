@@ -149,7 +149,8 @@ public:
 	 * Init SearchMan according to the game path.
 	 *
 	 * By default it adds the directory in non-flat mode with a depth of 4 as
-	 * priority 0 to SearchMan.
+	 * priority 0 to SearchMan. Its files are mapped into memory when the
+	 * "mmap_files" config key is set.
 	 *
 	 * @param gamePath The base directory of the game data.
 	 */
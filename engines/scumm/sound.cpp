@@ -37,6 +37,7 @@
 #include "scumm/sound.h"
 
 #include "audio/audiostream.h"
+#include "audio/samplecache.h"
 #include "audio/timestamp.h"
 #include "audio/decoders/flac.h"
 #include "audio/mididrv.h"
@@ -55,6 +56,11 @@ struct MP3OffsetTable {					/* Compressed Sound (.SO3) */
 	int compressed_size;
 };
 
+enum {
+	/** The memory for decoded speech, about a minute and a half at 22 kHz. */
+	kSpeechCacheBytes = 4 * 1024 * 1024
+};
+
 
 Sound::Sound(ScummEngine *parent, Audio::Mixer *mixer)
 	:
@@ -66,6 +72,7 @@ Sound::Sound(ScummEngine *parent, Audio::Mixer *mixer)
 	_sfxFileEncByte(0),
 	_offsetTable(0),
 	_numSoundEffects(0),
+	_speechCache(0),
 	_soundMode(kVOCMode),
 	_talk_sound_a1(0),
 	_talk_sound_a2(0),
@@ -103,6 +110,7 @@ Sound::~Sound() {
 	stopCDTimer();
 	stopCD();
 	free(_offsetTable);
+	delete _speechCache;
 }
 
 void Sound::addSoundToQueue(int sound, int heOffset, int heChannel, int heFlags) {
@@ -618,27 +626,11 @@ void Sound::startTalkSound(uint32 offset, uint32 b, int mode, Audio::SoundHandle
 
 		switch (_soundMode) {
 		case kMP3Mode:
-#ifdef USE_MAD
-			{
-			assert(size > 0);
-			input = Audio::makeMP3Stream(new Common::SeekableSubReadStream(file.release(), offset, offset + size, DisposeAfterUse::YES), DisposeAfterUse::YES);
-			}
-#endif
-			break;
 		case kVorbisMode:
-#ifdef USE_VORBIS
-			{
-			assert(size > 0);
-			input = Audio::makeVorbisStream(new Common::SeekableSubReadStream(file.release(), offset, offset + size, DisposeAfterUse::YES), DisposeAfterUse::YES);
-			}
-#endif
-			break;
 		case kFLACMode:
-#ifdef USE_FLAC
-			{
+#if defined(USE_FLAC) || defined(USE_VORBIS) || defined(USE_MAD)
 			assert(size > 0);
-			input = Audio::makeFLACStream(new Common::SeekableSubReadStream(file.release(), offset, offset + size, DisposeAfterUse::YES), DisposeAfterUse::YES);
-			}
+			input = makeCompressedTalkStream(file.release(), offset, size);
 #endif
 			break;
 		default:
@@ -666,6 +658,58 @@ void Sound::startTalkSound(uint32 offset, uint32 b, int mode, Audio::SoundHandle
 	}
 }
 
+Audio::AudioStream *Sound::makeCompressedStream(Common::SeekableReadStream *file, uint32 offset, int size) {
+	Common::SeekableReadStream *stream = new Common::SeekableSubReadStream(file, offset, offset + size, DisposeAfterUse::YES);
+
+	switch (_soundMode) {
+#ifdef USE_MAD
+	case kMP3Mode:
+		return Audio::makeMP3Stream(stream, DisposeAfterUse::YES);
+#endif
+#ifdef USE_VORBIS
+	case kVorbisMode:
+		return Audio::makeVorbisStream(stream, DisposeAfterUse::YES);
+#endif
+#ifdef USE_FLAC
+	case kFLACMode:
+		return Audio::makeFLACStream(stream, DisposeAfterUse::YES);
+#endif
+	default:
+		delete stream;
+		return NULL;
+	}
+}
+
+/*
+ * Lines which were said before are played from their decoded samples, if
+ * they are still cached. New lines are played as usual, and also decoded
+ * in the background from a file of their own, since many lines, like the
+ * replies to using things, are said again and again.
+ */
+Audio::AudioStream *Sound::makeCompressedTalkStream(Common::SeekableReadStream *file, uint32 offset, int size) {
+	if (!_speechCache)
+		return makeCompressedStream(file, offset, size);
+
+	const Common::String key = Common::String::format("%s:%u", _sfxFilename.c_str(), offset);
+	Audio::AudioStream *input = _speechCache->getStream(key);
+	if (input) {
+		delete file;
+		return input;
+	}
+
+	ScummFile *prefetchFile = new ScummFile();
+	if (_vm->openFile(*prefetchFile, _sfxFilename)) {
+		prefetchFile->setEnc(_sfxFileEncByte);
+		Audio::AudioStream *prefetch = makeCompressedStream(prefetchFile, offset, size);
+		if (prefetch)
+			_speechCache->prefetch(key, prefetch);
+	} else {
+		delete prefetchFile;
+	}
+
+	return makeCompressedStream(file, offset, size);
+}
+
 void Sound::stopTalkSound() {
 	if (_sfxMode & 2) {
 		if (_vm->_imuseDigital) {
@@ -967,6 +1011,9 @@ void Sound::setupSfxFile() {
 	}
 
 	if (_soundMode != kVOCMode) {
+		delete _speechCache;
+		_speechCache = new Audio::DecodedSampleCache(kSpeechCacheBytes, _vm->getTimerManager());
+
 		/* Now load the 'offset' index in memory to be able to find the MP3 data
 
 		   The format of the .SO3 file is easy :
@@ -30,6 +30,14 @@
 #include "backends/audiocd/audiocd.h"
 #include "scumm/saveload.h"
 
+namespace Audio {
+class DecodedSampleCache;
+}
+
+namespace Common {
+class SeekableReadStream;
+}
+
 namespace Scumm {
 
 class ScummEngine;
@@ -70,6 +78,7 @@ protected:
 	SoundMode _soundMode;
 	MP3OffsetTable *_offsetTable;	// For compressed audio
 	int _numSoundEffects;		// For compressed audio
+	Audio::DecodedSampleCache *_speechCache;	// For compressed audio
 
 	uint32 _talk_sound_a1, _talk_sound_a2, _talk_sound_b1, _talk_sound_b2;
 	byte _talk_sound_mode, _talk_sound_channel;
@@ -130,6 +139,8 @@ public:
 
 protected:
 	void setupSfxFile();
+	Audio::AudioStream *makeCompressedStream(Common::SeekableReadStream *file, uint32 offset, int size);
+	Audio::AudioStream *makeCompressedTalkStream(Common::SeekableReadStream *file, uint32 offset, int size);
 	bool isSfxFinished() const;
 	void processSfxQueues();
 
@@ -271,7 +271,7 @@ Graphics::PixelFormat BaseRenderOSystem::getPixelFormat() const {
 void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct &transform) {
 
 	if (_disableDirtyRects) {
-		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+		RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, &_transformCache);
 		ticket->_wantsDraw = true;
 		_renderQueue.push_back(ticket);
 		drawFromSurface(ticket);
@@ -303,7 +303,7 @@ void BaseRenderOSystem::drawSurface(BaseSurfaceOSystem *owner, const Graphics::S
 			}
 		}
 	}
-	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform);
+	RenderTicket *ticket = new RenderTicket(owner, surf, srcRect, dstRect, transform, &_transformCache);
 	if (!_disableDirtyRects) {
 		drawFromTicket(ticket);
 	} else {
@@ -319,6 +319,10 @@ void BaseRenderOSystem::invalidateTicket(RenderTicket *renderTicket) {
 //	renderTicket->_canDelete = true; // TODO: Maybe readd this, to avoid even more duplicates.
 }
 
+void BaseRenderOSystem::invalidateTransformCache(const Graphics::Surface &surf) {
+	_transformCache.invalidate(surf);
+}
+
 void BaseRenderOSystem::invalidateTicketsFromSurface(BaseSurfaceOSystem *surf) {
 	RenderQueueIterator it;
 	for (it = _renderQueue.begin(); it != _renderQueue.end(); ++it) {
@@ -54,7 +54,9 @@ BaseSurfaceOSystem::BaseSurfaceOSystem(BaseGame *inGame) : BaseSurface(inGame) {
 
 //////////////////////////////////////////////////////////////////////////
 BaseSurfaceOSystem::~BaseSurfaceOSystem() {
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	if (_surface) {
+		renderer->invalidateTransformCache(*_surface);
 		_surface->free();
 		delete _surface;
 		_surface = nullptr;
@@ -64,7 +66,6 @@ BaseSurfaceOSystem::~BaseSurfaceOSystem() {
 	_alphaMask = nullptr;
 
 	_gameRef->addMem(-_width * _height * 4);
-	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
 }
 
@@ -146,6 +147,7 @@ bool BaseSurfaceOSystem::finishLoad() {
 		// FIBITMAP *newImg = FreeImage_ConvertToGreyscale(img); TODO
 	}
 
+	static_cast<BaseRenderOSystem *>(_gameRef->_renderer)->invalidateTransformCache(*_surface);
 	_surface->free();
 	delete _surface;
 
@@ -317,6 +319,7 @@ bool BaseSurfaceOSystem::startPixelOp() {
 	// Any pixel-op makes the caching useless:
 	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
+	renderer->invalidateTransformCache(*_surface);
 	return STATUS_OK;
 }
 
@@ -442,6 +445,9 @@ bool BaseSurfaceOSystem::drawSprite(int x, int y, Rect32 *rect, Rect32 *newRect,
 }
 
 bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAlpha) {
+	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
+	renderer->invalidateTransformCache(*_surface);
+
 	_loaded = true;
 	if (surface.format == _surface->format && surface.pitch == _surface->pitch && surface.h == _surface->h) {
 		const byte *src = (const byte *)surface.getBasePtr(0, 0);
@@ -456,7 +462,6 @@ bool BaseSurfaceOSystem::putSurface(const Graphics::Surface &surface, bool hasAl
 	} else {
 		_alphaType = Graphics::ALPHA_OPAQUE;
 	}
-	BaseRenderOSystem *renderer = static_cast<BaseRenderOSystem *>(_gameRef->_renderer);
 	renderer->invalidateTicketsFromSurface(this);
 
 	return STATUS_OK;
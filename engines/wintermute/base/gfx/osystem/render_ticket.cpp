@@ -29,59 +29,60 @@
 
 #include "engines/wintermute/base/gfx/osystem/render_ticket.h"
 #include "engines/wintermute/base/gfx/osystem/base_surface_osystem.h"
+#include "graphics/transform_cache.h"
 #include "graphics/transform_tools.h"
 #include "common/textconsole.h"
 
 namespace Wintermute {
 
-RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform) :
+RenderTicket::RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRect, Graphics::TransformStruct transform, Graphics::TransformCache *cache) :
 	_owner(owner),
 	_srcRect(*srcRect),
 	_dstRect(*dstRect),
 	_isValid(true),
 	_wantsDraw(true),
 	_transform(transform) {
-	if (surf) {
-		_surface = new Graphics::Surface();
-		_surface->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
-		assert(_surface->format.bytesPerPixel == 4);
-		// Get a clipped copy of the surface
-		for (int i = 0; i < _surface->h; i++) {
-			memcpy(_surface->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * _surface->format.bytesPerPixel);
-		}
-		// Then scale it if necessary
-		//
-		// NB: The numTimesX/numTimesY properties don't yet mix well with
-		// scaling and rotation, but there is no need for that functionality at
-		// the moment.
-		// NB: Mirroring and rotation are probably done in the wrong order.
-		// (Mirroring should most likely be done before rotation. See also
-		// TransformTools.)
-		if (_transform._angle != Graphics::kDefaultAngle) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.rotoscale(transform);
-			_surface->free();
-			delete _surface;
-			_surface = temp;
-		} else if ((dstRect->width() != srcRect->width() ||
-					dstRect->height() != srcRect->height()) &&
-					_transform._numTimesX * _transform._numTimesY == 1) {
-			Graphics::TransparentSurface src(*_surface, false);
-			Graphics::Surface *temp = src.scale(dstRect->width(), dstRect->height());
-			_surface->free();
-			delete _surface;
-			_surface = temp;
-		}
-	} else {
-		_surface = nullptr;
+	if (!surf)
+		return;
+
+	// NB: The numTimesX/numTimesY properties don't yet mix well with
+	// scaling and rotation, but there is no need for that functionality at
+	// the moment.
+	// NB: Mirroring and rotation are probably done in the wrong order.
+	// (Mirroring should most likely be done before rotation. See also
+	// TransformTools.)
+	const bool rotate = _transform._angle != Graphics::kDefaultAngle;
+	const bool scale = !rotate &&
+	                   (dstRect->width() != srcRect->width() || dstRect->height() != srcRect->height()) &&
+	                   _transform._numTimesX * _transform._numTimesY == 1;
+
+	if ((rotate || scale) && cache) {
+		// The transformed surface is already a copy, which the cache can
+		// hand out again as long as the source does not change
+		assert(surf->format.bytesPerPixel == 4);
+		_surface = cache->get(*surf, *srcRect, transform, dstRect->width(), dstRect->height());
+		return;
 	}
+
+	Graphics::Surface *copy = new Graphics::Surface();
+	copy->create((uint16)srcRect->width(), (uint16)srcRect->height(), surf->format);
+	assert(copy->format.bytesPerPixel == 4);
+	// Get a clipped copy of the surface
+	for (int i = 0; i < copy->h; i++) {
+		memcpy(copy->getBasePtr(0, i), surf->getBasePtr(srcRect->left, srcRect->top + i), srcRect->width() * copy->format.bytesPerPixel);
+	}
+	// Then scale it if necessary
+	if (rotate || scale) {
+		Graphics::TransparentSurface src(*copy, false);
+		Graphics::Surface *temp = rotate ? src.rotoscale(transform) : src.scale(dstRect->width(), dstRect->height());
+		copy->free();
+		delete copy;
+		copy = temp;
+	}
+	_surface = Common::SharedPtr<Graphics::Surface>(copy, Graphics::SharedPtrSurfaceDeleter());
 }
 
 RenderTicket::~RenderTicket() {
-	if (_surface) {
-		_surface->free();
-		delete _surface;
-	}
 }
 
 bool RenderTicket::operator==(const RenderTicket &t) const {
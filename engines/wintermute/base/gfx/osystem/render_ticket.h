@@ -31,8 +31,13 @@
 
 #include "graphics/transparent_surface.h"
 #include "graphics/surface.h"
+#include "common/ptr.h"
 #include "common/rect.h"
 
+namespace Graphics {
+class TransformCache;
+}
+
 namespace Wintermute {
 
 class BaseSurfaceOSystem;
@@ -48,13 +53,16 @@ class BaseSurfaceOSystem;
  * (Video-surfaces may even change their data). The promise that is made when a ticket
  * is created is that what the state was of the surface at THAT point, is what will end
  * up on screen at flip() time.
+ *
+ * Scaled and rotated copies are taken from a TransformCache when one is given,
+ * since a ticket is recreated with the same arguments every frame.
  */
 class RenderTicket {
 public:
-	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, Graphics::TransformStruct transform);
+	RenderTicket(BaseSurfaceOSystem *owner, const Graphics::Surface *surf, Common::Rect *srcRect, Common::Rect *dstRest, Graphics::TransformStruct transform, Graphics::TransformCache *cache = nullptr);
 	RenderTicket() : _isValid(true), _wantsDraw(false), _transform(Graphics::TransformStruct()) {}
 	~RenderTicket();
-	const Graphics::Surface *getSurface() const { return _surface; }
+	const Graphics::Surface *getSurface() const { return _surface.get(); }
 	// Non-dirty-rects:
 	void drawToSurface(Graphics::Surface *_targetSurface) const;
 	// Dirty-rects:
@@ -71,7 +79,7 @@ public:
 	bool operator==(const RenderTicket &a) const;
 	const Common::Rect *getSrcRect() const { return &_srcRect; }
 private:
-	Graphics::Surface *_surface;
+	Common::SharedPtr<Graphics::Surface> _surface;
 	Common::Rect _srcRect;
 };
 
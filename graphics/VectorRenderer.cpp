@@ -33,7 +33,12 @@ namespace Graphics {
  * DRAWSTEP handling functions
  ********************************************************************/
 void VectorRenderer::drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra) {
+	applyStepState(step, extra);
 
+	(this->*(step.drawingCall))(area, step);
+}
+
+void VectorRenderer::applyStepState(const DrawStep &step, uint32 extra) {
 	if (step.bgColor.set)
 		setBgColor(step.bgColor.r, step.bgColor.g, step.bgColor.b);
 
@@ -54,8 +59,6 @@ void VectorRenderer::drawStep(const Common::Rect &area, const DrawStep &step, ui
 	setFillMode((FillMode)step.fillMode);
 
 	_dynamicData = extra;
-
-	(this->*(step.drawingCall))(area, step);
 }
 
 int VectorRenderer::stepGetRadius(const DrawStep &step, const Common::Rect &area) {
@@ -273,6 +273,11 @@ public:
 		_activeSurface = surface;
 	}
 
+	/**
+	 * Returns the surface which is currently drawn on.
+	 */
+	Surface *getActiveSurface() const { return _activeSurface; }
+
 	/**
 	 * Fills the active surface with the specified fg/bg color or the active gradient.
 	 * Defaults to using the active Foreground color for filling.
@@ -427,6 +432,24 @@ public:
 	 */
 	virtual void drawStep(const Common::Rect &area, const DrawStep &step, uint32 extra = 0);
 
+	/**
+	 * Sets the colors and drawing parameters of a draw step, just like
+	 * drawStep() does before drawing it, but does not draw anything.
+	 */
+	void applyStepState(const DrawStep &step, uint32 extra = 0);
+
+	/**
+	 * The colors which were last set with setFgColor(), setBgColor(),
+	 * setBevelColor() and setGradientColors(), in the format of the
+	 * surface. Draw steps without colors of their own use these.
+	 */
+	struct ColorState {
+		uint32 fg, bg, bevel;
+		uint32 gradientStart, gradientEnd;
+	};
+
+	virtual ColorState getColorState() const = 0;
+
 	/**
 	 * Copies the part of the current frame to the system overlay.
 	 *
@@ -483,6 +506,7 @@ public:
 	 */
 	virtual void disableShadows() { _disableShadows = true; }
 	virtual void enableShadows() { _disableShadows = false; }
+	bool shadowsDisabled() const { return _disableShadows; }
 
 	/**
 	 * Applies a whole-screen shading effect, used before opening a new dialog.
@@ -373,7 +373,8 @@ VectorRendererSpec(PixelFormat format) :
 	_redMask((0xFF >> format.rLoss) << format.rShift),
 	_greenMask((0xFF >> format.gLoss) << format.gShift),
 	_blueMask((0xFF >> format.bLoss) << format.bShift),
-	_alphaMask((0xFF >> format.aLoss) << format.aShift) {
+	_alphaMask((0xFF >> format.aLoss) << format.aShift),
+	_fgColor(0), _bgColor(0), _gradientStart(0), _gradientEnd(0), _bevelColor(0) {
 
 	_bitmapAlphaColor = _format.RGBToColor(255, 0, 255);
 }
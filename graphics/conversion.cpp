@@ -21,8 +21,10 @@
  */
 
 #include "graphics/conversion.h"
+#include "graphics/conversion_simd.h"
 #include "graphics/pixelformat.h"
 
+#include "common/cpudetect.h"
 #include "common/endian.h"
 
 namespace Graphics {
@@ -31,6 +33,179 @@ namespace Graphics {
 
 namespace {
 
+/** Expand a component of 4 to 8 bits to 8 bits, like ColorComponent does. */
+inline uint32 expandComponent(uint32 value, uint bits) {
+	return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+/** The alpha value to add when converting from a format without alpha. */
+inline uint32 alphaFill(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return (srcFmt.aLoss == 8 && dstFmt.aLoss != 8) ? (0xFFu >> dstFmt.aLoss) << dstFmt.aShift : 0;
+}
+
+template<int SrcBpp>
+inline void convertRowSwizzle(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const uint32 alpha = alphaFill(dstFmt, srcFmt);
+	const bool copyAlpha = srcFmt.aLoss == 0 && dstFmt.aLoss == 0;
+	uint32 *out = (uint32 *)dst;
+
+	for (uint x = 0; x < w; ++x) {
+		const uint32 color = (SrcBpp == 4) ? *(const uint32 *)src : READ_UINT24(src);
+		uint32 result = alpha |
+		                (((color >> srcFmt.rShift) & 0xFF) << dstFmt.rShift) |
+		                (((color >> srcFmt.gShift) & 0xFF) << dstFmt.gShift) |
+		                (((color >> srcFmt.bShift) & 0xFF) << dstFmt.bShift);
+		if (copyAlpha)
+			result |= ((color >> srcFmt.aShift) & 0xFF) << dstFmt.aShift;
+		out[x] = result;
+		src += SrcBpp;
+	}
+}
+
+} // End of anonymous namespace
+
+void convertRowSwizzle32(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	convertRowSwizzle<4>(dst, src, w, dstFmt, srcFmt);
+}
+
+void convertRowSwizzle24(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	convertRowSwizzle<3>(dst, src, w, dstFmt, srcFmt);
+}
+
+void convertRowExpand16(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const uint32 alpha = alphaFill(dstFmt, srcFmt);
+	const uint rBits = srcFmt.rBits(), gBits = srcFmt.gBits(), bBits = srcFmt.bBits();
+	const uint16 *in = (const uint16 *)src;
+	uint32 *out = (uint32 *)dst;
+
+	for (uint x = 0; x < w; ++x) {
+		const uint32 color = in[x];
+		out[x] = alpha |
+		         (expandComponent((color >> srcFmt.rShift) & (0xFF >> srcFmt.rLoss), rBits) << dstFmt.rShift) |
+		         (expandComponent((color >> srcFmt.gShift) & (0xFF >> srcFmt.gLoss), gBits) << dstFmt.gShift) |
+		         (expandComponent((color >> srcFmt.bShift) & (0xFF >> srcFmt.bLoss), bBits) << dstFmt.bShift);
+	}
+}
+
+void convertRowReduce32(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const uint32 *in = (const uint32 *)src;
+	uint16 *out = (uint16 *)dst;
+
+	for (uint x = 0; x < w; ++x) {
+		const uint32 color = in[x];
+		out[x] = (((color >> (srcFmt.rShift + dstFmt.rLoss)) & (0xFF >> dstFmt.rLoss)) << dstFmt.rShift) |
+		         (((color >> (srcFmt.gShift + dstFmt.gLoss)) & (0xFF >> dstFmt.gLoss)) << dstFmt.gShift) |
+		         (((color >> (srcFmt.bShift + dstFmt.bLoss)) & (0xFF >> dstFmt.bLoss)) << dstFmt.bShift);
+	}
+}
+
+namespace {
+
+typedef void (*ConvertRowFunc)(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+
+/**
+ * The row converters for one instruction set. Conversions the instruction
+ * set has no converter for are null, and use the scalar converter.
+ */
+struct ConvertRowFuncs {
+	ConvertRowFunc swizzle32;
+	ConvertRowFunc swizzle24;
+	ConvertRowFunc expand16;
+	ConvertRowFunc reduce32;
+};
+
+const ConvertRowFuncs kScalarConvertRowFuncs = { convertRowSwizzle32, convertRowSwizzle24, convertRowExpand16, convertRowReduce32 };
+#ifdef USE_SSE2
+const ConvertRowFuncs kSSE2ConvertRowFuncs = { convertRowSwizzle32SSE2, nullptr, convertRowExpand16SSE2, convertRowReduce32SSE2 };
+#endif
+#ifdef USE_NEON
+const ConvertRowFuncs kNEONConvertRowFuncs = { convertRowSwizzle32NEON, convertRowSwizzle24NEON, convertRowExpand16NEON, convertRowReduce32NEON };
+#endif
+
+const ConvertRowFuncs &getConvertRowFuncs() {
+#ifdef SCUMM_LITTLE_ENDIAN
+#ifdef USE_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return kSSE2ConvertRowFuncs;
+#endif
+#ifdef USE_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return kNEONConvertRowFuncs;
+#endif
+#endif
+	return kScalarConvertRowFuncs;
+}
+
+/** Pick the given converter of the best instruction set which has one. */
+ConvertRowFunc pickConvertRowFunc(ConvertRowFunc ConvertRowFuncs::*func) {
+	const ConvertRowFunc result = getConvertRowFuncs().*func;
+	return result ? result : kScalarConvertRowFuncs.*func;
+}
+
+/** Whether the format has 8 bits per color channel, at byte positions. */
+bool isByteAligned(const PixelFormat &fmt) {
+	return fmt.rLoss == 0 && fmt.gLoss == 0 && fmt.bLoss == 0 && (fmt.aLoss == 0 || fmt.aLoss == 8) &&
+	       !(fmt.rShift & 7) && !(fmt.gShift & 7) && !(fmt.bShift & 7) && (fmt.aLoss == 8 || !(fmt.aShift & 7));
+}
+
+/** Whether the format is a 16bpp one without alpha, like RGB565. */
+bool isHighColor(const PixelFormat &fmt) {
+	return fmt.bytesPerPixel == 2 && fmt.aLoss == 8 && fmt.rLoss <= 4 && fmt.gLoss <= 4 && fmt.bLoss <= 4;
+}
+
+/**
+ * Return the row converter for the given pair of formats, or nullptr if
+ * there is none.
+ */
+ConvertRowFunc getConvertRowFunc(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	if (dstFmt.bytesPerPixel == 4 && isByteAligned(dstFmt)) {
+		if (srcFmt.bytesPerPixel == 4 && isByteAligned(srcFmt))
+			return pickConvertRowFunc(&ConvertRowFuncs::swizzle32);
+		if (srcFmt.bytesPerPixel == 3 && srcFmt.aLoss == 8 && isByteAligned(srcFmt))
+			return pickConvertRowFunc(&ConvertRowFuncs::swizzle24);
+		if (isHighColor(srcFmt))
+			return pickConvertRowFunc(&ConvertRowFuncs::expand16);
+	} else if (isHighColor(dstFmt) && srcFmt.bytesPerPixel == 4 && isByteAligned(srcFmt)) {
+		return pickConvertRowFunc(&ConvertRowFuncs::reduce32);
+	}
+
+	return nullptr;
+}
+
+/**
+ * Convert with a row converter. When converting in place to a larger
+ * format, the rows are converted from the end, in small chunks which go
+ * through a buffer, so the source is only overwritten once it was read.
+ */
+void convertRows(ConvertRowFunc convertRow, byte *dst, const byte *src, const uint dstPitch, const uint srcPitch,
+                 const uint w, const uint h, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const bool overlap = dst < src + srcPitch * h && src < dst + dstPitch * h;
+
+	if (!overlap || dstFmt.bytesPerPixel <= srcFmt.bytesPerPixel) {
+		for (uint y = 0; y < h; ++y) {
+			convertRow(dst, src, w, dstFmt, srcFmt);
+			dst += dstPitch;
+			src += srcPitch;
+		}
+		return;
+	}
+
+	enum { kChunkPixels = 64 };
+	byte buffer[kChunkPixels * 4];
+
+	for (uint y = h; y-- > 0;) {
+		const byte *srcRow = src + y * srcPitch;
+		byte *dstRow = dst + y * dstPitch;
+
+		for (uint x = w; x > 0;) {
+			const uint count = MIN<uint>(x, kChunkPixels);
+			x -= count;
+			convertRow(buffer, srcRow + x * srcFmt.bytesPerPixel, count, dstFmt, srcFmt);
+			memcpy(dstRow + x * dstFmt.bytesPerPixel, buffer, count * dstFmt.bytesPerPixel);
+		}
+	}
+}
+
 template<typename SrcColor, typename DstColor, bool backward>
 inline void crossBlitLogic(byte *dst, const byte *src, const uint w, const uint h,
                            const PixelFormat &srcFmt, const PixelFormat &dstFmt,
@@ -126,6 +301,13 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	// Common pairs of formats have their own, possibly vectorized, converters
+	const ConvertRowFunc convertRow = getConvertRowFunc(dstFmt, srcFmt);
+	if (convertRow) {
+		convertRows(convertRow, dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+		return true;
+	}
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -167,4 +349,45 @@ bool crossBlit(byte *dst, const byte *src,
 	return true;
 }
 
+namespace {
+
+template<typename DstColor>
+inline void crossBlitMapLogic(byte *dst, const byte *src, const uint w, const uint h,
+                              const uint srcDelta, const uint dstDelta, const uint32 *map) {
+	// Like crossBlitLogic, go from bottom right to top left, so that the
+	// indices are not overwritten when converting in place.
+	for (uint y = 0; y < h; ++y) {
+		for (uint x = 0; x < w; ++x) {
+			*(DstColor *)dst = map[*src];
+			src -= 1;
+			dst -= sizeof(DstColor);
+		}
+
+		src -= srcDelta;
+		dst -= dstDelta;
+	}
+}
+
+} // End of anonymous namespace
+
+bool crossBlitMap(byte *dst, const byte *src,
+                  const uint dstPitch, const uint srcPitch,
+                  const uint w, const uint h,
+                  const uint bytesPerPixel, const uint32 *map) {
+	if (bytesPerPixel != 2 && bytesPerPixel != 4)
+		return false;
+
+	const uint srcDelta = srcPitch - w;
+	const uint dstDelta = dstPitch - w * bytesPerPixel;
+
+	dst += h * dstPitch - dstDelta - bytesPerPixel;
+	src += h * srcPitch - srcDelta - 1;
+
+	if (bytesPerPixel == 2)
+		crossBlitMapLogic<uint16>(dst, src, w, h, srcDelta, dstDelta, map);
+	else
+		crossBlitMapLogic<uint32>(dst, src, w, h, srcDelta, dstDelta, map);
+	return true;
+}
+
 } // End of namespace Graphics
@@ -72,6 +72,28 @@ bool crossBlit(byte *dst, const byte *src,
                const uint w, const uint h,
                const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt);
 
+/**
+ * Blits a rectangle of palette indices to a high color format, looking up
+ * each index in a map of 256 colors already in the destination format.
+ *
+ * @param dst			the buffer which will recieve the converted graphics data
+ * @param src			the buffer containing the palette indices
+ * @param dstPitch		width in bytes of one full line of the dest buffer
+ * @param srcPitch		width in bytes of one full line of the source buffer
+ * @param w				the width of the graphics data
+ * @param h				the height of the graphics data
+ * @param bytesPerPixel	the size of a destination pixel, 2 or 4
+ * @param map			the colors for each palette index
+ * @return				true if conversion completes successfully,
+ *						false if there is an error.
+ *
+ * @note Like crossBlit, this can convert a surface in place.
+ */
+bool crossBlitMap(byte *dst, const byte *src,
+                  const uint dstPitch, const uint srcPitch,
+                  const uint w, const uint h,
+                  const uint bytesPerPixel, const uint32 *map);
+
 } // End of namespace Graphics
 
 #endif // GRAPHICS_CONVERSION_H
@@ -0,0 +1,158 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/conversion_simd.h"
+#include "graphics/pixelformat.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+namespace {
+
+/**
+ * For each byte of a destination pixel, the byte of the source pixel it
+ * comes from, or -1 if it is filled with a constant.
+ */
+struct ByteMap {
+	int plane[4];
+	uint8 fill[4];
+
+	ByteMap(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+		for (int i = 0; i < 4; i++) {
+			plane[i] = -1;
+			fill[i] = 0;
+		}
+
+		plane[dstFmt.rShift / 8] = srcFmt.rShift / 8;
+		plane[dstFmt.gShift / 8] = srcFmt.gShift / 8;
+		plane[dstFmt.bShift / 8] = srcFmt.bShift / 8;
+		if (dstFmt.aLoss == 0) {
+			if (srcFmt.aLoss == 0)
+				plane[dstFmt.aShift / 8] = srcFmt.aShift / 8;
+			else
+				fill[dstFmt.aShift / 8] = 0xFF;
+		}
+	}
+
+	uint8x16_t get(const uint8x16_t *planes, int i) const {
+		return plane[i] >= 0 ? planes[plane[i]] : vdupq_n_u8(fill[i]);
+	}
+};
+
+/** Extract a channel of a 16bpp color and expand it to 8 bits, in each 16 bit lane. */
+inline uint16x8_t expandChannel(uint16x8_t color, int shift, int loss) {
+	const int bits = 8 - loss;
+	const uint16x8_t value = vandq_u16(vshlq_u16(color, vdupq_n_s16(-shift)), vdupq_n_u16(0xFF >> loss));
+	return vorrq_u16(vshlq_u16(value, vdupq_n_s16(8 - bits)), vshlq_u16(value, vdupq_n_s16(8 - 2 * bits)));
+}
+
+/** Move a channel, widened to 32 bits, to its position in the destination. */
+inline uint32x4_t placeChannel(uint16x4_t value, int shift) {
+	return vshlq_u32(vmovl_u16(value), vdupq_n_s32(shift));
+}
+
+/** Reduce a channel of 8 bits to a 16bpp channel, in each 32 bit lane. */
+inline uint32x4_t reduceChannel(uint32x4_t color, int srcShift, int loss, int dstShift) {
+	const uint32x4_t value = vandq_u32(vshlq_u32(color, vdupq_n_s32(-(srcShift + loss))), vdupq_n_u32(0xFF >> loss));
+	return vshlq_u32(value, vdupq_n_s32(dstShift));
+}
+
+} // End of anonymous namespace
+
+void convertRowSwizzle32NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const ByteMap map(dstFmt, srcFmt);
+
+	uint x = 0;
+	for (; x + 16 <= w; x += 16) {
+		const uint8x16x4_t in = vld4q_u8(src + x * 4);
+		uint8x16x4_t out;
+		for (int i = 0; i < 4; i++)
+			out.val[i] = map.get(in.val, i);
+		vst4q_u8(dst + x * 4, out);
+	}
+
+	if (x < w)
+		convertRowSwizzle32(dst + x * 4, src + x * 4, w - x, dstFmt, srcFmt);
+}
+
+void convertRowSwizzle24NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const ByteMap map(dstFmt, srcFmt);
+
+	uint x = 0;
+	for (; x + 16 <= w; x += 16) {
+		const uint8x16x3_t in = vld3q_u8(src + x * 3);
+		uint8x16x4_t out;
+		for (int i = 0; i < 4; i++)
+			out.val[i] = map.get(in.val, i);
+		vst4q_u8(dst + x * 4, out);
+	}
+
+	if (x < w)
+		convertRowSwizzle24(dst + x * 4, src + x * 3, w - x, dstFmt, srcFmt);
+}
+
+void convertRowExpand16NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const uint32x4_t alpha = vdupq_n_u32(dstFmt.aLoss != 8 ? 0xFFu << dstFmt.aShift : 0);
+
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		const uint16x8_t color = vld1q_u16((const uint16 *)(src + x * 2));
+		const uint16x8_t r = expandChannel(color, srcFmt.rShift, srcFmt.rLoss);
+		const uint16x8_t g = expandChannel(color, srcFmt.gShift, srcFmt.gLoss);
+		const uint16x8_t b = expandChannel(color, srcFmt.bShift, srcFmt.bLoss);
+
+		uint32x4_t lo = vorrq_u32(alpha, placeChannel(vget_low_u16(r), dstFmt.rShift));
+		lo = vorrq_u32(lo, placeChannel(vget_low_u16(g), dstFmt.gShift));
+		lo = vorrq_u32(lo, placeChannel(vget_low_u16(b), dstFmt.bShift));
+		uint32x4_t hi = vorrq_u32(alpha, placeChannel(vget_high_u16(r), dstFmt.rShift));
+		hi = vorrq_u32(hi, placeChannel(vget_high_u16(g), dstFmt.gShift));
+		hi = vorrq_u32(hi, placeChannel(vget_high_u16(b), dstFmt.bShift));
+
+		vst1q_u32((uint32 *)(dst + x * 4), lo);
+		vst1q_u32((uint32 *)(dst + x * 4 + 16), hi);
+	}
+
+	if (x < w)
+		convertRowExpand16(dst + x * 4, src + x * 2, w - x, dstFmt, srcFmt);
+}
+
+void convertRowReduce32NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		uint16x4_t result[2];
+		for (int i = 0; i < 2; i++) {
+			const uint32x4_t color = vld1q_u32((const uint32 *)(src + x * 4 + i * 16));
+			uint32x4_t value = vorrq_u32(reduceChannel(color, srcFmt.rShift, dstFmt.rLoss, dstFmt.rShift),
+			                             reduceChannel(color, srcFmt.gShift, dstFmt.gLoss, dstFmt.gShift));
+			value = vorrq_u32(value, reduceChannel(color, srcFmt.bShift, dstFmt.bLoss, dstFmt.bShift));
+			result[i] = vmovn_u32(value);
+		}
+
+		vst1q_u16((uint16 *)(dst + x * 2), vcombine_u16(result[0], result[1]));
+	}
+
+	if (x < w)
+		convertRowReduce32(dst + x * 2, src + x * 4, w - x, dstFmt, srcFmt);
+}
+
+} // End of namespace Graphics
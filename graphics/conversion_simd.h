@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_CONVERSION_SIMD_H
+#define GRAPHICS_CONVERSION_SIMD_H
+
+#include "common/scummsys.h"
+
+/*
+ * Internal to crossBlit: the row converters for common pairs of formats.
+ *
+ * Each converter handles one row of w pixels, between formats with the
+ * following properties:
+ *
+ *  - swizzle32: 32bpp to 32bpp, both with 8 bits per channel
+ *  - swizzle24: 24bpp without alpha to 32bpp, both with 8 bits per channel
+ *  - expand16:  16bpp without alpha (like RGB565) to 32bpp with 8 bits per channel
+ *  - reduce32:  32bpp with 8 bits per channel to 16bpp without alpha
+ *
+ * Channels may be at any position which is a multiple of 8 bits for the
+ * 8 bits formats, and of 4 to 8 bits at any position for the 16bpp ones.
+ * All converters give the same results as PixelFormat::colorToARGB()
+ * followed by PixelFormat::ARGBToColor(). The vectorized ones hand pixels
+ * which do not fill a whole register at the end of a row to the scalar
+ * converter.
+ */
+
+namespace Graphics {
+
+struct PixelFormat;
+
+// The scalar converters in conversion.cpp
+void convertRowSwizzle32(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowSwizzle24(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowExpand16(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowReduce32(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+
+#ifdef USE_SSE2
+void convertRowSwizzle32SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowExpand16SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowReduce32SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+#endif
+
+#ifdef USE_NEON
+void convertRowSwizzle32NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowSwizzle24NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowExpand16NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+void convertRowReduce32NEON(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+#endif
+
+} // End of namespace Graphics
+
+#endif
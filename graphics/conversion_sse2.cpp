@@ -0,0 +1,141 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -msse2, see graphics/module.mk
+
+#include "graphics/conversion_simd.h"
+#include "graphics/pixelformat.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+/** Shift count operand for the _mm_sll and _mm_srl families. */
+inline __m128i shiftCount(int count) {
+	return _mm_cvtsi32_si128(count);
+}
+
+/** Move a channel of 8 bits from one position in each 32 bit lane to another. */
+inline __m128i moveChannel(__m128i color, __m128i srcShift, __m128i dstShift) {
+	return _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(color, srcShift), _mm_set1_epi32(0xFF)), dstShift);
+}
+
+/** Extract a channel of a 16bpp color and expand it to 8 bits, in each 16 bit lane. */
+inline __m128i expandChannel(__m128i color, int shift, int loss) {
+	const int bits = 8 - loss;
+	const __m128i value = _mm_and_si128(_mm_srl_epi16(color, shiftCount(shift)), _mm_set1_epi16(0xFF >> loss));
+	return _mm_or_si128(_mm_sll_epi16(value, shiftCount(8 - bits)), _mm_srl_epi16(value, shiftCount(2 * bits - 8)));
+}
+
+/** Reduce a channel of 8 bits to a 16bpp channel, in each 32 bit lane. */
+inline __m128i reduceChannel(__m128i color, int srcShift, int loss, int dstShift) {
+	const __m128i value = _mm_and_si128(_mm_srl_epi32(color, shiftCount(srcShift + loss)), _mm_set1_epi32(0xFF >> loss));
+	return _mm_sll_epi32(value, shiftCount(dstShift));
+}
+
+/** Pack the low 16 bits of each 32 bit lane of two registers. */
+inline __m128i pack32To16(__m128i lo, __m128i hi) {
+	// packs saturates signed values, so sign extend the 16 bits first
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+	return _mm_packs_epi32(lo, hi);
+}
+
+} // End of anonymous namespace
+
+void convertRowSwizzle32SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const bool copyAlpha = srcFmt.aLoss == 0 && dstFmt.aLoss == 0;
+	const __m128i alpha = _mm_set1_epi32((srcFmt.aLoss == 8 && dstFmt.aLoss != 8) ? (int)(0xFFu << dstFmt.aShift) : 0);
+	const __m128i srcR = shiftCount(srcFmt.rShift), dstR = shiftCount(dstFmt.rShift);
+	const __m128i srcG = shiftCount(srcFmt.gShift), dstG = shiftCount(dstFmt.gShift);
+	const __m128i srcB = shiftCount(srcFmt.bShift), dstB = shiftCount(dstFmt.bShift);
+	const __m128i srcA = shiftCount(srcFmt.aShift), dstA = shiftCount(dstFmt.aShift);
+
+	uint x = 0;
+	for (; x + 4 <= w; x += 4) {
+		const __m128i color = _mm_loadu_si128((const __m128i *)(src + x * 4));
+		__m128i result = _mm_or_si128(alpha, moveChannel(color, srcR, dstR));
+		result = _mm_or_si128(result, moveChannel(color, srcG, dstG));
+		result = _mm_or_si128(result, moveChannel(color, srcB, dstB));
+		if (copyAlpha)
+			result = _mm_or_si128(result, moveChannel(color, srcA, dstA));
+		_mm_storeu_si128((__m128i *)(dst + x * 4), result);
+	}
+
+	if (x < w)
+		convertRowSwizzle32(dst + x * 4, src + x * 4, w - x, dstFmt, srcFmt);
+}
+
+void convertRowExpand16SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	const __m128i alpha = _mm_set1_epi32(dstFmt.aLoss != 8 ? (int)(0xFFu << dstFmt.aShift) : 0);
+	const __m128i dstR = shiftCount(dstFmt.rShift);
+	const __m128i dstG = shiftCount(dstFmt.gShift);
+	const __m128i dstB = shiftCount(dstFmt.bShift);
+	const __m128i zero = _mm_setzero_si128();
+
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		const __m128i color = _mm_loadu_si128((const __m128i *)(src + x * 2));
+		const __m128i r = expandChannel(color, srcFmt.rShift, srcFmt.rLoss);
+		const __m128i g = expandChannel(color, srcFmt.gShift, srcFmt.gLoss);
+		const __m128i b = expandChannel(color, srcFmt.bShift, srcFmt.bLoss);
+
+		__m128i lo = _mm_or_si128(alpha, _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), dstR));
+		lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), dstG));
+		lo = _mm_or_si128(lo, _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), dstB));
+		__m128i hi = _mm_or_si128(alpha, _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), dstR));
+		hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), dstG));
+		hi = _mm_or_si128(hi, _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), dstB));
+
+		_mm_storeu_si128((__m128i *)(dst + x * 4), lo);
+		_mm_storeu_si128((__m128i *)(dst + x * 4 + 16), hi);
+	}
+
+	if (x < w)
+		convertRowExpand16(dst + x * 4, src + x * 2, w - x, dstFmt, srcFmt);
+}
+
+void convertRowReduce32SSE2(byte *dst, const byte *src, uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		const __m128i color[2] = {
+			_mm_loadu_si128((const __m128i *)(src + x * 4)),
+			_mm_loadu_si128((const __m128i *)(src + x * 4 + 16))
+		};
+
+		__m128i result[2];
+		for (int i = 0; i < 2; i++) {
+			result[i] = _mm_or_si128(reduceChannel(color[i], srcFmt.rShift, dstFmt.rLoss, dstFmt.rShift),
+			                         reduceChannel(color[i], srcFmt.gShift, dstFmt.gLoss, dstFmt.gShift));
+			result[i] = _mm_or_si128(result[i], reduceChannel(color[i], srcFmt.bShift, dstFmt.bLoss, dstFmt.bShift));
+		}
+
+		_mm_storeu_si128((__m128i *)(dst + x * 2), pack32To16(result[0], result[1]));
+	}
+
+	if (x < w)
+		convertRowReduce32(dst + x * 2, src + x * 4, w - x, dstFmt, srcFmt);
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,131 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/dirty_rects.h"
+
+namespace Graphics {
+
+namespace {
+
+inline int area(const Common::Rect &r) {
+	return r.width() * r.height();
+}
+
+/**
+ * How many pixels more the bounding rect of a and b has than a and b
+ * together. Negative if they overlap enough.
+ */
+int overdraw(const Common::Rect &a, const Common::Rect &b) {
+	Common::Rect bounds(a);
+	bounds.extend(b);
+	return area(bounds) - area(a) - area(b);
+}
+
+} // End of anonymous namespace
+
+DirtyRectList::DirtyRectList(int overdrawThreshold, uint maxRects, bool mergeIntersecting)
+	: _overdrawThreshold(overdrawThreshold), _maxRects(maxRects), _mergeIntersecting(mergeIntersecting),
+	  _addedPixels(0) {
+	resetStats();
+}
+
+void DirtyRectList::add(const Common::Rect &r) {
+	if (r.isEmpty())
+		return;
+
+	_addedPixels += area(r);
+
+	Common::Rect merged(r);
+	mergeCheap(merged);
+
+	while (_maxRects && _rects.size() >= _maxRects) {
+		// Out of rects, so merge the one which costs the least overdraw
+		uint best = 0;
+		int bestOverdraw = overdraw(merged, _rects[0]);
+		for (uint i = 1; i < _rects.size(); i++) {
+			const int cost = overdraw(merged, _rects[i]);
+			if (cost < bestOverdraw) {
+				best = i;
+				bestOverdraw = cost;
+			}
+		}
+
+		merged.extend(_rects[best]);
+		_rects[best] = _rects.back();
+		_rects.pop_back();
+		mergeCheap(merged);
+	}
+
+	_rects.push_back(merged);
+}
+
+void DirtyRectList::mergeCheap(Common::Rect &r) {
+	bool didMerge = true;
+	while (didMerge) {
+		didMerge = false;
+		for (uint i = 0; i < _rects.size();) {
+			if (overdraw(r, _rects[i]) <= _overdrawThreshold ||
+			    (_mergeIntersecting && r.intersects(_rects[i]))) {
+				r.extend(_rects[i]);
+				// The order of the rects does not matter
+				_rects[i] = _rects.back();
+				_rects.pop_back();
+				didMerge = true;
+			} else {
+				++i;
+			}
+		}
+	}
+}
+
+void DirtyRectList::clear() {
+	// Keep the storage for the next frame
+	_rects.resize(0);
+	_addedPixels = 0;
+}
+
+void DirtyRectList::nextFrame() {
+	if (!_rects.empty()) {
+		_stats.frames++;
+		_stats.rects += _rects.size();
+		_stats.addedPixels += _addedPixels;
+		_stats.redrawnPixels += getArea();
+	}
+
+	clear();
+}
+
+uint32 DirtyRectList::getArea() const {
+	uint32 total = 0;
+	for (const_iterator i = _rects.begin(); i != _rects.end(); ++i)
+		total += area(*i);
+	return total;
+}
+
+void DirtyRectList::resetStats() {
+	_stats.frames = 0;
+	_stats.rects = 0;
+	_stats.addedPixels = 0;
+	_stats.redrawnPixels = 0;
+}
+
+} // End of namespace Graphics
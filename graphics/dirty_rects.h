@@ -0,0 +1,101 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_RECTS_H
+#define GRAPHICS_DIRTY_RECTS_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * The areas of a screen which changed since it was last updated.
+ *
+ * Rects are merged as they are added, whenever the bounding rect of two
+ * of them is at most overdrawThreshold pixels larger than their areas
+ * added up. That is when redrawing the bounding rect costs no more than
+ * redrawing the pixels which the two rects share twice, plus the
+ * threshold. This is the same rule as SCI32 uses for its show list.
+ * Optionally, rects which intersect at all are merged too, so that no
+ * pixel is redrawn twice.
+ *
+ * With a limit on the number of rects, the rect which costs the least
+ * overdraw is merged when the limit is reached, instead of giving up and
+ * redrawing everything.
+ *
+ * Callers have to clip the rects themselves.
+ */
+class DirtyRectList {
+public:
+	struct Stats {
+		uint32 frames;          ///< Frames with anything to redraw
+		uint32 rects;           ///< Rects redrawn, after merging
+		uint64 addedPixels;     ///< Total area of the rects which were added
+		uint64 redrawnPixels;   ///< Total area of the rects which were redrawn
+	};
+
+	typedef Common::Array<Common::Rect>::const_iterator const_iterator;
+
+	/**
+	 * @param overdrawThreshold  how many pixels may be redrawn needlessly
+	 *                           to save a rect
+	 * @param maxRects           the maximum number of rects, or 0 for no limit
+	 * @param mergeIntersecting  whether to merge intersecting rects whatever
+	 *                           the overdraw
+	 */
+	DirtyRectList(int overdrawThreshold = 0, uint maxRects = 0, bool mergeIntersecting = false);
+
+	void add(const Common::Rect &r);
+
+	/** Forget the rects, without counting them as redrawn. */
+	void clear();
+
+	/** Count the rects as redrawn in the statistics, and clear the list. */
+	void nextFrame();
+
+	bool empty() const { return _rects.empty(); }
+	uint size() const { return _rects.size(); }
+	const_iterator begin() const { return _rects.begin(); }
+	const_iterator end() const { return _rects.end(); }
+
+	/** The total area of the current rects. */
+	uint32 getArea() const;
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	/** Merge r with rects, which may now be cheap to merge, until there are none left. */
+	void mergeCheap(Common::Rect &r);
+
+	Common::Array<Common::Rect> _rects;
+	int _overdrawThreshold;
+	uint _maxRects;
+	bool _mergeIntersecting;
+	uint64 _addedPixels;    ///< Area added during the current frame
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -94,31 +94,15 @@ int getStringWidthImpl(const Font &font, const StringType &str) {
 }
 
 template<class StringType>
-void drawStringImpl(const Font &font, Surface *dst, const StringType &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) {
-	// The logic in getBoundingImpl is the same as we use here. In case we
-	// ever change something here we will need to change it there too.
-	assert(dst != 0);
-
-	const int leftX = x, rightX = x + w;
-	int width = font.getStringWidth(str);
-
-	if (align == kTextAlignCenter)
-		x = x + (w - width)/2;
-	else if (align == kTextAlignRight)
-		x = x + w - width;
-	x += deltax;
-
-	typename StringType::unsigned_type last = 0;
-	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
-		const typename StringType::unsigned_type cur = *i;
-		x += font.getKerningOffset(last, cur);
-		last = cur;
-		w = font.getCharWidth(cur);
-		if (x+w > rightX)
-			break;
-		if (x+w >= leftX)
-			font.drawChar(dst, cur, x, y, color);
-		x += w;
+void drawStringCharsImpl(const Font &font, Surface *dst, const StringType &str, uint first, uint last, int x, int y, uint32 color) {
+	typename StringType::unsigned_type prev = 0;
+	for (uint i = first; i < last; ++i) {
+		const typename StringType::unsigned_type cur = str[i];
+		if (i != first)
+			x += font.getKerningOffset(prev, cur);
+		prev = cur;
+		font.drawChar(dst, cur, x, y, color);
+		x += font.getCharWidth(cur);
 	}
 }
 
@@ -273,13 +257,64 @@ void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color)
 	dst->addDirtyRect(charBox);
 }
 
+template<class StringType>
+void Font::drawStringImpl(Surface *dst, const StringType &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const {
+	// The logic in getBoundingImpl is the same as we use here. In case we
+	// ever change something here we will need to change it there too.
+	assert(dst != 0);
+
+	const int leftX = x, rightX = x + w;
+	int width = getStringWidth(str);
+
+	if (align == kTextAlignCenter)
+		x = x + (w - width)/2;
+	else if (align == kTextAlignRight)
+		x = x + w - width;
+	x += deltax;
+
+	// Draw the runs of characters which fit into the text area. Characters
+	// left of the area are skipped wherever they are, since kerning can
+	// move one there after others were drawn.
+	uint first = 0, last = 0;
+	int firstX = x;
+
+	typename StringType::unsigned_type prev = 0;
+	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i, ++last) {
+		const typename StringType::unsigned_type cur = *i;
+		x += getKerningOffset(prev, cur);
+		prev = cur;
+		w = getCharWidth(cur);
+		if (x+w > rightX)
+			break;
+		if (x+w < leftX) {
+			if (first < last)
+				drawStringChars(dst, str, first, last, firstX, y, color);
+			first = last + 1;
+		} else if (first == last) {
+			firstX = x;
+		}
+		x += w;
+	}
+
+	if (first < last)
+		drawStringChars(dst, str, first, last, firstX, y, color);
+}
+
+void Font::drawStringChars(Surface *dst, const Common::String &str, uint first, uint last, int x, int y, uint32 color) const {
+	drawStringCharsImpl(*this, dst, str, first, last, x, y, color);
+}
+
+void Font::drawStringChars(Surface *dst, const Common::U32String &str, uint first, uint last, int x, int y, uint32 color) const {
+	drawStringCharsImpl(*this, dst, str, first, last, x, y, color);
+}
+
 void Font::drawString(Surface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
 	Common::String renderStr = useEllipsis ? handleEllipsis(str, w) : str;
-	drawStringImpl(*this, dst, renderStr, x, y, w, color, align, deltax);
+	drawStringImpl(dst, renderStr, x, y, w, color, align, deltax);
 }
 
 void Font::drawString(Surface *dst, const Common::U32String &str, int x, int y, int w, uint32 color, TextAlign align) const {
-	drawStringImpl(*this, dst, str, x, y, w, color, align, 0);
+	drawStringImpl(dst, str, x, y, w, color, align, 0);
 }
 
 void Font::drawString(ManagedSurface *dst, const Common::String &str, int x, int y, int w, uint32 color, TextAlign align, int deltax, bool useEllipsis) const {
@@ -177,7 +177,22 @@ public:
 	int wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines) const;
 	int wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines) const;
 
+protected:
+	/**
+	 * Draw the characters first up to last (exclusive) of a string, which
+	 * drawString found to fit into the text area. The first character is
+	 * drawn at (x, y), the following ones after it.
+	 *
+	 * The default implementation draws one character after the other with
+	 * drawChar. Fonts can override this to draw whole strings at once.
+	 */
+	virtual void drawStringChars(Surface *dst, const Common::String &str, uint first, uint last, int x, int y, uint32 color) const;
+	virtual void drawStringChars(Surface *dst, const Common::U32String &str, uint first, uint last, int x, int y, uint32 color) const;
+
 private:
+	template<class StringType>
+	void drawStringImpl(Surface *dst, const StringType &str, int x, int y, int w, uint32 color, TextAlign align, int deltax) const;
+
 	Common::String handleEllipsis(const Common::String &str, int w) const;
 };
 
@@ -34,8 +34,10 @@
 #include "common/singleton.h"
 #include "common/stream.h"
 #include "common/memstream.h"
+#include "common/array.h"
 #include "common/hashmap.h"
 #include "common/ptr.h"
+#include "common/ustr.h"
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -122,6 +124,13 @@ public:
 	virtual Common::Rect getBoundingBox(uint32 chr) const;
 
 	virtual void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const;
+
+	TTFCacheStats getCacheStats() const;
+
+protected:
+	virtual void drawStringChars(Surface *dst, const Common::String &str, uint first, uint last, int x, int y, uint32 color) const;
+	virtual void drawStringChars(Surface *dst, const Common::U32String &str, uint first, uint last, int x, int y, uint32 color) const;
+
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -133,18 +142,95 @@ private:
 	int _ascent, _descent;
 
 	struct Glyph {
-		Surface image;
 		int xOffset, yOffset;
+		int width, height;
 		int advance;
 		FT_UInt slot;
+
+		/** The atlas page holding the image, or -1 when it is not rendered. */
+		int page;
+		int atlasX, atlasY;
 	};
 
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
+	bool rasterizeGlyph(Glyph &glyph) const;
+	const uint8 *getGlyphImage(Glyph &glyph, int &pitch) const;
+	Glyph *findGlyph(uint32 chr) const;
 	typedef Common::HashMap<uint32, Glyph> GlyphCache;
 	mutable GlyphCache _glyphs;
+	/** The glyphs of the first 256 characters, which are all cached on loading. */
+	Glyph *_glyphTable[256];
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	/**
+	 * The glyph images are packed into a few large pages, in rows of glyphs
+	 * (shelves) of similar height. When the pages take up too much memory,
+	 * the least recently used one is cleared, and the glyphs which were on
+	 * it are rendered again when they are needed.
+	 */
+	struct AtlasShelf {
+		int y, height;
+		int usedWidth;
+	};
+
+	struct AtlasPage {
+		Surface image;
+		Common::Array<AtlasShelf> shelves;
+		int usedHeight;
+		uint32 lastUse;
+	};
+
+	uint8 *allocateGlyphImage(Glyph &glyph) const;
+	int evictAtlasPage(int width, int height) const;
+	mutable Common::Array<AtlasPage *> _atlas;
+	int _atlasPageSize;
+
+	/**
+	 * A string as runs of the pixels covered by its glyphs, relative to the
+	 * position of its first character. Drawing it only takes blending the
+	 * runs, without looking up any glyphs.
+	 */
+	struct TextRun {
+		int x, y;
+		uint length;
+		uint coverage;      ///< Offset of the values in CachedString::coverage
+	};
+
+	struct CachedString {
+		Common::Array<TextRun> runs;
+		Common::Array<uint8> coverage;
+		uint32 lastUse;
+
+		uint32 getSize() const { return runs.size() * sizeof(TextRun) + coverage.size(); }
+	};
+
+	struct U32StringHash {
+		uint operator()(const Common::U32String &str) const;
+	};
+
+	template<class StringType>
+	void drawStringCharsImpl(Surface *dst, const StringType &str, uint first, uint last, int x, int y, uint32 color) const;
+	void buildString(CachedString &cached, const Common::U32String &text) const;
+	void drawCachedString(Surface *dst, const CachedString &cached, int x, int y, uint32 color) const;
+	template<typename ColorType, class Format>
+	void drawRuns(Surface *dst, const CachedString &cached, int x, int y, ColorType color, const Format &dstFormat) const;
+	void evictString() const;
+
+	typedef Common::HashMap<Common::U32String, CachedString, U32StringHash> StringCache;
+	mutable StringCache _strings;
+	mutable uint32 _stringCacheSize;
+	mutable uint32 _stringCacheHits;
+
+	/** Counts the draw calls, to find the least recently used pages and strings. */
+	mutable uint32 _useCount;
+
+	enum {
+		kAtlasMinPageSize = 256,
+		kMaxAtlasSize = 1024 * 1024,        ///< Bytes of glyph images kept per font
+		kMaxStringCacheSize = 256 * 1024    ///< Bytes of cached strings kept per font
+	};
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -154,12 +240,18 @@ private:
 	FT_Int32 _loadFlags;
 	FT_Render_Mode _renderMode;
 	bool _hasKerning;
+
+	/** Kerning offsets by the slots of the left and right glyph. */
+	typedef Common::HashMap<uint32, int> KerningCache;
+	mutable KerningCache _kerning;
 };
 
 TTFFont::TTFFont()
     : _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
-      _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-      _hasKerning(false), _allowLateCaching(false) {
+      _descent(0), _glyphs(), _allowLateCaching(false), _atlas(), _atlasPageSize(kAtlasMinPageSize),
+      _strings(), _stringCacheSize(0), _stringCacheHits(0), _useCount(0), _loadFlags(FT_LOAD_TARGET_NORMAL),
+      _renderMode(FT_RENDER_MODE_NORMAL), _hasKerning(false), _kerning() {
+	memset(_glyphTable, 0, sizeof(_glyphTable));
 }
 
 TTFFont::~TTFFont() {
@@ -169,11 +261,13 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	for (uint i = 0; i < _atlas.size(); ++i) {
+		_atlas[i]->image.free();
+		delete _atlas[i];
+	}
 }
 
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping) {
@@ -245,6 +339,9 @@ bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode siz
 	_width = ftCeil26_6(FT_MulFix(_face->max_advance_width, _face->size->metrics.x_scale));
 	_height = _ascent - _descent + 1;
 
+	// A page holds a few rows of the largest glyphs
+	_atlasPageSize = MAX<int>(kAtlasMinPageSize, 4 * MAX(_width, _height));
+
 	if (!mapping) {
 		// Allow loading of all unicode characters.
 		_allowLateCaching = true;
@@ -272,6 +369,12 @@ bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode siz
 		}
 	}
 
+	for (uint i = 0; i < ARRAYSIZE(_glyphTable); ++i) {
+		GlyphCache::iterator glyphEntry = _glyphs.find(i);
+		if (glyphEntry != _glyphs.end())
+			_glyphTable[i] = &glyphEntry->_value;
+	}
+
 	_initialized = (_glyphs.size() != 0);
 	return _initialized;
 }
@@ -405,90 +508,134 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
-	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
-
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
-	} else {
+	const Glyph *leftGlyph = findGlyph(left);
+	if (!leftGlyph)
 		return 0;
-	}
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
-	} else {
+	const Glyph *rightGlyph = findGlyph(right);
+	if (!rightGlyph)
 		return 0;
-	}
 
-	if (!leftGlyph || !rightGlyph)
+	if (!leftGlyph->slot || !rightGlyph->slot)
 		return 0;
 
+	// Asking FreeType is slow compared to the rest of the layout, and the
+	// same pairs come up again and again
+	const bool cacheable = leftGlyph->slot < 0x10000 && rightGlyph->slot < 0x10000;
+	const uint32 pair = (leftGlyph->slot << 16) | rightGlyph->slot;
+	if (cacheable) {
+		KerningCache::const_iterator kerning = _kerning.find(pair);
+		if (kerning != _kerning.end())
+			return kerning->_value;
+	}
+
 	FT_Vector kerningVector;
-	FT_Get_Kerning(_face, leftGlyph, rightGlyph, FT_KERNING_DEFAULT, &kerningVector);
-	return (kerningVector.x / 64);
+	FT_Get_Kerning(_face, leftGlyph->slot, rightGlyph->slot, FT_KERNING_DEFAULT, &kerningVector);
+	const int offset = kerningVector.x / 64;
+
+	if (cacheable)
+		_kerning[pair] = offset;
+	return offset;
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		return Common::Rect(glyph->xOffset, glyph->yOffset, glyph->xOffset + glyph->width, glyph->yOffset + glyph->height);
 	}
 }
 
 namespace {
 
-template<typename ColorType>
-void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, ColorType color, const PixelFormat &dstFormat) {
-	uint8 sR, sG, sB;
-	dstFormat.colorToRGB(color, sR, sG, sB);
+/**
+ * A pixel format with 4 to 8 bits per color component. Expanding such
+ * components needs no lookup of the depth, which makes this a lot faster
+ * than PixelFormat when blending pixel by pixel, with the same results.
+ */
+struct BlendFormat {
+	explicit BlendFormat(const PixelFormat &format)
+	    : alpha((0xFF >> format.aLoss) << format.aShift),
+	      rShift(format.rShift), gShift(format.gShift), bShift(format.bShift),
+	      rLoss(format.rLoss), gLoss(format.gLoss), bLoss(format.bLoss) {
+	}
 
-	for (int y = 0; y < h; ++y) {
-		ColorType *rDst = (ColorType *)dstPos;
-		const uint8 *src = srcPos;
+	static bool isSupported(const PixelFormat &format) {
+		return format.rLoss <= 4 && format.gLoss <= 4 && format.bLoss <= 4;
+	}
 
-		for (int x = 0; x < w; ++x) {
-			if (*src == 255) {
-				*rDst = color;
-			} else if (*src) {
-				const uint8 a = *src;
+	static inline uint8 expand(uint32 value, uint8 loss) {
+		value &= 0xFF >> loss;
+		return (value << loss) | (value >> (8 - 2 * loss));
+	}
 
-				uint8 dR, dG, dB;
-				dstFormat.colorToRGB(*rDst, dR, dG, dB);
+	inline void colorToRGB(uint32 color, uint8 &r, uint8 &g, uint8 &b) const {
+		r = expand(color >> rShift, rLoss);
+		g = expand(color >> gShift, gLoss);
+		b = expand(color >> bShift, bLoss);
+	}
 
-				dR = ((255 - a) * dR + a * sR) / 255;
-				dG = ((255 - a) * dG + a * sG) / 255;
-				dB = ((255 - a) * dB + a * sB) / 255;
+	inline uint32 RGBToColor(uint8 r, uint8 g, uint8 b) const {
+		return alpha | ((r >> rLoss) << rShift) | ((g >> gLoss) << gShift) | ((b >> bLoss) << bShift);
+	}
 
-				*rDst = dstFormat.RGBToColor(dR, dG, dB);
-			}
+	const uint32 alpha;
+	const uint8 rShift, gShift, bShift;
+	const uint8 rLoss, gLoss, bLoss;
+};
+
+template<typename ColorType, class Format>
+inline void blendRow(ColorType *dst, const uint8 *src, const int w, const ColorType color, const uint8 sR, const uint8 sG, const uint8 sB, const Format &dstFormat) {
+	for (int x = 0; x < w; ++x) {
+		if (*src == 255) {
+			*dst = color;
+		} else if (*src) {
+			const uint8 a = *src;
 
-			++rDst;
-			++src;
+			uint8 dR, dG, dB;
+			dstFormat.colorToRGB(*dst, dR, dG, dB);
+
+			dR = ((255 - a) * dR + a * sR) / 255;
+			dG = ((255 - a) * dG + a * sG) / 255;
+			dB = ((255 - a) * dB + a * sB) / 255;
+
+			*dst = dstFormat.RGBToColor(dR, dG, dB);
 		}
 
+		++dst;
+		++src;
+	}
+}
+
+inline void drawRowCLUT8(uint8 *dst, const uint8 *src, const int w, const uint8 color) {
+	for (int x = 0; x < w; ++x) {
+		// We assume a 1Bpp mode is a color indexed mode, thus we can
+		// not take advantage of anti-aliasing here.
+		if (src[x] >= 0x80)
+			dst[x] = color;
+	}
+}
+
+template<typename ColorType, class Format>
+void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const int srcPitch, const int w, const int h, ColorType color, const Format &dstFormat) {
+	uint8 sR, sG, sB;
+	dstFormat.colorToRGB(color, sR, sG, sB);
+
+	for (int y = 0; y < h; ++y) {
+		blendRow<ColorType, Format>((ColorType *)dstPos, srcPos, w, color, sR, sG, sB, dstFormat);
+
 		dstPos += dstPitch;
 		srcPos += srcPitch;
 	}
@@ -497,25 +644,26 @@ void renderGlyph(uint8 *dstPos, const int dstPitch, const uint8 *srcPos, const i
 } // End of anonymous namespace
 
 void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
-
-	x += glyph.xOffset;
-	y += glyph.yOffset;
+	x += glyph->xOffset;
+	y += glyph->yOffset;
 
 	if (x > dst->w)
 		return;
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = glyph->width;
+	int h = glyph->height;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	++_useCount;
+	int srcPitch;
+	const uint8 *srcPos = getGlyphImage(*glyph, srcPitch);
+	if (!srcPos)
+		return;
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -531,7 +679,7 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * srcPitch;
 		h += y;
 		y = 0;
 	}
@@ -546,40 +694,207 @@ void TTFFont::drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) con
 
 	if (dst->format.bytesPerPixel == 1) {
 		for (int cy = 0; cy < h; ++cy) {
-			uint8 *rDst = dstPos;
-			const uint8 *src = srcPos;
+			drawRowCLUT8(dstPos, srcPos, w, color);
+
+			dstPos += dst->pitch;
+			srcPos += srcPitch;
+		}
+	} else if (dst->format.bytesPerPixel == 2) {
+		if (BlendFormat::isSupported(dst->format))
+			renderGlyph<uint16, BlendFormat>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, BlendFormat(dst->format));
+		else
+			renderGlyph<uint16, PixelFormat>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
+	} else if (dst->format.bytesPerPixel == 4) {
+		if (BlendFormat::isSupported(dst->format))
+			renderGlyph<uint32, BlendFormat>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, BlendFormat(dst->format));
+		else
+			renderGlyph<uint32, PixelFormat>(dstPos, dst->pitch, srcPos, srcPitch, w, h, color, dst->format);
+	}
+}
+
+void TTFFont::drawStringChars(Surface *dst, const Common::String &str, uint first, uint last, int x, int y, uint32 color) const {
+	drawStringCharsImpl(dst, str, first, last, x, y, color);
+}
+
+void TTFFont::drawStringChars(Surface *dst, const Common::U32String &str, uint first, uint last, int x, int y, uint32 color) const {
+	drawStringCharsImpl(dst, str, first, last, x, y, color);
+}
+
+uint TTFFont::U32StringHash::operator()(const Common::U32String &str) const {
+	uint hash = 0;
+	for (uint i = 0; i < str.size(); ++i)
+		hash = hash * 31 + str[i];
+	return hash;
+}
+
+template<class StringType>
+void TTFFont::drawStringCharsImpl(Surface *dst, const StringType &str, uint first, uint last, int x, int y, uint32 color) const {
+	Common::U32String text;
+	for (uint i = first; i < last; ++i)
+		text += (typename StringType::unsigned_type)str[i];
+
+	++_useCount;
 
-			for (int cx = 0; cx < w; ++cx) {
-				// We assume a 1Bpp mode is a color indexed mode, thus we can
-				// not take advantage of anti-aliasing here.
-				if (*src >= 0x80)
-					*rDst = color;
+	StringCache::iterator entry = _strings.find(text);
+	if (entry != _strings.end()) {
+		++_stringCacheHits;
+		entry->_value.lastUse = _useCount;
+		drawCachedString(dst, entry->_value, x, y, color);
+		return;
+	}
+
+	CachedString &cached = _strings[text];
+	buildString(cached, text);
+	cached.lastUse = _useCount;
+	drawCachedString(dst, cached, x, y, color);
+
+	// Do not let a single string push out many others
+	const uint32 size = cached.getSize();
+	if (size > kMaxStringCacheSize / 16) {
+		_strings.erase(text);
+		return;
+	}
 
-				++rDst;
-				++src;
+	_stringCacheSize += size;
+	while (_stringCacheSize > kMaxStringCacheSize)
+		evictString();
+}
+
+void TTFFont::buildString(CachedString &cached, const Common::U32String &text) const {
+	// Lay out the glyphs the way Font::drawStringChars does. The runs are
+	// stored glyph after glyph, so that drawing them blends overlapping
+	// glyphs just like drawing one glyph after the other.
+	int x = 0;
+	for (uint i = 0; i < text.size(); ++i) {
+		if (i != 0)
+			x += getKerningOffset(text[i - 1], text[i]);
+
+		Glyph *glyph = findGlyph(text[i]);
+		if (!glyph)
+			continue;
+
+		int srcPitch;
+		const uint8 *src = getGlyphImage(*glyph, srcPitch);
+		for (int y = 0; src && y < glyph->height; ++y) {
+			int cx = 0;
+			while (cx < glyph->width) {
+				if (!src[cx]) {
+					++cx;
+					continue;
+				}
+
+				TextRun run;
+				run.x = x + glyph->xOffset + cx;
+				run.y = glyph->yOffset + y;
+				run.coverage = cached.coverage.size();
+
+				const int start = cx;
+				while (cx < glyph->width && src[cx])
+					cached.coverage.push_back(src[cx++]);
+				run.length = cx - start;
+
+				cached.runs.push_back(run);
 			}
 
-			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			src += srcPitch;
 		}
+
+		x += glyph->advance;
+	}
+}
+
+void TTFFont::drawCachedString(Surface *dst, const CachedString &cached, int x, int y, uint32 color) const {
+	if (dst->format.bytesPerPixel == 1) {
+		drawRuns<uint8, PixelFormat>(dst, cached, x, y, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		if (BlendFormat::isSupported(dst->format))
+			drawRuns<uint16, BlendFormat>(dst, cached, x, y, color, BlendFormat(dst->format));
+		else
+			drawRuns<uint16, PixelFormat>(dst, cached, x, y, color, dst->format);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format);
+		if (BlendFormat::isSupported(dst->format))
+			drawRuns<uint32, BlendFormat>(dst, cached, x, y, color, BlendFormat(dst->format));
+		else
+			drawRuns<uint32, PixelFormat>(dst, cached, x, y, color, dst->format);
+	}
+}
+
+template<typename ColorType, class Format>
+void TTFFont::drawRuns(Surface *dst, const CachedString &cached, int x, int y, ColorType color, const Format &dstFormat) const {
+	uint8 sR = 0, sG = 0, sB = 0;
+	if (sizeof(ColorType) != 1)
+		dstFormat.colorToRGB(color, sR, sG, sB);
+
+	for (Common::Array<TextRun>::const_iterator run = cached.runs.begin(); run != cached.runs.end(); ++run) {
+		const int dstY = y + run->y;
+		if (dstY < 0 || dstY >= dst->h)
+			continue;
+
+		int dstX = x + run->x;
+		int w = run->length;
+		const uint8 *src = cached.coverage.begin() + run->coverage;
+
+		// Make sure we are not drawing outside the screen bounds
+		if (dstX < 0) {
+			src -= dstX;
+			w += dstX;
+			dstX = 0;
+		}
+
+		if (dstX + w > dst->w)
+			w = dst->w - dstX;
+
+		if (w <= 0)
+			continue;
+
+		ColorType *dstPos = (ColorType *)dst->getBasePtr(dstX, dstY);
+		if (sizeof(ColorType) == 1)
+			drawRowCLUT8((uint8 *)dstPos, src, w, color);
+		else
+			blendRow<ColorType, Format>(dstPos, src, w, color, sR, sG, sB, dstFormat);
 	}
 }
 
+TTFCacheStats TTFFont::getCacheStats() const {
+	TTFCacheStats stats;
+	stats.atlasBytes = 0;
+	for (uint i = 0; i < _atlas.size(); ++i)
+		stats.atlasBytes += _atlas[i]->image.w * _atlas[i]->image.h;
+	stats.maxAtlasBytes = kMaxAtlasSize;
+	stats.strings = _strings.size();
+	stats.stringBytes = _stringCacheSize;
+	stats.maxStringBytes = kMaxStringCacheSize;
+	stats.stringHits = _stringCacheHits;
+	return stats;
+}
+
+void TTFFont::evictString() const {
+	StringCache::iterator oldest = _strings.begin();
+	for (StringCache::iterator i = _strings.begin(); i != _strings.end(); ++i) {
+		if (i->_value.lastUse < oldest->_value.lastUse)
+			oldest = i;
+	}
+
+	_stringCacheSize -= oldest->_value.getSize();
+	_strings.erase(oldest);
+}
+
 bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	FT_UInt slot = FT_Get_Char_Index(_face, chr);
 	if (!slot)
 		return false;
 
 	glyph.slot = slot;
+	glyph.page = -1;
 
+	return rasterizeGlyph(glyph);
+}
+
+bool TTFFont::rasterizeGlyph(Glyph &glyph) const {
 	// We use the light target and render mode to improve the looks of the
 	// glyphs. It is most noticable in FreeSansBold.ttf, where otherwise the
 	// 't' glyph looks like it is cut off on the right side.
-	if (FT_Load_Glyph(_face, slot, _loadFlags))
+	if (FT_Load_Glyph(_face, glyph.slot, _loadFlags))
 		return false;
 
 	if (FT_Render_Glyph(_face->glyph, _renderMode))
@@ -594,7 +909,18 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	glyph.advance = ftCeil26_6(_face->glyph->advance.x);
 
 	const FT_Bitmap &bitmap = _face->glyph->bitmap;
-	glyph.image.create(bitmap.width, bitmap.rows, PixelFormat::createFormatCLUT8());
+	if (bitmap.pixel_mode != FT_PIXEL_MODE_MONO && bitmap.pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
+		return false;
+	}
+
+	glyph.width = bitmap.width;
+	glyph.height = bitmap.rows;
+	if (!glyph.width || !glyph.height)
+		return true;
+
+	uint8 *dst = allocateGlyphImage(glyph);
+	const int dstPitch = _atlas[glyph.page]->image.pitch;
 
 	const uint8 *src = bitmap.buffer;
 	int srcPitch = bitmap.pitch;
@@ -603,11 +929,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		srcPitch = -srcPitch;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
-	memset(dst, 0, glyph.image.h * glyph.image.pitch);
-
-	switch (bitmap.pixel_mode) {
-	case FT_PIXEL_MODE_MONO:
+	if (bitmap.pixel_mode == FT_PIXEL_MODE_MONO) {
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
 			const uint8 *curSrc = src;
 			uint8 mask = 0;
@@ -616,34 +938,140 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 				if ((x % 8) == 0)
 					mask = *curSrc++;
 
-				if (mask & 0x80)
-					*dst = 255;
-
+				dst[x] = (mask & 0x80) ? 255 : 0;
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += dstPitch;
 			src += srcPitch;
 		}
-		break;
-
-	case FT_PIXEL_MODE_GRAY:
+	} else {
 		for (int y = 0; y < (int)bitmap.rows; ++y) {
 			memcpy(dst, src, bitmap.width);
-			dst += glyph.image.pitch;
+			dst += dstPitch;
 			src += srcPitch;
 		}
-		break;
-
-	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap.pixel_mode);
-		glyph.image.free();
-		return false;
 	}
 
 	return true;
 }
 
+const uint8 *TTFFont::getGlyphImage(Glyph &glyph, int &pitch) const {
+	if (!glyph.width || !glyph.height)
+		return nullptr;
+
+	// The page of the glyph might have been cleared to make room for others
+	if (glyph.page < 0 && !rasterizeGlyph(glyph))
+		return nullptr;
+
+	AtlasPage *page = _atlas[glyph.page];
+	page->lastUse = _useCount;
+
+	pitch = page->image.pitch;
+	return (const uint8 *)page->image.getBasePtr(glyph.atlasX, glyph.atlasY);
+}
+
+uint8 *TTFFont::allocateGlyphImage(Glyph &glyph) const {
+	const int w = glyph.width, h = glyph.height;
+
+	// Put the glyph on the lowest shelf it fits on
+	int pageIndex = -1;
+	AtlasShelf *shelf = nullptr;
+	for (uint i = 0; i < _atlas.size(); ++i) {
+		AtlasPage *page = _atlas[i];
+		for (uint j = 0; j < page->shelves.size(); ++j) {
+			AtlasShelf &cur = page->shelves[j];
+			if (h <= cur.height && cur.usedWidth + w <= page->image.w && (!shelf || cur.height < shelf->height)) {
+				pageIndex = i;
+				shelf = &cur;
+			}
+		}
+	}
+
+	// Otherwise start a new shelf, on a new page if necessary
+	if (!shelf) {
+		for (uint i = 0; i < _atlas.size(); ++i) {
+			if (_atlas[i]->usedHeight + h <= _atlas[i]->image.h && w <= _atlas[i]->image.w) {
+				pageIndex = i;
+				break;
+			}
+		}
+
+		if (pageIndex < 0) {
+			const int pageWidth = MAX(_atlasPageSize, w), pageHeight = MAX(_atlasPageSize, h);
+
+			uint32 atlasSize = pageWidth * pageHeight;
+			for (uint i = 0; i < _atlas.size(); ++i)
+				atlasSize += _atlas[i]->image.w * _atlas[i]->image.h;
+
+			if (atlasSize > kMaxAtlasSize && !_atlas.empty()) {
+				pageIndex = evictAtlasPage(pageWidth, pageHeight);
+			} else {
+				AtlasPage *page = new AtlasPage();
+				page->image.create(pageWidth, pageHeight, PixelFormat::createFormatCLUT8());
+				page->usedHeight = 0;
+				page->lastUse = _useCount;
+
+				pageIndex = _atlas.size();
+				_atlas.push_back(page);
+			}
+		}
+
+		AtlasPage *page = _atlas[pageIndex];
+		AtlasShelf newShelf;
+		newShelf.y = page->usedHeight;
+		newShelf.height = h;
+		newShelf.usedWidth = 0;
+		page->shelves.push_back(newShelf);
+		page->usedHeight += h;
+
+		shelf = &page->shelves.back();
+	}
+
+	glyph.page = pageIndex;
+	glyph.atlasX = shelf->usedWidth;
+	glyph.atlasY = shelf->y;
+	shelf->usedWidth += w;
+
+	return (uint8 *)_atlas[pageIndex]->image.getBasePtr(glyph.atlasX, glyph.atlasY);
+}
+
+int TTFFont::evictAtlasPage(int width, int height) const {
+	uint pageIndex = 0;
+	for (uint i = 1; i < _atlas.size(); ++i) {
+		if (_atlas[i]->lastUse < _atlas[pageIndex]->lastUse)
+			pageIndex = i;
+	}
+
+	for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i) {
+		if (i->_value.page == (int)pageIndex)
+			i->_value.page = -1;
+	}
+
+	AtlasPage *page = _atlas[pageIndex];
+	if (page->image.w != width || page->image.h != height) {
+		page->image.free();
+		page->image.create(width, height, PixelFormat::createFormatCLUT8());
+	}
+	page->shelves.clear();
+	page->usedHeight = 0;
+	page->lastUse = _useCount;
+
+	return pageIndex;
+}
+
+TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	if (chr < ARRAYSIZE(_glyphTable))
+		return _glyphTable[chr];
+
+	assureCached(chr);
+	GlyphCache::iterator glyphEntry = _glyphs.find(chr);
+	if (glyphEntry == _glyphs.end())
+		return nullptr;
+
+	return &glyphEntry->_value;
+}
+
 void TTFFont::assureCached(uint32 chr) const {
 	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
 		return;
@@ -666,6 +1094,10 @@ Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode size
 	return font;
 }
 
+TTFCacheStats getTTFCacheStats(const Font &font) {
+	return static_cast<const TTFFont &>(font).getCacheStats();
+}
+
 } // End of namespace Graphics
 
 namespace Common {
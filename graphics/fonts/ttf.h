@@ -95,6 +95,24 @@ enum TTFSizeMode {
  */
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode = kTTFSizeModeCharacter, uint dpi = 0, TTFRenderMode renderMode = kTTFRenderModeLight, const uint32 *mapping = 0);
 
+/**
+ * The state of the caches of a font loaded by loadTTFFont.
+ */
+struct TTFCacheStats {
+	uint32 atlasBytes;          ///< Memory taken by the glyph images
+	uint32 maxAtlasBytes;       ///< Limit for the glyph images, past which pages are cleared
+	uint strings;               ///< Number of strings kept for drawString
+	uint32 stringBytes;         ///< Memory taken by the kept strings
+	uint32 maxStringBytes;      ///< Limit for the kept strings
+	uint32 stringHits;          ///< Number of strings which were drawn from the cache
+};
+
+/**
+ * Return the state of the caches of a font, for debugging. The font has to
+ * be one returned by loadTTFFont.
+ */
+TTFCacheStats getTTFCacheStats(const Font &font);
+
 void shutdownTTF();
 
 } // End of namespace Graphics
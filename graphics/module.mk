@@ -3,6 +3,7 @@ MODULE := graphics
 MODULE_OBJS := \
 	conversion.o \
 	cursorman.o \
+	dirty_rects.o \
 	font.o \
 	fontman.o \
 	fonts/bdf.o \
@@ -20,6 +21,7 @@ MODULE_OBJS := \
 	screen.o \
 	sjis.o \
 	surface.o \
+	transform_cache.o \
 	transform_struct.o \
 	transform_tools.o \
 	transparent_surface.o \
@@ -29,6 +31,31 @@ MODULE_OBJS := \
 	wincursor.o \
 	yuv_to_rgb.o
 
+ifdef USE_SSE2
+MODULE_OBJS += \
+	conversion_sse2.o \
+	transparent_surface_sse2.o \
+	yuv_to_rgb_sse2.o
+$(MODULE)/conversion_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/transparent_surface_sse2.o: CXXFLAGS += -msse2
+$(MODULE)/yuv_to_rgb_sse2.o: CXXFLAGS += -msse2
+endif
+
+ifdef USE_AVX2
+MODULE_OBJS += \
+	transparent_surface_avx2.o \
+	yuv_to_rgb_avx2.o
+$(MODULE)/transparent_surface_avx2.o: CXXFLAGS += -mavx2
+$(MODULE)/yuv_to_rgb_avx2.o: CXXFLAGS += -mavx2
+endif
+
+ifdef USE_NEON
+MODULE_OBJS += \
+	conversion_neon.o \
+	transparent_surface_neon.o \
+	yuv_to_rgb_neon.o
+endif
+
 ifdef USE_SCALERS
 MODULE_OBJS += \
 	scaler/2xsai.o \
@@ -48,12 +75,18 @@ endif
 ifdef USE_HQ_SCALERS
 MODULE_OBJS += \
 	scaler/hq2x.o \
-	scaler/hq3x.o
+	scaler/hq3x.o \
+	scaler/hqx_pattern.o
+
+ifdef USE_SSE2
+MODULE_OBJS += \
+	scaler/hqx_pattern_sse2.o
+$(MODULE)/scaler/hqx_pattern_sse2.o: CXXFLAGS += -msse2
+endif
 
-ifdef USE_NASM
+ifdef USE_NEON
 MODULE_OBJS += \
-	scaler/hq2x_i386.o \
-	scaler/hq3x_i386.o
+	scaler/hqx_pattern_neon.o
 endif
 
 endif
@@ -32,31 +32,6 @@ int gBitFormat = 565;
 // RGB-to-YUV lookup table
 extern "C" {
 
-#ifdef USE_NASM
-// NOTE: if your compiler uses different mangled names, add another
-//       condition here
-
-#if !defined(_WIN32) && !defined(MACOSX) && !defined(__OS2__)
-#define RGBtoYUV _RGBtoYUV
-#define hqx_highbits _hqx_highbits
-#define hqx_lowbits _hqx_lowbits
-#define hqx_low2bits _hqx_low2bits
-#define hqx_low3bits _hqx_low3bits
-#define hqx_greenMask _hqx_greenMask
-#define hqx_redBlueMask _hqx_redBlueMask
-#define hqx_green_redBlue_Mask _hqx_green_redBlue_Mask
-#endif
-
-uint32 hqx_highbits = 0xF7DEF7DE;
-uint32 hqx_lowbits = 0x0821;
-uint32 hqx_low2bits = 0x0C63;
-uint32 hqx_low3bits = 0x1CE7;
-uint32 hqx_greenMask = 0;
-uint32 hqx_redBlueMask = 0;
-uint32 hqx_green_redBlue_Mask = 0;
-
-#endif
-
 /**
  * 16bit RGB to YUV conversion table. This table is setup by InitLUT().
  * Used by the hq scaler family.
@@ -102,20 +77,6 @@ void InitLUT(Graphics::PixelFormat format) {
 		RGBtoYUV[color] = (Y << 16) | (u << 8) | v;
 	}
 
-#ifdef USE_NASM
-	hqx_lowbits  = (1 << format.rShift) | (1 << format.gShift) | (1 << format.bShift),
-	hqx_low2bits = (3 << format.rShift) | (3 << format.gShift) | (3 << format.bShift),
-	hqx_low3bits = (7 << format.rShift) | (7 << format.gShift) | (7 << format.bShift),
-
-	hqx_highbits = format.RGBToColor(255,255,255) ^ hqx_lowbits;
-
-	// FIXME: The following code only does the right thing
-	// if the color order is RGB or BGR, i.e., green is in the middle.
-	hqx_greenMask = format.RGBToColor(0,255,0);
-	hqx_redBlueMask = format.RGBToColor(255,0,255);
-
-	hqx_green_redBlue_Mask = (hqx_greenMask << 16) | hqx_redBlueMask;
-#endif
 }
 #endif
 
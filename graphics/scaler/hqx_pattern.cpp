@@ -0,0 +1,171 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/scaler/hqx_pattern.h"
+
+#include "common/atomic.h"
+#include "common/cpudetect.h"
+#include "common/textconsole.h"
+#include "common/util.h"
+
+extern "C" uint32 *RGBtoYUV;
+
+namespace {
+
+HQPatternFunc getHQPatternFunc() {
+#ifdef USE_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return computeHQPatternsSSE2;
+#endif
+#ifdef USE_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return computeHQPatternsNEON;
+#endif
+	return nullptr;
+}
+
+inline bool differs(int a, int b, int threshold) {
+	return ABS(a - b) > threshold;
+}
+
+inline bool differs(HQPatternPlanes planes, int row, int x, int x5) {
+	return differs(planes[row * 3 + 0][x], planes[3][x5], kHQThresholdY) ||
+	       differs(planes[row * 3 + 1][x], planes[4][x5], kHQThresholdU) ||
+	       differs(planes[row * 3 + 2][x], planes[5][x5], kHQThresholdV);
+}
+
+/** Compute the patterns of the pixels from start to width, one at a time. */
+void computeHQPatterns(HQPatternPlanes planes, int start, int width, uint8 *patterns) {
+	for (int x = start; x < width; x++) {
+		// The planes start one pixel to the left, so the pixel itself is at x + 1
+		const int x5 = x + 1;
+		int pattern = 0;
+		if (differs(planes, 0, x5 - 1, x5)) pattern |= 0x01;
+		if (differs(planes, 0, x5,     x5)) pattern |= 0x02;
+		if (differs(planes, 0, x5 + 1, x5)) pattern |= 0x04;
+		if (differs(planes, 1, x5 - 1, x5)) pattern |= 0x08;
+		if (differs(planes, 1, x5 + 1, x5)) pattern |= 0x10;
+		if (differs(planes, 2, x5 - 1, x5)) pattern |= 0x20;
+		if (differs(planes, 2, x5,     x5)) pattern |= 0x40;
+		if (differs(planes, 2, x5 + 1, x5)) pattern |= 0x80;
+		patterns[x] = pattern;
+	}
+}
+
+#ifdef COMMON_HAS_LOCKFREE_ATOMICS
+
+/**
+ * The buffers of finished scaler calls, kept for the next ones. There is a
+ * slot for each thread which may scale at the same time; the scaler pool
+ * never has more than a few.
+ */
+enum { kSpareBuffers = 8 };
+Common::Atomic<HQPatternBuffer *> spareBuffers[kSpareBuffers];
+
+#endif
+
+HQPatternBuffer *acquireBuffer(uint32 size) {
+	HQPatternBuffer *buffer = nullptr;
+#ifdef COMMON_HAS_LOCKFREE_ATOMICS
+	for (int i = 0; i < kSpareBuffers && !buffer; i++)
+		buffer = spareBuffers[i].exchange(nullptr);
+#endif
+
+	if (buffer && buffer->size < size) {
+		free(buffer->data);
+		buffer->data = nullptr;
+	}
+	if (!buffer) {
+		buffer = new HQPatternBuffer();
+		buffer->data = nullptr;
+	}
+	if (!buffer->data) {
+		buffer->data = (byte *)malloc(size);
+		buffer->size = size;
+		if (!buffer->data)
+			error("[HQPatternRows] Cannot allocate memory for the YUV planes");
+	}
+	return buffer;
+}
+
+void releaseBuffer(HQPatternBuffer *buffer) {
+#ifdef COMMON_HAS_LOCKFREE_ATOMICS
+	for (int i = 0; i < kSpareBuffers; i++) {
+		if (spareBuffers[i].compareExchange(nullptr, buffer))
+			return;
+	}
+#endif
+	free(buffer->data);
+	delete buffer;
+}
+
+} // End of anonymous namespace
+
+HQPatternRows::HQPatternRows(const uint16 *src, uint32 nextlineSrc, int width)
+	: _src(src), _nextlineSrc(nextlineSrc), _width(width), _simdFunc(getHQPatternFunc()) {
+	const int planeSize = width + 2;
+	_buffer = acquireBuffer(planeSize * 9 + width);
+
+	for (int i = 0; i < 9; i++)
+		_planes[i] = _buffer->data + planeSize * i;
+	_patterns = _buffer->data + planeSize * 9;
+
+	splitRow(src - nextlineSrc, 0);
+	splitRow(src, 1);
+}
+
+HQPatternRows::~HQPatternRows() {
+	releaseBuffer(_buffer);
+}
+
+void HQPatternRows::splitRow(const uint16 *src, int row) {
+	uint8 *y = _planes[row * 3 + 0];
+	uint8 *u = _planes[row * 3 + 1];
+	uint8 *v = _planes[row * 3 + 2];
+
+	src--;
+	for (int x = 0; x < _width + 2; x++) {
+		const uint32 yuv = RGBtoYUV[src[x]];
+		y[x] = yuv >> 16;
+		u[x] = yuv >> 8;
+		v[x] = yuv;
+	}
+}
+
+const uint8 *HQPatternRows::nextRow() {
+	splitRow(_src + _nextlineSrc, 2);
+
+	const int done = _simdFunc ? _simdFunc(_planes, _width, _patterns) : 0;
+	computeHQPatterns(_planes, done, _width, _patterns);
+
+	// The row below becomes the current one, and the row above is reused
+	// for the next row below
+	for (int i = 0; i < 3; i++) {
+		uint8 *above = _planes[i];
+		_planes[i] = _planes[3 + i];
+		_planes[3 + i] = _planes[6 + i];
+		_planes[6 + i] = above;
+	}
+	_src += _nextlineSrc;
+
+	return _patterns;
+}
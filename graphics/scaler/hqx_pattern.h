@@ -0,0 +1,111 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_HQX_PATTERN_H
+#define GRAPHICS_SCALER_HQX_PATTERN_H
+
+#include "common/scummsys.h"
+
+/*
+ * Internal to the HQ scalers: the computation of the patterns, which tell
+ * for each source pixel which of its eight neighbors differ noticeably from
+ * it. Bit 0 stands for the top left neighbor, bit 7 for the bottom right
+ * one, in reading order.
+ *
+ * The YUV values of the source pixels are looked up in RGBtoYUV only once,
+ * and stored in a Y, U and V plane of bytes for each row. The patterns of a
+ * whole row are then computed from the planes of that row and the rows
+ * above and below it, many pixels at once where the instruction set allows.
+ */
+
+/**
+ * The Y, U and V planes of the rows above, at and below the current row,
+ * in this order. Each plane starts with the pixel left of the row.
+ */
+typedef const uint8 *const HQPatternPlanes[9];
+
+/**
+ * The thresholds above which two pixels count as different, like in
+ * diffYUV().
+ */
+enum {
+	kHQThresholdY = 0x30,
+	kHQThresholdU = 0x07,
+	kHQThresholdV = 0x06
+};
+
+/**
+ * Compute the patterns of the first pixels of a row. Returns how many
+ * patterns were computed, which is left to the implementation.
+ */
+typedef int (*HQPatternFunc)(HQPatternPlanes planes, int width, uint8 *patterns);
+
+#ifdef USE_SSE2
+int computeHQPatternsSSE2(HQPatternPlanes planes, int width, uint8 *patterns);
+#endif
+
+#ifdef USE_NEON
+int computeHQPatternsNEON(HQPatternPlanes planes, int width, uint8 *patterns);
+#endif
+
+/** The memory for the planes and patterns of an HQPatternRows. */
+struct HQPatternBuffer {
+	uint32 size;
+	byte *data;
+};
+
+/**
+ * Walks over the rows of the source of an HQ scaler and provides the
+ * patterns for each of them. Several threads can scale different parts of
+ * the screen at the same time. The memory for the planes is kept between
+ * scaler calls where lock-free atomics allow to share it safely.
+ */
+class HQPatternRows {
+public:
+	/**
+	 * @param src          the first pixel of the first row to scale
+	 * @param nextlineSrc  the source pitch, in pixels
+	 * @param width        the number of pixels to scale in each row
+	 */
+	HQPatternRows(const uint16 *src, uint32 nextlineSrc, int width);
+	~HQPatternRows();
+
+	/**
+	 * Compute the patterns of the next row, starting with the first one.
+	 * The returned array stays valid until the next call.
+	 */
+	const uint8 *nextRow();
+
+private:
+	void splitRow(const uint16 *src, int row);
+
+	const uint16 *_src;
+	const uint32 _nextlineSrc;
+	const int _width;
+	const HQPatternFunc _simdFunc;
+
+	HQPatternBuffer *_buffer;
+	uint8 *_planes[9];
+	uint8 *_patterns;
+};
+
+#endif
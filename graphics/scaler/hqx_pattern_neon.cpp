@@ -0,0 +1,65 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+#include "graphics/scaler/hqx_pattern.h"
+
+#include <arm_neon.h>
+
+namespace {
+
+/** The neighbors of a pixel, as row and offset from the pixel left of it, in bit order. */
+const int kNeighbors[8][2] = {
+	{ 0, 0 }, { 0, 1 }, { 0, 2 },
+	{ 1, 0 },           { 1, 2 },
+	{ 2, 0 }, { 2, 1 }, { 2, 2 }
+};
+
+} // End of anonymous namespace
+
+int computeHQPatternsNEON(HQPatternPlanes planes, int width, uint8 *patterns) {
+	const int end = width - width % 16;
+	const uint8x16_t thresholds[3] = {
+		vdupq_n_u8(kHQThresholdY),
+		vdupq_n_u8(kHQThresholdU),
+		vdupq_n_u8(kHQThresholdV)
+	};
+
+	for (int x = 0; x < end; x += 16) {
+		uint8x16_t center[3];
+		for (int c = 0; c < 3; c++)
+			center[c] = vld1q_u8(planes[3 + c] + x + 1);
+
+		uint8x16_t pattern = vdupq_n_u8(0);
+		for (int i = 0; i < 8; i++) {
+			uint8x16_t differs = vdupq_n_u8(0);
+			for (int c = 0; c < 3; c++) {
+				const uint8x16_t neighbor = vld1q_u8(planes[kNeighbors[i][0] * 3 + c] + x + kNeighbors[i][1]);
+				differs = vorrq_u8(differs, vcgtq_u8(vabdq_u8(neighbor, center[c]), thresholds[c]));
+			}
+			pattern = vorrq_u8(pattern, vandq_u8(differs, vdupq_n_u8(1 << i)));
+		}
+		vst1q_u8(patterns + x, pattern);
+	}
+
+	return end;
+}
@@ -0,0 +1,74 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+
+// This file is compiled with -msse2, see graphics/module.mk
+
+#include "graphics/scaler/hqx_pattern.h"
+
+#include <emmintrin.h>
+
+namespace {
+
+/** The neighbors of a pixel, as row and offset from the pixel left of it, in bit order. */
+const int kNeighbors[8][2] = {
+	{ 0, 0 }, { 0, 1 }, { 0, 2 },
+	{ 1, 0 },           { 1, 2 },
+	{ 2, 0 }, { 2, 1 }, { 2, 2 }
+};
+
+/** Nonzero in the bytes in which a and b differ by more than threshold. */
+inline __m128i differs(__m128i a, __m128i b, __m128i threshold) {
+	const __m128i diff = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+	return _mm_subs_epu8(diff, threshold);
+}
+
+} // End of anonymous namespace
+
+int computeHQPatternsSSE2(HQPatternPlanes planes, int width, uint8 *patterns) {
+	const int end = width - width % 16;
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i thresholds[3] = {
+		_mm_set1_epi8(kHQThresholdY),
+		_mm_set1_epi8(kHQThresholdU),
+		_mm_set1_epi8(kHQThresholdV)
+	};
+
+	for (int x = 0; x < end; x += 16) {
+		__m128i center[3];
+		for (int c = 0; c < 3; c++)
+			center[c] = _mm_loadu_si128((const __m128i *)(planes[3 + c] + x + 1));
+
+		__m128i pattern = zero;
+		for (int i = 0; i < 8; i++) {
+			__m128i diff = zero;
+			for (int c = 0; c < 3; c++) {
+				const __m128i neighbor = _mm_loadu_si128((const __m128i *)(planes[kNeighbors[i][0] * 3 + c] + x + kNeighbors[i][1]));
+				diff = _mm_or_si128(diff, differs(neighbor, center[c], thresholds[c]));
+			}
+			pattern = _mm_or_si128(pattern, _mm_andnot_si128(_mm_cmpeq_epi8(diff, zero), _mm_set1_epi8((char)(1 << i))));
+		}
+		_mm_storeu_si128((__m128i *)(patterns + x), pattern);
+	}
+
+	return end;
+}
@@ -27,24 +27,21 @@
 
 namespace Graphics {
 
-Screen::Screen(): ManagedSurface() {
+Screen::Screen(): ManagedSurface(), _dirtyRects(0, 0, true) {
 	create(g_system->getWidth(), g_system->getHeight(), g_system->getScreenFormat());
 }
 
-Screen::Screen(int width, int height): ManagedSurface() {
+Screen::Screen(int width, int height): ManagedSurface(), _dirtyRects(0, 0, true) {
 	create(width, height);
 }
 
-Screen::Screen(int width, int height, PixelFormat pixelFormat): ManagedSurface() {
+Screen::Screen(int width, int height, PixelFormat pixelFormat): ManagedSurface(), _dirtyRects(0, 0, true) {
 	create(width, height, pixelFormat);
 }
 
 void Screen::update() {
-	// Merge the dirty rects
-	mergeDirtyRects();
-
 	// Loop through copying dirty areas to the physical screen
-	Common::List<Common::Rect>::iterator i;
+	DirtyRectList::const_iterator i;
 	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i) {
 		const Common::Rect &r = *i;
 		const byte *srcP = (const byte *)getBasePtr(r.left, r.top);
@@ -54,7 +51,7 @@ void Screen::update() {
 
 	// Signal the physical screen to update
 	g_system->updateScreen();
-	_dirtyRects.clear();
+	_dirtyRects.nextFrame();
 }
 
 
@@ -64,42 +61,13 @@ void Screen::addDirtyRect(const Common::Rect &r) {
 	bounds.translate(getOffsetFromOwner().x, getOffsetFromOwner().y);
 
 	if (bounds.width() > 0 && bounds.height() > 0)
-		_dirtyRects.push_back(bounds);
+		_dirtyRects.add(bounds);
 }
 
 void Screen::makeAllDirty() {
 	addDirtyRect(Common::Rect(0, 0, this->w, this->h));
 }
 
-void Screen::mergeDirtyRects() {
-	Common::List<Common::Rect>::iterator rOuter, rInner;
-
-	// Process the dirty rect list to find any rects to merge
-	for (rOuter = _dirtyRects.begin(); rOuter != _dirtyRects.end(); ++rOuter) {
-		rInner = rOuter;
-		while (++rInner != _dirtyRects.end()) {
-
-			if ((*rOuter).intersects(*rInner)) {
-				// These two rectangles overlap, so merge them
-				unionRectangle(*rOuter, *rOuter, *rInner);
-
-				// remove the inner rect from the list
-				_dirtyRects.erase(rInner);
-
-				// move back to beginning of list
-				rInner = rOuter;
-			}
-		}
-	}
-}
-
-bool Screen::unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2) {
-	destRect = src1;
-	destRect.extend(src2);
-
-	return !destRect.isEmpty();
-}
-
 void Screen::getPalette(byte palette[PALETTE_SIZE]) {
 	assert(format.bytesPerPixel == 1);
 	g_system->getPaletteManager()->grabPalette(palette, 0, PALETTE_COUNT);
@@ -23,6 +23,7 @@
 #ifndef GRAPHICS_SCREEN_H
 #define GRAPHICS_SCREEN_H
 
+#include "graphics/dirty_rects.h"
 #include "graphics/managed_surface.h"
 #include "graphics/pixelformat.h"
 #include "common/list.h"
@@ -42,19 +43,10 @@ namespace Graphics {
 class Screen : virtual public ManagedSurface {
 private:
 	/**
-	 * List of affected areas of the screen
+	 * List of affected areas of the screen. Intersecting areas are merged,
+	 * so that no pixel is copied to the screen twice.
 	 */
-	Common::List<Common::Rect> _dirtyRects;
-private:
-	/**
-	* Merges together overlapping dirty areas of the screen
-	*/
-	void mergeDirtyRects();
-
-	/**
-	* Returns the union of two dirty area rectangles
-	*/
-	bool unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2);
+	DirtyRectList _dirtyRects;
 protected:
 	/**
 	 * Adds a rectangle to the list of modified areas of the screen during the
@@ -82,6 +74,11 @@ public:
 	 */
 	virtual void clearDirtyRects() { _dirtyRects.clear(); }
 
+	/**
+	 * Returns statistics on how much of the screen was redrawn
+	 */
+	const DirtyRectList::Stats &getDirtyRectStats() const { return _dirtyRects.getStats(); }
+
 	/**
 	 * Updates the screen by copying any affected areas to the system
 	 */
@@ -0,0 +1,162 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transform_cache.h"
+#include "graphics/transparent_surface.h"
+
+namespace Graphics {
+
+bool TransformCache::Key::operator==(const Key &other) const {
+	return pixels == other.pixels && srcW == other.srcW && srcH == other.srcH && srcPitch == other.srcPitch &&
+	       srcFormat == other.srcFormat && srcRect == other.srcRect && zoom == other.zoom && hotspot == other.hotspot &&
+	       angle == other.angle && width == other.width && height == other.height && filtering == other.filtering;
+}
+
+uint TransformCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)(size_t)key.pixels;
+	hash = hash * 31 + (key.srcW | (key.srcH << 16));
+	hash = hash * 31 + (key.srcRect.left | (key.srcRect.top << 16));
+	hash = hash * 31 + (key.srcRect.right | (key.srcRect.bottom << 16));
+	hash = hash * 31 + (key.zoom.x | (key.zoom.y << 16));
+	hash = hash * 31 + (key.hotspot.x | (key.hotspot.y << 16));
+	hash = hash * 31 + key.angle;
+	hash = hash * 31 + (key.width | (key.height << 16));
+	return hash * 2 + key.filtering;
+}
+
+TransformCache::TransformCache(uint32 maxBytes, uint maxEntries) : _size(0), _maxBytes(maxBytes), _maxEntries(maxEntries) {
+	resetStats();
+}
+
+TransformCache::~TransformCache() {
+}
+
+Common::SharedPtr<Surface> TransformCache::get(const Surface &src, const Common::Rect &srcRect, const TransformStruct &transform,
+                                               uint16 width, uint16 height, bool filtering) {
+	Key key;
+	key.pixels = src.getPixels();
+	key.srcW = src.w;
+	key.srcH = src.h;
+	key.srcPitch = src.pitch;
+	key.srcFormat = src.format;
+	key.srcRect = srcRect;
+	key.angle = transform._angle;
+	key.filtering = filtering;
+	if (transform._angle != kDefaultAngle) {
+		// The size follows from the transform
+		key.zoom = transform._zoom;
+		key.hotspot = transform._hotspot;
+		key.width = key.height = 0;
+	} else {
+		key.zoom = Common::Point();
+		key.hotspot = Common::Point();
+		key.width = width;
+		key.height = height;
+	}
+
+	EntryMap::iterator i = _lookup.find(key);
+	if (i != _lookup.end()) {
+		_stats.hits++;
+
+		// Move the entry to the front of the list
+		EntryList::iterator entry = i->_value;
+		if (entry != _entries.begin()) {
+			_entries.push_front(Entry());
+			Entry &front = _entries.front();
+			front.key = entry->key;
+			front.surface = entry->surface;
+			front.size = entry->size;
+			_entries.erase(entry);
+			i->_value = _entries.begin();
+		}
+		return _entries.front().surface;
+	}
+
+	_stats.misses++;
+
+	TransparentSurface section(src.getSubArea(srcRect), false);
+	TransparentSurface *transformed;
+	if (transform._angle != kDefaultAngle)
+		transformed = section.rotoscale(transform, filtering);
+	else
+		transformed = section.scale(width, height, filtering);
+
+	// Construct the entry in place, so the surface has a single owner
+	// until it is returned
+	_entries.push_front(Entry());
+	Entry &entry = _entries.front();
+	entry.key = key;
+	entry.surface = Common::SharedPtr<Surface>(transformed, SharedPtrSurfaceDeleter());
+	entry.size = transformed->pitch * transformed->h;
+
+	_lookup[key] = _entries.begin();
+	_size += entry.size;
+
+	Common::SharedPtr<Surface> result = entry.surface;
+	enforceLimits();
+	return result;
+}
+
+void TransformCache::invalidate(const Surface &src) {
+	EntryList::iterator i = _entries.begin();
+	while (i != _entries.end()) {
+		EntryList::iterator next = i;
+		++next;
+		if (i->key.pixels == src.getPixels())
+			evict(i);
+		i = next;
+	}
+}
+
+void TransformCache::clear() {
+	_entries.clear();
+	_lookup.clear();
+	_size = 0;
+}
+
+void TransformCache::setLimits(uint32 maxBytes, uint maxEntries) {
+	_maxBytes = maxBytes;
+	_maxEntries = maxEntries;
+	enforceLimits();
+}
+
+void TransformCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+void TransformCache::evict(EntryList::iterator entry) {
+	_size -= entry->size;
+	_lookup.erase(entry->key);
+	_entries.erase(entry);
+}
+
+void TransformCache::enforceLimits() {
+	while (!_entries.empty() && (_size > _maxBytes || _lookup.size() > _maxEntries)) {
+		EntryList::iterator last = _entries.reverse_begin();
+		evict(last);
+		_stats.evictions++;
+	}
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,133 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSFORM_CACHE_H
+#define GRAPHICS_TRANSFORM_CACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/ptr.h"
+#include "common/rect.h"
+#include "graphics/surface.h"
+#include "graphics/transform_struct.h"
+
+namespace Graphics {
+
+/**
+ * Cache for scaled and rotated versions of 32bpp surfaces.
+ *
+ * Engines which draw the same sprites with the same transformation frame
+ * after frame can get the transformed surface from here, instead of
+ * creating it again every time. The least recently used entries are
+ * dropped when the cache exceeds its limits on total size or number of
+ * entries.
+ *
+ * Entries are identified by the pixel data, size and format of the source
+ * surface. Whoever owns the source has to call invalidate() when its
+ * content changes or it is freed.
+ */
+class TransformCache {
+public:
+	struct Stats {
+		uint32 hits;        ///< Lookups answered from the cache
+		uint32 misses;      ///< Lookups which required transforming the surface
+		uint32 evictions;   ///< Entries dropped to stay within the limits
+	};
+
+	TransformCache(uint32 maxBytes = 16 * 1024 * 1024, uint maxEntries = 256);
+	~TransformCache();
+
+	/**
+	 * Get the section srcRect of the source surface, transformed. If the
+	 * transform contains a rotation, this is what TransparentSurface::rotoscale()
+	 * returns, otherwise the section scaled to width x height.
+	 *
+	 * The returned surface stays valid as long as a reference to it is
+	 * held, even if it is dropped from the cache meanwhile.
+	 */
+	Common::SharedPtr<Surface> get(const Surface &src, const Common::Rect &srcRect, const TransformStruct &transform,
+	                               uint16 width, uint16 height, bool filtering = false);
+
+	/** Drop all entries created from the given source surface. */
+	void invalidate(const Surface &src);
+
+	/** Drop all entries. */
+	void clear();
+
+	/** Change the limits, dropping entries if necessary. */
+	void setLimits(uint32 maxBytes, uint maxEntries);
+
+	/** Total size in bytes of the surfaces held by the cache. */
+	uint32 getSize() const { return _size; }
+	uint getEntryCount() const { return _lookup.size(); }
+
+	const Stats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	struct Key {
+		// The pixel pointer alone is not enough, since another surface
+		// may be allocated at the same address after the source is freed
+		const void *pixels;
+		uint16 srcW, srcH, srcPitch;
+		PixelFormat srcFormat;
+		Common::Rect srcRect;
+		Common::Point zoom;
+		Common::Point hotspot;
+		int32 angle;
+		uint16 width, height;
+		bool filtering;
+
+		bool operator==(const Key &other) const;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const { return a == b; }
+	};
+
+	struct Entry {
+		Key key;
+		Common::SharedPtr<Surface> surface;
+		uint32 size;
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<Key, EntryList::iterator, KeyHash, KeyEqual> EntryMap;
+
+	void evict(EntryList::iterator entry);
+	void enforceLimits();
+
+	EntryList _entries;     ///< Most recently used first
+	EntryMap _lookup;
+	uint32 _size;
+	uint32 _maxBytes;
+	uint _maxEntries;
+	Stats _stats;
+};
+
+} // End of namespace Graphics
+
+#endif
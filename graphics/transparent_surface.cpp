@@ -28,6 +28,7 @@
 
 
 #include "common/algorithm.h"
+#include "common/cpudetect.h"
 #include "common/endian.h"
 #include "common/util.h"
 #include "common/rect.h"
@@ -35,10 +36,9 @@
 #include "common/textconsole.h"
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
+#include "graphics/transparent_surface_simd.h"
 #include "graphics/transform_tools.h"
 
-//#define ENABLE_BILINEAR
-
 namespace Graphics {
 
 static const int kBModShift = 0;//img->format.bShift;
@@ -61,9 +61,50 @@ static const int kRIndex = 0;
 
 void doBlitOpaqueFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
 void doBlitBinaryFast(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep);
-void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
-void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+typedef void (*BlendBlitFunc)(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+/**
+ * The blending kernels for one instruction set.
+ */
+struct BlendBlitFuncs {
+	BlendBlitFunc alphaBlend;
+	BlendBlitFunc additiveBlend;
+	BlendBlitFunc subtractiveBlend;
+};
+
+static const BlendBlitFuncs kScalarBlendBlitFuncs = { doBlitAlphaBlend, doBlitAdditiveBlend, doBlitSubtractiveBlend };
+#ifdef USE_SSE2
+static const BlendBlitFuncs kSSE2BlendBlitFuncs = { doBlitAlphaBlendSSE2, doBlitAdditiveBlendSSE2, doBlitSubtractiveBlendSSE2 };
+#endif
+#ifdef USE_AVX2
+static const BlendBlitFuncs kAVX2BlendBlitFuncs = { doBlitAlphaBlendAVX2, doBlitAdditiveBlendAVX2, doBlitSubtractiveBlendAVX2 };
+#endif
+#ifdef USE_NEON
+static const BlendBlitFuncs kNEONBlendBlitFuncs = { doBlitAlphaBlendNEON, doBlitAdditiveBlendNEON, doBlitSubtractiveBlendNEON };
+#endif
+
+/**
+ * Pick the fastest blending kernels the CPU supports. They all give the
+ * same results as the scalar ones.
+ */
+static const BlendBlitFuncs &getBlendBlitFuncs() {
+#ifdef SCUMM_LITTLE_ENDIAN
+#ifdef USE_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return kAVX2BlendBlitFuncs;
+#endif
+#ifdef USE_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return kSSE2BlendBlitFuncs;
+#endif
+#ifdef USE_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return kNEONBlendBlitFuncs;
+#endif
+#endif
+	return kScalarBlendBlitFuncs;
+}
 
 TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL) {}
 
@@ -302,19 +343,19 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 
 				out[kAIndex] = 255;
 				if (cb != 255) {
-					out[kBIndex] = MAX(out[kBIndex] - ((in[kBIndex] * cb  * (out[kBIndex]) * in[kAIndex]) >> 24), 0);
+					out[kBIndex] = MAX<int>(out[kBIndex] - (int)(((uint32)in[kBIndex] * cb * out[kBIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kBIndex] = MAX(out[kBIndex] - (in[kBIndex] * (out[kBIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cg != 255) {
-					out[kGIndex] = MAX(out[kGIndex] - ((in[kGIndex] * cg  * (out[kGIndex]) * in[kAIndex]) >> 24), 0);
+					out[kGIndex] = MAX<int>(out[kGIndex] - (int)(((uint32)in[kGIndex] * cg * out[kGIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kGIndex] = MAX(out[kGIndex] - (in[kGIndex] * (out[kGIndex]) * in[kAIndex] >> 16), 0);
 				}
 
 				if (cr != 255) {
-					out[kRIndex] = MAX(out[kRIndex] - ((in[kRIndex] * cr * (out[kRIndex]) * in[kAIndex]) >> 24), 0);
+					out[kRIndex] = MAX<int>(out[kRIndex] - (int)(((uint32)in[kRIndex] * cr * out[kRIndex] * in[kAIndex]) >> 24), 0);
 				} else {
 					out[kRIndex] = MAX(out[kRIndex] - (in[kRIndex] * (out[kRIndex]) * in[kAIndex] >> 16), 0);
 				}
@@ -328,6 +369,29 @@ void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height,
 	}
 }
 
+/**
+ * Blit using the kernel matching the color, blend mode and alpha mode.
+ */
+static void doBlit(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, TSpriteBlendMode blendMode, AlphaType alphaMode) {
+	if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_OPAQUE) {
+		doBlitOpaqueFast(ino, outo, width, height, pitch, inStep, inoStep);
+	} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_BINARY) {
+		doBlitBinaryFast(ino, outo, width, height, pitch, inStep, inoStep);
+	} else {
+		const BlendBlitFuncs &funcs = getBlendBlitFuncs();
+		if (blendMode == BLEND_ADDITIVE) {
+			funcs.additiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else if (blendMode == BLEND_SUBTRACTIVE) {
+			funcs.subtractiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else {
+			assert(blendMode == BLEND_NORMAL);
+			funcs.alphaBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		}
+	}
+}
+
+static Common::Rect blitScaled(const Surface &src, Surface &target, int posX, int posY, int flipping, uint color, int width, int height, TSpriteBlendMode blendMode, AlphaType alphaMode);
+
 Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
 
 	Common::Rect retSize;
@@ -388,17 +452,13 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 	height = height * 2 / 3;
 #endif
 
-	Graphics::Surface *img = nullptr;
-	Graphics::Surface *imgScaled = nullptr;
-	byte *savedPixels = nullptr;
 	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
-	} else {
-		img = &srcImage;
+		// Scale the image on the fly
+		return blitScaled(srcImage, target, posX, posY, flipping, color, width, height, blendMode, _alphaMode);
 	}
 
+	Graphics::Surface *img = &srcImage;
+
 	// Handle off-screen clipping
 	if (posY < 0) {
 		img->h = MAX(0, (int)img->h - -posY);
@@ -433,32 +493,12 @@ Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int p
 		byte *ino = (byte *)img->getBasePtr(xp, yp);
 		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
-		}
-
+		doBlit(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color, blendMode, _alphaMode);
 	}
 
 	retSize.setWidth(img->w);
 	retSize.setHeight(img->h);
 
-	if (imgScaled) {
-		imgScaled->setPixels(savedPixels);
-		imgScaled->free();
-		delete imgScaled;
-	}
-
 	return retSize;
 }
 
@@ -502,7 +542,7 @@ void TransparentSurface::setAlphaMode(AlphaType mode) {
 
 /*
 
-The below two functions are adapted from SDL_rotozoom.c,
+The samplers below are adapted from SDL_rotozoom.c,
 taken from SDL_gfx-2.0.18.
 
 Its copyright notice:
@@ -544,306 +584,401 @@ systems.
 
 
 
-TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform) const {
+namespace {
 
-	assert(transform._angle != 0); // This would not be ideal; rotoscale() should never be called in conditional branches where angle = 0 anyway.
+/**
+ * Bilinear interpolation between four pixels, treating all channels alike.
+ * ex and ey are the 16.16 fixed point fractions of the sample position.
+ */
+inline uint32 interpolate(const byte *c00, const byte *c01, const byte *c10, const byte *c11, int ex, int ey) {
+	uint32 result;
+	byte *dst = (byte *)&result;
+	for (int i = 0; i < 4; i++) {
+		int t1 = ((((c01[i] - c00[i]) * ex) >> 16) + c00[i]) & 0xff;
+		int t2 = ((((c11[i] - c10[i]) * ex) >> 16) + c10[i]) & 0xff;
+		dst[i] = (((t2 - t1) * ey) >> 16) + t1;
+	}
+	return result;
+}
 
-	Common::Point newHotspot;
-	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
-	Common::Rect rect = TransformTools::newRect(Common::Rect(srcRect), transform, &newHotspot);
-	Common::Rect dstRect(0, 0, (int16)(rect.right - rect.left), (int16)(rect.bottom - rect.top));
+/**
+ * Produces rows of a scaled version of a surface.
+ */
+class ScaleSampler {
+public:
+	ScaleSampler(const Surface &src, int dstW, int dstH, bool filtering) :
+		_src(src), _dstW(dstW), _dstH(dstH), _filtering(filtering) {
+		// For filtering, the corners of the destination map onto the
+		// corners of the source.
+		_stepX = (dstW > 1) ? (int)(65536.0f * (float)(src.w - 1) / (float)(dstW - 1)) : 0;
+		_stepY = (dstH > 1) ? (int)(65536.0f * (float)(src.h - 1) / (float)(dstH - 1)) : 0;
+	}
 
-	TransparentSurface *target = new TransparentSurface();
-	assert(format.bytesPerPixel == 4);
+	int width() const { return _dstW; }
+	int height() const { return _dstH; }
 
-	int srcW = w;
-	int srcH = h;
-	int dstW = dstRect.width();
-	int dstH = dstRect.height();
+	/** All pixels map onto the source. */
+	void getSpan(int y, int x0, int count, int &start, int &end) const {
+		start = 0;
+		end = count;
+	}
 
-	target->create((uint16)dstW, (uint16)dstH, this->format);
+	/** Write count pixels of row y, starting at column x0, to dst. */
+	void sampleRow(int y, int x0, int count, uint32 *dst) const {
+		if (_filtering)
+			sampleRowBilinear(y, x0, count, dst);
+		else
+			sampleRowNearest(y, x0, count, dst);
+	}
 
-	if (transform._zoom.x == 0 || transform._zoom.y == 0) {
-		return target;
+	void sampleSpan(int y, int x0, int count, uint32 *dst) const {
+		sampleRow(y, x0, count, dst);
 	}
 
-	uint32 invAngle = 360 - (transform._angle % 360);
-	float invCos = cos(invAngle * M_PI / 180.0);
-	float invSin = sin(invAngle * M_PI / 180.0);
+private:
+	void sampleRowNearest(int y, int x0, int count, uint32 *dst) const {
+		const uint32 *srcP = (const uint32 *)_src.getBasePtr(0, (uint32)y * _src.h / _dstH);
+
+		// Step through x * srcW / dstW without dividing for every pixel
+		const uint32 start = (uint32)x0 * _src.w;
+		uint32 srcX = start / _dstW;
+		uint32 frac = start % _dstW;
+		const uint32 step = _src.w / _dstW;
+		const uint32 fracStep = _src.w % _dstW;
+
+		for (int x = 0; x < count; x++) {
+			*dst++ = srcP[srcX];
+			srcX += step;
+			frac += fracStep;
+			if (frac >= (uint32)_dstW) {
+				frac -= _dstW;
+				srcX++;
+			}
+		}
+	}
 
-	struct tColorRGBA { byte r; byte g; byte b; byte a; };
-	int icosx = (int)(invCos * (65536.0f * kDefaultZoomX / transform._zoom.x));
-	int isinx = (int)(invSin * (65536.0f * kDefaultZoomX / transform._zoom.x));
-	int icosy = (int)(invCos * (65536.0f * kDefaultZoomY / transform._zoom.y));
-	int isiny = (int)(invSin * (65536.0f * kDefaultZoomY / transform._zoom.y));
+	void sampleRowBilinear(int y, int x0, int count, uint32 *dst) const {
+		const int maxX = (_src.w << 16) - 1;
+		const int maxY = (_src.h << 16) - 1;
+
+		const int sy = (int)MIN<int64>((int64)y * _stepY, maxY);
+		const int cy = sy >> 16;
+		const int ey = sy & 0xffff;
+		const byte *row0 = (const byte *)_src.getBasePtr(0, cy);
+		const byte *row1 = (cy < _src.h - 1) ? row0 + _src.pitch : row0;
+
+		int sx = (int)MIN<int64>((int64)x0 * _stepX, maxX);
+		for (int x = 0; x < count; x++) {
+			const int cx = sx >> 16;
+			const int next = (cx < _src.w - 1) ? 4 : 0;
+			const byte *c00 = row0 + cx * 4;
+			const byte *c10 = row1 + cx * 4;
+			*dst++ = interpolate(c00, c00 + next, c10, c10 + next, sx & 0xffff, ey);
+
+			sx = MIN(sx + _stepX, maxX);
+		}
+	}
 
+	const Surface &_src;
+	int _dstW, _dstH;
+	bool _filtering;
+	int _stepX, _stepY;
+};
 
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
+/**
+ * Produces rows of a rotated and scaled version of a surface. Pixels which
+ * do not map onto the source are fully transparent.
+ */
+class RotoscaleSampler {
+public:
+	RotoscaleSampler(const Surface &src, const TransformStruct &transform, bool filtering) :
+		_src(src), _filtering(filtering) {
+		Common::Point newHotspot;
+		Common::Rect rect = TransformTools::newRect(Common::Rect(0, 0, (int16)src.w, (int16)src.h), transform, &newHotspot);
+		_dstW = rect.width();
+		_dstH = rect.height();
+
+		_empty = (transform._zoom.x == 0 || transform._zoom.y == 0);
+		if (_empty)
+			return;
+
+		uint32 invAngle = 360 - (transform._angle % 360);
+		float invCos = cos(invAngle * M_PI / 180.0);
+		float invSin = sin(invAngle * M_PI / 180.0);
+
+		_icosx = (int)(invCos * (65536.0f * kDefaultZoomX / transform._zoom.x));
+		_isinx = (int)(invSin * (65536.0f * kDefaultZoomX / transform._zoom.x));
+		_icosy = (int)(invCos * (65536.0f * kDefaultZoomY / transform._zoom.y));
+		_isiny = (int)(invSin * (65536.0f * kDefaultZoomY / transform._zoom.y));
+
+		_xd = transform._hotspot.x << 16;
+		_yd = transform._hotspot.y << 16;
+		_cy = newHotspot.y;
+
+		_ax = -_icosx * newHotspot.x;
+		_ay = -_isiny * newHotspot.x;
+	}
 
-	int xd = (srcRect.left + transform._hotspot.x) << 16;
-	int yd = (srcRect.top + transform._hotspot.y) << 16;
-	int cx = newHotspot.x;
-	int cy = newHotspot.y;
+	int width() const { return _dstW; }
+	int height() const { return _dstH; }
+
+	/**
+	 * Find the part [start, end) of the count pixels of row y, starting at
+	 * column x0, which maps onto the source. All other pixels of the row
+	 * are fully transparent.
+	 */
+	void getSpan(int y, int x0, int count, int &start, int &end) const {
+		start = 0;
+		end = count;
+		if (_empty) {
+			end = 0;
+			return;
+		}
 
-	int ax = -icosx * cx;
-	int ay = -isiny * cx;
-	int sw = srcW - 1;
-	int sh = srcH - 1;
+		int sdx, sdy;
+		getRowStart(y, x0, sdx, sdy);
 
-	tColorRGBA *pc = (tColorRGBA*)target->getBasePtr(0, 0);
+		// Bilinear filtering needs the next pixel in both directions as well
+		const int border = _filtering ? 1 : 0;
+		clipSpan(sdx, _icosx, ((_src.w - border) << 16) - 1, start, end);
+		clipSpan(sdy, _isiny, ((_src.h - border) << 16) - 1, start, end);
+	}
 
-	for (int y = 0; y < dstH; y++) {
-		int t = cy - y;
-		int sdx = ax + (isinx * t) + xd;
-		int sdy = ay - (icosy * t) + yd;
-		for (int x = 0; x < dstW; x++) {
-			int dx = (sdx >> 16);
-			int dy = (sdy >> 16);
-			if (flipx) {
-				dx = sw - dx;
-			}
-			if (flipy) {
-				dy = sh - dy;
-			}
+	/** Write count pixels of row y, starting at column x0, to dst. */
+	void sampleRow(int y, int x0, int count, uint32 *dst) const {
+		int start, end;
+		getSpan(y, x0, count, start, end);
 
-#ifdef ENABLE_BILINEAR
-			if ((dx > -1) && (dy > -1) && (dx < sw) && (dy < sh)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				tColorRGBA c00, c01, c10, c11, cswap;
-				c00 = *sp;
-				sp += 1;
-				c01 = *sp;
-				sp += (this->pitch / 4);
-				c11 = *sp;
-				sp -= 1;
-				c10 = *sp;
-				if (flipx) {
-					cswap = c00; c00=c01; c01=cswap;
-					cswap = c10; c10=c11; c11=cswap;
-				}
-				if (flipy) {
-					cswap = c00; c00=c10; c10=cswap;
-					cswap = c01; c01=c11; c11=cswap;
-				}
-				/*
-				* Interpolate colors
-				*/
-				int ex = (sdx & 0xffff);
-				int ey = (sdy & 0xffff);
-				int t1, t2;
-				t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-				t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-				pc->r = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-				t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-				pc->g = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-				t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-				pc->b = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-				t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-				pc->a = (((t2 - t1) * ey) >> 16) + t1;
+		memset(dst, 0, start * 4);
+		memset(dst + end, 0, (count - end) * 4);
+		if (start < end)
+			sampleSpan(y, x0 + start, end - start, dst + start);
+	}
+
+	/**
+	 * Like sampleRow(), but all of the pixels have to be within the span
+	 * returned by getSpan().
+	 */
+	void sampleSpan(int y, int x0, int count, uint32 *dst) const {
+		int sdx, sdy;
+		getRowStart(y, x0, sdx, sdy);
+
+		// Within the span, there is no need to check the source bounds
+		const byte *pixels = (const byte *)_src.getPixels();
+		const int pitch = _src.pitch;
+
+		if (_filtering) {
+			for (int x = 0; x < count; x++) {
+				const byte *c00 = pixels + (sdy >> 16) * pitch + (sdx >> 16) * 4;
+				const byte *c10 = c00 + pitch;
+				dst[x] = interpolate(c00, c00 + 4, c10, c10 + 4, sdx & 0xffff, sdy & 0xffff);
+
+				sdx += _icosx;
+				sdy += _isiny;
 			}
-#else
-			if ((dx >= 0) && (dy >= 0) && (dx < srcW) && (dy < srcH)) {
-				const tColorRGBA *sp = (const tColorRGBA *)getBasePtr(dx, dy);
-				*pc = *sp;
+		} else {
+			for (int x = 0; x < count; x++) {
+				dst[x] = *(const uint32 *)(pixels + (sdy >> 16) * pitch + (sdx >> 16) * 4);
+
+				sdx += _icosx;
+				sdy += _isiny;
 			}
-#endif
-			sdx += icosx;
-			sdy += isiny;
-			pc++;
 		}
 	}
-	return target;
-}
 
-TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight) const {
+private:
+	/** The source position of column x0 of row y, in 16.16 fixed point. */
+	void getRowStart(int y, int x0, int &sdx, int &sdy) const {
+		const int t = _cy - y;
+		sdx = _ax + (_isinx * t) + _xd + x0 * _icosx;
+		sdy = _ay - (_icosy * t) + _yd + x0 * _isiny;
+	}
 
-	Common::Rect srcRect(0, 0, (int16)w, (int16)h);
-	Common::Rect dstRect(0, 0, (int16)newWidth, (int16)newHeight);
+	static int64 floorDiv(int64 a, int64 b) {
+		int64 q = a / b;
+		if ((a % b) != 0 && ((a < 0) != (b < 0)))
+			q--;
+		return q;
+	}
 
-	TransparentSurface *target = new TransparentSurface();
+	/**
+	 * Narrow [start, end) down to the columns x for which pos + x * step
+	 * lies within [0, max].
+	 */
+	static void clipSpan(int pos, int step, int max, int &start, int &end) {
+		int64 first, last;
+		if (step > 0) {
+			first = -floorDiv(pos, step);
+			last = floorDiv((int64)max - pos, step);
+		} else if (step < 0) {
+			first = -floorDiv((int64)max - pos, -step);
+			last = floorDiv(pos, -step);
+		} else if (pos >= 0 && pos <= max) {
+			return;
+		} else {
+			first = 0;
+			last = -1;
+		}
 
-	assert(format.bytesPerPixel == 4);
+		start = (int)CLIP<int64>(first, start, end);
+		end = (int)CLIP<int64>(last + 1, start, end);
+	}
 
-	int srcW = srcRect.width();
-	int srcH = srcRect.height();
-	int dstW = dstRect.width();
-	int dstH = dstRect.height();
+	const Surface &_src;
+	bool _filtering;
+	bool _empty;
+	int _dstW, _dstH;
+	int _icosx, _isinx, _icosy, _isiny;
+	int _xd, _yd, _cy, _ax, _ay;
+};
 
-	target->create((uint16)dstW, (uint16)dstH, this->format);
+/**
+ * Blit the image produced by a sampler like TransparentSurface::blit()
+ * would blit it, one row at a time. Only the visible part of the image is
+ * sampled, and there is no intermediate surface.
+ *
+ * The image starts at (offsetX, offsetY) in the sampler's coordinates and
+ * is imgW x imgH pixels large.
+ */
+/**
+ * Whether blitting a fully transparent pixel leaves the target unchanged,
+ * so that such pixels can be skipped.
+ */
+bool skipsTransparent(uint color, TSpriteBlendMode blendMode, AlphaType alphaMode) {
+	if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_OPAQUE)
+		return false;
 
-#ifdef ENABLE_BILINEAR
+	// Color modulated alpha blending and subtractive blending still change
+	// the target, see doBlitAlphaBlend() and doBlitSubtractiveBlend()
+	return color == 0xFFFFFFFF || blendMode == BLEND_ADDITIVE;
+}
 
-	// NB: The actual order of these bytes may not be correct, but
-	// since all values are treated equal, that does not matter.
-	struct tColorRGBA { byte r; byte g; byte b; byte a; };
+template<class Sampler>
+Common::Rect blitSampled(const Sampler &sampler, int offsetX, int offsetY, int imgW, int imgH, Surface &target, int posX, int posY, int flipping, uint color, TSpriteBlendMode blendMode, AlphaType alphaMode) {
+	// Handle off-screen clipping
+	int x0 = 0, y0 = 0;
+	if (posY < 0) {
+		imgH = MAX(0, imgH - -posY);
+		y0 = -posY;
+		posY = 0;
+	}
 
-	bool flipx = false, flipy = false; // TODO: See mirroring comment in RenderTicket ctor
+	if (posX < 0) {
+		imgW = MAX(0, imgW - -posX);
+		x0 = -posX;
+		posX = 0;
+	}
 
+	imgW = CLIP(imgW, 0, (int)MAX((int)target.w - posX, 0));
+	imgH = CLIP(imgH, 0, (int)MAX((int)target.h - posY, 0));
 
-	int *sax = new int[dstW + 1];
-	int *say = new int[dstH + 1];
-	assert(sax && say);
+	if (imgW > 0 && imgH > 0) {
+		uint32 *row = new uint32[imgW];
+		const bool skip = skipsTransparent(color, blendMode, alphaMode);
 
-	/*
-	* Precalculate row increments
-	*/
-	int spixelw = (srcW - 1);
-	int spixelh = (srcH - 1);
-	int sx = (int) (65536.0f * (float) spixelw / (float) (dstW - 1));
-	int sy = (int) (65536.0f * (float) spixelh / (float) (dstH - 1));
+		for (int i = 0; i < imgH; i++) {
+			// Flipping is applied to the clipped image, just like in blit()
+			const int y = offsetY + y0 + ((flipping & FLIP_V) ? (imgH - 1 - i) : i);
 
-	/* Maximum scaled source size */
-	int ssx = (srcW << 16) - 1;
-	int ssy = (srcH << 16) - 1;
+			int start = 0, end = imgW;
+			if (skip) {
+				sampler.getSpan(y, offsetX + x0, imgW, start, end);
+				if (start >= end)
+					continue;
+			}
 
-	/* Precalculate horizontal row increments */
-	int csx = 0;
-	int *csax = sax;
-	for (int x = 0; x <= dstW; x++) {
-		*csax = csx;
-		csax++;
-		csx += sx;
+			const int count = end - start;
+			if (skip)
+				sampler.sampleSpan(y, offsetX + x0 + start, count, row);
+			else
+				sampler.sampleRow(y, offsetX + x0, count, row);
+
+			int x = start;
+			if (flipping & FLIP_H) {
+				for (int l = 0, r = count - 1; l < r; l++, r--)
+					SWAP(row[l], row[r]);
+				x = imgW - end;
+			}
 
-		/* Guard from overflows */
-		if (csx > ssx) {
-			csx = ssx;
+			doBlit((byte *)row, (byte *)target.getBasePtr(posX + x, posY + i), count, 1, target.pitch, 4, 0, color, blendMode, alphaMode);
 		}
+
+		delete[] row;
 	}
 
-	/* Precalculate vertical row increments */
-	int csy = 0;
-	int *csay = say;
-	for (int y = 0; y <= dstH; y++) {
-		*csay = csy;
-		csay++;
-		csy += sy;
+	Common::Rect retSize;
+	retSize.top = 0;
+	retSize.left = 0;
+	retSize.setWidth(imgW);
+	retSize.setHeight(imgH);
+	return retSize;
+}
 
-		/* Guard from overflows */
-		if (csy > ssy) {
-			csy = ssy;
-		}
-	}
+} // End of anonymous namespace
 
-	const tColorRGBA *sp = (const tColorRGBA *) getBasePtr(0, 0);
-	tColorRGBA *dp = (tColorRGBA *) target->getBasePtr(0, 0);
-	int spixelgap = srcW;
-
-	if (flipx) {
-		sp += spixelw;
-	}
-	if (flipy) {
-		sp += spixelgap * spixelh;
-	}
-
-	csay = say;
-	for (int y = 0; y < dstH; y++) {
-		const tColorRGBA *csp = sp;
-		csax = sax;
-		for (int x = 0; x < dstW; x++) {
-			/*
-			* Setup color source pointers
-			*/
-			int ex = (*csax & 0xffff);
-			int ey = (*csay & 0xffff);
-			int cx = (*csax >> 16);
-			int cy = (*csay >> 16);
-
-			const tColorRGBA *c00, *c01, *c10, *c11;
-			c00 = sp;
-			c01 = sp;
-			c10 = sp;
-			if (cy < spixelh) {
-				if (flipy) {
-					c10 -= spixelgap;
-				} else {
-					c10 += spixelgap;
-				}
-			}
-			c11 = c10;
-			if (cx < spixelw) {
-				if (flipx) {
-					c01--;
-					c11--;
-				} else {
-					c01++;
-					c11++;
-				}
-			}
+static Common::Rect blitScaled(const Surface &src, Surface &target, int posX, int posY, int flipping, uint color, int width, int height, TSpriteBlendMode blendMode, AlphaType alphaMode) {
+	ScaleSampler sampler(src, width, height, false);
+	return blitSampled(sampler, 0, 0, width, height, target, posX, posY, flipping, color, blendMode, alphaMode);
+}
 
-			/*
-			* Draw and interpolate colors
-			*/
-			int t1, t2;
-			t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
-			t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
-			dp->r = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
-			t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
-			dp->g = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
-			t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
-			dp->b = (((t2 - t1) * ey) >> 16) + t1;
-			t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
-			t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
-			dp->a = (((t2 - t1) * ey) >> 16) + t1;
-
-			/*
-			* Advance source pointer x
-			*/
-			int *salastx = csax;
-			csax++;
-			int sstepx = (*csax >> 16) - (*salastx >> 16);
-			if (flipx) {
-				sp -= sstepx;
-			} else {
-				sp += sstepx;
-			}
+Common::Rect TransparentSurface::rotoscaleBlit(Graphics::Surface &target, int posX, int posY, const TransformStruct &transform, Common::Rect *pPartRect, bool filtering) {
+	Common::Rect retSize;
 
-			/*
-			* Advance destination pointer x
-			*/
-			dp++;
-		}
-		/*
-		* Advance source pointer y
-		*/
-		int *salasty = csay;
-		csay++;
-		int sstepy = (*csay >> 16) - (*salasty >> 16);
-		sstepy *= spixelgap;
-		if (flipy) {
-			sp = csp - sstepy;
-		} else {
-			sp = csp + sstepy;
-		}
+	// Check if we need to draw anything at all
+	int ca = (transform._rgbaMod >> kAModShift) & 0xff;
+	if (ca == 0) {
+		return retSize;
 	}
 
-	delete[] sax;
-	delete[] say;
+	if (format.bytesPerPixel != 4) {
+		warning("TransparentSurface can only blit 32bpp images, but got %d", format.bytesPerPixel * 8);
+		return retSize;
+	}
 
-#else
+	RotoscaleSampler sampler(*this, transform, filtering);
 
-	int *scaleCacheX = new int[dstW];
-	for (int x = 0; x < dstW; x++) {
-		scaleCacheX[x] = (x * srcW) / dstW;
+	int offsetX = 0, offsetY = 0;
+	int imgW = sampler.width();
+	int imgH = sampler.height();
+	if (pPartRect) {
+		offsetX = (transform._flip & FLIP_H) ? imgW - pPartRect->right : pPartRect->left;
+		offsetY = (transform._flip & FLIP_V) ? imgH - pPartRect->bottom : pPartRect->top;
+		imgW = pPartRect->width();
+		imgH = pPartRect->height();
 	}
 
-	for (int y = 0; y < dstH; y++) {
-		uint32 *destP = (uint32 *)target->getBasePtr(0, y);
-		const uint32 *srcP = (const uint32 *)getBasePtr(0, (y * srcH) / dstH);
-		for (int x = 0; x < dstW; x++) {
-			*destP++ = srcP[scaleCacheX[x]];
-		}
-	}
-	delete[] scaleCacheX;
+	return blitSampled(sampler, offsetX, offsetY, imgW, imgH, target, posX, posY, transform._flip, transform._rgbaMod, transform._blendMode, _alphaMode);
+}
 
-#endif
+TransparentSurface *TransparentSurface::rotoscale(const TransformStruct &transform, bool filtering) const {
+
+	assert(transform._angle != 0); // This would not be ideal; rotoscale() should never be called in conditional branches where angle = 0 anyway.
+	assert(format.bytesPerPixel == 4);
+
+	RotoscaleSampler sampler(*this, transform, filtering);
+
+	TransparentSurface *target = new TransparentSurface();
+	target->create((uint16)sampler.width(), (uint16)sampler.height(), this->format);
+
+	for (int y = 0; y < sampler.height(); y++)
+		sampler.sampleRow(y, 0, sampler.width(), (uint32 *)target->getBasePtr(0, y));
 
 	return target;
+}
 
+TransparentSurface *TransparentSurface::scale(uint16 newWidth, uint16 newHeight, bool filtering) const {
+
+	assert(format.bytesPerPixel == 4);
+
+	ScaleSampler sampler(*this, newWidth, newHeight, filtering);
+
+	TransparentSurface *target = new TransparentSurface();
+	target->create(newWidth, newHeight, this->format);
+
+	for (int y = 0; y < newHeight; y++)
+		sampler.sampleRow(y, 0, newWidth, (uint32 *)target->getBasePtr(0, y));
+
+	return target;
 }
 
 } // End of namespace Graphics
@@ -125,24 +125,43 @@ struct TransparentSurface : public Graphics::Surface {
 	                  TSpriteBlendMode blend = BLEND_NORMAL);
 	void applyColorKey(uint8 r, uint8 g, uint8 b, bool overwriteAlpha = false);
 
+	/**
+	 @brief renders a rotated and scaled version of the surface to another surface
+	 This gives the same result as blitting the surface returned by rotoscale() with the flipping,
+	 color modulation and blend mode of the transform. However, the source is sampled directly for
+	 each row drawn, so no transformed copy of the surface is created.
+	 @param target the surface to draw to.
+	 @param posX the position on the X-axis in the target image of the transformed image.
+	 @param posY the position on the Y-axis in the target image of the transformed image.
+	 @param transform the transformation to apply. @see TransformStruct
+	 @param pPartRect Pointer on Common::Rect which specifies the section to be rendered, or NULL for all of it.<br>
+	 Unlike for blit(), this refers to the unflipped, but transformed image.
+	 @param filtering whether to use bilinear filtering instead of picking the nearest pixel.
+	 @return the size of the area drawn.
+	 */
+	Common::Rect rotoscaleBlit(Graphics::Surface &target, int posX, int posY, const TransformStruct &transform,
+	                           Common::Rect *pPartRect = nullptr, bool filtering = false);
+
 	/**
 	 * @brief Scale function; this returns a transformed version of this surface after rotation and
 	 * scaling. Please do not use this if angle != 0, use rotoscale.
 	 *
 	 * @param newWidth the resulting width.
 	 * @param newHeight the resulting height.
+	 * @param filtering whether to use bilinear filtering instead of picking the nearest pixel.
 	 * @see TransformStruct
 	 */
-	TransparentSurface *scale(uint16 newWidth, uint16 newHeight) const;
+	TransparentSurface *scale(uint16 newWidth, uint16 newHeight, bool filtering = false) const;
 
 	/**
 	 * @brief Rotoscale function; this returns a transformed version of this surface after rotation and
 	 * scaling. Please do not use this if angle == 0, use plain old scaling function.
 	 *
 	 * @param transform a TransformStruct wrapping the required info. @see TransformStruct
+	 * @param filtering whether to use bilinear filtering instead of picking the nearest pixel.
 	 *
 	 */
-	TransparentSurface *rotoscale(const TransformStruct &transform) const;
+	TransparentSurface *rotoscale(const TransformStruct &transform, bool filtering = false) const;
 	AlphaType getAlphaMode() const;
 	void setAlphaMode(AlphaType);
 private:
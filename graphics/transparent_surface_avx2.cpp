@@ -0,0 +1,82 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -mavx2, see graphics/module.mk
+
+#include "graphics/transparent_surface_simd.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+struct AVX2Ops {
+	typedef __m256i Pixels;
+	typedef __m256i Wide;
+
+	enum { kPixels = 8 };
+
+	static Pixels load(const byte *ptr) { return _mm256_loadu_si256((const __m256i *)ptr); }
+	static Pixels loadReversed(const byte *ptr) { return _mm256_permutevar8x32_epi32(load(ptr), _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0)); }
+	static void store(byte *ptr, Pixels p) { _mm256_storeu_si256((__m256i *)ptr, p); }
+
+	// These work on each 128 bit lane separately, which is fine since pack
+	// restores the original order.
+	static Wide unpackLo(Pixels p) { return _mm256_unpacklo_epi8(p, _mm256_setzero_si256()); }
+	static Wide unpackHi(Pixels p) { return _mm256_unpackhi_epi8(p, _mm256_setzero_si256()); }
+	static Pixels pack(Wide lo, Wide hi) { return _mm256_packus_epi16(lo, hi); }
+
+	static Wide set(uint16 a, uint16 b, uint16 g, uint16 r) { return _mm256_set_epi16(r, g, b, a, r, g, b, a, r, g, b, a, r, g, b, a); }
+	static Wide alpha(Wide w) { return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(w, 0), 0); }
+	static Wide mul(Wide x, Wide y) { return _mm256_mullo_epi16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) { return _mm256_mulhi_epu16(x, y); }
+	static Wide add(Wide x, Wide y) { return _mm256_add_epi16(x, y); }
+	static Wide sub(Wide x, Wide y) { return _mm256_sub_epi16(x, y); }
+	static Wide shr8(Wide x) { return _mm256_srli_epi16(x, 8); }
+	static Wide selectWide(Wide mask, Wide x, Wide y) { return _mm256_blendv_epi8(y, x, mask); }
+
+	static Pixels alphaMask() { return _mm256_set1_epi32(0x000000FF); }
+	static Pixels colorMask() { return _mm256_set1_epi32((int)0xFFFFFF00); }
+	static Pixels alphaZero(Pixels p) { return _mm256_cmpeq_epi32(_mm256_and_si256(p, alphaMask()), _mm256_setzero_si256()); }
+	static Pixels select(Pixels mask, Pixels x, Pixels y) { return _mm256_blendv_epi8(y, x, mask); }
+	static Pixels bitAnd(Pixels x, Pixels y) { return _mm256_and_si256(x, y); }
+	static Pixels bitOr(Pixels x, Pixels y) { return _mm256_or_si256(x, y); }
+	static Pixels addSaturate(Pixels x, Pixels y) { return _mm256_adds_epu8(x, y); }
+	static Pixels subSaturate(Pixels x, Pixels y) { return _mm256_subs_epu8(x, y); }
+};
+
+} // End of anonymous namespace
+
+void doBlitAlphaBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAlphaBlend<AVX2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitAdditiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAdditiveBlend<AVX2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitSubtractiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitSubtractiveBlend<AVX2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/transparent_surface_simd.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+namespace {
+
+struct NEONOps {
+	typedef uint8x16_t Pixels;
+	typedef uint16x8_t Wide;
+
+	enum { kPixels = 4 };
+
+	static Pixels load(const byte *ptr) { return vld1q_u8(ptr); }
+	static Pixels loadReversed(const byte *ptr) {
+		const uint32x4_t p = vrev64q_u32(vreinterpretq_u32_u8(load(ptr)));
+		return vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(p), vget_low_u32(p)));
+	}
+	static void store(byte *ptr, Pixels p) { vst1q_u8(ptr, p); }
+
+	static Wide unpackLo(Pixels p) { return vmovl_u8(vget_low_u8(p)); }
+	static Wide unpackHi(Pixels p) { return vmovl_u8(vget_high_u8(p)); }
+	static Pixels pack(Wide lo, Wide hi) { return vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)); }
+
+	static Wide set(uint16 a, uint16 b, uint16 g, uint16 r) {
+		const uint16 values[8] = { a, b, g, r, a, b, g, r };
+		return vld1q_u16(values);
+	}
+	static Wide alpha(Wide w) {
+		// Each pixel is one 64 bit lane with the alpha in its lowest 16 bits
+		uint64x2_t a = vandq_u64(vreinterpretq_u64_u16(w), vdupq_n_u64(0xFF));
+		a = vorrq_u64(a, vshlq_n_u64(a, 16));
+		return vreinterpretq_u16_u64(vorrq_u64(a, vshlq_n_u64(a, 32)));
+	}
+	static Wide mul(Wide x, Wide y) { return vmulq_u16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) {
+		const uint32x4_t lo = vmull_u16(vget_low_u16(x), vget_low_u16(y));
+		const uint32x4_t hi = vmull_u16(vget_high_u16(x), vget_high_u16(y));
+		return vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16));
+	}
+	static Wide add(Wide x, Wide y) { return vaddq_u16(x, y); }
+	static Wide sub(Wide x, Wide y) { return vsubq_u16(x, y); }
+	static Wide shr8(Wide x) { return vshrq_n_u16(x, 8); }
+	static Wide selectWide(Wide mask, Wide x, Wide y) { return vbslq_u16(mask, x, y); }
+
+	static Pixels alphaMask() { return vreinterpretq_u8_u32(vdupq_n_u32(0x000000FF)); }
+	static Pixels colorMask() { return vreinterpretq_u8_u32(vdupq_n_u32(0xFFFFFF00)); }
+	static Pixels alphaZero(Pixels p) {
+		return vreinterpretq_u8_u32(vceqq_u32(vandq_u32(vreinterpretq_u32_u8(p), vdupq_n_u32(0xFF)), vdupq_n_u32(0)));
+	}
+	static Pixels select(Pixels mask, Pixels x, Pixels y) { return vbslq_u8(mask, x, y); }
+	static Pixels bitAnd(Pixels x, Pixels y) { return vandq_u8(x, y); }
+	static Pixels bitOr(Pixels x, Pixels y) { return vorrq_u8(x, y); }
+	static Pixels addSaturate(Pixels x, Pixels y) { return vqaddq_u8(x, y); }
+	static Pixels subSaturate(Pixels x, Pixels y) { return vqsubq_u8(x, y); }
+};
+
+} // End of anonymous namespace
+
+void doBlitAlphaBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAlphaBlend<NEONOps>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitAdditiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAdditiveBlend<NEONOps>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitSubtractiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitSubtractiveBlend<NEONOps>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of namespace Graphics
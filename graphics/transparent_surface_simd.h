@@ -0,0 +1,282 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_TRANSPARENTSURFACE_SIMD_H
+#define GRAPHICS_TRANSPARENTSURFACE_SIMD_H
+
+#include "common/scummsys.h"
+
+/*
+ * Internal to TransparentSurface: the vectorized blending kernels.
+ *
+ * The kernels are written once against a small set of vector operations,
+ * which each instruction set specific file provides as an "Ops" struct:
+ *
+ *  - Pixels: a register of Ops::kPixels 32bpp pixels
+ *  - Wide: half of such a register, widened to 16 bits per channel
+ *  - load/loadReversed/store, unpackLo/unpackHi/pack to convert between the two
+ *  - 16 bit arithmetic: mul (low half), mulHigh (high half), add, sub, shr8
+ *  - alpha(Wide): the alpha channel of each pixel, copied to all channels
+ *  - bitwise and saturating 8 bit operations on Pixels
+ *
+ * Each blender reproduces the integer arithmetic of the matching scalar
+ * function in transparent_surface.cpp exactly, so that all code paths give
+ * the same result. Pixels are expected in the little endian layout used by
+ * TransparentSurface, that is A, B, G, R in memory order.
+ *
+ * The Ops structs are local to their translation unit, which keeps the
+ * template instances compiled for a specific instruction set from being
+ * shared with other code.
+ */
+
+namespace Graphics {
+
+// The scalar kernels in transparent_surface.cpp, also used for the row tails
+void doBlitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+
+#ifdef USE_SSE2
+void doBlitAlphaBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+#endif
+
+#ifdef USE_AVX2
+void doBlitAlphaBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlendAVX2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+#endif
+
+#ifdef USE_NEON
+void doBlitAlphaBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitAdditiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+void doBlitSubtractiveBlendNEON(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color);
+#endif
+
+namespace BlendSIMD {
+
+/**
+ * Run a blender over all rows. Pixels which do not fill a whole register
+ * at the end of a row are handed to the scalar kernel.
+ */
+template<class Ops, class Blender>
+void blitRows(const Blender &blender, byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	typedef typename Ops::Pixels Pixels;
+
+	const uint32 blocks = width / Ops::kPixels;
+	const uint32 tail = width % Ops::kPixels;
+	const int32 blockStep = inStep * Ops::kPixels;
+
+	for (uint32 i = 0; i < height; i++) {
+		byte *in = ino;
+		byte *out = outo;
+
+		for (uint32 j = 0; j < blocks; j++) {
+			// With horizontal flipping, the source pixels of this block lie
+			// in memory before the current one, in reverse order.
+			const Pixels src = (inStep > 0) ? Ops::load(in) : Ops::loadReversed(in + blockStep - inStep);
+			const Pixels dst = Ops::load(out);
+			const Pixels blended = Ops::pack(blender.blend(Ops::unpackLo(src), Ops::unpackLo(dst)),
+			                                 blender.blend(Ops::unpackHi(src), Ops::unpackHi(dst)));
+			Ops::store(out, blender.finish(src, dst, blended));
+
+			in += blockStep;
+			out += Ops::kPixels * 4;
+		}
+
+		if (tail)
+			Blender::scalar(in, out, tail, 1, pitch, inStep, inoStep, color);
+
+		outo += pitch;
+		ino += inoStep;
+	}
+}
+
+/** out = (in * a + out * (255 - a)) >> 8, for pixels with a != 0. */
+template<class Ops>
+struct AlphaBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitAlphaBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide out) const {
+		const Wide a = Ops::alpha(in);
+		return Ops::shr8(Ops::add(Ops::mul(in, a), Ops::mul(out, Ops::sub(Ops::set(255, 255, 255, 255), a))));
+	}
+
+	Pixels finish(Pixels in, Pixels out, Pixels blended) const {
+		return Ops::select(Ops::alphaZero(in), out, Ops::bitOr(blended, Ops::alphaMask()));
+	}
+};
+
+/** Alpha blending with color modulation. */
+template<class Ops>
+struct AlphaColorBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	Wide _ca, _color;
+
+	AlphaColorBlender(byte ca, byte cr, byte cg, byte cb) : _ca(Ops::set(ca, ca, ca, ca)), _color(Ops::set(0, cb, cg, cr)) {}
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitAlphaBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide out) const {
+		const Wide ina = Ops::shr8(Ops::mul(Ops::alpha(in), _ca));
+		const Wide faded = Ops::shr8(Ops::mul(out, Ops::sub(Ops::set(255, 255, 255, 255), ina)));
+		// (in * ina * c) >> 16; in * ina still fits into 16 bits
+		return Ops::add(faded, Ops::mulHigh(Ops::mul(in, ina), _color));
+	}
+
+	Pixels finish(Pixels, Pixels, Pixels blended) const {
+		return Ops::bitOr(blended, Ops::alphaMask());
+	}
+};
+
+/** out = min(out + (in * a >> 8), 255), leaving the alpha channel alone. */
+template<class Ops>
+struct AdditiveBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitAdditiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide) const {
+		return Ops::shr8(Ops::mul(in, Ops::alpha(in)));
+	}
+
+	Pixels finish(Pixels, Pixels out, Pixels blended) const {
+		return Ops::addSaturate(out, Ops::bitAnd(blended, Ops::colorMask()));
+	}
+};
+
+/** Additive blending with color modulation. */
+template<class Ops>
+struct AdditiveColorBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	Wide _ca, _color, _isFull;
+
+	AdditiveColorBlender(byte ca, byte cr, byte cg, byte cb) : _ca(Ops::set(ca, ca, ca, ca)), _color(Ops::set(0, cb, cg, cr)),
+		_isFull(Ops::set(0, cb == 255 ? 0xFFFF : 0, cg == 255 ? 0xFFFF : 0, cr == 255 ? 0xFFFF : 0)) {}
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitAdditiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide) const {
+		const Wide ina = Ops::shr8(Ops::mul(Ops::alpha(in), _ca));
+		const Wide t = Ops::mul(in, ina);
+		// Channels with a modulation of 255 use (in * ina) >> 8 instead
+		return Ops::selectWide(_isFull, Ops::shr8(t), Ops::mulHigh(t, _color));
+	}
+
+	Pixels finish(Pixels, Pixels out, Pixels blended) const {
+		return Ops::addSaturate(out, Ops::bitAnd(blended, Ops::colorMask()));
+	}
+};
+
+/** out = out - (in * out * a >> 16), leaving the alpha channel alone. */
+template<class Ops>
+struct SubtractiveBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitSubtractiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide out) const {
+		return Ops::mulHigh(Ops::mul(in, out), Ops::alpha(in));
+	}
+
+	Pixels finish(Pixels, Pixels out, Pixels blended) const {
+		return Ops::subSaturate(out, Ops::bitAnd(blended, Ops::colorMask()));
+	}
+};
+
+/** Subtractive blending with color modulation. */
+template<class Ops>
+struct SubtractiveColorBlender {
+	typedef typename Ops::Pixels Pixels;
+	typedef typename Ops::Wide Wide;
+
+	Wide _color, _isFull;
+
+	SubtractiveColorBlender(byte cr, byte cg, byte cb) : _color(Ops::set(0, cb, cg, cr)),
+		_isFull(Ops::set(0, cb == 255 ? 0xFFFF : 0, cg == 255 ? 0xFFFF : 0, cr == 255 ? 0xFFFF : 0)) {}
+
+	static void scalar(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+		doBlitSubtractiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+	}
+
+	Wide blend(Wide in, Wide out) const {
+		const Wide a = Ops::alpha(in);
+		const Wide t = Ops::mul(in, out);
+		// (in * out * a * c) >> 24 is computed as ((in * out) * (a * c) >> 16) >> 8,
+		// channels with a modulation of 255 use (in * out * a) >> 16 instead
+		return Ops::selectWide(_isFull, Ops::mulHigh(t, a), Ops::shr8(Ops::mulHigh(t, Ops::mul(a, _color))));
+	}
+
+	Pixels finish(Pixels, Pixels out, Pixels blended) const {
+		return Ops::bitOr(Ops::subSaturate(out, Ops::bitAnd(blended, Ops::colorMask())), Ops::alphaMask());
+	}
+};
+
+template<class Ops>
+void blitAlphaBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (color == 0xffffffff)
+		blitRows<Ops>(AlphaBlender<Ops>(), ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blitRows<Ops>(AlphaColorBlender<Ops>(color >> 24, color >> 16, color >> 8, color), ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+template<class Ops>
+void blitAdditiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (color == 0xffffffff)
+		blitRows<Ops>(AdditiveBlender<Ops>(), ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blitRows<Ops>(AdditiveColorBlender<Ops>(color >> 24, color >> 16, color >> 8, color), ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+template<class Ops>
+void blitSubtractiveBlend(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	if (color == 0xffffffff)
+		blitRows<Ops>(SubtractiveBlender<Ops>(), ino, outo, width, height, pitch, inStep, inoStep, color);
+	else
+		blitRows<Ops>(SubtractiveColorBlender<Ops>(color >> 16, color >> 8, color), ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of namespace BlendSIMD
+
+} // End of namespace Graphics
+
+#endif
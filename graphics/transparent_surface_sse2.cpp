@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -msse2, see graphics/module.mk
+
+#include "graphics/transparent_surface_simd.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+struct SSE2Ops {
+	typedef __m128i Pixels;
+	typedef __m128i Wide;
+
+	enum { kPixels = 4 };
+
+	static Pixels load(const byte *ptr) { return _mm_loadu_si128((const __m128i *)ptr); }
+	static Pixels loadReversed(const byte *ptr) { return _mm_shuffle_epi32(load(ptr), _MM_SHUFFLE(0, 1, 2, 3)); }
+	static void store(byte *ptr, Pixels p) { _mm_storeu_si128((__m128i *)ptr, p); }
+
+	static Wide unpackLo(Pixels p) { return _mm_unpacklo_epi8(p, _mm_setzero_si128()); }
+	static Wide unpackHi(Pixels p) { return _mm_unpackhi_epi8(p, _mm_setzero_si128()); }
+	static Pixels pack(Wide lo, Wide hi) { return _mm_packus_epi16(lo, hi); }
+
+	static Wide set(uint16 a, uint16 b, uint16 g, uint16 r) { return _mm_set_epi16(r, g, b, a, r, g, b, a); }
+	static Wide alpha(Wide w) { return _mm_shufflehi_epi16(_mm_shufflelo_epi16(w, 0), 0); }
+	static Wide mul(Wide x, Wide y) { return _mm_mullo_epi16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) { return _mm_mulhi_epu16(x, y); }
+	static Wide add(Wide x, Wide y) { return _mm_add_epi16(x, y); }
+	static Wide sub(Wide x, Wide y) { return _mm_sub_epi16(x, y); }
+	static Wide shr8(Wide x) { return _mm_srli_epi16(x, 8); }
+	static Wide selectWide(Wide mask, Wide x, Wide y) { return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y)); }
+
+	static Pixels alphaMask() { return _mm_set1_epi32(0x000000FF); }
+	static Pixels colorMask() { return _mm_set1_epi32((int)0xFFFFFF00); }
+	static Pixels alphaZero(Pixels p) { return _mm_cmpeq_epi32(_mm_and_si128(p, alphaMask()), _mm_setzero_si128()); }
+	static Pixels select(Pixels mask, Pixels x, Pixels y) { return _mm_or_si128(_mm_and_si128(mask, x), _mm_andnot_si128(mask, y)); }
+	static Pixels bitAnd(Pixels x, Pixels y) { return _mm_and_si128(x, y); }
+	static Pixels bitOr(Pixels x, Pixels y) { return _mm_or_si128(x, y); }
+	static Pixels addSaturate(Pixels x, Pixels y) { return _mm_adds_epu8(x, y); }
+	static Pixels subSaturate(Pixels x, Pixels y) { return _mm_subs_epu8(x, y); }
+};
+
+} // End of anonymous namespace
+
+void doBlitAlphaBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAlphaBlend<SSE2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitAdditiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitAdditiveBlend<SSE2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+void doBlitSubtractiveBlendSSE2(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color) {
+	BlendSIMD::blitSubtractiveBlend<SSE2Ops>(ino, outo, width, height, pitch, inStep, inoStep, color);
+}
+
+} // End of namespace Graphics
@@ -83,8 +83,11 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/cpudetect.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_simd.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -99,17 +102,29 @@ public:
 	Graphics::PixelFormat getFormat() const { return _format; }
 	YUVToRGBManager::LuminanceScale getScale() const { return _scale; }
 	const uint32 *getRGBToPix() const { return _rgbToPix; }
+	const YUVToRGBParams &getParams() const { return _params; }
 
 private:
 	Graphics::PixelFormat _format;
 	YUVToRGBManager::LuminanceScale _scale;
 	uint32 _rgbToPix[3 * 768]; // 9216 bytes
+	YUVToRGBParams _params;
 };
 
 YUVToRGBLookup::YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale) {
 	_format = format;
 	_scale = scale;
 
+	_params.bytesPerPixel = format.bytesPerPixel;
+	_params.scaleITU = (scale == YUVToRGBManager::kScaleITU);
+	_params.alpha = format.RGBToColor(0, 0, 0);
+	_params.loss[0] = format.rLoss;
+	_params.loss[1] = format.gLoss;
+	_params.loss[2] = format.bLoss;
+	_params.shift[0] = format.rShift;
+	_params.shift[1] = format.gShift;
+	_params.shift[2] = format.bShift;
+
 	uint32 *r_2_pix_alloc = &_rgbToPix[0 * 768];
 	uint32 *g_2_pix_alloc = &_rgbToPix[1 * 768];
 	uint32 *b_2_pix_alloc = &_rgbToPix[2 * 768];
@@ -192,6 +207,50 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+namespace {
+
+/**
+ * The vectorized converters for one instruction set.
+ */
+struct YUVToRGBFuncs {
+	ConvertYUVToRGBFunc convert444;
+	ConvertYUVToRGBFunc convert420;
+};
+
+#ifdef USE_SSE2
+const YUVToRGBFuncs kSSE2YUVToRGBFuncs = { convertYUV444ToRGBSSE2, convertYUV420ToRGBSSE2 };
+#endif
+#ifdef USE_AVX2
+const YUVToRGBFuncs kAVX2YUVToRGBFuncs = { convertYUV444ToRGBAVX2, convertYUV420ToRGBAVX2 };
+#endif
+#ifdef USE_NEON
+const YUVToRGBFuncs kNEONYUVToRGBFuncs = { convertYUV444ToRGBNEON, convertYUV420ToRGBNEON };
+#endif
+
+/**
+ * Return the vectorized converters for the CPU we are running on, or
+ * nullptr if there are none.
+ */
+const YUVToRGBFuncs *getYUVToRGBFuncs() {
+#ifdef SCUMM_LITTLE_ENDIAN
+#ifdef USE_AVX2
+	if (Common::hasCPUFeature(Common::kCPUFeatureAVX2))
+		return &kAVX2YUVToRGBFuncs;
+#endif
+#ifdef USE_SSE2
+	if (Common::hasCPUFeature(Common::kCPUFeatureSSE2))
+		return &kSSE2YUVToRGBFuncs;
+#endif
+#ifdef USE_NEON
+	if (Common::hasCPUFeature(Common::kCPUFeatureNEON))
+		return &kNEONYUVToRGBFuncs;
+#endif
+#endif
+	return nullptr;
+}
+
+} // End of anonymous namespace
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -234,12 +293,28 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert(ySrc && uSrc && vSrc);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	// The vectorized converters leave the columns which do not fill a whole
+	// register to the lookup table code
+	const YUVToRGBFuncs *funcs = getYUVToRGBFuncs();
+	if (funcs) {
+		const int done = funcs->convert444(dstPtr, dst->pitch, lookup->getParams(), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		dstPtr += done * dst->format.bytesPerPixel;
+		ySrc += done;
+		uSrc += done;
+		vSrc += done;
+		yWidth -= done;
+	}
+
+	if (yWidth == 0)
+		return;
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV444ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV444ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 template<typename PixelInt>
@@ -274,7 +349,7 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 			dstPtr += sizeof(PixelInt);
 		}
 
-		dstPtr += dstPitch;
+		dstPtr += (dstPitch << 1) - yWidth * sizeof(PixelInt);
 		ySrc += (yPitch << 1) - yWidth;
 		uSrc += uvPitch - halfWidth;
 		vSrc += uvPitch - halfWidth;
@@ -290,12 +365,29 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 1) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPtr = (byte *)dst->getPixels();
+
+	// The vectorized converters leave the columns which do not fill a whole
+	// register to the lookup table code. Registers always hold an even
+	// number of pixels, so the chroma planes stay aligned with the rest.
+	const YUVToRGBFuncs *funcs = getYUVToRGBFuncs();
+	if (funcs) {
+		const int done = funcs->convert420(dstPtr, dst->pitch, lookup->getParams(), ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		dstPtr += done * dst->format.bytesPerPixel;
+		ySrc += done;
+		uSrc += done >> 1;
+		vSrc += done >> 1;
+		yWidth -= done;
+	}
+
+	if (yWidth == 0)
+		return;
 
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint16>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		convertYUV420ToRGB<uint32>(dstPtr, dst->pitch, lookup, _colorTab, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
 }
 
 #define READ_QUAD(ptr, prefix) \
@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -mavx2, see graphics/module.mk
+
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include <immintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+struct AVX2Ops {
+	typedef __m256i Wide;
+	typedef __m128i Count;
+
+	enum { kPixels = 16 };
+
+	static Wide loadBytes(const byte *ptr) { return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)ptr)); }
+	static Wide loadBytesDup(const byte *ptr) {
+		const __m128i bytes = _mm_loadl_epi64((const __m128i *)ptr);
+		return _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(bytes, bytes));
+	}
+
+	static Wide set(int16 x) { return _mm256_set1_epi16(x); }
+	static Wide add(Wide x, Wide y) { return _mm256_add_epi16(x, y); }
+	static Wide sub(Wide x, Wide y) { return _mm256_sub_epi16(x, y); }
+	static Wide min(Wide x, Wide y) { return _mm256_min_epi16(x, y); }
+	static Wide max(Wide x, Wide y) { return _mm256_max_epi16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) { return _mm256_mulhi_epu16(x, y); }
+	static Wide bitOr(Wide x, Wide y) { return _mm256_or_si256(x, y); }
+	static Wide bitXor(Wide x, Wide y) { return _mm256_xor_si256(x, y); }
+	static Wide sign(Wide x) { return _mm256_srai_epi16(x, 15); }
+
+	static Count count(int n) { return _mm_cvtsi32_si128(n); }
+	static Wide shl(Wide x, Count n) { return _mm256_sll_epi16(x, n); }
+	static Wide shr(Wide x, Count n) { return _mm256_srl_epi16(x, n); }
+
+	static void store16(byte *ptr, Wide color) { _mm256_storeu_si256((__m256i *)ptr, color); }
+	static void store32(byte *ptr, Wide lo, Wide hi) {
+		// unpack works on each 128 bit lane separately, so the pixels come
+		// out as 0-3 and 8-11, and 4-7 and 12-15
+		const __m256i first = _mm256_unpacklo_epi16(lo, hi);
+		const __m256i second = _mm256_unpackhi_epi16(lo, hi);
+		_mm256_storeu_si256((__m256i *)ptr, _mm256_permute2x128_si256(first, second, 0x20));
+		_mm256_storeu_si256((__m256i *)(ptr + 32), _mm256_permute2x128_si256(first, second, 0x31));
+	}
+};
+
+} // End of anonymous namespace
+
+int convertYUV444ToRGBAVX2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert444<AVX2Ops>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+int convertYUV420ToRGBAVX2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert420<AVX2Ops>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+} // End of namespace Graphics
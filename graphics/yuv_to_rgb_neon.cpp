@@ -0,0 +1,83 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include "common/endian.h"
+
+#include <arm_neon.h>
+
+namespace Graphics {
+
+namespace {
+
+struct NEONOps {
+	typedef int16x8_t Wide;
+	typedef int16x8_t Count;
+
+	enum { kPixels = 8 };
+
+	static Wide loadBytes(const byte *ptr) { return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(ptr))); }
+	static Wide loadBytesDup(const byte *ptr) {
+		const uint8x8_t bytes = vcreate_u8(READ_UINT32(ptr));
+		return vreinterpretq_s16_u16(vmovl_u8(vzip_u8(bytes, bytes).val[0]));
+	}
+
+	static Wide set(int16 x) { return vdupq_n_s16(x); }
+	static Wide add(Wide x, Wide y) { return vaddq_s16(x, y); }
+	static Wide sub(Wide x, Wide y) { return vsubq_s16(x, y); }
+	static Wide min(Wide x, Wide y) { return vminq_s16(x, y); }
+	static Wide max(Wide x, Wide y) { return vmaxq_s16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) {
+		const uint16x8_t ux = vreinterpretq_u16_s16(x), uy = vreinterpretq_u16_s16(y);
+		const uint16x4_t lo = vshrn_n_u32(vmull_u16(vget_low_u16(ux), vget_low_u16(uy)), 16);
+		const uint16x4_t hi = vshrn_n_u32(vmull_u16(vget_high_u16(ux), vget_high_u16(uy)), 16);
+		return vreinterpretq_s16_u16(vcombine_u16(lo, hi));
+	}
+	static Wide bitOr(Wide x, Wide y) { return vorrq_s16(x, y); }
+	static Wide bitXor(Wide x, Wide y) { return veorq_s16(x, y); }
+	static Wide sign(Wide x) { return vshrq_n_s16(x, 15); }
+
+	static Count count(int n) { return vdupq_n_s16(n); }
+	static Wide shl(Wide x, Count n) { return vreinterpretq_s16_u16(vshlq_u16(vreinterpretq_u16_s16(x), n)); }
+	static Wide shr(Wide x, Count n) { return vreinterpretq_s16_u16(vshlq_u16(vreinterpretq_u16_s16(x), vnegq_s16(n))); }
+
+	static void store16(byte *ptr, Wide color) { vst1q_u16((uint16 *)ptr, vreinterpretq_u16_s16(color)); }
+	static void store32(byte *ptr, Wide lo, Wide hi) {
+		uint16x8x2_t halves;
+		halves.val[0] = vreinterpretq_u16_s16(lo);
+		halves.val[1] = vreinterpretq_u16_s16(hi);
+		vst2q_u16((uint16 *)ptr, halves);
+	}
+};
+
+} // End of anonymous namespace
+
+int convertYUV444ToRGBNEON(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert444<NEONOps>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+int convertYUV420ToRGBNEON(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert420<NEONOps>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,248 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_SIMD_H
+#define GRAPHICS_YUV_TO_RGB_SIMD_H
+
+#include "common/scummsys.h"
+
+/*
+ * Internal to YUVToRGBManager: the vectorized YUV444 and YUV420 converters.
+ *
+ * Like the blending kernels of TransparentSurface, the converters are
+ * written once against a small set of vector operations, which each
+ * instruction set specific file provides as an "Ops" struct:
+ *
+ *  - Wide: a register of Ops::kPixels signed 16 bit lanes
+ *  - loadBytes: kPixels bytes, zero extended to 16 bits
+ *  - loadBytesDup: kPixels / 2 bytes, each one repeated, for 420 chroma
+ *  - 16 bit arithmetic: add, sub, min, max, mulHigh (unsigned high half),
+ *    bitOr, bitXor, and sign() which is 0 or -1 depending on the sign
+ *  - Count, count(), shl and shr for shifts by an amount known at runtime,
+ *    which give 0 for amounts of 16
+ *  - store16: store the lanes as kPixels 16bpp pixels
+ *  - store32: store kPixels 32bpp pixels, given their low and high halves
+ *
+ * Instead of looking up the chroma contributions in tables, they are
+ * computed in 1.15 fixed point. The coefficients are picked so that the
+ * results match the tables built by YUVToRGBManager exactly, including
+ * truncation towards zero, for all 256 chroma values. The same holds for
+ * rescaling the ITU luminance range. So all code paths give the same
+ * result, which the test suite checks.
+ *
+ * The converters only handle as many columns as fill whole registers and
+ * return that number. The remaining columns are left to the scalar code.
+ */
+
+namespace Graphics {
+
+/**
+ * The description of the target format which the vectorized converters
+ * need. Unlike the lookup tables, it does not depend on the instruction
+ * set.
+ */
+struct YUVToRGBParams {
+	int bytesPerPixel;
+	bool scaleITU;     ///< Whether luminance is in the [16, 235] range
+	uint32 alpha;      ///< The bits of the fully opaque alpha channel
+	int loss[3];       ///< Loss of the red, green and blue channels
+	int shift[3];      ///< Shift of the red, green and blue channels
+};
+
+typedef int (*ConvertYUVToRGBFunc)(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+
+#ifdef USE_SSE2
+int convertYUV444ToRGBSSE2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+int convertYUV420ToRGBSSE2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+#endif
+
+#ifdef USE_AVX2
+int convertYUV444ToRGBAVX2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+int convertYUV420ToRGBAVX2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+#endif
+
+#ifdef USE_NEON
+int convertYUV444ToRGBNEON(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+int convertYUV420ToRGBNEON(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch);
+#endif
+
+namespace YUVToRGBSIMD {
+
+enum {
+	// The factors of YUVToRGBManager's color tables, times 32768
+	kCrR = 45919, // 0.419 / 0.299
+	kCrG = 23383, // 0.299 / 0.419
+	kCbG = 11286, // 0.114 / 0.331
+	kCbB = 58111, // 0.587 / 0.331
+
+	// 255 / 219, times 32768, for the ITU luminance range
+	kScaleITU = 38155
+};
+
+template<class Ops>
+class Converter {
+public:
+	typedef typename Ops::Wide Wide;
+	typedef typename Ops::Count Count;
+
+	explicit Converter(const YUVToRGBParams &params) : _scaleITU(params.scaleITU) {
+		for (int i = 0; i < 3; i++) {
+			const int shift = params.shift[i];
+			_loss[i] = Ops::count(params.loss[i]);
+			_shiftLo[i] = Ops::count(shift < 16 ? shift : 16);
+			_shiftHiLeft[i] = Ops::count(shift >= 16 ? shift - 16 : 16);
+			_shiftHiRight[i] = Ops::count(shift < 16 ? 16 - shift : 16);
+		}
+
+		_alphaLo = Ops::set((int16)(params.alpha & 0xFFFF));
+		_alphaHi = Ops::set((int16)(params.alpha >> 16));
+	}
+
+	/**
+	 * Compute what the chroma values add to the luminance, for each of the
+	 * red, green and blue channels.
+	 */
+	void chroma(Wide u, Wide v, Wide *delta) const {
+		const Wide cb = Ops::sub(u, Ops::set(128));
+		const Wide cr = Ops::sub(v, Ops::set(128));
+
+		delta[0] = mulTruncate(cr, kCrR);
+		delta[1] = Ops::sub(Ops::sub(Ops::set(0), mulTruncate(cr, kCrG)), mulTruncate(cb, kCbG));
+		delta[2] = mulTruncate(cb, kCbB);
+	}
+
+	void store16(byte *dst, Wide y, const Wide *delta) const {
+		Wide color = _alphaLo;
+		for (int i = 0; i < 3; i++)
+			color = Ops::bitOr(color, Ops::shl(channel(y, delta[i], i), _shiftLo[i]));
+		Ops::store16(dst, color);
+	}
+
+	void store32(byte *dst, Wide y, const Wide *delta) const {
+		Wide lo = _alphaLo, hi = _alphaHi;
+		for (int i = 0; i < 3; i++) {
+			const Wide value = channel(y, delta[i], i);
+			lo = Ops::bitOr(lo, Ops::shl(value, _shiftLo[i]));
+			hi = Ops::bitOr(hi, Ops::bitOr(Ops::shl(value, _shiftHiLeft[i]), Ops::shr(value, _shiftHiRight[i])));
+		}
+		Ops::store32(dst, lo, hi);
+	}
+
+	void store(uint16 *dst, Wide y, const Wide *delta) const { store16((byte *)dst, y, delta); }
+	void store(uint32 *dst, Wide y, const Wide *delta) const { store32((byte *)dst, y, delta); }
+
+private:
+	/** (int16)(factor / 32768.0 * value), rounded towards zero like the tables. */
+	static Wide mulTruncate(Wide value, uint16 factor) {
+		const Wide sign = Ops::sign(value);
+		const Wide magnitude = Ops::sub(Ops::bitXor(value, sign), sign);
+		const Wide product = Ops::mulHigh(Ops::add(magnitude, magnitude), Ops::set((int16)factor));
+		return Ops::sub(Ops::bitXor(product, sign), sign);
+	}
+
+	/** A channel clipped to 8 bits, and reduced to the bits of the format. */
+	Wide channel(Wide y, Wide delta, int i) const {
+		Wide value = Ops::add(y, delta);
+		if (_scaleITU) {
+			value = Ops::sub(Ops::max(Ops::min(value, Ops::set(235)), Ops::set(16)), Ops::set(16));
+			value = Ops::mulHigh(Ops::add(value, value), Ops::set((int16)kScaleITU));
+		} else {
+			value = Ops::max(Ops::min(value, Ops::set(255)), Ops::set(0));
+		}
+		return Ops::shr(value, _loss[i]);
+	}
+
+	bool _scaleITU;
+	Count _loss[3];
+	Count _shiftLo[3], _shiftHiLeft[3], _shiftHiRight[3];
+	Wide _alphaLo, _alphaHi;
+};
+
+template<class Ops, typename PixelInt>
+int convert444(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	typedef typename Ops::Wide Wide;
+
+	const Converter<Ops> converter(params);
+	const int width = yWidth - yWidth % Ops::kPixels;
+
+	for (int h = 0; h < yHeight; h++) {
+		for (int x = 0; x < width; x += Ops::kPixels) {
+			Wide delta[3];
+			converter.chroma(Ops::loadBytes(uSrc + x), Ops::loadBytes(vSrc + x), delta);
+			converter.store((PixelInt *)dstPtr + x, Ops::loadBytes(ySrc + x), delta);
+		}
+
+		dstPtr += dstPitch;
+		ySrc += yPitch;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+template<class Ops, typename PixelInt>
+int convert420(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	typedef typename Ops::Wide Wide;
+
+	const Converter<Ops> converter(params);
+	const int width = yWidth - yWidth % Ops::kPixels;
+
+	for (int h = 0; h < yHeight; h += 2) {
+		for (int x = 0; x < width; x += Ops::kPixels) {
+			// Each chroma value covers two pixels in both of the rows
+			Wide delta[3];
+			converter.chroma(Ops::loadBytesDup(uSrc + x / 2), Ops::loadBytesDup(vSrc + x / 2), delta);
+			converter.store((PixelInt *)dstPtr + x, Ops::loadBytes(ySrc + x), delta);
+			converter.store((PixelInt *)(dstPtr + dstPitch) + x, Ops::loadBytes(ySrc + yPitch + x), delta);
+		}
+
+		dstPtr += dstPitch * 2;
+		ySrc += yPitch * 2;
+		uSrc += uvPitch;
+		vSrc += uvPitch;
+	}
+
+	return width;
+}
+
+template<class Ops>
+int convert444(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	if (params.bytesPerPixel == 2)
+		return convert444<Ops, uint16>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		return convert444<Ops, uint32>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+template<class Ops>
+int convert420(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	if (params.bytesPerPixel == 2)
+		return convert420<Ops, uint16>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+	else
+		return convert420<Ops, uint32>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+} // End of namespace YUVToRGBSIMD
+
+} // End of namespace Graphics
+
+#endif
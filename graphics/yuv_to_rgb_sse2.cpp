@@ -0,0 +1,78 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+// This file is compiled with -msse2, see graphics/module.mk
+
+#include "graphics/yuv_to_rgb_simd.h"
+
+#include "common/endian.h"
+
+#include <emmintrin.h>
+
+namespace Graphics {
+
+namespace {
+
+struct SSE2Ops {
+	typedef __m128i Wide;
+	typedef __m128i Count;
+
+	enum { kPixels = 8 };
+
+	static Wide loadBytes(const byte *ptr) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)ptr), _mm_setzero_si128()); }
+	static Wide loadBytesDup(const byte *ptr) {
+		const __m128i bytes = _mm_cvtsi32_si128(READ_UINT32(ptr));
+		return _mm_unpacklo_epi8(_mm_unpacklo_epi8(bytes, bytes), _mm_setzero_si128());
+	}
+
+	static Wide set(int16 x) { return _mm_set1_epi16(x); }
+	static Wide add(Wide x, Wide y) { return _mm_add_epi16(x, y); }
+	static Wide sub(Wide x, Wide y) { return _mm_sub_epi16(x, y); }
+	static Wide min(Wide x, Wide y) { return _mm_min_epi16(x, y); }
+	static Wide max(Wide x, Wide y) { return _mm_max_epi16(x, y); }
+	static Wide mulHigh(Wide x, Wide y) { return _mm_mulhi_epu16(x, y); }
+	static Wide bitOr(Wide x, Wide y) { return _mm_or_si128(x, y); }
+	static Wide bitXor(Wide x, Wide y) { return _mm_xor_si128(x, y); }
+	static Wide sign(Wide x) { return _mm_srai_epi16(x, 15); }
+
+	static Count count(int n) { return _mm_cvtsi32_si128(n); }
+	static Wide shl(Wide x, Count n) { return _mm_sll_epi16(x, n); }
+	static Wide shr(Wide x, Count n) { return _mm_srl_epi16(x, n); }
+
+	static void store16(byte *ptr, Wide color) { _mm_storeu_si128((__m128i *)ptr, color); }
+	static void store32(byte *ptr, Wide lo, Wide hi) {
+		_mm_storeu_si128((__m128i *)ptr, _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i *)(ptr + 16), _mm_unpackhi_epi16(lo, hi));
+	}
+};
+
+} // End of anonymous namespace
+
+int convertYUV444ToRGBSSE2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert444<SSE2Ops>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+int convertYUV420ToRGBSSE2(byte *dstPtr, int dstPitch, const YUVToRGBParams &params, const byte *ySrc, const byte *uSrc, const byte *vSrc, int yWidth, int yHeight, int yPitch, int uvPitch) {
+	return YUVToRGBSIMD::convert420<SSE2Ops>(dstPtr, dstPitch, params, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+}
+
+} // End of namespace Graphics
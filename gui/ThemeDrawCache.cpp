@@ -0,0 +1,225 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#include "gui/ThemeDrawCache.h"
+
+namespace GUI {
+
+void WidgetDrawData::calcCacheInfo() {
+	_cacheable = !_steps.empty();
+	_inheritedColors = DrawDataCache::kColorAll;
+
+	for (Common::List<Graphics::DrawStep>::const_iterator step = _steps.begin();
+	        step != _steps.end(); ++step) {
+		// Filling the surface and the base line of active tabs go beyond
+		// the area, and scaled steps depend on the position of the area
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_FILLSURFACE ||
+		        step->drawingCall == &Graphics::VectorRenderer::drawCallback_TAB)
+			_cacheable = false;
+
+		if (step->scale != (1 << 16) && step->scale != 0)
+			_cacheable = false;
+
+		// Triangles which are not square spill out of their box
+		if (step->drawingCall == &Graphics::VectorRenderer::drawCallback_TRIANGLE &&
+		        (step->autoWidth || step->autoHeight || step->w != step->h || step->w < 0))
+			_cacheable = false;
+	}
+
+	// Colors set by the first step are used instead of whatever was set
+	// before the item is drawn
+	if (!_steps.empty()) {
+		const Graphics::DrawStep &first = _steps.front();
+		if (first.fgColor.set)
+			_inheritedColors &= ~DrawDataCache::kColorFg;
+		if (first.bgColor.set)
+			_inheritedColors &= ~DrawDataCache::kColorBg;
+		if (first.bevelColor.set)
+			_inheritedColors &= ~DrawDataCache::kColorBevel;
+		if (first.gradColor1.set && first.gradColor2.set)
+			_inheritedColors &= ~DrawDataCache::kColorGradient;
+	}
+}
+
+bool DrawDataCache::Key::operator==(const Key &other) const {
+	return data == other.data && dynamic == other.dynamic && width == other.width && height == other.height &&
+	       parity == other.parity && shadows == other.shadows && background == other.background &&
+	       colors.fg == other.colors.fg && colors.bg == other.colors.bg && colors.bevel == other.colors.bevel &&
+	       colors.gradientStart == other.colors.gradientStart && colors.gradientEnd == other.colors.gradientEnd;
+}
+
+uint DrawDataCache::KeyHash::operator()(const Key &key) const {
+	uint hash = (uint)(size_t)key.data;
+	hash = hash * 31 + key.dynamic;
+	hash = hash * 31 + (key.width | (key.height << 16));
+	hash = hash * 31 + (key.parity | (key.shadows << 2));
+	hash = hash * 31 + key.colors.fg;
+	hash = hash * 31 + key.colors.bg;
+	hash = hash * 31 + key.colors.bevel;
+	hash = hash * 31 + key.colors.gradientStart;
+	hash = hash * 31 + key.colors.gradientEnd;
+	return hash * 31 + key.background;
+}
+
+uint32 DrawDataCache::hashBackground(const Graphics::Surface &surface, const Common::Rect &r) {
+	// Only look at the top, middle and bottom row and the middle column.
+	// This is enough to tell the backgrounds of the GUI apart, and the
+	// whole background is compared before a drawing is reused anyway.
+	const int bpp = surface.format.bytesPerPixel;
+	const int rows[] = { r.top, (r.top + r.bottom) / 2, r.bottom - 1 };
+
+	uint32 hash = 2166136261u;
+	for (uint i = 0; i < ARRAYSIZE(rows); ++i) {
+		const byte *src = (const byte *)surface.getBasePtr(r.left, rows[i]);
+		for (int x = 0; x < r.width() * bpp; ++x)
+			hash = (hash ^ src[x]) * 16777619u;
+	}
+
+	const byte *src = (const byte *)surface.getBasePtr((r.left + r.right) / 2, r.top);
+	for (int y = r.top; y < r.bottom; ++y, src += surface.pitch) {
+		for (int x = 0; x < bpp; ++x)
+			hash = (hash ^ src[x]) * 16777619u;
+	}
+
+	return hash;
+}
+
+void DrawDataCache::drawSteps(Graphics::VectorRenderer *renderer, const WidgetDrawData *data, const Common::Rect &area, uint32 dynamic) {
+	Common::List<Graphics::DrawStep>::const_iterator step;
+	for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+		renderer->drawStep(area, *step, dynamic);
+}
+
+void DrawDataCache::draw(Graphics::VectorRenderer *renderer, const WidgetDrawData *data, const Common::Rect &area,
+                         const Common::Rect &extendedRect, uint32 dynamic) {
+	Graphics::Surface *surface = renderer->getActiveSurface();
+	Common::Rect cacheRect = extendedRect;
+	cacheRect.grow(kOverdraw);
+	const uint32 rowSize = cacheRect.width() * surface->format.bytesPerPixel;
+	const uint32 entrySize = 2 * rowSize * cacheRect.height();
+
+	// The renderer leaves out parts of shapes close to the edges of the
+	// surface, so drawings there would look different elsewhere.
+	Common::Rect safeRect = cacheRect;
+	safeRect.grow(2);
+	if (!data->_cacheable || !Common::Rect(surface->w, surface->h).contains(safeRect) || entrySize > _maxBytes / 2) {
+		drawSteps(renderer, data, area, dynamic);
+		return;
+	}
+
+	Key key;
+	key.data = data;
+	key.dynamic = dynamic;
+	key.width = area.width();
+	key.height = area.height();
+	key.parity = (area.left & 1) | ((area.top & 1) << 1);
+	key.shadows = !renderer->shadowsDisabled();
+	key.background = hashBackground(*surface, cacheRect);
+
+	// Only the colors which the steps do not set themselves matter
+	const Graphics::VectorRenderer::ColorState colors = renderer->getColorState();
+	key.colors.fg = (data->_inheritedColors & kColorFg) ? colors.fg : 0;
+	key.colors.bg = (data->_inheritedColors & kColorBg) ? colors.bg : 0;
+	key.colors.bevel = (data->_inheritedColors & kColorBevel) ? colors.bevel : 0;
+	key.colors.gradientStart = (data->_inheritedColors & kColorGradient) ? colors.gradientStart : 0;
+	key.colors.gradientEnd = (data->_inheritedColors & kColorGradient) ? colors.gradientEnd : 0;
+
+	EntryMap::iterator i = _lookup.find(key);
+	if (i != _lookup.end()) {
+		EntryList::iterator entry = i->_value;
+
+		bool sameBackground = true;
+		for (int y = 0; y < cacheRect.height() && sameBackground; ++y)
+			sameBackground = !memcmp(entry->background.getBasePtr(0, y), surface->getBasePtr(cacheRect.left, cacheRect.top + y), rowSize);
+
+		if (sameBackground) {
+			_stats.hits++;
+
+			for (int y = 0; y < cacheRect.height(); ++y)
+				memcpy(surface->getBasePtr(cacheRect.left, cacheRect.top + y), entry->result.getBasePtr(0, y), rowSize);
+
+			// Leave the renderer in the same state as drawing would
+			Common::List<Graphics::DrawStep>::const_iterator step;
+			for (step = data->_steps.begin(); step != data->_steps.end(); ++step)
+				renderer->applyStepState(*step, dynamic);
+
+			// Move the entry to the front of the list
+			if (entry != _entries.begin()) {
+				_entries.push_front(*entry);
+				_entries.erase(entry);
+				i->_value = _entries.begin();
+			}
+			return;
+		}
+
+		// Another background with the same hash, replace it
+		evict(entry);
+	}
+
+	_stats.misses++;
+
+	Entry entry;
+	entry.key = key;
+	entry.background.create(cacheRect.width(), cacheRect.height(), surface->format);
+	entry.background.copyRectToSurface(*surface, 0, 0, cacheRect);
+
+	drawSteps(renderer, data, area, dynamic);
+
+	entry.result.create(cacheRect.width(), cacheRect.height(), surface->format);
+	entry.result.copyRectToSurface(*surface, 0, 0, cacheRect);
+
+	_entries.push_front(entry);
+	_lookup[key] = _entries.begin();
+	_size += entrySize;
+
+	while (_size > _maxBytes) {
+		evict(_entries.reverse_begin());
+		_stats.evictions++;
+	}
+}
+
+void DrawDataCache::clear() {
+	for (EntryList::iterator i = _entries.begin(); i != _entries.end(); ++i) {
+		i->background.free();
+		i->result.free();
+	}
+
+	_entries.clear();
+	_lookup.clear();
+	_size = 0;
+}
+
+void DrawDataCache::resetStats() {
+	_stats.hits = 0;
+	_stats.misses = 0;
+	_stats.evictions = 0;
+}
+
+void DrawDataCache::evict(EntryList::iterator entry) {
+	_size -= 2 * entry->background.pitch * entry->background.h;
+	entry->background.free();
+	entry->result.free();
+	_lookup.erase(entry->key);
+	_entries.erase(entry);
+}
+
+} // End of namespace GUI
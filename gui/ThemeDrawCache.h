@@ -0,0 +1,170 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ */
+
+#ifndef GUI_THEMEDRAWCACHE_H
+#define GUI_THEMEDRAWCACHE_H
+
+#include "common/hashmap.h"
+#include "common/list.h"
+
+#include "graphics/surface.h"
+#include "graphics/VectorRenderer.h"
+
+#include "gui/ThemeEngine.h"
+
+namespace GUI {
+
+/**
+ * The drawing steps and text settings of a DrawData item, as loaded from
+ * the theme description.
+ */
+struct WidgetDrawData {
+	/** List of all the steps needed to draw this widget */
+	Common::List<Graphics::DrawStep> _steps;
+
+	TextData _textDataId;
+	TextColor _textColorId;
+	Graphics::TextAlign _textAlignH;
+	GUI::ThemeEngine::TextAlignVertical _textAlignV;
+
+	/** Extra space that the widget occupies when it's drawn.
+	    E.g. when taking into account rounded corners, drop shadows, etc
+	    Used when restoring the widget background */
+	uint16 _backgroundOffset;
+
+	bool _buffer;
+
+	/** Whether drawings of this item may be reused, see DrawDataCache */
+	bool _cacheable;
+
+	/** The colors which the steps take over from earlier drawing, as DrawDataCache::ColorFlags */
+	uint _inheritedColors;
+
+
+	/**
+	 * Calculates the background threshold offset of a given DrawData item.
+	 * After fully loading all DrawSteps of a DrawData item, this function must be
+	 * called in order to calculate if such draw steps would be drawn outside of
+	 * the actual widget drawing zone (e.g. shadows). If this is the case, a constant
+	 * value will be added when restoring the background of the widget.
+	 */
+	void calcBackgroundOffset();
+
+	/**
+	 * Finds out whether the drawings of this DrawData item only depend on
+	 * the things DrawDataCache looks at. Like calcBackgroundOffset(), this
+	 * must be called after all DrawSteps have been loaded.
+	 */
+	void calcCacheInfo();
+};
+
+/**
+ * Keeps the results of drawing DrawData items, so that drawing an item
+ * again with the same size over the same background only takes copying
+ * pixels. The draw steps only depend on the position through the
+ * dithering of gradients, so a drawing is reused at any position with the
+ * same parity. The least recently used drawings are dropped when the
+ * cache grows too large.
+ */
+class DrawDataCache {
+public:
+	enum ColorFlags {
+		kColorFg = 1 << 0,
+		kColorBg = 1 << 1,
+		kColorBevel = 1 << 2,
+		kColorGradient = 1 << 3,
+		kColorAll = kColorFg | kColorBg | kColorBevel | kColorGradient
+	};
+
+	DrawDataCache() : _size(0), _maxBytes(0) { resetStats(); }
+	~DrawDataCache() { clear(); }
+
+	/**
+	 * Draw the steps of a DrawData item in area, or copy an earlier drawing
+	 * of it. extendedRect is the part of the surface the steps should
+	 * touch; the cache keeps kOverdraw more pixels on each side, since
+	 * shadows reach a little further.
+	 */
+	void draw(Graphics::VectorRenderer *renderer, const WidgetDrawData *data, const Common::Rect &area,
+	          const Common::Rect &extendedRect, uint32 dynamic);
+
+	/** Drop all drawings. */
+	void clear();
+
+	/** Drop all drawings, and keep at most maxBytes of them from now on. */
+	void setMaxBytes(uint32 maxBytes) {
+		clear();
+		_maxBytes = maxBytes;
+	}
+
+	const ThemeEngine::DrawCacheStats &getStats() const { return _stats; }
+	void resetStats();
+
+private:
+	enum {
+		kOverdraw = 2
+	};
+
+	struct Key {
+		const WidgetDrawData *data;
+		uint32 dynamic;
+		int16 width, height;
+		uint8 parity;                   ///< Lowest bits of the position
+		bool shadows;
+		Graphics::VectorRenderer::ColorState colors;
+		uint32 background;              ///< Hash of some of the pixels under the drawing
+
+		bool operator==(const Key &other) const;
+	};
+
+	struct KeyHash {
+		uint operator()(const Key &key) const;
+	};
+
+	struct KeyEqual {
+		bool operator()(const Key &a, const Key &b) const { return a == b; }
+	};
+
+	struct Entry {
+		Key key;
+		Graphics::Surface background;   ///< The pixels before drawing
+		Graphics::Surface result;       ///< The pixels after drawing
+	};
+
+	typedef Common::List<Entry> EntryList;
+	typedef Common::HashMap<Key, EntryList::iterator, KeyHash, KeyEqual> EntryMap;
+
+	static uint32 hashBackground(const Graphics::Surface &surface, const Common::Rect &r);
+	static void drawSteps(Graphics::VectorRenderer *renderer, const WidgetDrawData *data, const Common::Rect &area, uint32 dynamic);
+
+	void evict(EntryList::iterator entry);
+
+	EntryList _entries;     ///< Most recently used first
+	EntryMap _lookup;
+	uint32 _size;
+	uint32 _maxBytes;
+	ThemeEngine::DrawCacheStats _stats;
+};
+
+} // End of namespace GUI
+
+#endif
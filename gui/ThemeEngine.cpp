@@ -38,6 +38,7 @@
 #include "image/bmp.h"
 
 #include "gui/widget.h"
+#include "gui/ThemeDrawCache.h"
 #include "gui/ThemeEngine.h"
 #include "gui/ThemeEval.h"
 #include "gui/ThemeParser.h"
@@ -68,33 +69,6 @@ struct TextColorData {
 	int r, g, b;
 };
 
-struct WidgetDrawData {
-	/** List of all the steps needed to draw this widget */
-	Common::List<Graphics::DrawStep> _steps;
-
-	TextData _textDataId;
-	TextColor _textColorId;
-	Graphics::TextAlign _textAlignH;
-	GUI::ThemeEngine::TextAlignVertical _textAlignV;
-
-	/** Extra space that the widget occupies when it's drawn.
-	    E.g. when taking into account rounded corners, drop shadows, etc
-	    Used when restoring the widget background */
-	uint16 _backgroundOffset;
-
-	bool _buffer;
-
-
-	/**
-	 * Calculates the background threshold offset of a given DrawData item.
-	 * After fully loading all DrawSteps of a DrawData item, this function must be
-	 * called in order to calculate if such draw steps would be drawn outside of
-	 * the actual widget drawing zone (e.g. shadows). If this is the case, a constant
-	 * value will be added when restoring the background of the widget.
-	 */
-	void calcBackgroundOffset();
-};
-
 class ThemeItem {
 
 public:
@@ -233,11 +207,8 @@ void ThemeItemDrawData::drawSelf(bool draw, bool restore) {
 	if (restore)
 		_engine->restoreBackground(extendedRect);
 
-	if (draw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = _data->_steps.begin(); step != _data->_steps.end(); ++step)
-			_engine->renderer()->drawStep(_area, *step, _dynamicData);
-	}
+	if (draw)
+		_engine->drawDD(_data, _area, extendedRect, _dynamicData);
 
 	_engine->addDirtyRect(extendedRect);
 }
@@ -274,13 +245,14 @@ void ThemeItemBitmap::drawSelf(bool draw, bool restore) {
  * ThemeEngine class
  *********************************************************/
 ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
-	_system(0), _vectorRenderer(0),
+	_system(0), _vectorRenderer(0), _drawCache(0),
 	_buffering(false), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
 	_font(0), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
 	_cursor(0) {
 
 	_system = g_system;
 	_parser = new ThemeParser(this);
+	_drawCache = new DrawDataCache();
 	_themeEval = new GUI::ThemeEval();
 
 	_useCursor = false;
@@ -322,6 +294,7 @@ ThemeEngine::~ThemeEngine() {
 	_backBuffer.free();
 
 	unloadTheme();
+	delete _drawCache;
 
 	// Release all graphics surfaces
 	for (ImagesMap::iterator i = _bitmaps.begin(); i != _bitmaps.end(); ++i) {
@@ -524,6 +497,10 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// Keep a few screens worth of drawings, which is enough to cover the
+	// widgets of the usual dialogs
+	_drawCache->setMaxBytes(4 * _screen.pitch * _screen.h);
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -550,6 +527,18 @@ void ThemeEngine::restoreBackground(Common::Rect r) {
 	_vectorRenderer->blitSurface(&_backBuffer, r);
 }
 
+void ThemeEngine::drawDD(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedRect, uint32 dynamic) {
+	_drawCache->draw(_vectorRenderer, data, area, extendedRect, dynamic);
+}
+
+const ThemeEngine::DrawCacheStats &ThemeEngine::getDrawCacheStats() const {
+	return _drawCache->getStats();
+}
+
+void ThemeEngine::resetDrawCacheStats() {
+	_drawCache->resetStats();
+}
+
 
 
 /**********************************************************
@@ -705,6 +694,7 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 			warning("Missing data asset: '%s'", kDrawDataDefaults[i].name);
 		} else {
 			_widgets[i]->calcBackgroundOffset();
+			_widgets[i]->calcCacheInfo();
 		}
 	}
 }
@@ -713,6 +703,11 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	// The drawings refer to the DrawData items
+	const DrawCacheStats &stats = _drawCache->getStats();
+	debug(5, "DrawData cache: %u hits, %u misses, %u evictions", stats.hits, stats.misses, stats.evictions);
+	_drawCache->clear();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = 0;
@@ -1271,36 +1266,19 @@ void ThemeEngine::addDirtyRect(Common::Rect r) {
 	if (r.isEmpty())
 		return;
 
-	// Check if the new rectangle is contained within another in the list
-	Common::List<Common::Rect>::iterator it;
-	for (it = _dirtyScreen.begin(); it != _dirtyScreen.end();) {
-		// If we find a rectangle which fully contains the new one,
-		// we can abort the search.
-		if (it->contains(r))
-			return;
-
-		// Conversely, if we find rectangles which are contained in
-		// the new one, we can remove them
-		if (r.contains(*it))
-			it = _dirtyScreen.erase(it);
-		else
-			++it;
-	}
-
-	// If we got here, we can safely add r to the list of dirty rects.
-	_dirtyScreen.push_back(r);
+	_dirtyScreen.add(r);
 }
 
 void ThemeEngine::renderDirtyScreen() {
 	if (_dirtyScreen.empty())
 		return;
 
-	Common::List<Common::Rect>::iterator i;
+	Graphics::DirtyRectList::const_iterator i;
 	for (i = _dirtyScreen.begin(); i != _dirtyScreen.end(); ++i) {
 		_vectorRenderer->copyFrame(_system, *i);
 	}
 
-	_dirtyScreen.clear();
+	_dirtyScreen.nextFrame();
 }
 
 void ThemeEngine::openDialog(bool doBuffer, ShadingStyle style) {
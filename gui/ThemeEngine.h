@@ -31,6 +31,7 @@
 #include "common/str.h"
 #include "common/rect.h"
 
+#include "graphics/dirty_rects.h"
 #include "graphics/surface.h"
 #include "graphics/font.h"
 #include "graphics/pixelformat.h"
@@ -54,6 +55,7 @@ class Dialog;
 class GuiObject;
 class ThemeEval;
 class ThemeItem;
+class DrawDataCache;
 class ThemeParser;
 
 /**
@@ -523,6 +525,27 @@ public:
 	 */
 	void restoreBackground(Common::Rect r);
 
+	/**
+	 * Draws the steps of a DrawData item, or copies an earlier drawing of
+	 * the item with the same size over the same background.
+	 *
+	 * @param data         The item to draw.
+	 * @param area         Area of the widget.
+	 * @param extendedRect The part of the screen which the steps may change.
+	 * @param dynamic      Dynamic data of the item, e.g. the triangle orientation.
+	 */
+	void drawDD(const WidgetDrawData *data, const Common::Rect &area, const Common::Rect &extendedRect, uint32 dynamic);
+
+	struct DrawCacheStats {
+		uint32 hits;        ///< DrawData items copied from an earlier drawing
+		uint32 misses;      ///< DrawData items drawn step by step and kept
+		uint32 evictions;   ///< Drawings dropped to stay within the size limit
+	};
+
+	/** Statistics of the cache of drawn DrawData items, used by drawDD(). */
+	const DrawCacheStats &getDrawCacheStats() const;
+	void resetDrawCacheStats();
+
 	const Common::String &getThemeName() const { return _themeName; }
 	const Common::String &getThemeId() const { return _themeId; }
 	int getGraphicsMode() const { return _graphicsMode; }
@@ -632,6 +655,9 @@ protected:
 	/** Backbuffer surface. Stores previous states of the screen to blit back */
 	Graphics::Surface _backBuffer;
 
+	/** Drawings of DrawData items which can be copied instead of drawn again */
+	DrawDataCache *_drawCache;
+
 	/** Sets whether the current drawing is being buffered (stored for later
 	    processing) or drawn directly to the screen. */
 	bool _buffering;
@@ -665,7 +691,7 @@ protected:
 #endif
 
 	/** List of all the dirty screens that must be blitted to the overlay. */
-	Common::List<Common::Rect> _dirtyScreen;
+	Graphics::DirtyRectList _dirtyScreen;
 
 	/** Queue with all the drawing that must be done to the Back Buffer */
 	Common::List<ThemeItem *> _bufferQueue;
@@ -50,6 +50,9 @@ namespace GUI {
 
 Debugger::Debugger() {
 	_frameCountdown = 0;
+	_frameCount = 0;
+	_stringAllocsAtReset = _stringAllocsAtFrame = Common::String::getHeapAllocationCount();
+	_stringAllocsLastFrame = 0;
 	_isActive = false;
 	_errStr = NULL;
 	_firstTime = true;
@@ -78,6 +81,7 @@ Debugger::Debugger() {
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
+	registerCmd("string_allocs",		WRAP_METHOD(Debugger, cmdStringAllocs));
 }
 
 Debugger::~Debugger() {
@@ -171,6 +175,12 @@ void Debugger::detach() {
 
 // Temporary execution handler
 void Debugger::onFrame() {
+	// Keep track of the string allocations made during the last frame
+	const uint32 stringAllocs = Common::String::getHeapAllocationCount();
+	_stringAllocsLastFrame = stringAllocs - _stringAllocsAtFrame;
+	_stringAllocsAtFrame = stringAllocs;
+	_frameCount++;
+
 	// Count down until 0 is reached
 	if (_frameCountdown > 0) {
 		--_frameCountdown;
@@ -728,6 +738,28 @@ bool Debugger::cmdDebugFlagDisable(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdStringAllocs(int argc, const char **argv) {
+	if (argc > 2 || (argc == 2 && scumm_stricmp(argv[1], "reset"))) {
+		debugPrintf("Usage: %s [reset]\n", argv[0]);
+		return true;
+	}
+
+	if (argc == 2) {
+		_frameCount = 0;
+		_stringAllocsAtReset = _stringAllocsAtFrame = Common::String::getHeapAllocationCount();
+		_stringAllocsLastFrame = 0;
+		debugPrintf("String allocation counters reset\n");
+		return true;
+	}
+
+	const uint32 allocs = Common::String::getHeapAllocationCount() - _stringAllocsAtReset;
+	debugPrintf("String heap allocations: %u total, %u in the last frame", allocs, _stringAllocsLastFrame);
+	if (_frameCount)
+		debugPrintf(", %u per frame on average over %u frames", allocs / _frameCount, _frameCount);
+	debugPrintf("\n");
+	return true;
+}
+
 // Console handler
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 bool Debugger::debuggerInputCallback(GUI::ConsoleDialog *console, const char *input, void *refCon) {
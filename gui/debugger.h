@@ -150,6 +150,15 @@ private:
 	 */
 	uint _frameCountdown;
 
+	/**
+	 * String heap allocation counters, updated in onFrame() to report the
+	 * string churn per frame.
+	 */
+	uint32 _frameCount;
+	uint32 _stringAllocsAtReset;
+	uint32 _stringAllocsAtFrame;
+	uint32 _stringAllocsLastFrame;
+
 	Common::Array<Var> _vars;
 
 	typedef Common::HashMap<Common::String, Common::SharedPtr<Debuglet>, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> CommandsMap;
@@ -226,6 +235,7 @@ protected:
 	bool cmdDebugFlagsList(int argc, const char **argv);
 	bool cmdDebugFlagEnable(int argc, const char **argv);
 	bool cmdDebugFlagDisable(int argc, const char **argv);
+	bool cmdStringAllocs(int argc, const char **argv);
 
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 private:
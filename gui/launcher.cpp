@@ -52,6 +52,8 @@
 
 #include "graphics/cursorman.h"
 
+#include "engines/detectioncache.h"
+
 using Common::ConfigManager;
 
 namespace GUI {
@@ -848,6 +850,7 @@ void LauncherDialog::addGame() {
 			// ...so let's determine a list of candidates, games that
 			// could be contained in the specified directory.
 			GameList candidates(EngineMan.detectGames(files));
+			DetectionCacheMan.flush();
 
 			int idx;
 			if (candidates.empty()) {
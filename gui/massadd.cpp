@@ -21,6 +21,7 @@
  */
 
 #include "engines/metaengine.h"
+#include "engines/detectioncache.h"
 #include "common/algorithm.h"
 #include "common/config-manager.h"
 #include "common/debug.h"
@@ -63,6 +64,7 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	_dirsScanned(0),
 	_oldGamesCount(0),
 	_dirTotal(0),
+	_scanStartTime(0),
 	_okButton(0),
 	_dirProgressText(0),
 	_gameProgressText(0) {
@@ -72,6 +74,9 @@ MassAddDialog::MassAddDialog(const Common::FSNode &startDir)
 	// The dir we start our scan at
 	_scanStack.push(startDir);
 
+	// Only count the cache hits of this scan
+	DetectionCacheMan.resetStats();
+
 	// Removed for now... Why would you put a title on mass add dialog called "Mass Add Dialog"?
 	// new StaticTextWidget(this, "massadddialog_caption", "Mass Add Dialog");
 
@@ -163,7 +168,9 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave. Whatever
+		// was hashed so far is still worth keeping for the next scan.
+		DetectionCacheMan.flush();
 		_games.clear();
 		close();
 	} else {
@@ -176,6 +183,8 @@ void MassAddDialog::handleTickle() {
 		return;	// We have finished scanning
 
 	uint32 t = g_system->getMillis();
+	if (!_scanStartTime)
+		_scanStartTime = t;
 
 	// Perform a breadth-first scan of the filesystem.
 	while (!_scanStack.empty() && (g_system->getMillis() - t) < kMaxScanTime) {
@@ -256,6 +265,10 @@ void MassAddDialog::handleTickle() {
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
+		DetectionCacheMan.flush();
+		debug(1, "MassAdd: %u detection cache hits, %u misses",
+			DetectionCacheMan.getStats().hits, DetectionCacheMan.getStats().misses);
+
 		buf = _("Scan complete!");
 		_dirProgressText->setLabel(buf);
 
@@ -263,7 +276,11 @@ void MassAddDialog::handleTickle() {
 		_gameProgressText->setLabel(buf);
 
 	} else {
+		// The total number of directories is not known before the scan is
+		// done, so only show how fast it is going
+		uint32 elapsed = g_system->getMillis() - _scanStartTime;
 		buf = Common::String::format(_("Scanned %d directories ..."), _dirsScanned);
+		buf += " " + Common::String::format(_("(%d/s)"), elapsed ? (int)(_dirsScanned * 1000LL / elapsed) : 0);
 		_dirProgressText->setLabel(buf);
 
 		buf = Common::String::format(_("Discovered %d new games, ignored %d previously added games ..."), _games.size(), _oldGamesCount);
@@ -62,6 +62,7 @@ private:
 	int _dirsScanned;
 	int _oldGamesCount;
 	int _dirTotal;
+	uint32 _scanStartTime;
 
 	Widget *_okButton;
 	StaticTextWidget *_dirProgressText;
@@ -3,6 +3,7 @@
 
 #include "audio/decoders/raw.h"
 
+#include "common/memstream.h"
 #include "common/stream.h"
 #include "common/endian.h"
 
@@ -0,0 +1,520 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "common/atomic.h"
+#include "common/cpudetect.h"
+#include "common/system.h"
+#include "common/util.h"
+
+#include "helper.h"
+
+#ifdef POSIX
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Just enough of a system for the mixer: mutexes and a clock. With POSIX
+ * threads, the mutexes are real ones, so that the mixer callback can run in
+ * a thread of its own.
+ */
+class MixerTestSystem : public OSystem {
+public:
+	MixerTestSystem() : _locks(0) {}
+
+	/** The number of times a mutex has been locked. */
+	Common::Atomic<int> _locks;
+
+	virtual MutexRef createMutex() {
+#ifdef POSIX
+		pthread_mutexattr_t attr;
+		pthread_mutexattr_init(&attr);
+		pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+		pthread_mutex_t *mutex = new pthread_mutex_t;
+		pthread_mutex_init(mutex, &attr);
+		pthread_mutexattr_destroy(&attr);
+		return (MutexRef)mutex;
+#else
+		return (MutexRef)new int;
+#endif
+	}
+	virtual void lockMutex(MutexRef mutex) {
+#ifdef POSIX
+		pthread_mutex_lock((pthread_mutex_t *)mutex);
+#endif
+		int locks = _locks.load();
+		while (!_locks.compareExchange(locks, locks + 1))
+			locks = _locks.load();
+	}
+	virtual void unlockMutex(MutexRef mutex) {
+#ifdef POSIX
+		pthread_mutex_unlock((pthread_mutex_t *)mutex);
+#endif
+	}
+	virtual void deleteMutex(MutexRef mutex) {
+#ifdef POSIX
+		pthread_mutex_destroy((pthread_mutex_t *)mutex);
+		delete (pthread_mutex_t *)mutex;
+#else
+		delete (int *)mutex;
+#endif
+	}
+
+	virtual uint32 getMillis(bool skipRecord = false) { return 1; }
+	virtual void delayMillis(uint msecs) {
+#ifdef POSIX
+		sched_yield();
+#endif
+	}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return Graphics::PixelFormat::createFormatCLUT8(); }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(void *buf, int pitch) {}
+	virtual void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+};
+
+/** What happened to a MixerTestStream, which outlives the stream. */
+struct MixerTestStreamState {
+	MixerTestStreamState() : reads(0), reading(0), deleted(0), deletedWhileReading(0) {}
+
+	Common::Atomic<int> reads;
+	Common::Atomic<int> reading;
+	Common::Atomic<int> deleted;
+	Common::Atomic<int> deletedWhileReading;
+};
+
+/** A stereo stream of a constant value, which reports what happens to it. */
+class MixerTestStream : public Audio::AudioStream {
+public:
+	MixerTestStream(MixerTestStreamState *state, int16 value, int length, int rate = 22050)
+		: _state(state), _value(value), _left(length), _rate(rate), _mixer(0) {}
+
+	~MixerTestStream() {
+		if (_state->reading.load())
+			_state->deletedWhileReading.store(1);
+		_state->deleted.store(1);
+	}
+
+	/** Stop another sound, from within the mixer callback, on the first read. */
+	void stopOnRead(Audio::Mixer *mixer, Audio::SoundHandle handle) {
+		_mixer = mixer;
+		_stopHandle = handle;
+	}
+
+	virtual int readBuffer(int16 *buffer, const int numSamples) {
+		_state->reading.store(1);
+		_state->reads.store(_state->reads.load() + 1);
+
+		if (_mixer) {
+			_mixer->stopHandle(_stopHandle);
+			_mixer = 0;
+		}
+
+		const int samples = MIN(numSamples, _left);
+		for (int i = 0; i < samples; i++)
+			buffer[i] = _value;
+		_left -= samples;
+
+		_state->reading.store(0);
+		return samples;
+	}
+
+	virtual bool isStereo() const { return true; }
+	virtual int getRate() const { return _rate; }
+	virtual bool endOfData() const { return _left == 0; }
+
+private:
+	MixerTestStreamState *_state;
+	const int16 _value;
+	int _left;
+	const int _rate;
+
+	Audio::Mixer *_mixer;
+	Audio::SoundHandle _stopHandle;
+};
+
+class MixerTestSuite : public CxxTest::TestSuite
+{
+	MixerTestSystem *_system;
+	Audio::MixerImpl *_mixer;
+
+	enum {
+		kRate = 22050
+	};
+
+	static Audio::SoundHandle play(Audio::MixerImpl *mixer, Audio::AudioStream *stream,
+	                               byte volume = Audio::Mixer::kMaxChannelVolume, int8 balance = 0, bool reverseStereo = false) {
+		Audio::SoundHandle handle;
+		mixer->playStream(Audio::Mixer::kPlainSoundType, &handle, stream, -1, volume, balance,
+		                  DisposeAfterUse::YES, false, reverseStereo);
+		return handle;
+	}
+
+	Audio::SoundHandle play(Audio::AudioStream *stream) {
+		return play(_mixer, stream);
+	}
+
+	Audio::SoundHandle play(MixerTestStreamState *state, int16 value, int length) {
+		return play(new MixerTestStream(state, value, length));
+	}
+
+	/** Convert a sample of the mixer callback output to a signed one. */
+	static int toSigned(int16 sample) {
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		return (int16)(sample ^ 0x8000);
+#else
+		return sample;
+#endif
+	}
+
+	/** Mix some sample pairs, and return whether all of them are close to the value. */
+	bool mixes(int16 value, uint len = 256) {
+		int16 *buffer = new int16[2 * len];
+		_mixer->mixCallback((byte *)buffer, 4 * len);
+
+		bool match = true;
+		for (uint i = 0; i < 2 * len; i++) {
+			// The dither might change the lowest bit
+			if (ABS(toSigned(buffer[i]) - value) > 1)
+				match = false;
+		}
+		delete[] buffer;
+		return match;
+	}
+
+	/** Mix some sample pairs, and return the average of the samples. */
+	double mixAverage(uint len, int *minSample, int *maxSample) {
+		int16 *buffer = new int16[2 * len];
+		_mixer->mixCallback((byte *)buffer, 4 * len);
+
+		double sum = 0;
+		*minSample = *maxSample = toSigned(buffer[0]);
+		for (uint i = 0; i < 2 * len; i++) {
+			const int sample = toSigned(buffer[i]);
+			sum += sample;
+			*minSample = MIN(*minSample, sample);
+			*maxSample = MAX(*maxSample, sample);
+		}
+		delete[] buffer;
+		return sum / (2 * len);
+	}
+
+	/** Play some sounds with different converters and volumes, and return what they mix to. */
+	static void mixSines(int16 *buffer, uint len) {
+		Audio::MixerImpl mixer(g_system, kRate);
+		mixer.setReady(true);
+		play(&mixer, createSineStream<int16>(kRate, 1, 0, true, true), 200, -50);
+		play(&mixer, createSineStream<int16>(11025, 1, 0, true, false), 255, 100);
+		play(&mixer, createSineStream<int16>(44100, 1, 0, true, true), 17, 0, true);
+		play(&mixer, createSineStream<int16>(8000, 1, 0, true, true), 255, 0, true);
+
+		// In uneven chunks, to get the scalar tails of the vectorized loops
+		uint done = 0;
+		while (done < len) {
+			const uint chunk = MIN<uint>(len - done, 301);
+			mixer.mixCallback((byte *)(buffer + 2 * done), 4 * chunk);
+			done += chunk;
+		}
+	}
+
+#ifdef POSIX
+	struct MixerThread {
+		Audio::MixerImpl *mixer;
+		Common::Atomic<int> quit;
+	};
+
+	static void *runMixerThread(void *data) {
+		MixerThread *thread = (MixerThread *)data;
+		int16 buffer[2 * 64];
+		while (!thread->quit.load())
+			thread->mixer->mixCallback((byte *)buffer, sizeof(buffer));
+		return 0;
+	}
+#endif
+
+public:
+	void setUp() {
+		_system = new MixerTestSystem();
+		g_system = _system;
+		_mixer = new Audio::MixerImpl(_system, kRate);
+		_mixer->setReady(true);
+	}
+
+	void tearDown() {
+		delete _mixer;
+		g_system = 0;
+		delete _system;
+	}
+
+	void test_finished_sound_is_deleted_by_queries() {
+		MixerTestStreamState state;
+		Audio::SoundHandle handle = play(&state, 1000, 2 * 100);
+
+		TS_ASSERT(mixes(1000, 100));
+		TS_ASSERT(_mixer->isSoundHandleActive(handle));
+		TS_ASSERT(!state.deleted.load());
+
+		// The mixer callback notices that the sound has ended
+		TS_ASSERT(mixes(0));
+		TS_ASSERT(!_mixer->isSoundHandleActive(handle));
+		TS_ASSERT(state.deleted.load());
+	}
+
+	void test_finished_sound_is_deleted_by_stop() {
+		MixerTestStreamState finished, playing;
+		play(&finished, 1000, 2 * 100);
+		Audio::SoundHandle handle = play(&playing, 2000, 2 * kRate);
+
+		TS_ASSERT(mixes(3000, 100));
+		TS_ASSERT(mixes(2000));
+		TS_ASSERT(!finished.deleted.load());
+
+		_mixer->stopHandle(handle);
+		TS_ASSERT(finished.deleted.load());
+		TS_ASSERT(playing.deleted.load());
+	}
+
+	void test_stop_deletes_stream() {
+		MixerTestStreamState a, b;
+		Audio::SoundHandle handle = play(&a, 1000, 2 * kRate);
+		play(&b, 2000, 2 * kRate);
+		TS_ASSERT(mixes(3000));
+
+		_mixer->stopHandle(handle);
+		TS_ASSERT(a.deleted.load());
+		TS_ASSERT(!_mixer->isSoundHandleActive(handle));
+		TS_ASSERT(mixes(2000));
+
+		_mixer->stopAll();
+		TS_ASSERT(b.deleted.load());
+		TS_ASSERT(mixes(0));
+	}
+
+	void test_stop_from_mixer_callback() {
+		// Sounds stopped by the stream of another one from within the mixer
+		// callback are not mixed anymore, no matter whether they come
+		// before or after it
+		MixerTestStreamState before, stopping, after;
+		Audio::SoundHandle beforeHandle = play(&before, 1000, 2 * kRate);
+		MixerTestStream *stream = new MixerTestStream(&stopping, 2000, 2 * kRate);
+		play(stream);
+		Audio::SoundHandle afterHandle = play(&after, 4000, 2 * kRate);
+
+		stream->stopOnRead(_mixer, afterHandle);
+		TS_ASSERT(mixes(3000));
+		TS_ASSERT(after.deleted.load());
+		TS_ASSERT_EQUALS(after.reads.load(), 0);
+
+		stream->stopOnRead(_mixer, beforeHandle);
+		TS_ASSERT(mixes(3000));
+		TS_ASSERT(before.deleted.load());
+		TS_ASSERT(mixes(2000));
+		TS_ASSERT(!stopping.deleted.load());
+
+		_mixer->stopAll();
+		TS_ASSERT(stopping.deleted.load());
+	}
+
+	void test_mixer_callback_does_not_lock() {
+		MixerTestStreamState state;
+		play(&state, 1000, 2 * kRate);
+
+		const int locks = _system->_locks.load();
+		TS_ASSERT(mixes(1000));
+#ifdef COMMON_HAS_LOCKFREE_ATOMICS
+		TS_ASSERT_EQUALS(_system->_locks.load(), locks);
+#else
+		TS_ASSERT_LESS_THAN(locks, _system->_locks.load());
+#endif
+
+		_mixer->stopAll();
+	}
+
+	void test_silence_is_not_dithered() {
+		int16 buffer[2 * 64];
+		TS_ASSERT_EQUALS(_mixer->mixCallback((byte *)buffer, sizeof(buffer)), 0);
+		for (uint i = 0; i < ARRAYSIZE(buffer); i++)
+			TS_ASSERT_EQUALS(toSigned(buffer[i]), 0);
+
+		float floatBuffer[2 * 64];
+		TS_ASSERT_EQUALS(_mixer->mixCallbackFloat(floatBuffer, sizeof(floatBuffer)), 0);
+		for (uint i = 0; i < ARRAYSIZE(floatBuffer); i++)
+			TS_ASSERT_EQUALS(floatBuffer[i], 0.0f);
+	}
+
+	void test_bus_clips_only_the_output() {
+		// Sounds which would clip together are not clipped against each
+		// other, only the sum of all of them is
+		MixerTestStreamState a, b, c;
+		play(&a, 30000, 2 * kRate);
+		play(&b, 30000, 2 * kRate);
+		TS_ASSERT(mixes(32767));
+
+		play(&c, -30000, 2 * kRate);
+		TS_ASSERT(mixes(30000));
+
+		_mixer->stopAll();
+	}
+
+	void test_output_format() {
+		MixerTestStreamState a, b;
+		play(&a, 30000, 2 * kRate);
+		play(&b, 30000, 2 * kRate);
+
+		// Clipped values are not dithered
+		int16 buffer[2 * 64];
+		TS_ASSERT_EQUALS(_mixer->mixCallback((byte *)buffer, sizeof(buffer)), 64);
+#ifdef OUTPUT_UNSIGNED_AUDIO
+		const uint16 expected = 0xFFFF;
+#else
+		const uint16 expected = 0x7FFF;
+#endif
+		for (uint i = 0; i < ARRAYSIZE(buffer); i++)
+			TS_ASSERT_EQUALS((uint16)buffer[i], expected);
+
+		_mixer->stopAll();
+	}
+
+	void test_volume_keeps_fractions() {
+		// At about half the volume, a sample of 1 becomes half a sample.
+		// The dither keeps that on average, and two of them add up to one.
+		MixerTestStreamState a, b;
+		play(_mixer, new MixerTestStream(&a, 1, 2 * kRate), 128);
+
+		int minSample, maxSample;
+		TS_ASSERT_DELTA(mixAverage(4096, &minSample, &maxSample), 0.5, 0.05);
+		TS_ASSERT_EQUALS(minSample, 0);
+		TS_ASSERT_EQUALS(maxSample, 1);
+
+		play(_mixer, new MixerTestStream(&b, 1, 2 * kRate), 128);
+		TS_ASSERT_DELTA(mixAverage(4096, &minSample, &maxSample), 1.0, 0.05);
+		TS_ASSERT_LESS_THAN_EQUALS(0, minSample);
+		TS_ASSERT_LESS_THAN_EQUALS(maxSample, 2);
+
+		_mixer->stopAll();
+	}
+
+	void test_float_output() {
+		MixerTestStreamState a, b;
+		play(&a, 16384, 2 * kRate);
+
+		float buffer[2 * 64];
+		TS_ASSERT_EQUALS(_mixer->mixCallbackFloat(buffer, sizeof(buffer)), 64);
+		for (uint i = 0; i < ARRAYSIZE(buffer); i++)
+			TS_ASSERT_EQUALS(buffer[i], 0.5f);
+
+		play(&b, 30000, 2 * kRate);
+		TS_ASSERT_EQUALS(_mixer->mixCallbackFloat(buffer, sizeof(buffer)), 64);
+		for (uint i = 0; i < ARRAYSIZE(buffer); i++)
+			TS_ASSERT_EQUALS(buffer[i], 1.0f);
+
+		_mixer->stopAll();
+	}
+
+	void test_bus_matches_scalar() {
+		const uint len = 4000;
+		int16 *expected = new int16[2 * len];
+		int16 *actual = new int16[2 * len];
+
+		Common::setCPUFeatureMask(0);
+		mixSines(expected, len);
+
+		const uint32 masks[] = { Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+			Common::setCPUFeatureMask(masks[i]);
+			mixSines(actual, len);
+			TS_ASSERT(!memcmp(expected, actual, 2 * len * sizeof(int16)));
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	void test_sinc_sound_plays_to_the_end() {
+		delete _mixer;
+		_mixer = new Audio::MixerImpl(_system, kRate, Audio::kRateConverterSinc);
+		_mixer->setReady(true);
+
+		// 100 frames of input become 200 frames of output, of which the
+		// first mix call only takes some
+		MixerTestStreamState state;
+		Audio::SoundHandle handle = play(new MixerTestStream(&state, 1000, 2 * 100, kRate / 2));
+		int minSample, maxSample;
+		mixAverage(150, &minSample, &maxSample);
+		TS_ASSERT(_mixer->isSoundHandleActive(handle));
+
+		// The rest comes out after the stream has ended
+		TS_ASSERT(mixes(1000, 30));
+		mixAverage(20, &minSample, &maxSample);
+		TS_ASSERT_LESS_THAN(400, minSample);
+		TS_ASSERT(mixes(0));
+		TS_ASSERT(!_mixer->isSoundHandleActive(handle));
+	}
+
+	void test_stop_while_mixing() {
+#ifdef POSIX
+		// Play and stop sounds while the mixer callback runs in another
+		// thread. A stream must never be deleted while it is being read, and
+		// it must be gone once the stop call returns.
+		enum { kSounds = 500 };
+		MixerTestStreamState *states = new MixerTestStreamState[kSounds];
+
+		MixerThread thread;
+		thread.mixer = _mixer;
+		thread.quit.store(0);
+		pthread_t id;
+		TS_ASSERT_EQUALS(pthread_create(&id, 0, runMixerThread, &thread), 0);
+
+		for (int i = 0; i < kSounds; i++) {
+			// Some of them end before they are stopped
+			Audio::SoundHandle handle = play(&states[i], 1000, (i % 3) ? 2 * kRate : 2 * 16);
+			while (!states[i].reads.load() && _mixer->isSoundHandleActive(handle))
+				sched_yield();
+
+			if (i % 2)
+				_mixer->stopHandle(handle);
+			else
+				_mixer->stopAll();
+			TS_ASSERT(states[i].deleted.load());
+		}
+
+		thread.quit.store(1);
+		pthread_join(id, 0);
+
+		for (int i = 0; i < kSounds; i++)
+			TS_ASSERT(!states[i].deletedWhileReading.load());
+		delete[] states;
+#endif
+	}
+};
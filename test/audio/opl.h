@@ -0,0 +1,202 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/opl/dbopl.h"
+#include "common/cpudetect.h"
+#include "common/str.h"
+
+#include "test/common/benchmark.h"
+
+class OPLTestSuite : public CxxTest::TestSuite
+{
+	typedef OPL::DOSBox::DBOPL::Chip Chip;
+
+	/**
+	 * The register writes of a song, which are shaped like the ones of the
+	 * AdLib music drivers of our engines.
+	 */
+	enum Song {
+		/** All nine melodic channels, with the OPL2 wave forms enabled */
+		kSongMelodic,
+		/** Six melodic channels and the percussion ones in rhythm mode */
+		kSongRhythm,
+		/** OPL3 mode with four operator channels and panning */
+		kSongOPL3,
+		kSongCount
+	};
+
+	static const char *getSongName(int song) {
+		static const char *const names[] = { "melodic", "rhythm", "OPL3" };
+		return names[song];
+	}
+
+	static bool isStereo(int song) {
+		return song == kSongOPL3;
+	}
+
+	static void writeInstrument(Chip *chip, int channel, int instrument) {
+		// 0x20, 0x23, 0x40, 0x43, 0x60, 0x63, 0x80, 0x83, 0xE0, 0xE3, 0xC0
+		static const byte instruments[][11] = {
+			{ 0x21, 0x21, 0x1A, 0x00, 0xF1, 0xF2, 0x35, 0x16, 0x00, 0x00, 0x0E }, // Strings
+			{ 0x01, 0x11, 0x4F, 0x00, 0xF1, 0xD2, 0x53, 0x74, 0x00, 0x00, 0x06 }, // Piano
+			{ 0x31, 0x21, 0x1C, 0x80, 0x41, 0x92, 0x0B, 0x3B, 0x00, 0x00, 0x0E }, // Brass
+			{ 0xE1, 0xE2, 0x23, 0x00, 0x74, 0x65, 0x17, 0x17, 0x01, 0x00, 0x0B }, // Organ
+			{ 0x62, 0x21, 0x1E, 0x00, 0x75, 0x75, 0x11, 0x18, 0x02, 0x00, 0x07 }, // Bass
+			{ 0x13, 0x01, 0x96, 0x00, 0xFF, 0xFF, 0x21, 0x0A, 0x03, 0x00, 0x0F }, // Bell
+		};
+		static const byte operators[] = { 0x00, 0x01, 0x02, 0x08, 0x09, 0x0A, 0x10, 0x11, 0x12 };
+
+		const byte *regs = instruments[instrument % ARRAYSIZE(instruments)];
+		const int bank = (channel / 9) * 0x100;
+		const int op = bank + operators[channel % 9];
+		for (int i = 0; i < 4; i++) {
+			chip->WriteReg(0x20 + i * 0x20 + op, regs[i * 2]);
+			chip->WriteReg(0x23 + i * 0x20 + op, regs[i * 2 + 1]);
+		}
+		chip->WriteReg(0xE0 + op, regs[8]);
+		chip->WriteReg(0xE3 + op, regs[9]);
+		// Both speakers in OPL3 mode, ignored in OPL2 mode
+		chip->WriteReg(0xC0 + bank + channel % 9, regs[10] | (channel & 1 ? 0x10 : 0x30));
+	}
+
+	static void writeNote(Chip *chip, int channel, int note, bool on) {
+		static const uint16 fnums[] = { 0x157, 0x16B, 0x181, 0x198, 0x1B0, 0x1CA, 0x1E5, 0x202, 0x220, 0x241, 0x263, 0x287 };
+		const int reg = (channel / 9) * 0x100 + channel % 9;
+		const uint16 fnum = fnums[note % 12];
+		const int block = note / 12;
+		chip->WriteReg(0xA0 + reg, fnum & 0xFF);
+		chip->WriteReg(0xB0 + reg, (on ? 0x20 : 0) | (block << 2) | (fnum >> 8));
+	}
+
+	/** Play a song, with one tick of the music driver every 1/60th of a second. */
+	static void render(int song, int rate, int32 *output, int samples) {
+		OPL::DOSBox::DBOPL::InitTables();
+		Chip *chip = new Chip();
+		chip->Setup(rate);
+
+		static const byte melody[] = { 0, 4, 7, 12, 11, 7, 4, 2, 0, 5, 9, 12, 14, 12, 9, 5 };
+		const int channels = song == kSongOPL3 ? 18 : (song == kSongRhythm ? 6 : 9);
+
+		chip->WriteReg(0x01, 0x20);
+		if (song == kSongOPL3) {
+			chip->WriteReg(0x105, 0x01);
+			// Four operator channels 0 and 1, which also use channels 3 and 4
+			chip->WriteReg(0x104, 0x03);
+		}
+		for (int ch = 0; ch < channels; ch++)
+			writeInstrument(chip, ch, ch);
+		if (song == kSongRhythm) {
+			writeInstrument(chip, 6, 4);
+			writeInstrument(chip, 7, 5);
+			writeInstrument(chip, 8, 5);
+			writeNote(chip, 6, 24, false);
+			writeNote(chip, 7, 55, false);
+			writeNote(chip, 8, 48, false);
+		}
+
+		const int samplesPerTick = rate / 60;
+		const int stereo = isStereo(song) ? 2 : 1;
+		int32 *end = output + samples * stereo;
+		for (int tick = 0; output < end; tick++) {
+			for (int ch = 0; ch < channels; ch++) {
+				// Each channel plays a note every few ticks, and holds it for
+				// a while, with the lower channels playing the bass line
+				const int length = 6 + (ch % 4) * 4;
+				const int phase = (tick + ch * 5) % length;
+				if (phase == 0)
+					writeNote(chip, ch, 36 + (ch % 3) * 12 + melody[(tick / length + ch) % ARRAYSIZE(melody)], true);
+				else if (phase == length - 2)
+					writeNote(chip, ch, 36 + (ch % 3) * 12 + melody[(tick / length + ch) % ARRAYSIZE(melody)], false);
+			}
+			if (song == kSongRhythm) {
+				// Bass drum, snare and hi-hat patterns, with a cymbal now and then
+				static const byte drums[] = { 0x11, 0x01, 0x09, 0x01, 0x10, 0x01, 0x09, 0x03 };
+				chip->WriteReg(0xBD, 0x20);
+				if (tick % 4 == 0)
+					chip->WriteReg(0xBD, 0x20 | drums[(tick / 4) % ARRAYSIZE(drums)]);
+			}
+
+			int todo = MIN<int>(samplesPerTick, (end - output) / stereo);
+			while (todo > 0) {
+				// Like OPL::DOSBox::OPL::generateSamples
+				const int block = MIN(todo, 512);
+				if (stereo == 2)
+					chip->GenerateBlock3(block, output);
+				else
+					chip->GenerateBlock2(block, output);
+				output += block * stereo;
+				todo -= block;
+			}
+		}
+
+		delete chip;
+	}
+
+public:
+	void test_simd_matches_scalar() {
+		const int samples = 44100;
+		int32 *expected = new int32[samples * 2];
+		int32 *actual = new int32[samples * 2];
+
+		const uint32 masks[] = { Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		for (int song = 0; song < kSongCount; song++) {
+			const int numSamples = samples * (isStereo(song) ? 2 : 1);
+			Common::setCPUFeatureMask(0);
+			render(song, 44100, expected, samples);
+
+			for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+				Common::setCPUFeatureMask(masks[i]);
+				render(song, 44100, actual, samples);
+				TS_ASSERT(!memcmp(expected, actual, numSamples * sizeof(int32)));
+			}
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		delete[] expected;
+		delete[] actual;
+	}
+
+	void test_songs_are_audible() {
+		const int samples = 22050;
+		int32 *output = new int32[samples * 2];
+
+		for (int song = 0; song < kSongCount; song++) {
+			render(song, 22050, output, samples);
+
+			int32 peak = 0;
+			for (int i = 0; i < samples * (isStereo(song) ? 2 : 1); i++)
+				peak = MAX<int32>(peak, ABS(output[i]));
+			TS_ASSERT_LESS_THAN(1000, peak);
+		}
+
+		delete[] output;
+	}
+
+	void test_benchmark_songs() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const int kRate = 44100;
+		const int kSamples = kRate * 10;
+		int32 *output = new int32[kSamples * 2];
+
+		static const struct {
+			const char *name;
+			uint32 cpuFeatures;
+		} runs[] = {
+			{ "scalar", 0 },
+			{ "SIMD", 0xFFFFFFFF }
+		};
+
+		for (int song = 0; song < kSongCount; song++) {
+			for (uint r = 0; r < ARRAYSIZE(runs); r++) {
+				Common::setCPUFeatureMask(runs[r].cpuFeatures);
+				BenchmarkTimer timer;
+				render(song, kRate, output, kSamples);
+				timer.report(Common::String::format("DOSBox OPL, %s song, %s", getSongName(song), runs[r].name).c_str(), kSamples, "samples");
+			}
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		delete[] output;
+	}
+};
@@ -0,0 +1,286 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/rate.h"
+#include "common/cpudetect.h"
+#include "common/str.h"
+
+#include "test/common/benchmark.h"
+
+#include <math.h>
+
+class RateTestSuite : public CxxTest::TestSuite
+{
+	/** Plays back a buffer of samples, which it takes ownership of. */
+	class BufferStream : public Audio::AudioStream {
+	public:
+		BufferStream(int16 *samples, int numSamples, int rate, bool stereo)
+			: _samples(samples), _numSamples(numSamples), _pos(0), _rate(rate), _stereo(stereo) {}
+		~BufferStream() { delete[] _samples; }
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			const int len = MIN(numSamples, _numSamples - _pos);
+			memcpy(buffer, _samples + _pos, len * sizeof(int16));
+			_pos += len;
+			return len;
+		}
+		bool isStereo() const { return _stereo; }
+		int getRate() const { return _rate; }
+		bool endOfData() const { return _pos >= _numSamples; }
+
+	private:
+		int16 *_samples;
+		int _numSamples, _pos;
+		int _rate;
+		bool _stereo;
+	};
+
+	static BufferStream *makeNoise(int frames, int rate, bool stereo, uint32 seed) {
+		const int numSamples = frames * (stereo ? 2 : 1);
+		int16 *samples = new int16[numSamples];
+		for (int i = 0; i < numSamples; i++) {
+			seed = seed * 1103515245 + 12345;
+			samples[i] = seed >> 16;
+		}
+		return new BufferStream(samples, numSamples, rate, stereo);
+	}
+
+	static BufferStream *makeSine(int frames, int rate, bool stereo, double freq, double amplitude) {
+		const int numSamples = frames * (stereo ? 2 : 1);
+		int16 *samples = new int16[numSamples];
+		for (int i = 0; i < numSamples; i++)
+			samples[i] = (int16)(sin(2 * M_PI * freq * (stereo ? i / 2 : i) / rate) * amplitude);
+		return new BufferStream(samples, numSamples, rate, stereo);
+	}
+
+	static int flow(Audio::RateConverter *converter, Audio::AudioStream &input, int16 *obuf, int frames,
+	                Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		return converter->flow(input, obuf, frames, volL, volR);
+	}
+
+	static int flow(Audio::RateConverter *converter, Audio::AudioStream &input, int32 *obuf, int frames,
+	                Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		return converter->flowMix32(input, obuf, frames, volL, volR);
+	}
+
+	/**
+	 * Convert noise into a buffer which already holds noise, so that the
+	 * additions also saturate, in small enough chunks to get scalar tails.
+	 */
+	template<class T>
+	static void convertNoise(T *obuf, int frames, int inRate, int outRate, bool stereo, bool reverseStereo,
+	                         Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		uint32 seed = 7;
+		for (int i = 0; i < frames * 2; i++) {
+			seed = seed * 1103515245 + 12345;
+			obuf[i] = (int16)(seed >> 16);
+		}
+
+		BufferStream *input = makeNoise(frames * 4, inRate, stereo, 3);
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, stereo, reverseStereo);
+		int done = 0;
+		while (done < frames)
+			done += flow(converter, *input, obuf + done * 2, MIN(frames - done, 37), volL, volR);
+
+		delete converter;
+		delete input;
+	}
+
+	template<class T>
+	static bool conversionMatches(int inRate, int outRate, bool stereo, bool reverseStereo, Audio::st_volume_t volL, Audio::st_volume_t volR) {
+		const int frames = 1000;
+		T expected[frames * 2];
+		T actual[frames * 2];
+
+		Common::setCPUFeatureMask(0);
+		convertNoise(expected, frames, inRate, outRate, stereo, reverseStereo, volL, volR);
+
+		bool match = true;
+		const uint32 masks[] = { Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+			Common::setCPUFeatureMask(masks[i]);
+			convertNoise(actual, frames, inRate, outRate, stereo, reverseStereo, volL, volR);
+			match = match && !memcmp(expected, actual, sizeof(expected));
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		return match;
+	}
+
+	/** Convert a stream at full volume and return the output frames. */
+	static int convert(Audio::AudioStream &input, int outRate, Audio::RateConverterQuality quality, int16 *obuf, int frames) {
+		memset(obuf, 0, frames * 2 * sizeof(int16));
+		Audio::RateConverter *converter = Audio::makeRateConverter(input.getRate(), outRate, input.isStereo(), false, quality);
+		const int done = converter->flow(input, obuf, frames, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		delete converter;
+		return done;
+	}
+
+	static int peak(const int16 *samples, int numSamples) {
+		int result = 0;
+		for (int i = 0; i < numSamples; i++)
+			result = MAX<int>(result, ABS<int>(samples[i]));
+		return result;
+	}
+
+	public:
+	void test_mixing_matches_scalar() {
+		// Copy, simple and linear converters
+		const int rates[][2] = { { 22050, 22050 }, { 44100, 22050 }, { 11025, 22050 } };
+		const Audio::st_volume_t volumes[][2] = { { 256, 256 }, { 255, 0 }, { 17, 200 }, { 0, 0 } };
+
+		for (uint r = 0; r < ARRAYSIZE(rates); r++) {
+			for (uint v = 0; v < ARRAYSIZE(volumes); v++) {
+				TS_ASSERT(conversionMatches<int16>(rates[r][0], rates[r][1], false, false, volumes[v][0], volumes[v][1]));
+				TS_ASSERT(conversionMatches<int16>(rates[r][0], rates[r][1], true, false, volumes[v][0], volumes[v][1]));
+				TS_ASSERT(conversionMatches<int16>(rates[r][0], rates[r][1], true, true, volumes[v][0], volumes[v][1]));
+
+				TS_ASSERT(conversionMatches<int32>(rates[r][0], rates[r][1], false, false, volumes[v][0], volumes[v][1]));
+				TS_ASSERT(conversionMatches<int32>(rates[r][0], rates[r][1], true, false, volumes[v][0], volumes[v][1]));
+				TS_ASSERT(conversionMatches<int32>(rates[r][0], rates[r][1], true, true, volumes[v][0], volumes[v][1]));
+			}
+		}
+	}
+
+	void test_mixing_32_bit() {
+		// The volume is multiplied in, without any rounding or clipping
+		int16 *samples = new int16[6];
+		samples[0] = 30000; samples[1] = -3;
+		samples[2] = -32768; samples[3] = 1;
+		samples[4] = 7; samples[5] = 32767;
+		BufferStream input(samples, 6, 22050, true);
+
+		int32 obuf[3 * 2] = { 1, 2, 3, 4, 5, 6 };
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 22050, true, true);
+		TS_ASSERT_EQUALS(converter->flowMix32(input, obuf, 3, 17, 256), 3);
+		delete converter;
+
+		// Reversed stereo, with the left volume going to the right output
+		TS_ASSERT_EQUALS(obuf[0], 1 - 3 * 256);
+		TS_ASSERT_EQUALS(obuf[1], 2 + 30000 * 17);
+		TS_ASSERT_EQUALS(obuf[2], 3 + 1 * 256);
+		TS_ASSERT_EQUALS(obuf[3], 4 - 32768 * 17);
+		TS_ASSERT_EQUALS(obuf[4], 5 + 32767 * 256);
+		TS_ASSERT_EQUALS(obuf[5], 6 + 7 * 17);
+	}
+
+	void test_sinc_passes_dc() {
+		const int frames = 4000;
+		int16 *samples = new int16[frames * 2];
+		for (int i = 0; i < frames * 2; i++)
+			samples[i] = (i & 1) ? -12345 : 20000;
+		BufferStream input(samples, frames * 2, 22050, true);
+
+		int16 obuf[1000 * 2];
+		TS_ASSERT_EQUALS(convert(input, 44100, Audio::kRateConverterSinc, obuf, 1000), 1000);
+
+		// Skip the start, where the filter still sees the silence before it
+		for (int i = 100; i < 1000; i++) {
+			TS_ASSERT_DELTA(obuf[i * 2], 20000, 2);
+			TS_ASSERT_DELTA(obuf[i * 2 + 1], -12345, 2);
+		}
+	}
+
+	void test_sinc_flushes_tail() {
+		const int frames = 1000;
+		int16 *samples = new int16[frames];
+		for (int i = 0; i < frames; i++)
+			samples[i] = 20000;
+		BufferStream input(samples, frames, 22050, false);
+
+		// All input frames come out, up to the very last one, which the
+		// filter sees next to the silence after the end
+		int16 obuf[4000 * 2];
+		TS_ASSERT_EQUALS(convert(input, 44100, Audio::kRateConverterSinc, obuf, 4000), 2000);
+		TS_ASSERT_DELTA(obuf[1980 * 2], 20000, 2);
+		TS_ASSERT_LESS_THAN(5000, obuf[1999 * 2]);
+		TS_ASSERT_EQUALS(obuf[2000 * 2], 0);
+	}
+
+	void test_sinc_keeps_passband() {
+		BufferStream *input = makeSine(4000, 22050, false, 1000.0, 16000.0);
+
+		int16 obuf[4000 * 2];
+		TS_ASSERT_EQUALS(convert(*input, 44100, Audio::kRateConverterSinc, obuf, 4000), 4000);
+		TS_ASSERT_DELTA(peak(obuf + 400, 4000 * 2 - 400), 16000, 300);
+		delete input;
+	}
+
+	void test_sinc_filters_aliases() {
+		// A tone above the Nyquist frequency of the output rate, which the
+		// linear converter folds back into the audible range
+		BufferStream *input = makeSine(12000, 48000, false, 10000.0, 16000.0);
+		int16 obuf[2000 * 2];
+		convert(*input, 11025, Audio::kRateConverterLinear, obuf, 2000);
+		TS_ASSERT_LESS_THAN(4000, peak(obuf + 200, 2000 * 2 - 200));
+		delete input;
+
+		input = makeSine(12000, 48000, false, 10000.0, 16000.0);
+		convert(*input, 11025, Audio::kRateConverterSinc, obuf, 2000);
+		TS_ASSERT_LESS_THAN(peak(obuf + 200, 2000 * 2 - 200), 160);
+		delete input;
+	}
+
+	void test_benchmark_mix_streams() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		// Like a busy scene: many streams at rates which do not match the
+		// output rate, mixed in the chunks an audio callback would ask for
+		const int kStreams = 32;
+		const int kOutRate = 44100;
+		const int kFrames = kOutRate;
+		const int kChunk = 1024;
+		const int rates[] = { 8000, 11025, 22050, 32000, 48000 };
+
+		static const struct {
+			const char *name;
+			uint32 cpuFeatures;
+			Audio::RateConverterQuality quality;
+			bool mix32;
+		} runs[] = {
+			{ "linear, scalar", 0, Audio::kRateConverterLinear, false },
+			{ "linear, SIMD", 0xFFFFFFFF, Audio::kRateConverterLinear, false },
+			{ "linear, scalar, 32 bit", 0, Audio::kRateConverterLinear, true },
+			{ "linear, SIMD, 32 bit", 0xFFFFFFFF, Audio::kRateConverterLinear, true },
+			{ "sinc, SIMD", 0xFFFFFFFF, Audio::kRateConverterSinc, false }
+		};
+
+		int16 *obuf = new int16[kChunk * 2];
+		int32 *obuf32 = new int32[kChunk * 2];
+		for (uint r = 0; r < ARRAYSIZE(runs); r++) {
+			Common::setCPUFeatureMask(runs[r].cpuFeatures);
+
+			BufferStream *inputs[kStreams];
+			Audio::RateConverter *converters[kStreams];
+			for (int i = 0; i < kStreams; i++) {
+				const int rate = rates[i % ARRAYSIZE(rates)];
+				const bool stereo = (i / ARRAYSIZE(rates)) & 1;
+				inputs[i] = makeNoise((int)((double)kFrames * rate / kOutRate) + 64, rate, stereo, i + 1);
+				converters[i] = Audio::makeRateConverter(rate, kOutRate, stereo, false, runs[r].quality);
+			}
+
+			BenchmarkTimer timer;
+			for (int done = 0; done < kFrames; done += kChunk) {
+				if (runs[r].mix32) {
+					memset(obuf32, 0, kChunk * 2 * sizeof(int32));
+					for (int i = 0; i < kStreams; i++)
+						converters[i]->flowMix32(*inputs[i], obuf32, kChunk, Audio::Mixer::kMaxMixerVolume / 8, Audio::Mixer::kMaxMixerVolume / 8);
+				} else {
+					memset(obuf, 0, kChunk * 2 * sizeof(int16));
+					for (int i = 0; i < kStreams; i++)
+						converters[i]->flow(*inputs[i], obuf, kChunk, Audio::Mixer::kMaxMixerVolume / 8, Audio::Mixer::kMaxMixerVolume / 8);
+				}
+			}
+			timer.report(Common::String::format("Mixing %d streams, %s", kStreams, runs[r].name).c_str(), (double)kStreams * kFrames, "frames");
+
+			for (int i = 0; i < kStreams; i++) {
+				delete converters[i];
+				delete inputs[i];
+			}
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		delete[] obuf32;
+		delete[] obuf;
+	}
+};
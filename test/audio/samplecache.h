@@ -0,0 +1,185 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/samplecache.h"
+#include "audio/audiostream.h"
+
+#include "helper.h"
+
+class DecodedSampleCacheTestSuite : public CxxTest::TestSuite
+{
+private:
+	static Audio::SeekableAudioStream *createSound(int16 **samples, bool isStereo) {
+		return createSineStream<int16>(11025, 1, samples, true, isStereo);
+	}
+
+	static bool playsSamples(Audio::AudioStream *stream, const int16 *samples, int numSamples) {
+		int16 *buffer = new int16[numSamples + 2];
+		const bool match = stream->readBuffer(buffer, numSamples + 2) == numSamples &&
+		                   !memcmp(buffer, samples, numSamples * sizeof(int16)) && stream->endOfData();
+		delete[] buffer;
+		return match;
+	}
+
+	/**
+	 * Drops its sound from the cache and queues another stream for it on
+	 * the first read, like another thread could while it is decoded.
+	 */
+	class RequeueingStream : public Audio::AudioStream {
+	public:
+		RequeueingStream(Audio::DecodedSampleCache *cache, Audio::AudioStream *parent, Audio::AudioStream *replacement)
+			: _cache(cache), _parent(parent), _replacement(replacement) {}
+		~RequeueingStream() { delete _parent; }
+
+		int readBuffer(int16 *buffer, const int numSamples) {
+			if (_replacement) {
+				_cache->remove("sound");
+				_cache->prefetch("sound", _replacement);
+				_replacement = 0;
+			}
+			return _parent->readBuffer(buffer, numSamples);
+		}
+		bool isStereo() const { return _parent->isStereo(); }
+		int getRate() const { return _parent->getRate(); }
+		bool endOfData() const { return _parent->endOfData(); }
+
+	private:
+		Audio::DecodedSampleCache *_cache;
+		Audio::AudioStream *_parent;
+		Audio::AudioStream *_replacement;
+	};
+
+public:
+	void test_decode() {
+		Audio::DecodedSampleCache cache(1024 * 1024);
+		int16 *samples;
+		cache.prefetch("sound", createSound(&samples, true));
+
+		TS_ASSERT(!cache.isCached("sound"));
+		TS_ASSERT(!cache.getStream("sound"));
+
+		// Decoding a sound can take several updates
+		TS_ASSERT(cache.update(1000));
+		TS_ASSERT(!cache.isCached("sound"));
+		while (cache.update(1000))
+			;
+		TS_ASSERT(cache.isCached("sound"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 11025 * 2 * sizeof(int16));
+
+		Audio::SeekableAudioStream *stream = cache.getStream("sound");
+		TS_ASSERT(stream);
+		TS_ASSERT(stream->isStereo());
+		TS_ASSERT_EQUALS(stream->getRate(), 11025);
+		TS_ASSERT_EQUALS(stream->getLength().msecs(), 1000);
+		TS_ASSERT(playsSamples(stream, samples, 11025 * 2));
+
+		TS_ASSERT(stream->seek(Audio::Timestamp(0, 5000, 11025)));
+		TS_ASSERT(playsSamples(stream, samples + 10000, 11025 * 2 - 10000));
+
+		delete stream;
+		delete[] samples;
+	}
+
+	void test_prefetch_twice() {
+		Audio::DecodedSampleCache cache(1024 * 1024);
+		int16 *samples;
+		cache.prefetch("sound", createSound(&samples, false));
+		delete[] samples;
+		cache.prefetch("sound", createSound(&samples, false));
+		delete[] samples;
+
+		while (cache.update())
+			;
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 11025 * sizeof(int16));
+	}
+
+	void test_evict_least_recently_used() {
+		// Room for two sounds
+		Audio::DecodedSampleCache cache(11025 * sizeof(int16) * 5 / 2);
+		int16 *samples[3];
+
+		cache.prefetch("a", createSound(&samples[0], false));
+		cache.prefetch("b", createSound(&samples[1], false));
+		while (cache.update())
+			;
+
+		Audio::AudioStream *stream = cache.getStream("a");
+		delete stream;
+
+		cache.prefetch("c", createSound(&samples[2], false));
+		while (cache.update())
+			;
+
+		TS_ASSERT(cache.isCached("a"));
+		TS_ASSERT(!cache.isCached("b"));
+		TS_ASSERT(cache.isCached("c"));
+		TS_ASSERT_LESS_THAN_EQUALS(cache.getUsedBytes(), 11025 * sizeof(int16) * 5 / 2);
+
+		for (int i = 0; i < 3; i++)
+			delete[] samples[i];
+	}
+
+	void test_too_large() {
+		Audio::DecodedSampleCache cache(1000);
+		int16 *samples;
+		cache.prefetch("sound", createSound(&samples, false));
+
+		while (cache.update())
+			;
+		TS_ASSERT(!cache.isCached("sound"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 0u);
+
+		delete[] samples;
+	}
+
+	void test_stream_outlives_cache() {
+		Audio::DecodedSampleCache *cache = new Audio::DecodedSampleCache(1024 * 1024);
+		int16 *samples;
+		cache->prefetch("sound", createSound(&samples, false));
+		while (cache->update())
+			;
+
+		Audio::AudioStream *stream = cache->getStream("sound");
+		cache->remove("sound");
+		TS_ASSERT(!cache->isCached("sound"));
+		TS_ASSERT_EQUALS(cache->getUsedBytes(), 0u);
+		delete cache;
+
+		TS_ASSERT(playsSamples(stream, samples, 11025));
+
+		delete stream;
+		delete[] samples;
+	}
+
+	void test_remove_while_decoding() {
+		Audio::DecodedSampleCache cache(1024 * 1024);
+		int16 *samples;
+		cache.prefetch("sound", createSound(&samples, false));
+		cache.update(1000);
+		cache.remove("sound");
+
+		TS_ASSERT(!cache.update());
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 0u);
+
+		delete[] samples;
+	}
+
+	void test_requeue_while_reading() {
+		Audio::DecodedSampleCache cache(1024 * 1024);
+		int16 *samples, *replacementSamples;
+		Audio::AudioStream *replacement = createSound(&replacementSamples, true);
+		cache.prefetch("sound", new RequeueingStream(&cache, createSound(&samples, false), replacement));
+
+		// The samples read from the dropped stream are thrown away
+		while (cache.update(1000))
+			;
+		TS_ASSERT(cache.isCached("sound"));
+		TS_ASSERT_EQUALS(cache.getUsedBytes(), 11025 * 2 * sizeof(int16));
+
+		Audio::AudioStream *stream = cache.getStream("sound");
+		TS_ASSERT(playsSamples(stream, replacementSamples, 11025 * 2));
+
+		delete stream;
+		delete[] samples;
+		delete[] replacementSamples;
+	}
+};
@@ -0,0 +1,39 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+
+class AtomicTestSuite : public CxxTest::TestSuite {
+public:
+	void test_load_store() {
+		Common::Atomic<int> value;
+		TS_ASSERT_EQUALS(value.load(), 0);
+
+		value.store(-5);
+		TS_ASSERT_EQUALS(value.load(), -5);
+
+		Common::Atomic<uint32> initialized(0xFFFFFFFF);
+		TS_ASSERT_EQUALS(initialized.load(), 0xFFFFFFFFu);
+	}
+
+	void test_exchange() {
+		Common::Atomic<uint32> value(1);
+		TS_ASSERT_EQUALS(value.exchange(2), 1u);
+		TS_ASSERT_EQUALS(value.exchange(3), 2u);
+		TS_ASSERT_EQUALS(value.load(), 3u);
+	}
+
+	void test_compare_exchange() {
+		int a, b;
+		Common::Atomic<int *> ptr(&a);
+
+		// Only replaced if the expected value matches
+		TS_ASSERT(!ptr.compareExchange(&b, 0));
+		TS_ASSERT_EQUALS(ptr.load(), &a);
+
+		TS_ASSERT(ptr.compareExchange(&a, &b));
+		TS_ASSERT_EQUALS(ptr.load(), &b);
+
+		TS_ASSERT(ptr.compareExchange(&b, 0));
+		TS_ASSERT(ptr.load() == 0);
+	}
+};
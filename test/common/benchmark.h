@@ -0,0 +1,56 @@
+#ifndef TEST_COMMON_BENCHMARK_H
+#define TEST_COMMON_BENCHMARK_H
+
+#include <cxxtest/TestSuite.h>
+
+#include "common/str.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Simple wall clock for the micro benchmarks in the test suite. The result
+ * is reported as a trace message, so it shows up in the runner output but
+ * never fails a test.
+ *
+ * The benchmarks take a while, so they only run when the SCUMMVM_BENCHMARK
+ * environment variable is set, as done by "make benchmark". Each benchmark
+ * starts with:
+ *
+ *	if (!BenchmarkTimer::enabled())
+ *		return;
+ */
+class BenchmarkTimer {
+public:
+	BenchmarkTimer() : _start(clock()) {}
+
+	static bool enabled() {
+		const char *env = getenv("SCUMMVM_BENCHMARK");
+		return env && *env && strcmp(env, "0") != 0;
+	}
+
+	double elapsedMs() const {
+		return (double)(clock() - _start) * 1000.0 / CLOCKS_PER_SEC;
+	}
+
+	void report(const char *name, double units, const char *unitName) const {
+		const double ms = elapsedMs();
+		double rate = ms > 0 ? units * 1000.0 / ms : 0;
+		const char *prefix = "";
+		if (rate >= 1000000.0) {
+			rate /= 1000000.0;
+			prefix = "M";
+		} else if (rate >= 1000.0) {
+			rate /= 1000.0;
+			prefix = "k";
+		}
+		Common::String msg = Common::String::format("%s: %.1f ms (%.2f %s%s/s)", name, ms, rate, prefix, unitName);
+		TS_TRACE(msg.c_str());
+	}
+
+private:
+	clock_t _start;
+};
+
+#endif
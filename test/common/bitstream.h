@@ -3,15 +3,75 @@
 #include "common/bitstream.h"
 #include "common/memstream.h"
 
+#include "test/common/benchmark.h"
+
 class BitStreamTestSuite : public CxxTest::TestSuite
 {
-	public:
-	void test_get_bit() {
+	/**
+	 * Read the data through both bit stream variants with a pseudo-random
+	 * mix of operations, and check they agree with a reference reader.
+	 */
+	template<class BS, class BSMemory>
+	void checkMixedReads(bool isLE, bool msbFirst, int valueBytes) {
+		byte data[64];
+		uint32 seed = 7;
+		for (uint i = 0; i < sizeof(data); i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+
+		Common::MemoryReadStream ms(data, sizeof(data));
+		BS bs(ms);
+		Common::BitStreamMemoryStream bms(data, sizeof(data));
+		BSMemory bsm(bms);
+
+		uint32 pos = 0;
+		bool match = true;
+		while (pos + 32 <= sizeof(data) * 8) {
+			seed = seed * 1103515245 + 12345;
+			uint8 n = 1 + ((seed >> 16) % 32);
+
+			// Assemble the expected value bit by bit
+			uint32 expected = 0;
+			for (uint8 b = 0; b < n; b++) {
+				uint32 bitPos = pos + b;
+				uint32 byteInValue = (bitPos / 8) % valueBytes;
+				uint32 valueStart = bitPos / (valueBytes * 8) * valueBytes;
+				uint32 byteIndex = valueStart + (isLE ? (valueBytes - 1 - byteInValue) : byteInValue);
+				if (!msbFirst)
+					byteIndex = valueStart + (isLE ? byteInValue : (valueBytes - 1 - byteInValue));
+				uint32 bit = msbFirst ? ((data[byteIndex] >> (7 - bitPos % 8)) & 1) : ((data[byteIndex] >> (bitPos % 8)) & 1);
+				expected = msbFirst ? ((expected << 1) | bit) : (expected | (bit << b));
+			}
+
+			match = match && (bs.peekBits(n) == expected) && (bsm.peekBits(n) == expected);
+			if (seed & 0x100) {
+				match = match && (bs.getBits(n) == expected) && (bsm.getBits(n) == expected);
+			} else {
+				bs.skip(n);
+				bsm.skip(n);
+			}
+			pos += n;
+			match = match && (bs.pos() == pos) && (bsm.pos() == pos);
+		}
+		TS_ASSERT(match);
+
+		// Aligning puts the data stream right behind the current value
+		bs.align();
+		bsm.align();
+		TS_ASSERT_EQUALS(bs.pos() % (valueBytes * 8), 0u);
+		TS_ASSERT_EQUALS(bs.pos(), bsm.pos());
+		TS_ASSERT_EQUALS((uint32)ms.pos() * 8, bs.pos());
+		TS_ASSERT_EQUALS((uint32)bms.pos() * 8, bsm.pos());
+	}
+
+	template<class MS, class BS>
+	void tmpl_get_bit() {
 		byte contents[] = { 'a' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.getBit(), 0u);
 		TS_ASSERT_EQUALS(bs.getBit(), 1u);
@@ -20,12 +80,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_get_bits() {
+	template<class MS, class BS>
+	void tmpl_get_bits() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.getBits(3), 3u);
 		TS_ASSERT_EQUALS(bs.pos(), 3u);
@@ -34,12 +95,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_skip() {
+	template<class MS, class BS>
+	void tmpl_skip() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		bs.skip(5);
 		TS_ASSERT_EQUALS(bs.pos(), 5u);
@@ -49,12 +111,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_rewind() {
+	template<class MS, class BS>
+	void tmpl_rewind() {
 		byte contents[] = { 'a' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		bs.skip(5);
 		TS_ASSERT_EQUALS(bs.pos(), 5u);
@@ -66,12 +129,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.size(), 8u);
 	}
 
-	void test_peek_bit() {
+	template<class MS, class BS>
+	void tmpl_peek_bit() {
 		byte contents[] = { 'a' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.peekBit(), 0u);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
@@ -82,12 +146,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_peek_bits() {
+	template<class MS, class BS>
+	void tmpl_peek_bits() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.peekBits(3), 3u);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
@@ -101,12 +166,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_eos() {
+	template<class MS, class BS>
+	void tmpl_eos() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8MSB bs(ms);
+		BS bs(ms);
 		bs.skip(11);
 		TS_ASSERT_EQUALS(bs.pos(), 11u);
 		TS_ASSERT_EQUALS(bs.getBits(5), 2u);
@@ -117,12 +183,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_get_bits_lsb() {
+	template<class MS, class BS>
+	void tmpl_get_bits_lsb() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8LSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.getBits(3), 1u);
 		TS_ASSERT_EQUALS(bs.pos(), 3u);
@@ -131,12 +198,13 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT(!bs.eos());
 	}
 
-	void test_peek_bits_lsb() {
+	template<class MS, class BS>
+	void tmpl_peek_bits_lsb() {
 		byte contents[] = { 'a', 'b' };
 
-		Common::MemoryReadStream ms(contents, sizeof(contents));
+		MS ms(contents, sizeof(contents));
 
-		Common::BitStream8LSB bs(ms);
+		BS bs(ms);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
 		TS_ASSERT_EQUALS(bs.peekBits(3), 1u);
 		TS_ASSERT_EQUALS(bs.pos(), 0u);
@@ -149,4 +217,95 @@ class BitStreamTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(bs.peekBits(5), 12u);
 		TS_ASSERT(!bs.eos());
 	}
+	public:
+	void test_get_bit() {
+		tmpl_get_bit<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_get_bit<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_get_bits() {
+		tmpl_get_bits<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_get_bits<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_skip() {
+		tmpl_skip<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_skip<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_rewind() {
+		tmpl_rewind<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_rewind<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_peek_bit() {
+		tmpl_peek_bit<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_peek_bit<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_peek_bits() {
+		tmpl_peek_bits<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_peek_bits<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_eos() {
+		tmpl_eos<Common::MemoryReadStream, Common::BitStream8MSB>();
+		tmpl_eos<Common::BitStreamMemoryStream, Common::BitStreamMemory8MSB>();
+	}
+
+	void test_get_bits_lsb() {
+		tmpl_get_bits_lsb<Common::MemoryReadStream, Common::BitStream8LSB>();
+		tmpl_get_bits_lsb<Common::BitStreamMemoryStream, Common::BitStreamMemory8LSB>();
+	}
+
+	void test_peek_bits_lsb() {
+		tmpl_peek_bits_lsb<Common::MemoryReadStream, Common::BitStream8LSB>();
+		tmpl_peek_bits_lsb<Common::BitStreamMemoryStream, Common::BitStreamMemory8LSB>();
+	}
+
+	void test_mixed_reads() {
+		checkMixedReads<Common::BitStream8MSB, Common::BitStreamMemory8MSB>(false, true, 1);
+		checkMixedReads<Common::BitStream8LSB, Common::BitStreamMemory8LSB>(false, false, 1);
+		checkMixedReads<Common::BitStream16LEMSB, Common::BitStreamMemory16LEMSB>(true, true, 2);
+		checkMixedReads<Common::BitStream16BELSB, Common::BitStreamMemory16BELSB>(false, false, 2);
+		checkMixedReads<Common::BitStream32LELSB, Common::BitStreamMemory32LELSB>(true, false, 4);
+		checkMixedReads<Common::BitStream32BEMSB, Common::BitStreamMemory32BEMSB>(false, true, 4);
+	}
+
+	template<class BS>
+	static uint32 benchGetBits(BS &bs, uint32 count) {
+		uint32 sum = 0;
+		for (uint32 i = 0; i < count; i++)
+			sum += bs.getBits(1 + (i & 15));
+		return sum;
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const uint32 kDataSize = 1024 * 1024;
+		byte *data = (byte *)malloc(kDataSize);
+		for (uint32 i = 0; i < kDataSize; i++)
+			data[i] = i * 7 + (i >> 8);
+
+		// Average 8.5 bits per read, staying clear of the end
+		const uint32 kReads = kDataSize * 8 / 9;
+
+		Common::MemoryReadStream ms(data, kDataSize);
+		Common::BitStream32LELSB bs(ms);
+		BenchmarkTimer timer;
+		uint32 sum = benchGetBits(bs, kReads);
+		timer.report("BitStream32LELSB getBits()", kReads, "call");
+
+		Common::BitStreamMemoryStream bms(data, kDataSize);
+		Common::BitStreamMemory32LELSB bsm(bms);
+		BenchmarkTimer memoryTimer;
+		uint32 memorySum = benchGetBits(bsm, kReads);
+		memoryTimer.report("BitStreamMemory32LELSB getBits()", kReads, "call");
+
+		TS_ASSERT_EQUALS(sum, memorySum);
+
+		free(data);
+	}
 };
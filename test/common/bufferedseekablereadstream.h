@@ -81,4 +81,28 @@ class BufferedSeekableReadStreamTestSuite : public CxxTest::TestSuite {
 
 		delete &ssrs;
 	}
+
+	void test_peek_buffer() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableReadStream &ssrs
+			= *Common::wrapBufferedSeekableReadStream(&ms, 4, DisposeAfterUse::NO);
+
+		ssrs.seek(2);
+
+		// Buffered streams fall back to handing out a copy
+		const byte *buffer = ssrs.peekBuffer(7);
+		TS_ASSERT(buffer != 0);
+		TS_ASSERT(buffer != contents + 2);
+		TS_ASSERT_EQUALS(buffer[0], 2);
+		TS_ASSERT_EQUALS(buffer[6], 8);
+		TS_ASSERT_EQUALS(ssrs.pos(), 2);
+		ssrs.releaseBuffer(buffer);
+
+		TS_ASSERT(ssrs.peekBuffer(9) == 0);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 2);
+
+		delete &ssrs;
+	}
 };
@@ -0,0 +1,240 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/flathashmap.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
+
+#include "test/common/benchmark.h"
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String> FlatStringMap;
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		FlatStringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear();
+		TS_ASSERT(container2.empty());
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		FlatStringMap container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("quux"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		container.erase(0);
+		container.erase(1);
+		container.erase(2);
+		container.erase(3);
+		TS_ASSERT(!container.empty());
+		container.erase(container.find(4));
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup_with_default() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container[2] = 45;
+
+		// We take a const ref now to ensure that the map
+		// is not modified by getVal.
+		const Common::FlatHashMap<int, int> &containerRef = container;
+
+		TS_ASSERT_EQUALS(containerRef[1], -1);
+		TS_ASSERT_EQUALS(containerRef.getVal(0), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17), 0);
+		TS_ASSERT_EQUALS(containerRef.getVal(0, -10), 17);
+		TS_ASSERT_EQUALS(containerRef.getVal(17, -10), -10);
+		TS_ASSERT_EQUALS(containerRef.size(), 3u);
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT_EQUALS(container.begin(), container.end());
+
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		container.erase(1);
+		container[1] = 42;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			int key = i->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			int key = j->_key;
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+	}
+
+	void test_copy() {
+		FlatStringMap map1, map2;
+		map1["foo"] = "bar";
+		map1["baz"] = "qux";
+		map1.erase("baz");
+		map2 = map1;
+		map1["foo"] = "changed";
+		TS_ASSERT_EQUALS(map2["foo"], "bar");
+		TS_ASSERT(!map2.contains("baz"));
+		TS_ASSERT_EQUALS(map2.size(), 1u);
+
+		FlatStringMap map3(map2);
+		TS_ASSERT_EQUALS(map3["foo"], "bar");
+	}
+
+	void test_grow_and_churn() {
+		// Exercise rehashing as well as reuse of erased slots, and compare
+		// the result against the regular HashMap.
+		Common::FlatHashMap<int, int> flat;
+		Common::HashMap<int, int> reference;
+
+		flat.reserve(100);
+		for (int i = 0; i < 5000; i++) {
+			int key = (i * 7919) % 1237;
+			if (i % 3 == 2) {
+				flat.erase(key);
+				reference.erase(key);
+			} else {
+				flat[key] = i;
+				reference[key] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<int, int>::const_iterator i = reference.begin(); i != reference.end(); ++i) {
+			TS_ASSERT(flat.contains(i->_key));
+			TS_ASSERT_EQUALS(flat[i->_key], i->_value);
+		}
+
+		uint count = 0;
+		for (Common::FlatHashMap<int, int>::const_iterator i = flat.begin(); i != flat.end(); ++i) {
+			TS_ASSERT(reference.contains(i->_key));
+			count++;
+		}
+		TS_ASSERT_EQUALS(count, reference.size());
+
+		flat.clear(true);
+		TS_ASSERT(flat.empty());
+		TS_ASSERT(!flat.contains(0));
+	}
+
+	template<class Map>
+	static uint benchIntLookups(Map &map, int keys, int rounds) {
+		for (int i = 0; i < keys; i++)
+			map[i * 37] = i;
+
+		uint hits = 0;
+		for (int r = 0; r < rounds; r++) {
+			for (int i = 0; i < keys * 2; i++)
+				hits += map.contains(i * 37 + (i & 1));
+		}
+		return hits;
+	}
+
+	template<class Map>
+	static uint benchStringLookups(Map &map, const Common::Array<Common::String> &keys, int rounds) {
+		for (uint i = 0; i < keys.size(); i++)
+			map[keys[i]] = i;
+
+		// Look the keys up in a different order than they were inserted in.
+		// HashMap allocates its nodes one after the other, so looking them up
+		// in insertion order would only walk through memory sequentially.
+		const uint mask = keys.size() - 1;
+		assert(!(keys.size() & mask));
+		uint sum = 0;
+		for (int r = 0; r < rounds; r++) {
+			for (uint i = 0; i < keys.size(); i++)
+				sum += map[keys[(i * 40503) & mask]];
+		}
+		return sum;
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const int kKeys = 65536;
+		const int kRounds = 10;
+
+		Common::HashMap<int, int> intMap;
+		BenchmarkTimer intTimer;
+		uint intHits = benchIntLookups(intMap, kKeys, kRounds);
+		intTimer.report("HashMap<int> lookups", 2.0 * kKeys * kRounds, "lookup");
+
+		Common::FlatHashMap<int, int> flatIntMap;
+		BenchmarkTimer flatIntTimer;
+		uint flatIntHits = benchIntLookups(flatIntMap, kKeys, kRounds);
+		flatIntTimer.report("FlatHashMap<int> lookups", 2.0 * kKeys * kRounds, "lookup");
+
+		TS_ASSERT_EQUALS(intHits, flatIntHits);
+
+		Common::Array<Common::String> keys;
+		for (int i = 0; i < kKeys; i++)
+			keys.push_back(Common::String::format("selector_%d", i * 13));
+
+		Common::HashMap<Common::String, uint> strMap;
+		BenchmarkTimer strTimer;
+		uint strSum = benchStringLookups(strMap, keys, kRounds / 5);
+		strTimer.report("HashMap<String> lookups", (double)kKeys * kRounds / 5, "lookup");
+
+		Common::FlatHashMap<Common::String, uint> flatStrMap;
+		BenchmarkTimer flatStrTimer;
+		uint flatStrSum = benchStringLookups(flatStrMap, keys, kRounds / 5);
+		flatStrTimer.report("FlatHashMap<String> lookups", (double)kKeys * kRounds / 5, "lookup");
+
+		TS_ASSERT_EQUALS(strSum, flatStrSum);
+	}
+};
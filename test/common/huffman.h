@@ -3,6 +3,8 @@
 #include "common/bitstream.h"
 #include "common/memstream.h"
 
+#include "test/common/benchmark.h"
+
 /**
 * A test suite for the Huffman decoder in common/huffman.h
 * The encoding used comes from the example on the Wikipedia page
@@ -141,4 +143,199 @@ class HuffmanTestSuite : public CxxTest::TestSuite {
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[5]);
 		TS_ASSERT_EQUALS(h.getSymbol(bs), expected[6]);
 	}
+
+	/**
+	 * Build a canonical code with the lengths 1, 2, ..., maxLength, maxLength.
+	 * The codes are returned in the convention of the given bit order, as
+	 * they would be assembled by BitStream::addBit().
+	 */
+	static uint32 makeChainCode(uint8 maxLength, bool msbFirst, uint32 *codes, uint8 *lengths) {
+		uint32 count = maxLength + 1;
+		for (uint32 i = 0; i < count; i++) {
+			lengths[i] = MIN<uint8>(i + 1, maxLength);
+
+			// All ones followed by a zero, and all ones for the last code
+			uint32 code = (i == count - 1) ? ((1 << maxLength) - 1) : (((1 << lengths[i]) - 1) & ~1);
+			if (!msbFirst) {
+				uint32 reversed = 0;
+				for (uint8 b = 0; b < lengths[i]; b++)
+					reversed |= ((code >> b) & 1) << (lengths[i] - 1 - b);
+				code = reversed;
+			}
+			codes[i] = code;
+		}
+		return count;
+	}
+
+	/** Write the code into the buffer, in the order it is read back. */
+	static void putCode(byte *buffer, uint32 &bitPos, uint32 code, uint8 length, bool msbFirst) {
+		for (uint8 b = 0; b < length; b++, bitPos++) {
+			// The first bit is the MSB of the code in MSB2LSB order, the LSB otherwise
+			uint32 bit = msbFirst ? ((code >> (length - 1 - b)) & 1) : ((code >> b) & 1);
+			if (bit)
+				buffer[bitPos >> 3] |= msbFirst ? (0x80 >> (bitPos & 7)) : (1 << (bitPos & 7));
+		}
+	}
+
+	void checkRoundTrip(uint8 maxLength, bool msbFirst) {
+		uint32 codes[32];
+		uint8 lengths[32];
+		uint32 symbols[32];
+		uint32 count = makeChainCode(maxLength, msbFirst, codes, lengths);
+		for (uint32 i = 0; i < count; i++)
+			symbols[i] = 1000 + i;
+
+		Common::Huffman h(0, count, codes, lengths, symbols);
+
+		const uint32 kSymbols = 500;
+		byte buffer[kSymbols * 32 / 8 + 4];
+		memset(buffer, 0, sizeof(buffer));
+
+		uint32 expected[kSymbols];
+		uint32 bitPos = 0;
+		uint32 seed = 42;
+		for (uint32 i = 0; i < kSymbols; i++) {
+			seed = seed * 1103515245 + 12345;
+			uint32 index = (seed >> 16) % count;
+			expected[i] = symbols[index];
+			putCode(buffer, bitPos, codes[index], lengths[index], msbFirst);
+		}
+
+		Common::MemoryReadStream ms(buffer, (bitPos + 7) / 8);
+		Common::BitStream *bs;
+		if (msbFirst)
+			bs = new Common::BitStream8MSB(ms);
+		else
+			bs = new Common::BitStream8LSB(ms);
+
+		bool match = true;
+		for (uint32 i = 0; i < kSymbols; i++)
+			match = match && (h.getSymbol(*bs) == expected[i]);
+
+		TS_ASSERT(match);
+		TS_ASSERT_EQUALS(bs->pos(), bitPos);
+
+		delete bs;
+	}
+
+	void test_long_codes() {
+		// Codes which fit into the primary and secondary tables
+		checkRoundTrip(16, true);
+		checkRoundTrip(16, false);
+
+		// Codes too long for the secondary tables
+		checkRoundTrip(24, true);
+		checkRoundTrip(24, false);
+	}
+
+	/**
+	 * Build a canonical MSB2LSB code with the given number of codes per
+	 * length, starting at length 1.
+	 */
+	static uint32 makeCanonicalCode(const uint32 *lengthCounts, uint8 maxLength, uint32 *codes, uint8 *lengths) {
+		uint32 count = 0;
+		uint32 code = 0;
+		for (uint8 length = 1; length <= maxLength; length++) {
+			for (uint32 i = 0; i < lengthCounts[length - 1]; i++) {
+				codes[count] = code++;
+				lengths[count] = length;
+				count++;
+			}
+			code <<= 1;
+		}
+		return count;
+	}
+
+	/** Decode a symbol bit by bit, like the decoder did before it used tables. */
+	static uint32 getSymbolReference(Common::BitStream &bits, const Common::Array<Common::Array<uint32> > &codesByLength) {
+		uint32 code = 0;
+		uint32 index = 0;
+		for (uint32 length = 0; length < codesByLength.size(); length++) {
+			bits.addBit(code, length);
+			for (uint32 i = 0; i < codesByLength[length].size(); i++)
+				if (codesByLength[length][i] == code)
+					return index + i;
+			index += codesByLength[length].size();
+		}
+		return 0;
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		// Something shaped like the SVQ1 mean codebooks: 976 codes of up to
+		// 13 bits, which form a complete code.
+		const uint32 lengthCounts[] = { 0, 0, 0, 0, 16, 0, 0, 64, 0, 128, 0, 256, 512 };
+		const uint8 maxLength = ARRAYSIZE(lengthCounts);
+		uint32 *codes = new uint32[1024];
+		uint8 *lengths = new uint8[1024];
+		uint32 count = makeCanonicalCode(lengthCounts, maxLength, codes, lengths);
+		Common::Huffman h(0, count, codes, lengths);
+
+		Common::Array<Common::Array<uint32> > codesByLength;
+		codesByLength.resize(maxLength);
+		for (uint32 i = 0; i < count; i++)
+			codesByLength[lengths[i] - 1].push_back(codes[i]);
+
+		// The code is complete, so any data decodes
+		const uint32 kDataSize = 1024 * 1024;
+		byte *data = (byte *)malloc(kDataSize);
+		uint32 seed = 1;
+		for (uint32 i = 0; i < kDataSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+
+		// Stay clear of the end, where the decoder has to slow down
+		const uint32 kSymbols = 500000;
+
+		Common::MemoryReadStream refStream(data, kDataSize);
+		Common::BitStream32BEMSB refBits(refStream);
+		uint32 refSum = 0;
+		BenchmarkTimer refTimer;
+		for (uint32 i = 0; i < kSymbols; i++)
+			refSum += getSymbolReference(refBits, codesByLength);
+		refTimer.report("Huffman bit by bit decoding", kSymbols, "symbol");
+
+		Common::MemoryReadStream tableStream(data, kDataSize);
+		Common::BitStream32BEMSB tableBits(tableStream);
+		uint32 tableSum = 0;
+		BenchmarkTimer tableTimer;
+		for (uint32 i = 0; i < kSymbols; i++)
+			tableSum += h.getSymbol(tableBits);
+		tableTimer.report("Huffman table decoding", kSymbols, "symbol");
+
+		TS_ASSERT_EQUALS(refSum, tableSum);
+		TS_ASSERT_EQUALS(refBits.pos(), tableBits.pos());
+
+		// The bit stream operations the decoders are built on
+		Common::MemoryReadStream bitStream(data, kDataSize);
+		Common::BitStream32BEMSB bits(bitStream);
+		uint32 bitSum = 0;
+		BenchmarkTimer bitTimer;
+		for (uint32 i = 0; i < kSymbols; i++) {
+			uint32 value = 0;
+			for (uint32 j = 0; j < 7; j++)
+				value = (value << 1) | bits.getBit();
+			bitSum += value;
+		}
+		bitTimer.report("BitStream 7 x getBit()", kSymbols, "call");
+
+		Common::MemoryReadStream peekStream(data, kDataSize);
+		Common::BitStream32BEMSB peekBits(peekStream);
+		uint32 peekSum = 0;
+		BenchmarkTimer peekTimer;
+		for (uint32 i = 0; i < kSymbols; i++) {
+			peekSum += peekBits.peekBits(7);
+			peekBits.skip(7);
+		}
+		peekTimer.report("BitStream peekBits(7) + skip(7)", kSymbols, "call");
+
+		TS_ASSERT_EQUALS(bitSum, peekSum);
+
+		free(data);
+		delete[] codes;
+		delete[] lengths;
+	}
 };
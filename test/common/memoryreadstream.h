@@ -104,4 +104,20 @@ class MemoryReadStreamTestSuite : public CxxTest::TestSuite {
 		ms.seek(0, SEEK_SET);
 		TS_ASSERT(!ms.eos());
 	}
+
+	void test_peek_buffer() {
+		byte contents[] = { 1, 2, 3, 4, 5, 6, 7 };
+		Common::MemoryReadStream ms(contents, sizeof(contents));
+
+		ms.seek(2);
+		const byte *buffer = ms.peekBuffer(4);
+		// The buffer should point right into the stream memory
+		TS_ASSERT_EQUALS(buffer, contents + 2);
+		TS_ASSERT_EQUALS(ms.pos(), 2);
+		ms.releaseBuffer(buffer);
+
+		TS_ASSERT(ms.peekBuffer(5) != 0);
+		TS_ASSERT(ms.peekBuffer(6) == 0);
+		TS_ASSERT_EQUALS(ms.readByte(), 3);
+	}
 };
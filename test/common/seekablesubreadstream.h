@@ -70,4 +70,21 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_peek_buffer() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+
+		Common::SeekableSubReadStream ssrs(&ms, 1, 9);
+		ssrs.seek(3);
+
+		const byte *buffer = ssrs.peekBuffer(5);
+		TS_ASSERT_EQUALS(buffer, contents + 4);
+		TS_ASSERT_EQUALS(ssrs.pos(), 3);
+		ssrs.releaseBuffer(buffer);
+
+		// The substream must not hand out bytes past its end
+		TS_ASSERT(ssrs.peekBuffer(6) == 0);
+		TS_ASSERT_EQUALS(ssrs.readByte(), 4);
+	}
 };
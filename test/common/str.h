@@ -419,4 +419,63 @@ class StringTestSuite : public CxxTest::TestSuite
 		TS_ASSERT_EQUALS(scumm_strnicmp("abCd", "ABCde", 4), 0);
 		TS_ASSERT_LESS_THAN(scumm_strnicmp("abCd", "ABCde", 5), 0);
 	}
+	void test_heap_allocation_count() {
+		const uint32 start = Common::String::getHeapAllocationCount();
+
+		// Short strings live in the internal storage ...
+		Common::String shortStr("short");
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start);
+
+		// ... longer ones need a heap buffer, which copies share.
+		Common::String longStr("This string is definitely too long for the internal storage");
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start + 1);
+		Common::String copy(longStr);
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start + 1);
+
+		// Modifying a shared string unshares it.
+		copy += "!";
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start + 2);
+		TS_ASSERT_DIFFERS(copy, longStr);
+	}
+
+	void test_move() {
+#if __cplusplus >= 201103L
+		Common::String longStr("This string is definitely too long for the internal storage");
+		const char *storage = longStr.c_str();
+
+		const uint32 start = Common::String::getHeapAllocationCount();
+		Common::String moved(static_cast<Common::String &&>(longStr));
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start);
+		TS_ASSERT_EQUALS(moved.c_str(), storage);
+		TS_ASSERT(longStr.empty());
+
+		Common::String shortStr("short");
+		shortStr = static_cast<Common::String &&>(moved);
+		TS_ASSERT_EQUALS(shortStr.c_str(), storage);
+		TS_ASSERT(moved.empty());
+
+		moved = static_cast<Common::String &&>(Common::String("tiny"));
+		TS_ASSERT_EQUALS(moved, "tiny");
+#else
+		// Without move support, strings in external storage are passed on
+		// by sharing the buffer, which does not allocate either.
+		Common::String longStr("This string is definitely too long for the internal storage");
+		const char *storage = longStr.c_str();
+
+		const uint32 start = Common::String::getHeapAllocationCount();
+		Common::String copy(longStr);
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start);
+		TS_ASSERT_EQUALS(copy.c_str(), storage);
+
+		Common::String shortStr("short");
+		shortStr = copy;
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start);
+		TS_ASSERT_EQUALS(shortStr.c_str(), storage);
+
+		shortStr = "tiny";
+		TS_ASSERT_EQUALS(shortStr, "tiny");
+		TS_ASSERT_EQUALS(copy.c_str(), storage);
+		TS_ASSERT_EQUALS(Common::String::getHeapAllocationCount(), start);
+#endif
+	}
 };
@@ -0,0 +1,172 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/zlib.h"
+
+#include "test/common/benchmark.h"
+
+class ZlibTestSuite : public CxxTest::TestSuite {
+	enum {
+		kDataSize = 3 * 1024 * 1024 + 123
+	};
+
+	static byte *makeData(uint32 size) {
+		// Something which compresses, but not too well
+		byte *data = (byte *)malloc(size);
+		uint32 seed = 12345;
+		for (uint32 i = 0; i < size; ++i) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = (seed >> 16) & 0x3F;
+		}
+		return data;
+	}
+
+	/**
+	 * Compress the given data in gzip format. The returned buffer has to be
+	 * freed by the caller.
+	 */
+	static byte *compress(const byte *data, uint32 size, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *memStream = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzStream = Common::wrapCompressedWriteStream(memStream);
+		gzStream->write(data, size);
+		gzStream->finalize();
+
+		byte *compressed = memStream->getData();
+		compressedSize = memStream->size();
+
+		// This also deletes memStream, but leaves the data alone
+		delete gzStream;
+		return compressed;
+	}
+
+	public:
+	void test_deflate_stream_seek() {
+#ifdef USE_ZLIB
+		byte *data = makeData(kDataSize);
+		uint32 compressedSize;
+		byte *compressed = compress(data, kDataSize, compressedSize);
+
+		// Strip the 10 byte gzip header and the 8 byte trailer to get at
+		// the raw deflate data.
+		Common::SeekableReadStream *stream = Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(compressed + 10, compressedSize - 18), kDataSize);
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), (int32)kDataSize);
+
+		// Read everything once, which also records the checkpoints
+		byte buffer[4096];
+		bool match = true;
+		uint32 pos = 0;
+		while (pos < kDataSize) {
+			uint32 got = stream->read(buffer, sizeof(buffer));
+			if (!got)
+				break;
+			for (uint32 i = 0; i < got; ++i)
+				match = match && (buffer[i] == data[pos + i]);
+			pos += got;
+		}
+		TS_ASSERT(match);
+		TS_ASSERT_EQUALS(pos, (uint32)kDataSize);
+		TS_ASSERT_EQUALS(stream->read(buffer, 1), 0u);
+		TS_ASSERT(stream->eos());
+
+		const int32 offsets[] = { 2500000, 100, 1572871, 3000000, 0, 2000000, 1048570 };
+		for (uint i = 0; i < ARRAYSIZE(offsets); ++i) {
+			TS_ASSERT(stream->seek(offsets[i], SEEK_SET));
+			TS_ASSERT(!stream->eos());
+			TS_ASSERT_EQUALS(stream->pos(), offsets[i]);
+			TS_ASSERT_EQUALS(stream->read(buffer, 64), 64u);
+			for (uint32 j = 0; j < 64; ++j)
+				TS_ASSERT_EQUALS(buffer[j], data[offsets[i] + j]);
+		}
+
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, 64), 10u);
+		TS_ASSERT_EQUALS(buffer[9], data[kDataSize - 1]);
+
+		delete stream;
+		free(compressed);
+		free(data);
+#endif
+	}
+
+	void test_deflate_stream_known_size() {
+#ifdef USE_ZLIB
+		byte *data = makeData(kDataSize);
+		uint32 compressedSize;
+		byte *compressed = compress(data, kDataSize, compressedSize);
+		byte buffer[4096];
+
+		// A member which declares less data than it holds stops there
+		Common::SeekableReadStream *stream = Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(compressed + 10, compressedSize - 18), 1000);
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 1000u);
+		TS_ASSERT(stream->eos());
+		TS_ASSERT(stream->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(stream->read(buffer, sizeof(buffer)), 10u);
+		TS_ASSERT_EQUALS(buffer[9], data[999]);
+		delete stream;
+
+		// Seeking past the data of a truncated member fails
+		stream = Common::wrapDeflateReadStream(
+			new Common::MemoryReadStream(compressed + 10, (compressedSize - 18) / 2), kDataSize);
+		TS_ASSERT(!stream->seek(-10, SEEK_END));
+		TS_ASSERT_LESS_THAN(stream->pos(), (int32)kDataSize - 10);
+		TS_ASSERT(stream->seek(100, SEEK_SET));
+		TS_ASSERT_EQUALS(stream->read(buffer, 64), 64u);
+		TS_ASSERT_EQUALS(buffer[0], data[100]);
+		delete stream;
+
+		free(compressed);
+		free(data);
+#endif
+	}
+
+	static uint32 benchSeeks(Common::SeekableReadStream *stream, const byte *data, int seeks) {
+		// Jump back and forth through the data, like a reader which parses
+		// an index and then fetches the entries it refers to.
+		uint32 seed = 1;
+		uint32 mismatches = 0;
+		byte buffer[256];
+		for (int i = 0; i < seeks; ++i) {
+			seed = seed * 1103515245 + 12345;
+			uint32 pos = (seed >> 8) % (kDataSize - sizeof(buffer));
+			stream->seek(pos, SEEK_SET);
+			stream->read(buffer, sizeof(buffer));
+			mismatches += memcmp(buffer, data + pos, sizeof(buffer)) != 0;
+		}
+		return mismatches;
+	}
+
+	void test_gzip_checkpoint_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+#ifdef USE_ZLIB
+		const int kSeeks = 40;
+
+		byte *data = makeData(kDataSize);
+		uint32 compressedSize;
+		byte *compressed = compress(data, kDataSize, compressedSize);
+
+		Common::SeekableReadStream *plain = Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize));
+		BenchmarkTimer plainTimer;
+		TS_ASSERT_EQUALS(benchSeeks(plain, data, kSeeks), 0u);
+		plainTimer.report("GZipReadStream random seeks", kSeeks, "seek");
+		delete plain;
+
+		Common::SeekableReadStream *indexed = Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(compressed, compressedSize), 0, 64 * 1024);
+		// Build the checkpoint index in a first forward pass
+		TS_ASSERT(indexed->seek(0, SEEK_END));
+		BenchmarkTimer indexedTimer;
+		TS_ASSERT_EQUALS(benchSeeks(indexed, data, kSeeks), 0u);
+		indexedTimer.report("GZipReadStream random seeks, 64 KB checkpoints", kSeeks, "seek");
+		delete indexed;
+
+		free(compressed);
+		free(data);
+#endif
+	}
+};
@@ -0,0 +1,277 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/endian.h"
+#include "common/str.h"
+#include "graphics/conversion.h"
+#include "graphics/pixelformat.h"
+#include "graphics/surface.h"
+
+#include "test/common/benchmark.h"
+
+class ConversionTestSuite : public CxxTest::TestSuite
+{
+	struct NamedFormat {
+		const char *name;
+		Graphics::PixelFormat format;
+	};
+
+	static Common::Array<NamedFormat> getFormats() {
+		static const struct {
+			const char *name;
+			byte bpp, rBits, gBits, bBits, aBits, rShift, gShift, bShift, aShift;
+		} formats[] = {
+			{ "ARGB8888", 4, 8, 8, 8, 8, 16, 8, 0, 24 },
+			{ "RGBA8888", 4, 8, 8, 8, 8, 24, 16, 8, 0 },
+			{ "ABGR8888", 4, 8, 8, 8, 8, 0, 8, 16, 24 },
+			{ "BGRA8888", 4, 8, 8, 8, 8, 8, 16, 24, 0 },
+			{ "XRGB8888", 4, 8, 8, 8, 0, 16, 8, 0, 0 },
+			{ "RGB24", 3, 8, 8, 8, 0, 16, 8, 0, 0 },
+			{ "BGR24", 3, 8, 8, 8, 0, 0, 8, 16, 0 },
+			{ "RGB565", 2, 5, 6, 5, 0, 11, 5, 0, 0 },
+			{ "BGR565", 2, 5, 6, 5, 0, 0, 5, 11, 0 },
+			{ "RGB555", 2, 5, 5, 5, 0, 10, 5, 0, 0 },
+			{ "ARGB4444", 2, 4, 4, 4, 4, 8, 4, 0, 12 }
+		};
+
+		Common::Array<NamedFormat> result;
+		for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+			NamedFormat named;
+			named.name = formats[i].name;
+			named.format = Graphics::PixelFormat(formats[i].bpp, formats[i].rBits, formats[i].gBits, formats[i].bBits, formats[i].aBits,
+			                                     formats[i].rShift, formats[i].gShift, formats[i].bShift, formats[i].aShift);
+			result.push_back(named);
+		}
+		return result;
+	}
+
+	static void fillRandom(byte *data, uint size, uint32 seed) {
+		for (uint i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+	}
+
+	static uint32 readPixel(const byte *ptr, uint bpp) {
+		if (bpp == 2)
+			return READ_UINT16(ptr);
+		else if (bpp == 3)
+			return READ_UINT24(ptr);
+		return READ_UINT32(ptr);
+	}
+
+	/** Convert pixel by pixel through colorToARGB and ARGBToColor. */
+	static void referenceBlit(byte *dst, const byte *src, uint dstPitch, uint srcPitch, uint w, uint h,
+	                          const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		for (uint y = 0; y < h; y++) {
+			for (uint x = 0; x < w; x++) {
+				byte a, r, g, b;
+				srcFmt.colorToARGB(readPixel(src + y * srcPitch + x * srcFmt.bytesPerPixel, srcFmt.bytesPerPixel), a, r, g, b);
+				const uint32 color = dstFmt.ARGBToColor(a, r, g, b);
+				if (dstFmt.bytesPerPixel == 2)
+					WRITE_UINT16(dst + y * dstPitch + x * 2, color);
+				else
+					WRITE_UINT32(dst + y * dstPitch + x * 4, color);
+			}
+		}
+	}
+
+	static bool blitMatches(const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		// An odd width, so all converters also have a scalar tail, and
+		// padding at the end of the rows
+		const uint w = 37, h = 5;
+		const uint srcPitch = w * srcFmt.bytesPerPixel + 6;
+		const uint dstPitch = w * dstFmt.bytesPerPixel + 8;
+
+		byte *src = new byte[srcPitch * h];
+		byte *expected = new byte[dstPitch * h];
+		byte *actual = new byte[dstPitch * h];
+		fillRandom(src, srcPitch * h, 1);
+		memset(expected, 0xAB, dstPitch * h);
+		referenceBlit(expected, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+
+		bool match = true;
+		const uint32 masks[] = { 0, 0xFFFFFFFF };
+		for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+			Common::setCPUFeatureMask(masks[i]);
+			memset(actual, 0xAB, dstPitch * h);
+			match = match && Graphics::crossBlit(actual, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+			match = match && !memcmp(expected, actual, dstPitch * h);
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		delete[] src;
+		delete[] expected;
+		delete[] actual;
+		return match;
+	}
+
+	public:
+	void test_cross_blit_matches_reference() {
+		const Common::Array<NamedFormat> formats = getFormats();
+
+		for (uint d = 0; d < formats.size(); d++) {
+			if (formats[d].format.bytesPerPixel == 3)
+				continue;
+
+			for (uint s = 0; s < formats.size(); s++) {
+				if (s == d)
+					continue;
+
+				const bool match = blitMatches(formats[d].format, formats[s].format);
+				TSM_ASSERT(Common::String::format("%s to %s", formats[s].name, formats[d].name).c_str(), match);
+			}
+		}
+	}
+
+	void test_convert_in_place() {
+		const Common::Array<NamedFormat> formats = getFormats();
+
+		for (uint d = 0; d < formats.size(); d++) {
+			if (formats[d].format.bytesPerPixel == 3)
+				continue;
+
+			for (uint s = 0; s < formats.size(); s++) {
+				if (s == d)
+					continue;
+
+				Graphics::Surface surface;
+				surface.create(150, 3, formats[s].format);
+				fillRandom((byte *)surface.getPixels(), surface.pitch * surface.h, s * 16 + d);
+
+				Graphics::Surface *copy = surface.convertTo(formats[d].format);
+				surface.convertToInPlace(formats[d].format);
+
+				bool match = surface.pitch == copy->pitch;
+				for (int y = 0; match && y < surface.h; y++)
+					match = !memcmp(surface.getBasePtr(0, y), copy->getBasePtr(0, y), surface.w * formats[d].format.bytesPerPixel);
+				TSM_ASSERT(Common::String::format("%s to %s", formats[s].name, formats[d].name).c_str(), match);
+
+				copy->free();
+				delete copy;
+				surface.free();
+			}
+		}
+	}
+
+	void test_convert_clut8() {
+		byte palette[256 * 3];
+		fillRandom(palette, sizeof(palette), 2);
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+			Graphics::Surface surface;
+			surface.create(33, 7, Graphics::PixelFormat::createFormatCLUT8());
+			fillRandom((byte *)surface.getPixels(), surface.pitch * surface.h, 3);
+
+			Graphics::Surface *converted = surface.convertTo(formats[i], palette);
+			bool match = true;
+			for (int y = 0; y < surface.h; y++) {
+				for (int x = 0; x < surface.w; x++) {
+					const byte index = *(const byte *)surface.getBasePtr(x, y);
+					const uint32 expected = formats[i].RGBToColor(palette[index * 3], palette[index * 3 + 1], palette[index * 3 + 2]);
+					match = match && readPixel((const byte *)converted->getBasePtr(x, y), formats[i].bytesPerPixel) == expected;
+				}
+			}
+			TS_ASSERT(match);
+
+			// Converting in place has to give the same result
+			surface.convertToInPlace(formats[i], palette);
+			for (int y = 0; y < surface.h; y++)
+				TS_ASSERT(!memcmp(surface.getBasePtr(0, y), converted->getBasePtr(0, y), surface.w * formats[i].bytesPerPixel));
+
+			converted->free();
+			delete converted;
+			surface.free();
+		}
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const uint w = 640, h = 480;
+		const int kRounds = 10;
+
+		const Graphics::PixelFormat clut8 = Graphics::PixelFormat::createFormatCLUT8();
+		const Graphics::PixelFormat rgb565(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		const Graphics::PixelFormat argb8888(4, 8, 8, 8, 8, 16, 8, 0, 24);
+		const Graphics::PixelFormat bgra8888(4, 8, 8, 8, 8, 8, 16, 24, 0);
+		const Graphics::PixelFormat rgba8888(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		const Graphics::PixelFormat rgb24(3, 8, 8, 8, 0, 16, 8, 0, 0);
+
+		static const struct {
+			const char *name;
+			const Graphics::PixelFormat *src, *dst;
+		} pairs[] = {
+			{ "CLUT8 to RGB565", &clut8, &rgb565 },
+			{ "CLUT8 to ARGB8888", &clut8, &argb8888 },
+			{ "RGB565 to ARGB8888", &rgb565, &argb8888 },
+			{ "ARGB8888 to RGB565", &argb8888, &rgb565 },
+			{ "RGBA8888 to BGRA8888", &rgba8888, &bgra8888 },
+			{ "BGRA8888 to RGBA8888", &bgra8888, &rgba8888 },
+			{ "RGB24 to ARGB8888", &rgb24, &argb8888 }
+		};
+
+		byte palette[256 * 3];
+		fillRandom(palette, sizeof(palette), 4);
+		byte *src = new byte[w * h * 4];
+		byte *dst = new byte[w * h * 4];
+		fillRandom(src, w * h * 4, 5);
+
+		for (uint i = 0; i < ARRAYSIZE(pairs); i++) {
+			const Graphics::PixelFormat &srcFmt = *pairs[i].src;
+			const Graphics::PixelFormat &dstFmt = *pairs[i].dst;
+			const uint srcPitch = w * srcFmt.bytesPerPixel;
+			const uint dstPitch = w * dstFmt.bytesPerPixel;
+
+			if (srcFmt.bytesPerPixel == 1) {
+				BenchmarkTimer referenceTimer;
+				for (int r = 0; r < kRounds; r++) {
+					for (uint p = 0; p < w * h; p++) {
+						const byte *c = palette + src[p] * 3;
+						const uint32 color = dstFmt.RGBToColor(c[0], c[1], c[2]);
+						if (dstFmt.bytesPerPixel == 2)
+							WRITE_UINT16(dst + p * 2, color);
+						else
+							WRITE_UINT32(dst + p * 4, color);
+					}
+				}
+				referenceTimer.report(Common::String::format("%s, per pixel", pairs[i].name).c_str(), (double)w * h * kRounds, "pixel");
+
+				BenchmarkTimer mapTimer;
+				for (int r = 0; r < kRounds; r++) {
+					uint32 map[256];
+					for (uint c = 0; c < 256; c++)
+						map[c] = dstFmt.RGBToColor(palette[c * 3], palette[c * 3 + 1], palette[c * 3 + 2]);
+					Graphics::crossBlitMap(dst, src, dstPitch, srcPitch, w, h, dstFmt.bytesPerPixel, map);
+				}
+				mapTimer.report(Common::String::format("%s, crossBlitMap", pairs[i].name).c_str(), (double)w * h * kRounds, "pixel");
+				continue;
+			}
+
+			BenchmarkTimer referenceTimer;
+			for (int r = 0; r < kRounds; r++)
+				referenceBlit(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+			referenceTimer.report(Common::String::format("%s, per pixel", pairs[i].name).c_str(), (double)w * h * kRounds, "pixel");
+
+			// Not every instruction set has a converter for every pair, so
+			// the second run may well use the scalar converter again
+			for (int simd = 0; simd < 2; simd++) {
+				Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+				BenchmarkTimer timer;
+				for (int r = 0; r < kRounds; r++)
+					Graphics::crossBlit(dst, src, dstPitch, srcPitch, w, h, dstFmt, srcFmt);
+				timer.report(Common::String::format("%s, crossBlit %s", pairs[i].name, simd ? "with CPU features" : "scalar").c_str(), (double)w * h * kRounds, "pixel");
+			}
+			Common::setCPUFeatureMask(0xFFFFFFFF);
+		}
+
+		delete[] src;
+		delete[] dst;
+	}
+};
@@ -0,0 +1,137 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/dirty_rects.h"
+
+class DirtyRectListTestSuite : public CxxTest::TestSuite
+{
+	static bool covers(const Graphics::DirtyRectList &list, const Common::Rect &r) {
+		for (int y = r.top; y < r.bottom; y++) {
+			for (int x = r.left; x < r.right; x++) {
+				bool found = false;
+				for (Graphics::DirtyRectList::const_iterator i = list.begin(); i != list.end(); ++i)
+					found = found || i->contains(x, y);
+				if (!found)
+					return false;
+			}
+		}
+		return true;
+	}
+
+	public:
+	void test_merge_overlapping() {
+		Graphics::DirtyRectList list;
+
+		list.add(Common::Rect(0, 0, 10, 10));
+		list.add(Common::Rect(0, 5, 10, 15));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+		TS_ASSERT_EQUALS(*list.begin(), Common::Rect(0, 0, 10, 15));
+
+		// Contained rects do not add anything
+		list.add(Common::Rect(2, 2, 4, 4));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+		TS_ASSERT_EQUALS(*list.begin(), Common::Rect(0, 0, 10, 15));
+
+		// Neither do empty ones
+		list.add(Common::Rect(40, 40, 40, 50));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+
+		// Overlapping diagonally, the bounding rect has 25 pixels more than
+		// both rects together
+		list.add(Common::Rect(5, 10, 15, 20));
+		TS_ASSERT_EQUALS(list.size(), 2u);
+	}
+
+	void test_merge_intersecting() {
+		Graphics::DirtyRectList list(0, 0, true);
+
+		// Overlapping diagonally costs overdraw, but is merged anyway
+		list.add(Common::Rect(0, 0, 10, 10));
+		list.add(Common::Rect(5, 5, 15, 15));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+		TS_ASSERT_EQUALS(*list.begin(), Common::Rect(0, 0, 15, 15));
+
+		// Rects which only touch are still kept apart
+		list.add(Common::Rect(15, 20, 25, 30));
+		TS_ASSERT_EQUALS(list.size(), 2u);
+
+		// One rect can bring two others together
+		list.add(Common::Rect(10, 10, 20, 25));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+		TS_ASSERT_EQUALS(*list.begin(), Common::Rect(0, 0, 25, 30));
+	}
+
+	void test_keep_distant() {
+		Graphics::DirtyRectList list;
+
+		list.add(Common::Rect(0, 0, 10, 10));
+		list.add(Common::Rect(100, 100, 110, 110));
+		TS_ASSERT_EQUALS(list.size(), 2u);
+
+		// A rect covering both replaces them
+		list.add(Common::Rect(0, 0, 110, 110));
+		TS_ASSERT_EQUALS(list.size(), 1u);
+		TS_ASSERT_EQUALS(*list.begin(), Common::Rect(0, 0, 110, 110));
+	}
+
+	void test_overdraw_threshold() {
+		// Two 10x10 rects, 2 pixels apart, cost 20 pixels of overdraw
+		Graphics::DirtyRectList strict(19);
+		strict.add(Common::Rect(0, 0, 10, 10));
+		strict.add(Common::Rect(12, 0, 22, 10));
+		TS_ASSERT_EQUALS(strict.size(), 2u);
+
+		Graphics::DirtyRectList relaxed(20);
+		relaxed.add(Common::Rect(0, 0, 10, 10));
+		relaxed.add(Common::Rect(12, 0, 22, 10));
+		TS_ASSERT_EQUALS(relaxed.size(), 1u);
+		TS_ASSERT_EQUALS(*relaxed.begin(), Common::Rect(0, 0, 22, 10));
+	}
+
+	void test_max_rects() {
+		Graphics::DirtyRectList list(0, 4);
+
+		Common::Rect added[50];
+		uint32 seed = 1;
+		for (int i = 0; i < ARRAYSIZE(added); i++) {
+			seed = seed * 1103515245 + 12345;
+			const int x = (seed >> 8) % 300, y = (seed >> 20) % 200;
+			added[i] = Common::Rect(x, y, x + 1 + (seed & 7), y + 1 + ((seed >> 3) & 7));
+			list.add(added[i]);
+			TS_ASSERT_LESS_THAN_EQUALS(list.size(), 4u);
+		}
+
+		// Merging must not lose anything
+		for (int i = 0; i < ARRAYSIZE(added); i++)
+			TS_ASSERT(covers(list, added[i]));
+	}
+
+	void test_stats() {
+		Graphics::DirtyRectList list;
+
+		list.add(Common::Rect(0, 0, 10, 10));
+		list.add(Common::Rect(0, 0, 10, 10));
+		list.add(Common::Rect(20, 0, 30, 5));
+		TS_ASSERT_EQUALS(list.getArea(), 150u);
+		list.nextFrame();
+		TS_ASSERT(list.empty());
+
+		// Frames without anything to redraw do not count
+		list.nextFrame();
+
+		// Neither do discarded rects
+		list.add(Common::Rect(0, 0, 100, 100));
+		list.clear();
+
+		list.add(Common::Rect(0, 0, 4, 4));
+		list.nextFrame();
+
+		const Graphics::DirtyRectList::Stats &stats = list.getStats();
+		TS_ASSERT_EQUALS(stats.frames, 2u);
+		TS_ASSERT_EQUALS(stats.rects, 3u);
+		TS_ASSERT_EQUALS(stats.addedPixels, 266u);
+		TS_ASSERT_EQUALS(stats.redrawnPixels, 166u);
+
+		list.resetStats();
+		TS_ASSERT_EQUALS(list.getStats().frames, 0u);
+	}
+};
@@ -0,0 +1,143 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/str.h"
+#include "graphics/scaler.h"
+
+#include "test/common/benchmark.h"
+
+class HQScalerTestSuite : public CxxTest::TestSuite
+{
+	struct Picture {
+		int width, height, pitch;
+		uint16 *pixels;
+
+		/**
+		 * A picture with flat areas, edges and single pixels, including
+		 * colors which are only slightly different. It has a border of one
+		 * pixel, which the scalers read as well.
+		 */
+		Picture(int w, int h, uint32 seed) : width(w), height(h), pitch(w + 2) {
+			pixels = new uint16[pitch * (h + 2)];
+
+			uint16 palette[8];
+			for (int i = 0; i < 8; i += 2) {
+				seed = seed * 1103515245 + 12345;
+				palette[i] = seed >> 16;
+				palette[i + 1] = palette[i] ^ (1 << (i * 2));
+			}
+
+			uint16 color = palette[0];
+			for (int i = 0; i < pitch * (h + 2); i++) {
+				seed = seed * 1103515245 + 12345;
+				const uint32 r = seed >> 8;
+				if ((r & 3) == 0)
+					color = palette[(r >> 4) & 7];
+				else if ((r & 4) && i >= pitch)
+					color = pixels[i - pitch];
+				pixels[i] = color;
+			}
+		}
+
+		~Picture() {
+			delete[] pixels;
+		}
+
+		const uint8 *getBasePtr() const {
+			return (const uint8 *)(pixels + pitch + 1);
+		}
+	};
+
+	static uint32 checksum(const uint16 *pixels, int pitch, int w, int h) {
+		uint32 hash = 2166136261u;
+		for (int y = 0; y < h; y++) {
+			for (int x = 0; x < w; x++) {
+				hash = (hash ^ pixels[y * pitch + x]) * 16777619u;
+			}
+		}
+		return hash;
+	}
+
+	static uint32 scale(ScalerProc *proc, int factor, const Picture &picture) {
+		const int w = picture.width * factor, h = picture.height * factor;
+		// Padding at the end of the rows, which must stay untouched
+		const int pitch = w + 3;
+		uint16 *dst = new uint16[pitch * h];
+		memset(dst, 0, pitch * h * sizeof(uint16));
+
+		proc(picture.getBasePtr(), picture.pitch * sizeof(uint16), (uint8 *)dst, pitch * sizeof(uint16), picture.width, picture.height);
+
+		uint32 hash = checksum(dst, pitch, w, h);
+		for (int y = 0; y < h; y++) {
+			for (int x = w; x < pitch; x++) {
+				if (dst[y * pitch + x])
+					hash = 0;
+			}
+		}
+
+		delete[] dst;
+		return hash;
+	}
+
+	public:
+	void test_output_unchanged() {
+		// Checksums of what the HQ scalers gave before they were vectorized
+		static const struct {
+			int factor;
+			int bitFormat;
+			int width, height;
+			uint32 checksum;
+		} cases[] = {
+			{ 2, 565, 64, 48, 0xFA34EE1A },
+			{ 2, 565, 61, 7, 0x105A8A9F },
+			{ 2, 555, 64, 48, 0x873BC1DB },
+			{ 3, 565, 64, 48, 0x31A93477 },
+			{ 3, 565, 61, 7, 0xDE48BB93 },
+			{ 3, 555, 64, 48, 0x61513F04 }
+		};
+
+		const uint32 masks[] = { 0, Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		for (uint i = 0; i < ARRAYSIZE(cases); i++) {
+			InitScalers(cases[i].bitFormat);
+			const Picture picture(cases[i].width, cases[i].height, i + 1);
+
+			for (uint j = 0; j < ARRAYSIZE(masks); j++) {
+				Common::setCPUFeatureMask(masks[j]);
+				const uint32 hash = scale(cases[i].factor == 2 ? HQ2x : HQ3x, cases[i].factor, picture);
+				TSM_ASSERT_EQUALS(Common::String::format("HQ%dx, %d, %dx%d, features %x", cases[i].factor, cases[i].bitFormat,
+				                                         cases[i].width, cases[i].height, masks[j]).c_str(), hash, cases[i].checksum);
+			}
+			Common::setCPUFeatureMask(0xFFFFFFFF);
+		}
+
+		DestroyScalers();
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const int kFrames = 10;
+		InitScalers(565);
+		const Picture picture(320, 200, 7);
+
+		for (int factor = 2; factor <= 3; factor++) {
+			const int pitch = picture.width * factor;
+			uint16 *dst = new uint16[pitch * picture.height * factor];
+
+			for (int simd = 0; simd < 2; simd++) {
+				Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+				BenchmarkTimer timer;
+				for (int f = 0; f < kFrames; f++)
+					(factor == 2 ? HQ2x : HQ3x)(picture.getBasePtr(), picture.pitch * sizeof(uint16), (uint8 *)dst, pitch * sizeof(uint16), picture.width, picture.height);
+				timer.report(Common::String::format("HQ%dx, %s", factor, simd ? "SIMD" : "scalar").c_str(),
+				             (double)picture.width * picture.height * kFrames, "pixel");
+			}
+			Common::setCPUFeatureMask(0xFFFFFFFF);
+
+			delete[] dst;
+		}
+
+		DestroyScalers();
+	}
+};
@@ -0,0 +1,194 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/transform_cache.h"
+#include "graphics/transparent_surface.h"
+
+#include "test/common/benchmark.h"
+
+class TransformCacheTestSuite : public CxxTest::TestSuite
+{
+	static void fill(Graphics::Surface &surface, uint32 seed) {
+		uint32 *pixels = (uint32 *)surface.getPixels();
+		for (int i = 0; i < surface.w * surface.h; i++) {
+			seed = seed * 1103515245 + 12345;
+			pixels[i] = seed;
+		}
+	}
+
+	public:
+	void test_hit_and_miss() {
+		Graphics::Surface src;
+		src.create(32, 24, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fill(src, 1);
+
+		Graphics::TransformCache cache;
+		const Common::Rect rect(4, 2, 20, 18);
+		const Graphics::TransformStruct plain;
+		const Graphics::TransformStruct rotated(100, 100, 45, 8, 8);
+		const Graphics::TransformStruct otherHotspot(100, 100, 45, 0, 0);
+
+		Common::SharedPtr<Graphics::Surface> scaled = cache.get(src, rect, plain, 32, 8);
+		TS_ASSERT_EQUALS(scaled->w, 32);
+		TS_ASSERT_EQUALS(scaled->h, 8);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 1u);
+
+		// The same request is answered from the cache
+		TS_ASSERT_EQUALS(cache.get(src, rect, plain, 32, 8).get(), scaled.get());
+		TS_ASSERT_EQUALS(cache.getStats().hits, 1u);
+
+		// Anything else is a different entry
+		TS_ASSERT_DIFFERS(cache.get(src, rect, plain, 32, 9).get(), scaled.get());
+		TS_ASSERT_DIFFERS(cache.get(src, Common::Rect(4, 2, 20, 17), plain, 32, 8).get(), scaled.get());
+		TS_ASSERT_DIFFERS(cache.get(src, rect, plain, 32, 8, true).get(), scaled.get());
+		Common::SharedPtr<Graphics::Surface> rotation = cache.get(src, rect, rotated, 0, 0);
+		TS_ASSERT_DIFFERS(cache.get(src, rect, otherHotspot, 0, 0).get(), rotation.get());
+		TS_ASSERT_EQUALS(cache.get(src, rect, rotated, 0, 0).get(), rotation.get());
+		TS_ASSERT_EQUALS(cache.getStats().hits, 2u);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 6u);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 6u);
+
+		// The cached surfaces are the same as transforming directly
+		Graphics::TransparentSurface section(src.getSubArea(rect), false);
+		Graphics::TransparentSurface *direct = section.rotoscale(rotated);
+		TS_ASSERT_EQUALS(direct->w, rotation->w);
+		TS_ASSERT_EQUALS(direct->h, rotation->h);
+		bool match = true;
+		for (int y = 0; y < direct->h; y++)
+			match = match && !memcmp(direct->getBasePtr(0, y), rotation->getBasePtr(0, y), direct->w * 4);
+		TS_ASSERT(match);
+		direct->free();
+		delete direct;
+
+		src.free();
+	}
+
+	void test_invalidate() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+		Graphics::Surface a, b;
+		a.create(16, 16, format);
+		b.create(16, 16, format);
+		fill(a, 2);
+		fill(b, 3);
+
+		Graphics::TransformCache cache;
+		const Graphics::TransformStruct plain;
+		const Common::Rect rect(16, 16);
+		Common::SharedPtr<Graphics::Surface> scaledA = cache.get(a, rect, plain, 8, 8);
+		cache.get(a, rect, plain, 4, 4);
+		cache.get(b, rect, plain, 8, 8);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 3u);
+		TS_ASSERT_EQUALS(cache.getSize(), 8u * 8 * 4 * 2 + 4 * 4 * 4);
+
+		cache.invalidate(a);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 1u);
+		TS_ASSERT_EQUALS(cache.getSize(), 8u * 8 * 4);
+
+		// Surfaces handed out before stay valid
+		TS_ASSERT_EQUALS(scaledA->w, 8);
+		TS_ASSERT(scaledA->getPixels());
+
+		TS_ASSERT_DIFFERS(cache.get(a, rect, plain, 8, 8).get(), scaledA.get());
+		TS_ASSERT_EQUALS(cache.getStats().misses, 4u);
+
+		cache.clear();
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 0u);
+		TS_ASSERT_EQUALS(cache.getSize(), 0u);
+
+		a.free();
+		b.free();
+	}
+
+	void test_reused_pixels() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+		Graphics::Surface a;
+		a.create(16, 16, format);
+		fill(a, 4);
+
+		Graphics::TransformCache cache;
+		const Graphics::TransformStruct plain;
+		const Common::Rect rect(8, 8);
+		Common::SharedPtr<Graphics::Surface> scaledA = cache.get(a, rect, plain, 8, 8);
+
+		// Like a surface allocated at the same address after the first one
+		// was freed, without calling invalidate()
+		Graphics::Surface b;
+		b.init(8, 32, 32, a.getPixels(), format);
+		TS_ASSERT_DIFFERS(cache.get(b, rect, plain, 8, 8).get(), scaledA.get());
+
+		Graphics::Surface c;
+		c.init(16, 16, 64, a.getPixels(), Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24));
+		TS_ASSERT_DIFFERS(cache.get(c, rect, plain, 8, 8).get(), scaledA.get());
+
+		TS_ASSERT_EQUALS(cache.get(a, rect, plain, 8, 8).get(), scaledA.get());
+		TS_ASSERT_EQUALS(cache.getStats().misses, 3u);
+
+		a.free();
+	}
+
+	void test_eviction() {
+		Graphics::Surface src;
+		src.create(16, 16, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fill(src, 4);
+
+		// Room for four 8x8 surfaces
+		Graphics::TransformCache cache(4 * 8 * 8 * 4, 16);
+		const Graphics::TransformStruct plain;
+		for (int i = 0; i < 4; i++)
+			cache.get(src, Common::Rect(i, 0, 16, 16), plain, 8, 8);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 4u);
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 0u);
+
+		// Use the oldest entry again, so the second one is dropped next
+		cache.get(src, Common::Rect(0, 0, 16, 16), plain, 8, 8);
+		cache.get(src, Common::Rect(4, 0, 16, 16), plain, 8, 8);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 4u);
+		TS_ASSERT_EQUALS(cache.getStats().evictions, 1u);
+
+		cache.resetStats();
+		cache.get(src, Common::Rect(0, 0, 16, 16), plain, 8, 8);
+		cache.get(src, Common::Rect(2, 0, 16, 16), plain, 8, 8);
+		TS_ASSERT_EQUALS(cache.getStats().hits, 2u);
+		cache.get(src, Common::Rect(1, 0, 16, 16), plain, 8, 8);
+		TS_ASSERT_EQUALS(cache.getStats().misses, 1u);
+
+		// The entry limit applies as well
+		cache.setLimits(1024 * 1024, 2);
+		TS_ASSERT_EQUALS(cache.getEntryCount(), 2u);
+		TS_ASSERT_EQUALS(cache.getSize(), 2u * 8 * 8 * 4);
+
+		src.free();
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const int kFrames = 50;
+
+		Graphics::Surface src;
+		src.create(128, 128, Graphics::TransparentSurface::getSupportedPixelFormat());
+		fill(src, 5);
+
+		// A scene with a few sprites, drawn with the same transform every frame
+		const Common::Rect rect(128, 128);
+		const Graphics::TransformStruct transform(120, 120, 30, 64, 64);
+
+		BenchmarkTimer uncachedTimer;
+		for (int frame = 0; frame < kFrames; frame++) {
+			Graphics::TransparentSurface section(src.getSubArea(rect), false);
+			Graphics::TransparentSurface *rotated = section.rotoscale(transform);
+			rotated->free();
+			delete rotated;
+		}
+		uncachedTimer.report("TransparentSurface::rotoscale", kFrames, "frame");
+
+		Graphics::TransformCache cache;
+		BenchmarkTimer cachedTimer;
+		for (int frame = 0; frame < kFrames; frame++)
+			cache.get(src, rect, transform, 0, 0);
+		cachedTimer.report("TransformCache::get, rotated", kFrames, "frame");
+		TS_ASSERT_EQUALS(cache.getStats().hits, (uint32)kFrames - 1);
+
+		src.free();
+	}
+};
@@ -0,0 +1,373 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/rect.h"
+#include "common/str.h"
+#include "graphics/transparent_surface.h"
+
+#include "test/common/benchmark.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite
+{
+	static void fillRandom(Graphics::Surface &surface, uint32 seed) {
+		byte *pixels = (byte *)surface.getPixels();
+		for (int i = 0; i < surface.pitch * surface.h; i++) {
+			seed = seed * 1103515245 + 12345;
+			pixels[i] = seed >> 16;
+		}
+
+		// Make sure the special alpha values are covered
+		const uint32 alpha = surface.format.ARGBToColor(255, 0, 0, 0);
+		for (int y = 0; y < surface.h; y++) {
+			*(uint32 *)surface.getBasePtr(y % surface.w, y) &= ~alpha;
+			*(uint32 *)surface.getBasePtr((y * 7) % surface.w, y) |= alpha;
+		}
+	}
+
+	static bool blitMatches(Graphics::TransparentSurface &src, const Graphics::Surface &dst, int flipping, uint color, Graphics::TSpriteBlendMode blendMode) {
+		// Use a clip rect and an offset, so the rows do not start aligned
+		Common::Rect part(1, 2, src.w - 1, src.h);
+
+		Graphics::Surface scalar;
+		scalar.copyFrom(dst);
+		Common::setCPUFeatureMask(0);
+		src.blit(scalar, 3, 1, flipping, &part, color, -1, -1, blendMode);
+
+		// Check all kernels available, from the oldest instruction set up
+		const uint32 masks[] = { Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		bool match = true;
+		for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+			Graphics::Surface simd;
+			simd.copyFrom(dst);
+			Common::setCPUFeatureMask(masks[i]);
+			src.blit(simd, 3, 1, flipping, &part, color, -1, -1, blendMode);
+
+			for (int y = 0; y < dst.h; y++)
+				match = match && !memcmp(scalar.getBasePtr(0, y), simd.getBasePtr(0, y), dst.w * 4);
+			simd.free();
+		}
+
+		scalar.free();
+		return match;
+	}
+
+	static bool surfacesEqual(const Graphics::Surface &a, const Graphics::Surface &b) {
+		if (a.w != b.w || a.h != b.h)
+			return false;
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * 4))
+				return false;
+		}
+		return true;
+	}
+
+	public:
+	void test_subtractive_color_reference() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(1, 1, format);
+		*(uint32 *)src.getPixels() = format.ARGBToColor(255, 255, 255, 255);
+
+		Graphics::Surface dst;
+		dst.create(1, 1, format);
+		*(uint32 *)dst.getPixels() = format.ARGBToColor(255, 200, 100, 50);
+
+		// out - (in * c * out * a >> 24), which must not overflow. The color
+		// is given as 0xAARRGGBB.
+		src.blit(dst, 0, 0, Graphics::FLIP_NONE, nullptr, 0xFF80FEFF, -1, -1, Graphics::BLEND_SUBTRACTIVE);
+
+		byte a, r, g, b;
+		format.colorToARGB(*(const uint32 *)dst.getPixels(), a, r, g, b);
+		TS_ASSERT_EQUALS(a, 255);
+		TS_ASSERT_EQUALS(r, 200 - (255 * 128 * 200 * 255 >> 24));
+		TS_ASSERT_EQUALS(g, 100 - (int)((255u * 254 * 100 * 255) >> 24));
+		TS_ASSERT_EQUALS(b, 50 - (255 * 50 * 255 >> 16));
+
+		src.free();
+		dst.free();
+	}
+
+	void test_blend_kernels_match() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(37, 13, format);
+		fillRandom(src, 1);
+
+		Graphics::Surface dst;
+		dst.create(45, 17, format);
+		fillRandom(dst, 2);
+
+		// Colors are 0xAARRGGBB, including channels with and without modulation
+		const uint colors[] = { 0xFFFFFFFF, 0x80FFFFFF, 0xFF40FFC8, 0xC8FF0011, 0x018081FF };
+		const Graphics::TSpriteBlendMode modes[] = {
+			Graphics::BLEND_NORMAL, Graphics::BLEND_ADDITIVE, Graphics::BLEND_SUBTRACTIVE
+		};
+
+		for (uint mode = 0; mode < ARRAYSIZE(modes); mode++) {
+			for (int flipping = 0; flipping <= Graphics::FLIP_HV; flipping++) {
+				for (uint color = 0; color < ARRAYSIZE(colors); color++)
+					TS_ASSERT(blitMatches(src, dst, flipping, colors[color], modes[mode]));
+			}
+		}
+
+		src.free();
+		dst.free();
+	}
+
+	void test_scale_nearest() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(23, 11, format);
+		fillRandom(src, 5);
+
+		const int sizes[][2] = { { 23, 11 }, { 61, 29 }, { 7, 5 }, { 1, 1 }, { 46, 3 } };
+		for (uint i = 0; i < ARRAYSIZE(sizes); i++) {
+			const int w = sizes[i][0], h = sizes[i][1];
+			Graphics::TransparentSurface *scaled = src.scale(w, h);
+			bool match = true;
+			for (int y = 0; y < h; y++) {
+				for (int x = 0; x < w; x++)
+					match = match && *(const uint32 *)scaled->getBasePtr(x, y) == *(const uint32 *)src.getBasePtr(x * src.w / w, y * src.h / h);
+			}
+			TS_ASSERT(match);
+			scaled->free();
+			delete scaled;
+		}
+
+		src.free();
+	}
+
+	void test_scale_filtering() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		// A uniform surface has to stay uniform
+		Graphics::TransparentSurface src;
+		src.create(9, 7, format);
+		src.fillRect(Common::Rect(9, 7), format.ARGBToColor(200, 10, 120, 250));
+
+		Graphics::TransparentSurface *scaled = src.scale(31, 4, true);
+		bool uniform = true;
+		for (int y = 0; y < scaled->h; y++) {
+			for (int x = 0; x < scaled->w; x++)
+				uniform = uniform && *(const uint32 *)scaled->getBasePtr(x, y) == *(const uint32 *)src.getPixels();
+		}
+		TS_ASSERT(uniform);
+		scaled->free();
+		delete scaled;
+
+		// A gradient is interpolated instead of repeated
+		src.fillRect(Common::Rect(0, 0, 1, 7), format.ARGBToColor(255, 0, 0, 0));
+		src.fillRect(Common::Rect(1, 0, 9, 7), format.ARGBToColor(255, 255, 255, 255));
+		scaled = src.scale(36, 7, true);
+		byte a, r, g, b;
+		format.colorToARGB(*(const uint32 *)scaled->getBasePtr(2, 3), a, r, g, b);
+		TS_ASSERT_EQUALS(a, 255);
+		TS_ASSERT(r > 0 && r < 255);
+		scaled->free();
+		delete scaled;
+
+		src.free();
+	}
+
+	void test_scaled_blit_matches() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(21, 15, format);
+		fillRandom(src, 6);
+
+		Graphics::Surface dst;
+		dst.create(40, 30, format);
+		fillRandom(dst, 7);
+
+		// The streaming scaled blit has to match scaling first and blitting
+		// the result, also when clipped against the target
+		Common::Rect part(2, 1, 19, 14);
+		const int positions[][2] = { { 3, 2 }, { -7, 5 }, { 20, -4 }, { 25, 20 } };
+		const int sizes[][2] = { { 34, 26 }, { 9, 6 }, { 17, 40 } };
+
+		for (uint pos = 0; pos < ARRAYSIZE(positions); pos++) {
+			for (uint size = 0; size < ARRAYSIZE(sizes); size++) {
+				for (int flipping = 0; flipping <= Graphics::FLIP_HV; flipping++) {
+					const int x = positions[pos][0], y = positions[pos][1];
+					const int w = sizes[size][0], h = sizes[size][1];
+
+					Graphics::Surface streamed;
+					streamed.copyFrom(dst);
+					Common::Rect streamedRect = src.blit(streamed, x, y, flipping, &part, 0xC0FF80FF, w, h);
+
+					Graphics::TransparentSurface section(src.getSubArea(part), false);
+					Graphics::TransparentSurface *scaled = section.scale(w, h);
+					Graphics::Surface reference;
+					reference.copyFrom(dst);
+					Common::Rect referenceRect = scaled->blit(reference, x, y, flipping, nullptr, 0xC0FF80FF);
+
+					TS_ASSERT(surfacesEqual(streamed, reference));
+					TS_ASSERT_EQUALS(streamedRect, referenceRect);
+
+					scaled->free();
+					delete scaled;
+					streamed.free();
+					reference.free();
+				}
+			}
+		}
+
+		src.free();
+		dst.free();
+	}
+
+	void test_rotoscale_blit_matches() {
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+
+		Graphics::TransparentSurface src;
+		src.create(25, 18, format);
+		fillRandom(src, 8);
+
+		Graphics::Surface dst;
+		dst.create(64, 48, format);
+		fillRandom(dst, 9);
+
+		const Graphics::TransformStruct transforms[] = {
+			Graphics::TransformStruct(100, 100, 30, 0, 0, Graphics::BLEND_NORMAL, 0xFFFFFFFF),
+			Graphics::TransformStruct(150, 80, 200, 12, 9, Graphics::BLEND_ADDITIVE, 0xC0FFFFFF, true, false),
+			Graphics::TransformStruct(60, 130, 315, 3, 17, Graphics::BLEND_NORMAL, 0xFF80FF40, false, true),
+			Graphics::TransformStruct(120, 120, 90, 5, 5, Graphics::BLEND_SUBTRACTIVE, 0xFFFFFFFF, true, true)
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(transforms); i++) {
+			for (int filtering = 0; filtering < 2; filtering++) {
+				Graphics::TransparentSurface *rotated = src.rotoscale(transforms[i], filtering);
+				rotated->setAlphaMode(src.getAlphaMode());
+
+				for (int usePart = 0; usePart < 2; usePart++) {
+					Common::Rect part(3, 2, rotated->w - 4, rotated->h - 1);
+					Common::Rect *partRect = usePart ? &part : nullptr;
+
+					Graphics::Surface streamed;
+					streamed.copyFrom(dst);
+					Common::Rect streamedRect = src.rotoscaleBlit(streamed, -4, 6, transforms[i], partRect, filtering);
+
+					Graphics::Surface reference;
+					reference.copyFrom(dst);
+					Common::Rect referenceRect = rotated->blit(reference, -4, 6, transforms[i]._flip, partRect,
+					                                           transforms[i]._rgbaMod, -1, -1, transforms[i]._blendMode);
+
+					TS_ASSERT(surfacesEqual(streamed, reference));
+					TS_ASSERT_EQUALS(streamedRect, referenceRect);
+
+					streamed.free();
+					reference.free();
+				}
+
+				rotated->free();
+				delete rotated;
+			}
+		}
+
+		src.free();
+		dst.free();
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+		const int kBlits = 20;
+
+		Graphics::TransparentSurface sprite;
+		sprite.create(256, 256, format);
+		fillRandom(sprite, 3);
+
+		Graphics::Surface screen;
+		screen.create(800, 600, format);
+		fillRandom(screen, 4);
+
+		static const char *const modeNames[] = { "normal", "additive", "subtractive" };
+		const Graphics::TSpriteBlendMode modes[] = {
+			Graphics::BLEND_NORMAL, Graphics::BLEND_ADDITIVE, Graphics::BLEND_SUBTRACTIVE
+		};
+
+		for (int simd = 0; simd < 2; simd++) {
+			Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+
+			for (uint mode = 0; mode < ARRAYSIZE(modes); mode++) {
+				for (int colorMod = 0; colorMod < 2; colorMod++) {
+					const uint color = colorMod ? 0xC0FF8040 : 0xFFFFFFFF;
+
+					// Cycle through all flipping modes
+					BenchmarkTimer timer;
+					for (int i = 0; i < kBlits; i++)
+						sprite.blit(screen, (i * 97) % 500, (i * 53) % 300, i % 4, nullptr, color, -1, -1, modes[mode]);
+					timer.report(Common::String::format("TransparentSurface::blit %s, %s%s", simd ? "SIMD" : "scalar",
+					             modeNames[mode], colorMod ? ", color" : "").c_str(), 256.0 * 256 * kBlits, "pixel");
+				}
+			}
+		}
+
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+		sprite.free();
+		screen.free();
+	}
+
+	void test_transform_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const Graphics::PixelFormat format = Graphics::TransparentSurface::getSupportedPixelFormat();
+		const int kBlits = 20;
+
+		Graphics::TransparentSurface sprite;
+		sprite.create(200, 150, format);
+		fillRandom(sprite, 10);
+
+		Graphics::Surface screen;
+		screen.create(800, 600, format);
+		fillRandom(screen, 11);
+
+		const Graphics::TransformStruct transform(140, 140, 25, 100, 75, Graphics::BLEND_NORMAL, 0xFFFFFFFF);
+
+		// Creating the transformed surface first, as engines did so far
+		BenchmarkTimer scaleTimer;
+		for (int i = 0; i < kBlits; i++) {
+			Graphics::TransparentSurface *scaled = sprite.scale(300, 225);
+			scaled->blit(screen, (i * 97) % 500, (i * 53) % 300);
+			scaled->free();
+			delete scaled;
+		}
+		scaleTimer.report("TransparentSurface::scale + blit", 300.0 * 225 * kBlits, "pixel");
+
+		BenchmarkTimer scaledBlitTimer;
+		for (int i = 0; i < kBlits; i++)
+			sprite.blit(screen, (i * 97) % 500, (i * 53) % 300, Graphics::FLIP_NONE, nullptr, 0xFFFFFFFF, 300, 225);
+		scaledBlitTimer.report("TransparentSurface::blit, scaled", 300.0 * 225 * kBlits, "pixel");
+
+		int area = 0;
+		BenchmarkTimer rotoscaleTimer;
+		for (int i = 0; i < kBlits; i++) {
+			Graphics::TransparentSurface *rotated = sprite.rotoscale(transform);
+			rotated->blit(screen, (i * 97) % 400, (i * 53) % 200);
+			area = rotated->w * rotated->h;
+			rotated->free();
+			delete rotated;
+		}
+		rotoscaleTimer.report("TransparentSurface::rotoscale + blit", (double)area * kBlits, "pixel");
+
+		BenchmarkTimer rotoscaleBlitTimer;
+		for (int i = 0; i < kBlits; i++)
+			sprite.rotoscaleBlit(screen, (i * 97) % 400, (i * 53) % 200, transform);
+		rotoscaleBlitTimer.report("TransparentSurface::rotoscaleBlit", (double)area * kBlits, "pixel");
+
+		BenchmarkTimer filteringTimer;
+		for (int i = 0; i < kBlits; i++)
+			sprite.rotoscaleBlit(screen, (i * 97) % 400, (i * 53) % 200, transform, nullptr, true);
+		filteringTimer.report("TransparentSurface::rotoscaleBlit, bilinear", (double)area * kBlits, "pixel");
+
+		sprite.free();
+		screen.free();
+	}
+};
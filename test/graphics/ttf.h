@@ -0,0 +1,246 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/str.h"
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/surface.h"
+
+class TTFFontTestSuite : public CxxTest::TestSuite
+{
+#ifdef USE_FREETYPE2
+	/** Load one of the fonts of the built-in themes, or return 0 if that fails. */
+	static Graphics::Font *loadFont(const char *name, int size, Graphics::TTFRenderMode renderMode) {
+		const Common::String path = Common::String::format("%s/gui/themes/fonts/%s", TEST_SRCDIR, name);
+		FILE *file = fopen(path.c_str(), "rb");
+		if (!file)
+			return 0;
+
+		fseek(file, 0, SEEK_END);
+		const long fileSize = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		byte *data = (byte *)malloc(fileSize);
+		const bool read = fread(data, fileSize, 1, file) == 1;
+		fclose(file);
+		if (!read) {
+			free(data);
+			return 0;
+		}
+
+		Common::MemoryReadStream stream(data, fileSize, DisposeAfterUse::YES);
+		return Graphics::loadTTFFont(stream, size, Graphics::kTTFSizeModeCharacter, 0, renderMode);
+	}
+
+	static uint32 checksum(const Graphics::Surface &surface, uint32 hash) {
+		const byte *pixels = (const byte *)surface.getPixels();
+		for (int i = 0; i < surface.pitch * surface.h; i++)
+			hash = (hash ^ pixels[i]) * 16777619u;
+		return hash;
+	}
+
+	/**
+	 * Draw some lines of text onto a patterned background, including kerned
+	 * pairs, text which is cut off on either side and text which does not
+	 * fit into its area.
+	 */
+	static void drawText(const Graphics::Font *font, Graphics::Surface &surface) {
+		const Graphics::PixelFormat &format = surface.format;
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				const uint32 color = format.bytesPerPixel == 1 ? (x + y) & 0xFF : format.RGBToColor(x * 3, y * 5, 90);
+				if (format.bytesPerPixel == 1)
+					*(uint8 *)surface.getBasePtr(x, y) = color;
+				else if (format.bytesPerPixel == 2)
+					*(uint16 *)surface.getBasePtr(x, y) = color;
+				else
+					*(uint32 *)surface.getBasePtr(x, y) = color;
+			}
+		}
+
+		const uint32 color = format.bytesPerPixel == 1 ? 15 : format.RGBToColor(255, 200, 40);
+		const int lineHeight = font->getFontHeight() + 2;
+		int y = -lineHeight / 2;
+
+		font->drawString(&surface, "The quick brown fox jumps over the lazy dog", 2, y += lineHeight, surface.w - 4, color);
+		font->drawString(&surface, "AVAWAY To Ty Wa LT \"fi\" 0123456789", -7, y += lineHeight, surface.w + 7, color);
+		font->drawString(&surface, "Centered, with an ellipsis because it is far too long", 10, y += lineHeight, 120, color, Graphics::kTextAlignCenter);
+		font->drawString(&surface, "Right aligned past the edge", surface.w - 100, y += lineHeight, 140, color, Graphics::kTextAlignRight);
+		font->drawString(&surface, "Caf\xE9 na\xEFve \xDF\xFC\xF1 (Latin-1)", 3, y += lineHeight, surface.w, color);
+
+		Common::U32String wide;
+		const uint32 chars[] = { 0x41, 0x3A9, 0x416, 0x2014, 0x20AC, 0x42 };
+		for (uint i = 0; i < ARRAYSIZE(chars); i++)
+			wide += chars[i];
+		font->drawString(&surface, wide, 3, y += lineHeight, surface.w, color);
+
+		for (uint32 chr = 'a'; chr <= 'z'; chr++)
+			font->drawChar(&surface, chr, (chr - 'a') * lineHeight / 2, y + lineHeight, color);
+	}
+#endif
+
+public:
+	void test_output_unchanged() {
+#ifdef USE_FREETYPE2
+		static const char *const fonts[] = { "FreeSans.ttf", "FreeSansBold.ttf", "FreeMonoBold.ttf" };
+		static const int sizes[] = { 8, 12, 20 };
+		static const Graphics::TTFRenderMode renderModes[] = {
+			Graphics::kTTFRenderModeNormal, Graphics::kTTFRenderModeLight, Graphics::kTTFRenderModeMonochrome
+		};
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat::createFormatCLUT8(),
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		// Checksums of what the fonts drew before the glyphs were packed into
+		// an atlas, for all of the pixel formats
+		static const uint32 checksums[ARRAYSIZE(fonts)][ARRAYSIZE(sizes)][ARRAYSIZE(renderModes)] = {
+			{
+				{ 0x07A1F742, 0xE01C233B, 0x2BBA4284 },
+				{ 0x1AA195BA, 0x7D4281A5, 0xFDC4539C },
+				{ 0x6AD98879, 0xEFA90C2D, 0x63485C7E }
+			},
+			{
+				{ 0xF21138EF, 0x49DB78B7, 0x01CEB384 },
+				{ 0x19E46A12, 0x65A29A03, 0xE58743A1 },
+				{ 0x0786A8C7, 0x6BAC781C, 0x546B3648 }
+			},
+			{
+				{ 0x6F41D549, 0x1DC4710E, 0x364F9641 },
+				{ 0xC4252BD8, 0x1F987C97, 0x7D2C5C03 },
+				{ 0x1B10B666, 0xBE840AE9, 0xD6C4CCCA }
+			}
+		};
+
+		for (uint f = 0; f < ARRAYSIZE(fonts); f++) {
+			for (uint s = 0; s < ARRAYSIZE(sizes); s++) {
+				for (uint m = 0; m < ARRAYSIZE(renderModes); m++) {
+					Graphics::Font *font = loadFont(fonts[f], sizes[s], renderModes[m]);
+					TSM_ASSERT(Common::String::format("Could not load %s", fonts[f]).c_str(), font);
+					if (!font)
+						return;
+
+					uint32 hash = 2166136261u;
+					for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+						Graphics::Surface surface;
+						surface.create(200, 150, formats[i]);
+
+						// The second time, the strings are drawn from the cache
+						drawText(font, surface);
+						const uint32 first = checksum(surface, 2166136261u);
+						drawText(font, surface);
+						TS_ASSERT_EQUALS(checksum(surface, 2166136261u), first);
+
+						hash = checksum(surface, hash);
+						surface.free();
+					}
+
+					TSM_ASSERT_EQUALS(Common::String::format("%s, size %d, render mode %d", fonts[f], sizes[s], m).c_str(),
+					                  hash, checksums[f][s][m]);
+					delete font;
+				}
+			}
+		}
+#endif
+	}
+
+	void test_string_cache_limit() {
+#ifdef USE_FREETYPE2
+		Graphics::Font *font = loadFont("FreeSans.ttf", 24, Graphics::kTTFRenderModeLight);
+		TSM_ASSERT("Could not load FreeSans.ttf", font);
+		if (!font)
+			return;
+
+		Graphics::Surface surface;
+		surface.create(400, 40, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+
+		// Fill the cache way past its limit with different strings, while
+		// drawing one string over and over
+		const Common::String kept = "Drawn every time";
+		font->drawString(&surface, kept, 0, 0, surface.w, 0xFFFF);
+
+		Graphics::TTFCacheStats stats = Graphics::getTTFCacheStats(*font);
+		const uint32 keptBytes = stats.stringBytes;
+		TS_ASSERT_EQUALS(stats.strings, 1u);
+		TS_ASSERT_LESS_THAN(0u, keptBytes);
+
+		uint32 maxBytes = 0;
+		const int kStrings = 5 * stats.maxStringBytes / keptBytes;
+		for (int i = 0; i < kStrings; i++) {
+			font->drawString(&surface, Common::String::format("String number %d", i), 0, 0, surface.w, 0xFFFF);
+			font->drawString(&surface, kept, 0, 0, surface.w, 0xFFFF);
+
+			stats = Graphics::getTTFCacheStats(*font);
+			maxBytes = MAX(maxBytes, stats.stringBytes);
+		}
+
+		TS_ASSERT_LESS_THAN_EQUALS(maxBytes, stats.maxStringBytes);
+		TS_ASSERT_LESS_THAN(stats.strings, (uint)kStrings);
+		// The string which is drawn all the time is never evicted
+		TS_ASSERT_EQUALS(stats.stringHits, (uint32)kStrings);
+
+		// While the first of the others is long gone
+		font->drawString(&surface, "String number 0", 0, 0, surface.w, 0xFFFF);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats(*font).stringHits, (uint32)kStrings);
+
+		// Strings which would take a large part of the cache are not kept
+		Common::String text;
+		for (int i = 0; i < 400; i++)
+			text += (char)('A' + i % 26);
+		Graphics::Surface wide;
+		wide.create(8000, 40, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		const uint strings = Graphics::getTTFCacheStats(*font).strings;
+		font->drawString(&wide, text, 0, 0, wide.w, 0xFFFF);
+		TS_ASSERT_EQUALS(Graphics::getTTFCacheStats(*font).strings, strings);
+
+		wide.free();
+		surface.free();
+		delete font;
+#endif
+	}
+	void test_atlas_eviction() {
+#ifdef USE_FREETYPE2
+		// Glyphs this large do not all fit into the atlas at once
+		Graphics::Font *font = loadFont("FreeSans.ttf", 160, Graphics::kTTFRenderModeNormal);
+		TSM_ASSERT("Could not load FreeSans.ttf", font);
+		if (!font)
+			return;
+
+		Graphics::TTFCacheStats stats = Graphics::getTTFCacheStats(*font);
+		uint32 glyphBytes = 0;
+		for (uint32 chr = 0x21; chr < 0x100; chr++) {
+			const Common::Rect box = font->getBoundingBox(chr);
+			glyphBytes += box.width() * box.height();
+		}
+		TS_ASSERT_LESS_THAN(stats.maxAtlasBytes, glyphBytes);
+
+		Graphics::Surface surface;
+		surface.create(1600, font->getFontHeight(), Graphics::PixelFormat::createFormatCLUT8());
+
+		// Loading the font already cleared the pages with the glyphs of the
+		// text, so this checks that they are rendered again
+		const uint32 expected = 0xA94C1C86;
+		const Common::String text = "Ag\xE9";
+		surface.fillRect(Common::Rect(surface.w, surface.h), 0);
+		font->drawString(&surface, text, 0, 0, surface.w, 1);
+		TS_ASSERT_EQUALS(checksum(surface, 2166136261u), expected);
+
+		// Draw all other characters, which clears the pages holding the
+		// glyphs of the text above
+		for (uint32 chr = 0x21; chr < 0x100; chr++) {
+			font->drawChar(&surface, chr, 0, 0, 1);
+			stats = Graphics::getTTFCacheStats(*font);
+			TS_ASSERT_LESS_THAN_EQUALS(stats.atlasBytes, stats.maxAtlasBytes);
+		}
+
+		// And again, bypassing the string cache
+		surface.fillRect(Common::Rect(surface.w, surface.h), 0);
+		font->drawString(&surface, text + " ", 0, 0, surface.w, 1);
+		TS_ASSERT_EQUALS(checksum(surface, 2166136261u), expected);
+
+		surface.free();
+		delete font;
+#endif
+	}
+};
@@ -0,0 +1,188 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/cpudetect.h"
+#include "common/rect.h"
+#include "common/str.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "test/common/benchmark.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite
+{
+	enum Subsampling {
+		k444,
+		k420,
+		k410
+	};
+
+	static void fillRandom(byte *data, uint size, uint32 seed) {
+		for (uint i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+	}
+
+	static int clip(int value, int min, int max) {
+		return value < min ? min : (value > max ? max : value);
+	}
+
+	/** The color of one pixel, computed the way the lookup tables are built. */
+	static uint32 referenceColor(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, byte y, byte u, byte v) {
+		const int16 cr = v - 128, cb = u - 128;
+		int rgb[3] = {
+			y + (int16)((0.419 / 0.299) * cr),
+			y + (int16)(-(0.299 / 0.419) * cr) + (int16)(-(0.114 / 0.331) * cb),
+			y + (int16)((0.587 / 0.331) * cb)
+		};
+
+		for (int i = 0; i < 3; i++) {
+			if (scale == Graphics::YUVToRGBManager::kScaleITU)
+				rgb[i] = (clip(rgb[i], 16, 235) - 16) * 255 / 219;
+			else
+				rgb[i] = clip(rgb[i], 0, 255);
+		}
+
+		return format.RGBToColor(rgb[0], rgb[1], rgb[2]);
+	}
+
+	struct Planes {
+		int width, height, yPitch, uvPitch;
+		byte *y, *u, *v;
+
+		Planes(int w, int h, Subsampling subsampling, uint32 seed) : width(w), height(h) {
+			const int uvWidth = (subsampling == k444) ? w : (subsampling == k420 ? w / 2 : w / 4 + 1);
+			const int uvHeight = (subsampling == k444) ? h : (subsampling == k420 ? h / 2 : h / 4 + 1);
+			// Padding at the end of the rows
+			yPitch = w + 5;
+			uvPitch = uvWidth + 3;
+			y = new byte[yPitch * h];
+			u = new byte[uvPitch * uvHeight];
+			v = new byte[uvPitch * uvHeight];
+			fillRandom(y, yPitch * h, seed);
+			fillRandom(u, uvPitch * uvHeight, seed + 1);
+			fillRandom(v, uvPitch * uvHeight, seed + 2);
+		}
+
+		~Planes() {
+			delete[] y;
+			delete[] u;
+			delete[] v;
+		}
+	};
+
+	static void convert(Graphics::Surface &dst, Graphics::YUVToRGBManager::LuminanceScale scale, Subsampling subsampling, const Planes &planes) {
+		switch (subsampling) {
+		case k444:
+			YUVToRGBMan.convert444(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		case k420:
+			YUVToRGBMan.convert420(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		case k410:
+			YUVToRGBMan.convert410(&dst, scale, planes.y, planes.u, planes.v, planes.width, planes.height, planes.yPitch, planes.uvPitch);
+			break;
+		}
+	}
+
+	static bool conversionMatches(const Graphics::PixelFormat &format, Graphics::YUVToRGBManager::LuminanceScale scale, Subsampling subsampling) {
+		// A width which leaves a tail for the lookup table code with all
+		// register sizes, and a target wider than the image
+		const int w = 70, h = 6;
+		const Planes planes(w, h, subsampling, w * h + scale * 3 + subsampling);
+
+		Graphics::Surface target;
+		target.create(w + 10, h, format);
+
+		bool match = true;
+		const uint32 masks[] = { 0, Common::kCPUFeatureSSE2 | Common::kCPUFeatureNEON, 0xFFFFFFFF };
+		for (uint i = 0; i < ARRAYSIZE(masks); i++) {
+			Common::setCPUFeatureMask(masks[i]);
+			Graphics::Surface dst = target.getSubArea(Common::Rect(w, h));
+			convert(dst, scale, subsampling, planes);
+
+			for (int y = 0; y < h; y++) {
+				for (int x = 0; x < w; x++) {
+					const int uvX = (subsampling == k444) ? x : x / 2;
+					const int uvY = (subsampling == k444) ? y : y / 2;
+					const byte u = planes.u[uvY * planes.uvPitch + uvX];
+					const byte v = planes.v[uvY * planes.uvPitch + uvX];
+					const uint32 expected = referenceColor(format, scale, planes.y[y * planes.yPitch + x], u, v);
+					const uint32 actual = (format.bytesPerPixel == 2) ? *(const uint16 *)dst.getBasePtr(x, y) : *(const uint32 *)dst.getBasePtr(x, y);
+					match = match && expected == actual;
+				}
+			}
+		}
+		Common::setCPUFeatureMask(0xFFFFFFFF);
+
+		target.free();
+		return match;
+	}
+
+	public:
+	void test_conversion_matches_reference() {
+		static const struct {
+			const char *name;
+			Graphics::PixelFormat format;
+		} formats[] = {
+			{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+			{ "ARGB1555", Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15) },
+			{ "ARGB8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) },
+			{ "RGBA8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0) },
+			{ "XBGR8888", Graphics::PixelFormat(4, 8, 8, 8, 0, 0, 8, 16, 0) },
+			{ "RGB666 in 32 bits", Graphics::PixelFormat(4, 6, 6, 6, 0, 12, 6, 0, 0) }
+		};
+
+		for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+			for (int scale = 0; scale < 2; scale++) {
+				for (int subsampling = k444; subsampling <= k420; subsampling++) {
+					const bool match = conversionMatches(formats[i].format, (Graphics::YUVToRGBManager::LuminanceScale)scale, (Subsampling)subsampling);
+					TSM_ASSERT(Common::String::format("%s, %s, %s", formats[i].name, scale ? "ITU" : "full",
+					                                  subsampling == k444 ? "444" : "420").c_str(), match);
+				}
+			}
+		}
+	}
+
+	void test_benchmark() {
+		if (!BenchmarkTimer::enabled())
+			return;
+
+		const int w = 1280, h = 720;
+		const int kFrames = 10;
+
+		static const struct {
+			const char *name;
+			Graphics::PixelFormat format;
+		} formats[] = {
+			{ "RGB565", Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0) },
+			{ "ARGB8888", Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24) }
+		};
+		static const char *const subsamplingNames[] = { "444", "420", "410" };
+
+		for (int subsampling = k444; subsampling <= k410; subsampling++) {
+			const Planes planes(w, h, (Subsampling)subsampling, 7);
+
+			for (uint i = 0; i < ARRAYSIZE(formats); i++) {
+				Graphics::Surface dst;
+				dst.create(w, h, formats[i].format);
+
+				for (int simd = 0; simd < 2; simd++) {
+					// The 410 converter is not vectorized
+					if (simd && subsampling == k410)
+						continue;
+
+					Common::setCPUFeatureMask(simd ? 0xFFFFFFFF : 0);
+					BenchmarkTimer timer;
+					for (int f = 0; f < kFrames; f++)
+						convert(dst, Graphics::YUVToRGBManager::kScaleITU, (Subsampling)subsampling, planes);
+					timer.report(Common::String::format("YUV%s to %s, %s", subsamplingNames[subsampling], formats[i].name, simd ? "SIMD" : "scalar").c_str(),
+					             (double)w * h * kFrames, "pixel");
+				}
+				Common::setCPUFeatureMask(0xFFFFFFFF);
+
+				dst.free();
+			}
+		}
+	}
+};
@@ -0,0 +1,233 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "graphics/surface.h"
+#include "graphics/VectorRenderer.h"
+#include "gui/ThemeDrawCache.h"
+
+/**
+ * Just enough of a system for the vector renderers, which take the pixel
+ * format from the overlay.
+ */
+class ThemeDrawCacheTestSystem : public OSystem {
+public:
+	ThemeDrawCacheTestSystem(const Graphics::PixelFormat &format) : _format(format) {}
+
+	virtual MutexRef createMutex() { return 0; }
+	virtual void lockMutex(MutexRef mutex) {}
+	virtual void unlockMutex(MutexRef mutex) {}
+	virtual void deleteMutex(MutexRef mutex) {}
+
+	virtual uint32 getMillis(bool skipRecord = false) { return 0; }
+	virtual void delayMillis(uint msecs) {}
+	virtual void getTimeAndDate(TimeDate &t) const {}
+
+	virtual const GraphicsMode *getSupportedGraphicsModes() const { return 0; }
+	virtual int getDefaultGraphicsMode() const { return 0; }
+	virtual bool setGraphicsMode(int mode) { return false; }
+	virtual int getGraphicsMode() const { return 0; }
+	virtual Graphics::PixelFormat getScreenFormat() const { return _format; }
+	virtual Common::List<Graphics::PixelFormat> getSupportedFormats() const { return Common::List<Graphics::PixelFormat>(); }
+	virtual void initSize(uint width, uint height, const Graphics::PixelFormat *format = NULL) {}
+	virtual int16 getHeight() { return 0; }
+	virtual int16 getWidth() { return 0; }
+	virtual PaletteManager *getPaletteManager() { return 0; }
+	virtual void copyRectToScreen(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual Graphics::Surface *lockScreen() { return 0; }
+	virtual void unlockScreen() {}
+	virtual void fillScreen(uint32 col) {}
+	virtual void updateScreen() {}
+	virtual void setShakePos(int shakeOffset) {}
+	virtual void showOverlay() {}
+	virtual void hideOverlay() {}
+	virtual Graphics::PixelFormat getOverlayFormat() const { return _format; }
+	virtual void clearOverlay() {}
+	virtual void grabOverlay(void *buf, int pitch) {}
+	virtual void copyRectToOverlay(const void *buf, int pitch, int x, int y, int w, int h) {}
+	virtual int16 getOverlayHeight() { return 0; }
+	virtual int16 getOverlayWidth() { return 0; }
+	virtual bool showMouse(bool visible) { return false; }
+	virtual void warpMouse(int x, int y) {}
+	virtual void setMouseCursor(const void *buf, uint w, uint h, int hotspotX, int hotspotY, uint32 keycolor, bool dontScale = false, const Graphics::PixelFormat *format = NULL) {}
+	virtual Audio::Mixer *getMixer() { return 0; }
+	virtual void quit() {}
+	virtual void displayMessageOnOSD(const char *msg) {}
+	virtual void logMessage(LogMessageType::Type type, const char *message) {}
+
+private:
+	const Graphics::PixelFormat _format;
+};
+
+class ThemeDrawCacheTestSuite : public CxxTest::TestSuite
+{
+	/** A step with the defaults of ThemeParser. */
+	static Graphics::DrawStep newStep(Graphics::DrawingFunctionCallback call) {
+		Graphics::DrawStep step = Graphics::DrawStep();
+		step.xAlign = Graphics::DrawStep::kVectorAlignManual;
+		step.yAlign = Graphics::DrawStep::kVectorAlignManual;
+		step.factor = 1;
+		step.autoWidth = true;
+		step.autoHeight = true;
+		step.fillMode = Graphics::VectorRenderer::kFillDisabled;
+		step.scale = (1 << 16);
+		step.radius = 0xFF;
+		step.drawingCall = call;
+		return step;
+	}
+
+	static void setColor(Graphics::DrawStep::Color &color, uint8 r, uint8 g, uint8 b) {
+		color.r = r;
+		color.g = g;
+		color.b = b;
+		color.set = true;
+	}
+
+	static void finish(GUI::WidgetDrawData &data) {
+		uint8 shadow = 0;
+		for (Common::List<Graphics::DrawStep>::const_iterator step = data._steps.begin(); step != data._steps.end(); ++step)
+			shadow = MAX(shadow, MAX(step->shadow, step->bevel));
+		data._backgroundOffset = shadow;
+		data.calcCacheInfo();
+	}
+
+	/**
+	 * Fill the surface with a pattern, so that backgrounds differ. It
+	 * repeats every 64 pixels.
+	 */
+	static void fillBackground(Graphics::Surface &surface) {
+		for (int y = 0; y < surface.h; y++) {
+			for (int x = 0; x < surface.w; x++) {
+				const uint32 color = surface.format.RGBToColor((x / 16 % 4) * 60, (y / 16 % 4) * 80, 128);
+				if (surface.format.bytesPerPixel == 2)
+					*(uint16 *)surface.getBasePtr(x, y) = color;
+				else
+					*(uint32 *)surface.getBasePtr(x, y) = color;
+			}
+		}
+	}
+
+	static bool equal(const Graphics::Surface &a, const Graphics::Surface &b) {
+		for (int y = 0; y < a.h; y++) {
+			if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Draw some items over and over, with the cache and without, and check
+	 * that the results are the same each time.
+	 */
+	static void checkRenderer(int mode, const Graphics::PixelFormat &format) {
+		ThemeDrawCacheTestSystem system(format);
+		OSystem *oldSystem = g_system;
+		g_system = &system;
+
+		// A gradient filled button with a shadow, which sets its colors
+		GUI::WidgetDrawData button;
+		Graphics::DrawStep step = newStep(&Graphics::VectorRenderer::drawCallback_ROUNDSQ);
+		step.radius = 5;
+		step.shadow = 3;
+		step.stroke = 1;
+		step.fillMode = Graphics::VectorRenderer::kFillGradient;
+		setColor(step.fgColor, 10, 20, 30);
+		setColor(step.gradColor1, 200, 180, 40);
+		setColor(step.gradColor2, 120, 60, 10);
+		button._steps.push_back(step);
+		finish(button);
+
+		// A square and an arrow on the right in the colors which were set
+		// before
+		GUI::WidgetDrawData arrow;
+		step = newStep(&Graphics::VectorRenderer::drawCallback_SQUARE);
+		step.fillMode = Graphics::VectorRenderer::kFillForeground;
+		arrow._steps.push_back(step);
+		step = newStep(&Graphics::VectorRenderer::drawCallback_TRIANGLE);
+		step.fillMode = Graphics::VectorRenderer::kFillBackground;
+		step.extraData = Graphics::VectorRenderer::kTriangleDown;
+		step.autoWidth = step.autoHeight = false;
+		step.w = step.h = 10;
+		step.xAlign = Graphics::DrawStep::kVectorAlignRight;
+		step.yAlign = Graphics::DrawStep::kVectorAlignCenter;
+		step.padding.right = 2;
+		arrow._steps.push_back(step);
+		finish(arrow);
+
+		// A beveled box, which is darkened inside
+		GUI::WidgetDrawData box;
+		step = newStep(&Graphics::VectorRenderer::drawCallback_BEVELSQ);
+		step.bevel = 2;
+		step.fillMode = Graphics::VectorRenderer::kFillBackground;
+		setColor(step.bevelColor, 250, 250, 250);
+		setColor(step.bgColor, 0, 0, 0);
+		box._steps.push_back(step);
+		finish(box);
+
+		TS_ASSERT(button._cacheable);
+		TS_ASSERT(arrow._cacheable);
+		TS_ASSERT(box._cacheable);
+
+		Graphics::Surface background, cached, drawn;
+		background.create(320, 200, format);
+		fillBackground(background);
+		cached.copyFrom(background);
+		drawn.copyFrom(background);
+
+		Graphics::VectorRenderer *renderer = Graphics::createRenderer(mode);
+		GUI::DrawDataCache cache, noCache;
+		cache.setMaxBytes(1024 * 1024);
+		noCache.setMaxBytes(0);
+
+		// Items of the same size at positions of both parities, over the
+		// same background or another one. As in the GUI, the background is
+		// restored before drawing, but not where the items overlap.
+		static const int positions[][2] = {
+			{ 10, 10 }, { 74, 10 }, { 11, 75 }, { 139, 139 }, { 10, 10 }, { 30, 20 }, { 74, 10 }, { 75, 11 }
+		};
+		GUI::WidgetDrawData *const items[] = { &button, &arrow, &box };
+
+		for (int pass = 0; pass < 2; pass++) {
+			for (uint i = 0; i < ARRAYSIZE(positions); i++) {
+				for (uint j = 0; j < ARRAYSIZE(items); j++) {
+					const Common::Rect area(positions[i][0] + j * 20, positions[i][1] + j * 10,
+					                        positions[i][0] + j * 20 + 60, positions[i][1] + j * 10 + 24);
+					Common::Rect extendedRect = area;
+					extendedRect.grow(GUI::ThemeEngine::kDirtyRectangleThreshold + items[j]->_backgroundOffset);
+
+					// The inherited colors change from pass to pass
+					for (int k = 0; k < 2; k++) {
+						Graphics::Surface &surface = k ? drawn : cached;
+						if (j == 0)
+							surface.copyRectToSurface(background, extendedRect.left, extendedRect.top, extendedRect);
+						renderer->setSurface(&surface);
+						renderer->setFgColor(40 + pass * 100, 200, 90);
+						renderer->setBgColor(250, 90 - pass * 50, 30);
+						(k ? noCache : cache).draw(renderer, items[j], area, extendedRect, pass);
+					}
+
+					TSM_ASSERT(Common::String::format("pass %d, position %d, item %d", pass, i, j).c_str(), equal(cached, drawn));
+				}
+			}
+		}
+
+		// The cache was used at all
+		TS_ASSERT_LESS_THAN(0u, cache.getStats().hits);
+		TS_ASSERT_EQUALS(noCache.getStats().hits, 0u);
+
+		delete renderer;
+		background.free();
+		cached.free();
+		drawn.free();
+		g_system = oldSystem;
+	}
+
+public:
+	void test_cache_matches_drawing() {
+		checkRenderer(GUI::ThemeEngine::kGfxStandard, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkRenderer(GUI::ThemeEngine::kGfxStandard, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+#ifndef DISABLE_FANCY_THEMES
+		checkRenderer(GUI::ThemeEngine::kGfxAntialias, Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkRenderer(GUI::ThemeEngine::kGfxAntialias, Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0));
+#endif
+	}
+};
@@ -5,13 +5,21 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h
-TEST_LIBS    := audio/libaudio.a common/libcommon.a
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/gui/*.h
+TEST_LIBS    := gui/libgui.a graphics/libgraphics.a audio/libaudio.a common/libcommon.a
 
 #
 TEST_FLAGS   := --runner=StdioPrinter --no-std --no-eh --include=$(srcdir)/test/cxxtest_mingw.h
 TEST_CFLAGS  := -I$(srcdir)/test/cxxtest
+# The benchmarks in the test suite need clock() and getenv().
+TEST_CFLAGS  += -DFORBIDDEN_SYMBOL_ALLOW_ALL
+# Some tests read data files which are part of the sources, like fonts.
+TEST_CFLAGS  += -DTEST_SRCDIR=\"$(srcdir)\"
 TEST_LDFLAGS := $(LIBS)
+ifdef POSIX
+# The mixer tests run the mixer callback in a thread of its own.
+TEST_LDFLAGS += -lpthread
+endif
 TEST_CXXFLAGS := $(filter-out -Wglobal-constructors,$(CXXFLAGS))
 
 ifdef HAVE_GCC3
@@ -28,6 +36,9 @@ endif
 
 test: test/runner
 	./test/runner
+# The same tests, including the benchmarks, which report their timings.
+benchmark: test/runner
+	SCUMMVM_BENCHMARK=1 ./test/runner
 test/runner: test/runner.cpp $(TEST_LIBS)
 	$(QUIET_LINK)$(CXX) $(TEST_CXXFLAGS) $(CPPFLAGS) $(TEST_CFLAGS) -o $@ $+ $(TEST_LDFLAGS)
 test/runner.cpp: $(TESTS)
@@ -39,4 +50,4 @@ clean: clean-test
 clean-test:
 	-$(RM) test/runner.cpp test/runner
 
-.PHONY: test clean-test
+.PHONY: test benchmark clean-test